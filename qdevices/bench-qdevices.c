@@ -0,0 +1,930 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sys/types.h>
+#include <sys/resource.h>
+
+#include <err.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "dynar.h"
+#include "msg.h"
+#include "node-list.h"
+#include "pr-poll-loop.h"
+#include "timer-list.h"
+#include "tlv.h"
+#include "utils.h"
+
+#define BENCH_DEFAULT_REPEATS		5
+#define BENCH_MAX_REPEATS		1000
+
+#define BENCH_MSG_ITERATIONS		100000
+#define BENCH_MSG_NODES			16
+#define BENCH_MSG_MAX_SIZE		(1 << 20)
+#define BENCH_NODE_LIST_OPS		1000000
+#define BENCH_DYNAR_CHUNK_SIZE		64
+#define BENCH_DYNAR_TOTAL_SIZE		(16 << 20)
+#define BENCH_POLL_ITERATIONS		10000
+
+/*
+ * Quick mode divides number of iterations and skips biggest sizes
+ */
+#define BENCH_QUICK_DIVISOR		10
+#define BENCH_QUICK_MAX_SIZE		10000
+
+enum bench_output_format {
+	BENCH_OUTPUT_FORMAT_CSV,
+	BENCH_OUTPUT_FORMAT_JSON,
+};
+
+struct bench_settings {
+	size_t repeats;
+	int quick;
+	const char *filter;
+	enum bench_output_format output_format;
+};
+
+/*
+ * Run function returns number of nanoseconds spent in measured code and
+ * number of operations it executed (in ops).
+ */
+typedef uint64_t (*bench_run_fn)(size_t size, size_t iterations, size_t *ops, void *user_data);
+
+static struct bench_settings bench_settings;
+static size_t bench_no_results;
+static uint32_t bench_rand_state;
+
+static const size_t bench_timer_list_sizes[] = {1000, 10000, 100000, 1000000};
+static const size_t bench_tlv_iter_sizes[] = {3, 16, 256, 1024};
+static const size_t bench_node_list_sizes[] = {3, 16, 64, 256};
+static const size_t bench_dynar_sizes[] = {1024, 64 * 1024, 1024 * 1024, 16 * 1024 * 1024};
+static const size_t bench_poll_sizes[] = {1, 16, 256, 1024};
+
+struct bench_msg_type {
+	enum msg_type type;
+	const char *name;
+};
+
+static const struct bench_msg_type bench_msg_types[] = {
+	{MSG_TYPE_PREINIT, "preinit"},
+	{MSG_TYPE_PREINIT_REPLY, "preinit_reply"},
+	{MSG_TYPE_STARTTLS, "starttls"},
+	{MSG_TYPE_INIT, "init"},
+	{MSG_TYPE_INIT_REPLY, "init_reply"},
+	{MSG_TYPE_SERVER_ERROR, "server_error"},
+	{MSG_TYPE_SET_OPTION, "set_option"},
+	{MSG_TYPE_SET_OPTION_REPLY, "set_option_reply"},
+	{MSG_TYPE_ECHO_REQUEST, "echo_request"},
+	{MSG_TYPE_ECHO_REPLY, "echo_reply"},
+	{MSG_TYPE_NODE_LIST, "node_list"},
+	{MSG_TYPE_NODE_LIST_REPLY, "node_list_reply"},
+	{MSG_TYPE_ASK_FOR_VOTE, "ask_for_vote"},
+	{MSG_TYPE_ASK_FOR_VOTE_REPLY, "ask_for_vote_reply"},
+	{MSG_TYPE_VOTE_INFO, "vote_info"},
+	{MSG_TYPE_VOTE_INFO_REPLY, "vote_info_reply"},
+	{MSG_TYPE_HEURISTICS_CHANGE, "heuristics_change"},
+	{MSG_TYPE_HEURISTICS_CHANGE_REPLY, "heuristics_change_reply"},
+};
+
+static uint64_t
+bench_now_ns(void)
+{
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+		err(EXIT_FAILURE, "Can't get monotonic time");
+	}
+
+	return ((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+}
+
+/*
+ * Deterministic xorshift generator so every run uses same data
+ */
+static uint32_t
+bench_rand(void)
+{
+
+	bench_rand_state ^= bench_rand_state << 13;
+	bench_rand_state ^= bench_rand_state >> 17;
+	bench_rand_state ^= bench_rand_state << 5;
+
+	return (bench_rand_state);
+}
+
+static size_t
+bench_iterations(size_t iterations)
+{
+
+	if (bench_settings.quick) {
+		iterations /= BENCH_QUICK_DIVISOR;
+	}
+
+	return (iterations > 0 ? iterations : 1);
+}
+
+static int
+bench_size_enabled(size_t size)
+{
+
+	return (!bench_settings.quick || size <= BENCH_QUICK_MAX_SIZE);
+}
+
+static int
+bench_uint64_cmp(const void *a, const void *b)
+{
+	uint64_t ua, ub;
+
+	ua = *(const uint64_t *)a;
+	ub = *(const uint64_t *)b;
+
+	return ((ua > ub) - (ua < ub));
+}
+
+static void
+bench_output_header(void)
+{
+
+	switch (bench_settings.output_format) {
+	case BENCH_OUTPUT_FORMAT_CSV:
+		printf("benchmark,size,iterations,ops,repeats,"
+		    "min_ns_per_op,median_ns_per_op,max_ns_per_op\n");
+		break;
+	case BENCH_OUTPUT_FORMAT_JSON:
+		printf("{\"format_version\":1,\"results\":[");
+		break;
+	}
+}
+
+static void
+bench_output_footer(void)
+{
+
+	switch (bench_settings.output_format) {
+	case BENCH_OUTPUT_FORMAT_CSV:
+		break;
+	case BENCH_OUTPUT_FORMAT_JSON:
+		printf("%s]}\n", (bench_no_results > 0 ? "\n" : ""));
+		break;
+	}
+}
+
+static void
+bench_output_result(const char *name, size_t size, size_t iterations, size_t ops,
+    double min_ns, double median_ns, double max_ns)
+{
+
+	switch (bench_settings.output_format) {
+	case BENCH_OUTPUT_FORMAT_CSV:
+		printf("%s,%zu,%zu,%zu,%zu,%.2f,%.2f,%.2f\n", name, size, iterations, ops,
+		    bench_settings.repeats, min_ns, median_ns, max_ns);
+		break;
+	case BENCH_OUTPUT_FORMAT_JSON:
+		printf("%s\n{\"benchmark\":\"%s\",\"size\":%zu,\"iterations\":%zu,\"ops\":%zu,"
+		    "\"repeats\":%zu,\"min_ns_per_op\":%.2f,\"median_ns_per_op\":%.2f,"
+		    "\"max_ns_per_op\":%.2f}", (bench_no_results > 0 ? "," : ""),
+		    name, size, iterations, ops, bench_settings.repeats,
+		    min_ns, median_ns, max_ns);
+		break;
+	}
+
+	bench_no_results++;
+	fflush(stdout);
+}
+
+/*
+ * Execute fn one time for warm-up and then bench_settings.repeats times.
+ * Each run starts with same pseudo random seed.
+ */
+static void
+bench_run(const char *name, size_t size, size_t iterations, bench_run_fn fn, void *user_data)
+{
+	uint64_t *ns_per_op;
+	uint64_t elapsed;
+	size_t ops;
+	size_t zi;
+
+	if (bench_settings.filter != NULL && strstr(name, bench_settings.filter) == NULL) {
+		return;
+	}
+
+	ns_per_op = malloc(sizeof(*ns_per_op) * bench_settings.repeats);
+	if (ns_per_op == NULL) {
+		errx(EXIT_FAILURE, "Can't alloc results array");
+	}
+
+	ops = 0;
+
+	for (zi = 0; zi <= bench_settings.repeats; zi++) {
+		bench_rand_state = 2463534242U;
+		ops = 0;
+
+		elapsed = fn(size, iterations, &ops, user_data);
+
+		if (ops == 0) {
+			errx(EXIT_FAILURE, "Benchmark %s returned no operations", name);
+		}
+
+		if (zi > 0) {
+			/*
+			 * Store in picoseconds per operation to keep precision
+			 */
+			ns_per_op[zi - 1] = (elapsed * 1000) / ops;
+		}
+	}
+
+	qsort(ns_per_op, bench_settings.repeats, sizeof(*ns_per_op), bench_uint64_cmp);
+
+	bench_output_result(name, size, iterations, ops,
+	    ns_per_op[0] / 1000.0,
+	    ns_per_op[bench_settings.repeats / 2] / 1000.0,
+	    ns_per_op[bench_settings.repeats - 1] / 1000.0);
+
+	free(ns_per_op);
+}
+
+/*
+ * timer_list benchmarks
+ */
+static int
+bench_timer_list_cb(void *data1, void *data2)
+{
+
+	return (0);
+}
+
+static void
+bench_timer_list_fill(struct timer_list *tlist, size_t size, struct timer_list_entry **entries,
+    int short_interval)
+{
+	struct timer_list_entry *entry;
+	PRUint32 interval;
+	size_t zi;
+
+	for (zi = 0; zi < size; zi++) {
+		interval = (short_interval ? 1 : 1000 + bench_rand() % 100000);
+
+		entry = timer_list_add(tlist, interval, bench_timer_list_cb, NULL, NULL);
+		if (entry == NULL) {
+			errx(EXIT_FAILURE, "Can't add timer list entry");
+		}
+
+		if (entries != NULL) {
+			entries[zi] = entry;
+		}
+	}
+}
+
+static uint64_t
+bench_timer_list_add(size_t size, size_t iterations, size_t *ops, void *user_data)
+{
+	struct timer_list tlist;
+	uint64_t start, end;
+
+	timer_list_init(&tlist);
+
+	start = bench_now_ns();
+	bench_timer_list_fill(&tlist, size, NULL, 0);
+	end = bench_now_ns();
+
+	timer_list_free(&tlist);
+
+	*ops = size;
+
+	return (end - start);
+}
+
+static uint64_t
+bench_timer_list_reschedule(size_t size, size_t iterations, size_t *ops, void *user_data)
+{
+	struct timer_list tlist;
+	struct timer_list_entry **entries;
+	uint64_t start, end;
+	size_t zi;
+
+	entries = malloc(sizeof(*entries) * size);
+	if (entries == NULL) {
+		errx(EXIT_FAILURE, "Can't alloc timer list entries array");
+	}
+
+	timer_list_init(&tlist);
+	bench_timer_list_fill(&tlist, size, entries, 0);
+
+	start = bench_now_ns();
+	for (zi = 0; zi < size; zi++) {
+		timer_list_entry_reschedule(&tlist, entries[bench_rand() % size]);
+	}
+	end = bench_now_ns();
+
+	timer_list_free(&tlist);
+	free(entries);
+
+	*ops = size;
+
+	return (end - start);
+}
+
+static uint64_t
+bench_timer_list_expire(size_t size, size_t iterations, size_t *ops, void *user_data)
+{
+	struct timer_list tlist;
+	uint64_t start, end;
+
+	timer_list_init(&tlist);
+	bench_timer_list_fill(&tlist, size, NULL, 1);
+
+	/*
+	 * Wait until all timers are expired so only expiration is measured
+	 */
+	while (timer_list_time_to_expire(&tlist) != 0) {
+		(void)poll(NULL, 0, 1);
+	}
+	(void)poll(NULL, 0, 2);
+
+	start = bench_now_ns();
+	timer_list_expire(&tlist);
+	end = bench_now_ns();
+
+	if (tlist.size != 0) {
+		errx(EXIT_FAILURE, "Not all timer list entries expired");
+	}
+
+	timer_list_free(&tlist);
+
+	*ops = size;
+
+	return (end - start);
+}
+
+/*
+ * msg and tlv benchmarks
+ */
+static void
+bench_node_list_fill(struct node_list *nlist, size_t size)
+{
+	size_t zi;
+
+	node_list_init(nlist);
+
+	for (zi = 0; zi < size; zi++) {
+		if (node_list_add(nlist, zi + 1, bench_rand() % 4, TLV_NODE_STATE_MEMBER) == NULL) {
+			errx(EXIT_FAILURE, "Can't add node list entry");
+		}
+	}
+}
+
+static size_t
+bench_msg_create(enum msg_type type, struct dynar *msg, const struct node_list *nodes)
+{
+	struct tlv_ring_id ring_id;
+	struct tlv_tie_breaker tie_breaker;
+	enum msg_type *supported_msgs;
+	size_t no_supported_msgs;
+	enum tlv_opt_type *supported_opts;
+	size_t no_supported_opts;
+	enum tlv_decision_algorithm_type decision_algorithms[] = {
+	    TLV_DECISION_ALGORITHM_TYPE_FFSPLIT, TLV_DECISION_ALGORITHM_TYPE_LMS};
+	struct dynar echo_request;
+	size_t res;
+
+	ring_id.node_id = 1;
+	ring_id.seq = 42;
+	tie_breaker.mode = TLV_TIE_BREAKER_MODE_LOWEST;
+	tie_breaker.node_id = 0;
+
+	msg_get_supported_messages(&supported_msgs, &no_supported_msgs);
+	tlv_get_supported_options(&supported_opts, &no_supported_opts);
+
+	res = 0;
+
+	switch (type) {
+	case MSG_TYPE_PREINIT:
+		res = msg_create_preinit(msg, "benchcluster", 1, 1);
+		break;
+	case MSG_TYPE_PREINIT_REPLY:
+		res = msg_create_preinit_reply(msg, 1, 1, TLV_TLS_SUPPORTED, 1);
+		break;
+	case MSG_TYPE_STARTTLS:
+		res = msg_create_starttls(msg, 1, 1);
+		break;
+	case MSG_TYPE_INIT:
+		res = msg_create_init(msg, 1, 1, TLV_DECISION_ALGORITHM_TYPE_FFSPLIT,
+		    supported_msgs, no_supported_msgs, supported_opts, no_supported_opts,
+		    1, 8000, &tie_breaker, &ring_id);
+		break;
+	case MSG_TYPE_INIT_REPLY:
+		res = msg_create_init_reply(msg, 1, 1, TLV_REPLY_ERROR_CODE_NO_ERROR,
+		    supported_msgs, no_supported_msgs, supported_opts, no_supported_opts,
+		    32768, 32768, decision_algorithms,
+		    sizeof(decision_algorithms) / sizeof(decision_algorithms[0]));
+		break;
+	case MSG_TYPE_SERVER_ERROR:
+		res = msg_create_server_error(msg, 1, 1, TLV_REPLY_ERROR_CODE_INTERNAL_ERROR);
+		break;
+	case MSG_TYPE_SET_OPTION:
+		res = msg_create_set_option(msg, 1, 1, 1, 8000, 1,
+		    TLV_KEEP_ACTIVE_PARTITION_TIE_BREAKER_ENABLED);
+		break;
+	case MSG_TYPE_SET_OPTION_REPLY:
+		res = msg_create_set_option_reply(msg, 1, 1, 1, 8000, 1,
+		    TLV_KEEP_ACTIVE_PARTITION_TIE_BREAKER_ENABLED);
+		break;
+	case MSG_TYPE_ECHO_REQUEST:
+		res = msg_create_echo_request(msg, 1, 1);
+		break;
+	case MSG_TYPE_ECHO_REPLY:
+		dynar_init(&echo_request, BENCH_MSG_MAX_SIZE);
+		if (msg_create_echo_request(&echo_request, 1, 1) != 0) {
+			res = msg_create_echo_reply(msg, &echo_request);
+		}
+		dynar_destroy(&echo_request);
+		break;
+	case MSG_TYPE_NODE_LIST:
+		res = msg_create_node_list(msg, 1, TLV_NODE_LIST_TYPE_MEMBERSHIP,
+		    1, &ring_id, 0, 0, 0, TLV_QUORATE_INQUORATE, 1, TLV_HEURISTICS_PASS, nodes);
+		break;
+	case MSG_TYPE_NODE_LIST_REPLY:
+		res = msg_create_node_list_reply(msg, 1, TLV_NODE_LIST_TYPE_MEMBERSHIP,
+		    &ring_id, TLV_VOTE_ACK, 0, 0);
+		break;
+	case MSG_TYPE_ASK_FOR_VOTE:
+		res = msg_create_ask_for_vote(msg, 1);
+		break;
+	case MSG_TYPE_ASK_FOR_VOTE_REPLY:
+		res = msg_create_ask_for_vote_reply(msg, 1, &ring_id, TLV_VOTE_ACK);
+		break;
+	case MSG_TYPE_VOTE_INFO:
+		res = msg_create_vote_info(msg, 1, &ring_id, TLV_VOTE_ACK);
+		break;
+	case MSG_TYPE_VOTE_INFO_REPLY:
+		res = msg_create_vote_info_reply(msg, 1);
+		break;
+	case MSG_TYPE_HEURISTICS_CHANGE:
+		res = msg_create_heuristics_change(msg, 1, TLV_HEURISTICS_PASS);
+		break;
+	case MSG_TYPE_HEURISTICS_CHANGE_REPLY:
+		res = msg_create_heuristics_change_reply(msg, 1, &ring_id, TLV_HEURISTICS_PASS,
+		    TLV_VOTE_ACK);
+		break;
+	/*
+	 * Default is not defined intentionally. Compiler shows warning when msg type is added
+	 */
+	}
+
+	if (res == 0) {
+		errx(EXIT_FAILURE, "Can't create %s message", msg_type_to_str(type));
+	}
+
+	return (res);
+}
+
+static uint64_t
+bench_msg_create_run(size_t size, size_t iterations, size_t *ops, void *user_data)
+{
+	enum msg_type type = *(const enum msg_type *)user_data;
+	struct node_list nodes;
+	struct dynar msg;
+	uint64_t start, end;
+	size_t zi;
+
+	bench_node_list_fill(&nodes, BENCH_MSG_NODES);
+	dynar_init(&msg, BENCH_MSG_MAX_SIZE);
+
+	start = bench_now_ns();
+	for (zi = 0; zi < iterations; zi++) {
+		(void)bench_msg_create(type, &msg, &nodes);
+	}
+	end = bench_now_ns();
+
+	dynar_destroy(&msg);
+	node_list_free(&nodes);
+
+	*ops = iterations;
+
+	return (end - start);
+}
+
+static uint64_t
+bench_msg_decode_run(size_t size, size_t iterations, size_t *ops, void *user_data)
+{
+	enum msg_type type = *(const enum msg_type *)user_data;
+	struct node_list nodes;
+	struct dynar msg;
+	struct msg_decoded decoded_msg;
+	uint64_t start, end;
+	size_t zi;
+
+	bench_node_list_fill(&nodes, BENCH_MSG_NODES);
+	dynar_init(&msg, BENCH_MSG_MAX_SIZE);
+	(void)bench_msg_create(type, &msg, &nodes);
+	msg_decoded_init(&decoded_msg);
+
+	start = bench_now_ns();
+	for (zi = 0; zi < iterations; zi++) {
+		if (msg_decode(&msg, &decoded_msg) != 0) {
+			errx(EXIT_FAILURE, "Can't decode %s message", msg_type_to_str(type));
+		}
+	}
+	end = bench_now_ns();
+
+	msg_decoded_destroy(&decoded_msg);
+	dynar_destroy(&msg);
+	node_list_free(&nodes);
+
+	*ops = iterations;
+
+	return (end - start);
+}
+
+static uint64_t
+bench_tlv_iter_run(size_t size, size_t iterations, size_t *ops, void *user_data)
+{
+	struct node_list nodes;
+	struct dynar msg;
+	struct tlv_iterator tlv_iter;
+	struct tlv_node_info node_info;
+	uint64_t start, end;
+	size_t zi;
+	size_t no_options;
+	int res;
+
+	bench_node_list_fill(&nodes, size);
+	dynar_init(&msg, BENCH_MSG_MAX_SIZE);
+	(void)bench_msg_create(MSG_TYPE_NODE_LIST, &msg, &nodes);
+
+	no_options = 0;
+
+	start = bench_now_ns();
+	for (zi = 0; zi < iterations; zi++) {
+		tlv_iter_init(&msg, msg_get_header_length(), &tlv_iter);
+
+		while ((res = tlv_iter_next(&tlv_iter)) > 0) {
+			if (tlv_iter_get_type(&tlv_iter) == TLV_OPT_NODE_INFO &&
+			    tlv_iter_decode_node_info(&tlv_iter, &node_info) != 0) {
+				errx(EXIT_FAILURE, "Can't decode node info");
+			}
+
+			no_options++;
+		}
+
+		if (res != 0) {
+			errx(EXIT_FAILURE, "Can't iterate node list message");
+		}
+	}
+	end = bench_now_ns();
+
+	dynar_destroy(&msg);
+	node_list_free(&nodes);
+
+	*ops = no_options;
+
+	return (end - start);
+}
+
+/*
+ * node_list benchmarks
+ */
+static uint64_t
+bench_node_list_eq_run(size_t size, size_t iterations, size_t *ops, void *user_data)
+{
+	struct node_list list1, list2;
+	uint64_t start, end;
+	size_t zi;
+
+	bench_node_list_fill(&list1, size);
+	if (node_list_clone(&list2, &list1) != 0) {
+		errx(EXIT_FAILURE, "Can't clone node list");
+	}
+
+	start = bench_now_ns();
+	for (zi = 0; zi < iterations; zi++) {
+		if (node_list_eq(&list1, &list2) != 1) {
+			errx(EXIT_FAILURE, "Node lists are not equal");
+		}
+	}
+	end = bench_now_ns();
+
+	node_list_free(&list1);
+	node_list_free(&list2);
+
+	*ops = iterations;
+
+	return (end - start);
+}
+
+static uint64_t
+bench_node_list_clone_run(size_t size, size_t iterations, size_t *ops, void *user_data)
+{
+	struct node_list list1, list2;
+	uint64_t start, end;
+	size_t zi;
+
+	bench_node_list_fill(&list1, size);
+
+	start = bench_now_ns();
+	for (zi = 0; zi < iterations; zi++) {
+		if (node_list_clone(&list2, &list1) != 0) {
+			errx(EXIT_FAILURE, "Can't clone node list");
+		}
+		node_list_free(&list2);
+	}
+	end = bench_now_ns();
+
+	node_list_free(&list1);
+
+	*ops = iterations;
+
+	return (end - start);
+}
+
+/*
+ * dynar benchmarks
+ */
+static uint64_t
+bench_dynar_cat_run(size_t size, size_t iterations, size_t *ops, void *user_data)
+{
+	struct dynar array;
+	char chunk[BENCH_DYNAR_CHUNK_SIZE];
+	uint64_t start, end;
+	size_t zi, zj;
+
+	memset(chunk, 'x', sizeof(chunk));
+
+	start = bench_now_ns();
+	for (zi = 0; zi < iterations; zi++) {
+		dynar_init(&array, size);
+
+		for (zj = 0; zj < size / sizeof(chunk); zj++) {
+			if (dynar_cat(&array, chunk, sizeof(chunk)) != 0) {
+				errx(EXIT_FAILURE, "Can't append to dynar");
+			}
+		}
+
+		dynar_destroy(&array);
+	}
+	end = bench_now_ns();
+
+	*ops = iterations * (size / sizeof(chunk));
+
+	return (end - start);
+}
+
+/*
+ * pr_poll_loop benchmarks
+ */
+static int
+bench_poll_read_cb(int fd, void *user_data1, void *user_data2)
+{
+
+	return (0);
+}
+
+static uint64_t
+bench_pr_poll_loop_exec_run(size_t size, size_t iterations, size_t *ops, void *user_data)
+{
+	struct pr_poll_loop poll_loop;
+	int *pipes;
+	uint64_t start, end;
+	size_t zi;
+
+	/*
+	 * size - 1 idle pipes plus one pipe which is always readable so
+	 * pr_poll_loop_exec never blocks
+	 */
+	pipes = malloc(sizeof(*pipes) * size * 2);
+	if (pipes == NULL) {
+		errx(EXIT_FAILURE, "Can't alloc pipes array");
+	}
+
+	pr_poll_loop_init(&poll_loop);
+
+	for (zi = 0; zi < size; zi++) {
+		if (pipe(&pipes[zi * 2]) != 0) {
+			err(EXIT_FAILURE, "Can't create pipe");
+		}
+
+		if (pr_poll_loop_add_fd(&poll_loop, pipes[zi * 2], POLLIN, NULL,
+		    bench_poll_read_cb, NULL, NULL, NULL, NULL) != 0) {
+			errx(EXIT_FAILURE, "Can't add fd to poll loop");
+		}
+	}
+
+	if (write(pipes[1], "x", 1) != 1) {
+		err(EXIT_FAILURE, "Can't write to pipe");
+	}
+
+	start = bench_now_ns();
+	for (zi = 0; zi < iterations; zi++) {
+		if (pr_poll_loop_exec(&poll_loop) != 0) {
+			errx(EXIT_FAILURE, "Poll loop exec failed");
+		}
+	}
+	end = bench_now_ns();
+
+	pr_poll_loop_destroy(&poll_loop);
+
+	for (zi = 0; zi < size * 2; zi++) {
+		close(pipes[zi]);
+	}
+	free(pipes);
+
+	*ops = iterations;
+
+	return (end - start);
+}
+
+/*
+ * Each pipe needs two fds. Try to raise soft limit to hard limit and return
+ * maximum number of pipes which can be created.
+ */
+static size_t
+bench_max_pipes(void)
+{
+	struct rlimit rlim;
+
+	if (getrlimit(RLIMIT_NOFILE, &rlim) != 0) {
+		return (0);
+	}
+
+	if (rlim.rlim_cur < rlim.rlim_max) {
+		rlim.rlim_cur = rlim.rlim_max;
+		(void)setrlimit(RLIMIT_NOFILE, &rlim);
+		(void)getrlimit(RLIMIT_NOFILE, &rlim);
+	}
+
+	if (rlim.rlim_cur == RLIM_INFINITY) {
+		return (SIZE_MAX);
+	}
+
+	return (rlim.rlim_cur > 64 ? (rlim.rlim_cur - 64) / 2 : 0);
+}
+
+static void
+bench_all(void)
+{
+	char name[128];
+	size_t zi;
+	size_t max_pipes;
+
+	for (zi = 0; zi < sizeof(bench_timer_list_sizes) / sizeof(bench_timer_list_sizes[0]); zi++) {
+		if (!bench_size_enabled(bench_timer_list_sizes[zi])) {
+			continue;
+		}
+
+		bench_run("timer_list_add", bench_timer_list_sizes[zi], 1,
+		    bench_timer_list_add, NULL);
+		bench_run("timer_list_reschedule", bench_timer_list_sizes[zi], 1,
+		    bench_timer_list_reschedule, NULL);
+		bench_run("timer_list_expire", bench_timer_list_sizes[zi], 1,
+		    bench_timer_list_expire, NULL);
+	}
+
+	for (zi = 0; zi < sizeof(bench_msg_types) / sizeof(bench_msg_types[0]); zi++) {
+		snprintf(name, sizeof(name), "msg_create_%s", bench_msg_types[zi].name);
+		bench_run(name, BENCH_MSG_NODES, bench_iterations(BENCH_MSG_ITERATIONS),
+		    bench_msg_create_run, (void *)&bench_msg_types[zi].type);
+	}
+
+	for (zi = 0; zi < sizeof(bench_msg_types) / sizeof(bench_msg_types[0]); zi++) {
+		snprintf(name, sizeof(name), "msg_decode_%s", bench_msg_types[zi].name);
+		bench_run(name, BENCH_MSG_NODES, bench_iterations(BENCH_MSG_ITERATIONS),
+		    bench_msg_decode_run, (void *)&bench_msg_types[zi].type);
+	}
+
+	for (zi = 0; zi < sizeof(bench_tlv_iter_sizes) / sizeof(bench_tlv_iter_sizes[0]); zi++) {
+		bench_run("tlv_iter_node_list", bench_tlv_iter_sizes[zi],
+		    bench_iterations(BENCH_NODE_LIST_OPS / bench_tlv_iter_sizes[zi]),
+		    bench_tlv_iter_run, NULL);
+	}
+
+	for (zi = 0; zi < sizeof(bench_node_list_sizes) / sizeof(bench_node_list_sizes[0]); zi++) {
+		bench_run("node_list_eq", bench_node_list_sizes[zi],
+		    bench_iterations(BENCH_NODE_LIST_OPS / bench_node_list_sizes[zi]),
+		    bench_node_list_eq_run, NULL);
+		bench_run("node_list_clone", bench_node_list_sizes[zi],
+		    bench_iterations(BENCH_NODE_LIST_OPS / bench_node_list_sizes[zi]),
+		    bench_node_list_clone_run, NULL);
+	}
+
+	for (zi = 0; zi < sizeof(bench_dynar_sizes) / sizeof(bench_dynar_sizes[0]); zi++) {
+		if (!bench_size_enabled(bench_dynar_sizes[zi])) {
+			continue;
+		}
+
+		bench_run("dynar_cat", bench_dynar_sizes[zi],
+		    BENCH_DYNAR_TOTAL_SIZE / bench_dynar_sizes[zi], bench_dynar_cat_run, NULL);
+	}
+
+	max_pipes = bench_max_pipes();
+
+	for (zi = 0; zi < sizeof(bench_poll_sizes) / sizeof(bench_poll_sizes[0]); zi++) {
+		if (bench_poll_sizes[zi] > max_pipes) {
+			warnx("Skipping pr_poll_loop_exec with %zu fds because of fd limit",
+			    bench_poll_sizes[zi]);
+			continue;
+		}
+
+		bench_run("pr_poll_loop_exec", bench_poll_sizes[zi],
+		    bench_iterations(BENCH_POLL_ITERATIONS), bench_pr_poll_loop_exec_run, NULL);
+	}
+}
+
+static void
+usage(void)
+{
+
+	printf("usage: bench-qdevices [-hq] [-b filter] [-f csv|json] [-r repeats]\n");
+}
+
+static void
+cli_parse(int argc, char * const argv[])
+{
+	int ch;
+	long long int tmpll;
+
+	bench_settings.repeats = BENCH_DEFAULT_REPEATS;
+	bench_settings.output_format = BENCH_OUTPUT_FORMAT_CSV;
+
+	while ((ch = getopt(argc, argv, "hqb:f:r:")) != -1) {
+		switch (ch) {
+		case 'b':
+			bench_settings.filter = optarg;
+			break;
+		case 'f':
+			if (strcmp(optarg, "csv") == 0) {
+				bench_settings.output_format = BENCH_OUTPUT_FORMAT_CSV;
+			} else if (strcmp(optarg, "json") == 0) {
+				bench_settings.output_format = BENCH_OUTPUT_FORMAT_JSON;
+			} else {
+				errx(EXIT_FAILURE, "Output format %s is not supported", optarg);
+			}
+			break;
+		case 'q':
+			bench_settings.quick = 1;
+			break;
+		case 'r':
+			if (utils_strtonum(optarg, 1, BENCH_MAX_REPEATS, &tmpll) == -1) {
+				errx(EXIT_FAILURE, "Number of repeats must be between 1 and %u",
+				    BENCH_MAX_REPEATS);
+			}
+			bench_settings.repeats = (size_t)tmpll;
+			break;
+		case 'h':
+		case '?':
+			usage();
+			exit(EXIT_FAILURE);
+			break;
+		}
+	}
+}
+
+int
+main(int argc, char * const argv[])
+{
+
+	cli_parse(argc, argv);
+
+	bench_output_header();
+	bench_all();
+	bench_output_footer();
+
+	return (EXIT_SUCCESS);
+}
@@ -52,6 +52,9 @@ enum qdevice_tool_operation {
 	QDEVICE_TOOL_OPERATION_NONE,
 	QDEVICE_TOOL_OPERATION_SHUTDOWN,
 	QDEVICE_TOOL_OPERATION_STATUS,
+	QDEVICE_TOOL_OPERATION_FLIGHT_RECORDER,
+	QDEVICE_TOOL_OPERATION_SUBSCRIBE,
+	QDEVICE_TOOL_OPERATION_HEURISTICS_HISTORY,
 };
 
 enum qdevice_tool_exit_code {
@@ -66,18 +69,19 @@ static void
 usage(void)
 {
 
-	printf("usage: %s [-Hhsv] [-p qdevice_ipc_socket_path]\n",
+	printf("usage: %s [-Hehjrstv] [-p qdevice_ipc_socket_path]\n",
 	    QDEVICE_TOOL_PROGRAM_NAME);
 }
 
 static void
 cli_parse(int argc, char * const argv[], enum qdevice_tool_operation *operation,
-    int *verbose, char **socket_path)
+    int *verbose, int *json, char **socket_path)
 {
 	int ch;
 
 	*operation = QDEVICE_TOOL_OPERATION_NONE;
 	*verbose = 0;
+	*json = 0;
 	*socket_path = strdup(QDEVICE_DEFAULT_LOCAL_SOCKET_FILE);
 
 	if (*socket_path == NULL) {
@@ -85,14 +89,26 @@ cli_parse(int argc, char * const argv[], enum qdevice_tool_operation *operation,
 		    "Can't alloc memory for socket path string");
 	}
 
-	while ((ch = getopt(argc, argv, "Hhsvp:")) != -1) {
+	while ((ch = getopt(argc, argv, "Hehjrstvp:")) != -1) {
 		switch (ch) {
 		case 'H':
 			*operation = QDEVICE_TOOL_OPERATION_SHUTDOWN;
 			break;
+		case 'e':
+			*operation = QDEVICE_TOOL_OPERATION_SUBSCRIBE;
+			break;
+		case 'j':
+			*json = 1;
+			break;
 		case 's':
 			*operation = QDEVICE_TOOL_OPERATION_STATUS;
 			break;
+		case 'r':
+			*operation = QDEVICE_TOOL_OPERATION_FLIGHT_RECORDER;
+			break;
+		case 't':
+			*operation = QDEVICE_TOOL_OPERATION_HEURISTICS_HISTORY;
+			break;
 		case 'v':
 			*verbose = 1;
 			break;
@@ -119,7 +135,8 @@ cli_parse(int argc, char * const argv[], enum qdevice_tool_operation *operation,
 }
 
 static int
-store_command(struct dynar *str, enum qdevice_tool_operation operation, int verbose)
+store_command(struct dynar *str, enum qdevice_tool_operation operation, int verbose,
+    int json)
 {
 	const char *nline = "\n\0";
 	const int nline_len = 2;
@@ -138,6 +155,21 @@ store_command(struct dynar *str, enum qdevice_tool_operation operation, int verb
 			return (-1);
 		}
 		break;
+	case QDEVICE_TOOL_OPERATION_FLIGHT_RECORDER:
+		if (dynar_str_cat(str, "flight-recorder ") != 0) {
+			return (-1);
+		}
+		break;
+	case QDEVICE_TOOL_OPERATION_SUBSCRIBE:
+		if (dynar_str_cat(str, "subscribe ") != 0) {
+			return (-1);
+		}
+		break;
+	case QDEVICE_TOOL_OPERATION_HEURISTICS_HISTORY:
+		if (dynar_str_cat(str, "heuristics-history ") != 0) {
+			return (-1);
+		}
+		break;
 	}
 
 	if (verbose) {
@@ -146,6 +178,12 @@ store_command(struct dynar *str, enum qdevice_tool_operation operation, int verb
 		}
 	}
 
+	if (json) {
+		if (dynar_str_cat(str, "json ") != 0) {
+			return (-1);
+		}
+	}
+
 	if (dynar_cat(str, nline, nline_len) != 0) {
 		return (-1);
 	}
@@ -221,6 +259,7 @@ main(int argc, char * const argv[])
 {
 	enum qdevice_tool_operation operation;
 	int verbose;
+	int json;
 	char *socket_path;
 	int sock_fd;
 	FILE *sock;
@@ -230,7 +269,7 @@ main(int argc, char * const argv[])
 
 	exit_code = QDEVICE_TOOL_EXIT_CODE_NO_ERROR;
 
-	cli_parse(argc, argv, &operation, &verbose, &socket_path);
+	cli_parse(argc, argv, &operation, &verbose, &json, &socket_path);
 
 	dynar_init(&send_str, QDEVICE_DEFAULT_IPC_MAX_RECEIVE_SIZE);
 
@@ -245,7 +284,7 @@ main(int argc, char * const argv[])
 		err(QDEVICE_TOOL_EXIT_CODE_INTERNAL_ERROR, "Can't open QDevice socket fd");
 	}
 
-	if (store_command(&send_str, operation, verbose) != 0) {
+	if (store_command(&send_str, operation, verbose, json) != 0) {
 		errx(QDEVICE_TOOL_EXIT_CODE_INTERNAL_ERROR, "Can't store command");
 	}
 
@@ -255,6 +294,13 @@ main(int argc, char * const argv[])
 		errx(QDEVICE_TOOL_EXIT_CODE_INTERNAL_ERROR, "Can't send command");
 	}
 
+	if (operation == QDEVICE_TOOL_OPERATION_SUBSCRIBE) {
+		/*
+		 * Events should be visible as soon as they arrive
+		 */
+		(void)setvbuf(stdout, NULL, _IOLBF, 0);
+	}
+
 	res = read_ipc_reply(sock);
 	switch (res) {
 	case -1:
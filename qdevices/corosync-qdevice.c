@@ -39,6 +39,7 @@
 #include "dynar.h"
 #include "dynar-str.h"
 #include "dynar-getopt-lex.h"
+#include "flight-recorder.h"
 #include "log.h"
 #include "qdevice-advanced-settings.h"
 #include "qdevice-config.h"
@@ -72,6 +73,13 @@ signal_term_handler(int sig)
 	qdevice_ipc_close(global_instance);
 }
 
+static void
+signal_usr1_handler(int sig)
+{
+
+	flight_recorder_dump_request();
+}
+
 static void
 signal_handlers_register(void)
 {
@@ -89,6 +97,12 @@ signal_handlers_register(void)
 
 	sigaction(SIGTERM, &act, NULL);
 
+	act.sa_handler = signal_usr1_handler;
+	sigemptyset(&act.sa_mask);
+	act.sa_flags = SA_RESTART;
+
+	sigaction(SIGUSR1, &act, NULL);
+
 	act.sa_handler = SIG_DFL;
 	sigemptyset(&act.sa_mask);
 	act.sa_flags = SA_RESTART;
@@ -270,6 +284,15 @@ main(int argc, char * const argv[])
 		return (EXIT_FAILURE);
 	}
 
+	if (advanced_settings.log_async) {
+		log(LOG_DEBUG, "Starting asynchronous logging");
+		if (log_async_start(advanced_settings.log_async_queue_size) != 0) {
+			log(LOG_ERR, "Can't start asynchronous logging thread");
+
+			return (EXIT_FAILURE);
+		}
+	}
+
 	log(LOG_DEBUG, "Initializing votequorum");
 	qdevice_votequorum_init(&instance);
 
@@ -307,6 +330,12 @@ main(int argc, char * const argv[])
 		return (EXIT_FAILURE);
 	}
 
+	log(LOG_DEBUG, "Initializing flight recorder");
+	if (flight_recorder_init(advanced_settings.flight_recorder_size) != 0) {
+		log(LOG_ERR, "Can't initialize flight recorder");
+		return (EXIT_FAILURE);
+	}
+
 	log(LOG_DEBUG, "Registering main poll loop callbacks");
 	if (qdevice_pr_poll_loop_cb_register(&instance) != 0) {
 		return (EXIT_FAILURE);
@@ -351,6 +380,8 @@ main(int argc, char * const argv[])
 	log(LOG_DEBUG, "Destroying heuristics");
 	qdevice_heuristics_destroy(&instance.heuristics_instance, foreground);
 
+	flight_recorder_destroy();
+
 	log(LOG_DEBUG, "Closing log");
 	qdevice_log_close(&instance);
 
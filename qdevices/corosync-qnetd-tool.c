@@ -53,6 +53,8 @@ enum qnetd_tool_operation {
 	QNETD_TOOL_OPERATION_SHUTDOWN,
 	QNETD_TOOL_OPERATION_STATUS,
 	QNETD_TOOL_OPERATION_LIST,
+	QNETD_TOOL_OPERATION_FLIGHT_RECORDER,
+	QNETD_TOOL_OPERATION_SUBSCRIBE,
 };
 
 enum qnetd_tool_exit_code {
@@ -67,19 +69,22 @@ static void
 usage(void)
 {
 
-	printf("usage: %s [-Hhlsv] [-c cluster_name] [-p qnetd_ipc_socket_path]\n",
+	printf("usage: %s [-Hehjlrsv] [-c cluster_name] [-n node_id] [-p qnetd_ipc_socket_path]\n",
 	    QNETD_TOOL_PROGRAM_NAME);
 }
 
 static void
 cli_parse(int argc, char * const argv[], enum qnetd_tool_operation *operation,
-    int *verbose, char **cluster_name, char **socket_path)
+    int *verbose, int *json, char **cluster_name, char **node_id, char **socket_path)
 {
 	int ch;
+	long long int tmpll;
 
 	*operation = QNETD_TOOL_OPERATION_NONE;
 	*verbose = 0;
+	*json = 0;
 	*cluster_name = NULL;
+	*node_id = NULL;
 	*socket_path = strdup(QNETD_DEFAULT_LOCAL_SOCKET_FILE);
 
 	if (*socket_path == NULL) {
@@ -87,14 +92,23 @@ cli_parse(int argc, char * const argv[], enum qnetd_tool_operation *operation,
 		    "Can't alloc memory for socket path string");
 	}
 
-	while ((ch = getopt(argc, argv, "Hhlsvc:p:")) != -1) {
+	while ((ch = getopt(argc, argv, "Hehjlrsvc:n:p:")) != -1) {
 		switch (ch) {
 		case 'H':
 			*operation = QNETD_TOOL_OPERATION_SHUTDOWN;
 			break;
+		case 'e':
+			*operation = QNETD_TOOL_OPERATION_SUBSCRIBE;
+			break;
+		case 'j':
+			*json = 1;
+			break;
 		case 'l':
 			*operation = QNETD_TOOL_OPERATION_LIST;
 			break;
+		case 'r':
+			*operation = QNETD_TOOL_OPERATION_FLIGHT_RECORDER;
+			break;
 		case 's':
 			*operation = QNETD_TOOL_OPERATION_STATUS;
 			break;
@@ -109,6 +123,18 @@ cli_parse(int argc, char * const argv[], enum qnetd_tool_operation *operation,
 				    "Can't alloc memory for cluster name string");
 			}
 			break;
+		case 'n':
+			if (utils_strtonum(optarg, 0, UINT32_MAX, &tmpll) == -1) {
+				errx(QNETD_TOOL_EXIT_CODE_USAGE, "Node ID must be a number");
+			}
+
+			free(*node_id);
+			*node_id = strdup(optarg);
+			if (*node_id == NULL) {
+				errx(QNETD_TOOL_EXIT_CODE_INTERNAL_ERROR,
+				    "Can't alloc memory for node ID string");
+			}
+			break;
 		case 'p':
 			free(*socket_path);
 			*socket_path = strdup(optarg);
@@ -133,7 +159,7 @@ cli_parse(int argc, char * const argv[], enum qnetd_tool_operation *operation,
 
 static int
 store_command(struct dynar *str, enum qnetd_tool_operation operation, int verbose,
-    const char *cluster_name)
+    int json, const char *cluster_name, const char *node_id)
 {
 	const char *nline = "\n\0";
 	const int nline_len = 2;
@@ -157,6 +183,16 @@ store_command(struct dynar *str, enum qnetd_tool_operation operation, int verbos
 			return (-1);
 		}
 		break;
+	case QNETD_TOOL_OPERATION_FLIGHT_RECORDER:
+		if (dynar_str_cat(str, "flight-recorder ") != 0) {
+			return (-1);
+		}
+		break;
+	case QNETD_TOOL_OPERATION_SUBSCRIBE:
+		if (dynar_str_cat(str, "subscribe ") != 0) {
+			return (-1);
+		}
+		break;
 	}
 
 	if (verbose) {
@@ -165,6 +201,12 @@ store_command(struct dynar *str, enum qnetd_tool_operation operation, int verbos
 		}
 	}
 
+	if (json) {
+		if (dynar_str_cat(str, "json ") != 0) {
+			return (-1);
+		}
+	}
+
 	if (cluster_name != NULL) {
 		if (dynar_str_cat(str, "cluster ") != 0 ||
 		    dynar_str_quote_cat(str, cluster_name) != 0 ||
@@ -173,6 +215,14 @@ store_command(struct dynar *str, enum qnetd_tool_operation operation, int verbos
 		}
 	}
 
+	if (node_id != NULL) {
+		if (dynar_str_cat(str, "node ") != 0 ||
+		    dynar_str_quote_cat(str, node_id) != 0 ||
+		    dynar_str_cat(str, " ") != 0) {
+			return (-1);
+		}
+	}
+
 	if (dynar_cat(str, nline, nline_len) != 0) {
 		return (-1);
 	}
@@ -248,7 +298,9 @@ main(int argc, char * const argv[])
 {
 	enum qnetd_tool_operation operation;
 	int verbose;
+	int json;
 	char *cluster_name;
+	char *node_id;
 	char *socket_path;
 	int sock_fd;
 	FILE *sock;
@@ -258,7 +310,7 @@ main(int argc, char * const argv[])
 
 	exit_code = QNETD_TOOL_EXIT_CODE_NO_ERROR;
 
-	cli_parse(argc, argv, &operation, &verbose, &cluster_name, &socket_path);
+	cli_parse(argc, argv, &operation, &verbose, &json, &cluster_name, &node_id, &socket_path);
 
 	dynar_init(&send_str, QNETD_DEFAULT_IPC_MAX_RECEIVE_SIZE);
 
@@ -273,7 +325,7 @@ main(int argc, char * const argv[])
 		err(QNETD_TOOL_EXIT_CODE_INTERNAL_ERROR, "Can't open QNetd socket fd");
 	}
 
-	if (store_command(&send_str, operation, verbose, cluster_name) != 0) {
+	if (store_command(&send_str, operation, verbose, json, cluster_name, node_id) != 0) {
 		errx(QNETD_TOOL_EXIT_CODE_INTERNAL_ERROR, "Can't store command");
 	}
 
@@ -283,6 +335,13 @@ main(int argc, char * const argv[])
 		errx(QNETD_TOOL_EXIT_CODE_INTERNAL_ERROR, "Can't send command");
 	}
 
+	if (operation == QNETD_TOOL_OPERATION_SUBSCRIBE) {
+		/*
+		 * Events should be visible as soon as they arrive
+		 */
+		(void)setvbuf(stdout, NULL, _IOLBF, 0);
+	}
+
 	res = read_ipc_reply(sock);
 	switch (res) {
 	case -1:
@@ -303,6 +362,7 @@ main(int argc, char * const argv[])
 	}
 
 	free(cluster_name);
+	free(node_id);
 	free(socket_path);
 	dynar_destroy(&send_str);
 
@@ -44,7 +44,9 @@
 #include "dynar.h"
 #include "dynar-str.h"
 #include "dynar-getopt-lex.h"
+#include "flight-recorder.h"
 #include "log.h"
+#include "log-ratelimit.h"
 #include "nss-sock.h"
 #include "pr-poll-array.h"
 #include "qnetd-advanced-settings.h"
@@ -117,6 +119,15 @@ server_socket_poll_loop_err_cb(PRFileDesc *prfd, short revents, const PRPollDesc
 	return (-1);
 }
 
+static int
+flight_recorder_dump_request_read_cb(int fd, void *user_data1, void *user_data2)
+{
+
+	flight_recorder_dump_request_process(LOG_INFO);
+
+	return (0);
+}
+
 static void
 signal_int_handler(int sig)
 {
@@ -135,6 +146,13 @@ signal_term_handler(int sig)
 	qnetd_ipc_close(global_instance);
 }
 
+static void
+signal_usr1_handler(int sig)
+{
+
+	flight_recorder_dump_request();
+}
+
 static void
 signal_handlers_register(void)
 {
@@ -151,6 +169,12 @@ signal_handlers_register(void)
 	act.sa_flags = SA_RESTART;
 
 	sigaction(SIGTERM, &act, NULL);
+
+	act.sa_handler = signal_usr1_handler;
+	sigemptyset(&act.sa_mask);
+	act.sa_flags = SA_RESTART;
+
+	sigaction(SIGUSR1, &act, NULL);
 }
 
 static int
@@ -350,6 +374,7 @@ main(int argc, char * const argv[])
 	int another_instance_running;
 	int log_target;
 	int main_loop_res;
+	int flight_recorder_fd;
 
 	if (qnetd_advanced_settings_init(&advanced_settings) != 0) {
 		errx(EXIT_FAILURE, "Can't alloc memory for advanced settings");
@@ -369,6 +394,8 @@ main(int argc, char * const argv[])
 
 	log_set_debug(debug_log);
 	log_set_priority_bump(bump_log_priority);
+	log_ratelimit_init(advanced_settings.log_ratelimit_burst,
+	    advanced_settings.log_ratelimit_interval);
 
 	/*
 	 * Check that it's possible to open NSS dir if needed
@@ -398,6 +425,15 @@ main(int argc, char * const argv[])
 		return (EXIT_FAILURE);
 	}
 
+	if (advanced_settings.log_async) {
+		log(LOG_DEBUG, "Starting asynchronous logging");
+		if (log_async_start(advanced_settings.log_async_queue_size) != 0) {
+			log(LOG_ERR, "Can't start asynchronous logging thread");
+
+			return (EXIT_FAILURE);
+		}
+	}
+
 	log(LOG_DEBUG, "Initializing nss");
 	if (nss_sock_init_nss((tls_supported != TLV_TLS_UNSUPPORTED ?
 	    advanced_settings.nss_db_dir : NULL)) != 0) {
@@ -452,6 +488,26 @@ main(int argc, char * const argv[])
 		return (EXIT_FAILURE);
 	}
 
+	if (flight_recorder_init(advanced_settings.flight_recorder_size) != 0) {
+		log(LOG_ERR, "Can't initialize flight recorder");
+
+		return (EXIT_FAILURE);
+	}
+
+	if ((flight_recorder_fd = flight_recorder_dump_request_init()) == -1) {
+		log_err(LOG_ERR, "Can't create flight recorder dump request pipe");
+
+		return (EXIT_FAILURE);
+	}
+
+	if (pr_poll_loop_add_fd(&instance.main_poll_loop, flight_recorder_fd, POLLIN,
+	    NULL, flight_recorder_dump_request_read_cb, NULL, NULL,
+	    &instance, NULL) != 0) {
+		log(LOG_ERR, "Can't add flight recorder dump request pipe to main poll loop");
+
+		return (EXIT_FAILURE);
+	}
+
 	global_instance = &instance;
 	signal_handlers_register();
 
@@ -460,6 +516,10 @@ main(int argc, char * const argv[])
 		return (EXIT_FAILURE);
 	}
 
+	if (qnetd_instance_state_snapshot_init(&instance) != 0) {
+		return (EXIT_FAILURE);
+	}
+
 	log(LOG_DEBUG, "QNetd ready to provide service");
 
 #ifdef HAVE_LIBSYSTEMD
@@ -472,6 +532,9 @@ main(int argc, char * const argv[])
 	/*
 	 * Cleanup
 	 */
+	log(LOG_DEBUG, "Saving state snapshot");
+	(void)qnetd_instance_state_snapshot_save(&instance);
+
 	log(LOG_DEBUG, "Destroying qnetd ipc");
 	qnetd_ipc_destroy(&instance);
 
@@ -489,6 +552,8 @@ main(int argc, char * const argv[])
 
 	qnetd_instance_destroy(&instance);
 
+	flight_recorder_destroy();
+
 	qnetd_advanced_settings_destroy(&advanced_settings);
 
 	if (NSS_Shutdown() != SECSuccess) {
@@ -499,6 +564,8 @@ main(int argc, char * const argv[])
 		qnetd_warn_nss();
 	}
 
+	log_ratelimit_destroy();
+
 	log(LOG_DEBUG, "Closing log");
 	log_close();
 
@@ -167,3 +167,66 @@ dynar_str_quote_cpy(struct dynar *dest, const char *str)
 
 	return (dynar_str_quote_cat(dest, str));
 }
+
+/*
+ * Add str as a JSON string (enclosed in quotes, with special characters escaped)
+ */
+int
+dynar_str_json_quote_cat(struct dynar *dest, const char *str)
+{
+	size_t zi;
+	size_t str_len;
+	unsigned char ch;
+	int res;
+
+	if (dynar_str_cat(dest, "\"") != 0) {
+		return (-1);
+	}
+
+	str_len = strlen(str);
+
+	for (zi = 0; zi < str_len; zi++) {
+		ch = (unsigned char)str[zi];
+
+		switch (ch) {
+		case '"':
+			res = dynar_str_cat(dest, "\\\"");
+			break;
+		case '\\':
+			res = dynar_str_cat(dest, "\\\\");
+			break;
+		case '\b':
+			res = dynar_str_cat(dest, "\\b");
+			break;
+		case '\f':
+			res = dynar_str_cat(dest, "\\f");
+			break;
+		case '\n':
+			res = dynar_str_cat(dest, "\\n");
+			break;
+		case '\r':
+			res = dynar_str_cat(dest, "\\r");
+			break;
+		case '\t':
+			res = dynar_str_cat(dest, "\\t");
+			break;
+		default:
+			if (ch < 0x20) {
+				res = (dynar_str_catf(dest, "\\u%04x", ch) == -1 ? -1 : 0);
+			} else {
+				res = dynar_cat(dest, &str[zi], sizeof(str[zi]));
+			}
+			break;
+		}
+
+		if (res != 0) {
+			return (-1);
+		}
+	}
+
+	if (dynar_str_cat(dest, "\"") != 0) {
+		return (-1);
+	}
+
+	return (0);
+}
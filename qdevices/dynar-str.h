@@ -59,6 +59,8 @@ extern int		dynar_str_quote_cat(struct dynar *dest, const char *str);
 
 extern int		dynar_str_quote_cpy(struct dynar *dest, const char *str);
 
+extern int		dynar_str_json_quote_cat(struct dynar *dest, const char *str);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,473 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sys/types.h>
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "dynar-str.h"
+#include "flight-recorder.h"
+#include "log.h"
+#include "utils.h"
+
+#define FLIGHT_RECORDER_LINE_LEN	256
+#define FLIGHT_RECORDER_DUMP_RESERVE	64
+
+static struct flight_recorder_event *flight_recorder_events = NULL;
+static size_t flight_recorder_size = 0;
+static uint64_t flight_recorder_no_events = 0;
+static int flight_recorder_dump_request_pipe[2] = {-1, -1};
+
+static const char *flight_recorder_event_type_str[] = {
+    "recv",
+    "send",
+    "connect",
+    "disconnect",
+    "cast-vote",
+};
+
+int
+flight_recorder_init(size_t size)
+{
+
+	flight_recorder_destroy();
+
+	if (size == 0) {
+		return (0);
+	}
+
+	flight_recorder_events = calloc(size, sizeof(*flight_recorder_events));
+	if (flight_recorder_events == NULL) {
+		return (-1);
+	}
+
+	flight_recorder_size = size;
+
+	return (0);
+}
+
+void
+flight_recorder_destroy(void)
+{
+
+	if (flight_recorder_dump_request_pipe[0] != -1) {
+		close(flight_recorder_dump_request_pipe[0]);
+		close(flight_recorder_dump_request_pipe[1]);
+		flight_recorder_dump_request_pipe[0] = flight_recorder_dump_request_pipe[1] = -1;
+	}
+
+	free(flight_recorder_events);
+	flight_recorder_events = NULL;
+	flight_recorder_size = 0;
+	flight_recorder_no_events = 0;
+}
+
+size_t
+flight_recorder_get_size(void)
+{
+
+	return (flight_recorder_size);
+}
+
+uint64_t
+flight_recorder_get_no_events(void)
+{
+
+	return (flight_recorder_no_events);
+}
+
+const char *
+flight_recorder_event_type_to_str(enum flight_recorder_event_type type)
+{
+
+	if ((size_t)type >= sizeof(flight_recorder_event_type_str) /
+	    sizeof(flight_recorder_event_type_str[0])) {
+		return ("unknown");
+	}
+
+	return (flight_recorder_event_type_str[type]);
+}
+
+/*
+ * Return next free slot in ring (oldest event is overwritten) with filled
+ * common fields or NULL if flight recorder is disabled
+ */
+static struct flight_recorder_event *
+flight_recorder_new_event(enum flight_recorder_event_type type, const char *cluster_name,
+    uint32_t node_id)
+{
+	struct flight_recorder_event *event;
+
+	if (flight_recorder_size == 0) {
+		return (NULL);
+	}
+
+	event = &flight_recorder_events[flight_recorder_no_events % flight_recorder_size];
+	flight_recorder_no_events++;
+
+	memset(event, 0, sizeof(*event));
+
+	(void)clock_gettime(CLOCK_REALTIME, &event->realtime);
+	(void)clock_gettime(CLOCK_MONOTONIC, &event->monotonic);
+
+	event->type = type;
+	event->node_id = node_id;
+
+	if (cluster_name != NULL) {
+		strncpy(event->cluster_name, cluster_name, sizeof(event->cluster_name) - 1);
+	}
+
+	return (event);
+}
+
+void
+flight_recorder_record_msg(enum flight_recorder_event_type type, const char *cluster_name,
+    uint32_t node_id, const struct msg_decoded *msg)
+{
+	struct flight_recorder_event *event;
+
+	event = flight_recorder_new_event(type, cluster_name, node_id);
+	if (event == NULL) {
+		return ;
+	}
+
+	event->msg_type_set = 1;
+	event->msg_type = msg->type;
+	event->seq_number_set = msg->seq_number_set;
+	event->seq_number = msg->seq_number;
+	event->vote_set = msg->vote_set;
+	event->vote = msg->vote;
+}
+
+void
+flight_recorder_record_msg_info(enum flight_recorder_event_type type, const char *cluster_name,
+    uint32_t node_id, enum msg_type msg_type, int seq_number_set, uint32_t seq_number,
+    int vote_set, enum tlv_vote vote)
+{
+	struct flight_recorder_event *event;
+
+	event = flight_recorder_new_event(type, cluster_name, node_id);
+	if (event == NULL) {
+		return ;
+	}
+
+	event->msg_type_set = 1;
+	event->msg_type = msg_type;
+	event->seq_number_set = (seq_number_set ? 1 : 0);
+	event->seq_number = seq_number;
+	event->vote_set = (vote_set ? 1 : 0);
+	event->vote = vote;
+}
+
+void
+flight_recorder_record_event(enum flight_recorder_event_type type, const char *cluster_name,
+    uint32_t node_id)
+{
+
+	(void)flight_recorder_new_event(type, cluster_name, node_id);
+}
+
+void
+flight_recorder_record_vote(const char *cluster_name, uint32_t node_id, enum tlv_vote vote)
+{
+	struct flight_recorder_event *event;
+
+	event = flight_recorder_new_event(FLIGHT_RECORDER_EVENT_TYPE_VOTE_CAST, cluster_name,
+	    node_id);
+	if (event == NULL) {
+		return ;
+	}
+
+	event->vote_set = 1;
+	event->vote = vote;
+}
+
+static size_t
+flight_recorder_str_appendf(char *str, size_t len, size_t pos, const char *format, ...)
+    __attribute__((__format__(__printf__, 4, 5)));
+
+static size_t
+flight_recorder_str_appendf(char *str, size_t len, size_t pos, const char *format, ...)
+{
+	va_list ap;
+	int res;
+
+	if (pos >= len) {
+		return (len);
+	}
+
+	va_start(ap, format);
+	res = vsnprintf(str + pos, len - pos, format, ap);
+	va_end(ap);
+
+	if (res < 0) {
+		return (len);
+	}
+
+	return (pos + res);
+}
+
+static void
+flight_recorder_event_to_str(const struct flight_recorder_event *event, char *str, size_t len)
+{
+	struct tm tm_res;
+	size_t pos;
+
+	localtime_r(&event->realtime.tv_sec, &tm_res);
+
+	pos = strftime(str, len, "%Y-%m-%d %H:%M:%S", &tm_res);
+
+	pos = flight_recorder_str_appendf(str, len, pos,
+	    ".%03ld (%lld.%06ld) %-10s cluster=%s node_id="UTILS_PRI_NODE_ID,
+	    event->realtime.tv_nsec / 1000000,
+	    (long long)event->monotonic.tv_sec, event->monotonic.tv_nsec / 1000,
+	    flight_recorder_event_type_to_str(event->type),
+	    (event->cluster_name[0] != '\0' ? event->cluster_name : "-"),
+	    event->node_id);
+
+	if (event->msg_type_set) {
+		pos = flight_recorder_str_appendf(str, len, pos, " msg=%s",
+		    msg_type_to_str(event->msg_type));
+	}
+
+	if (event->seq_number_set) {
+		pos = flight_recorder_str_appendf(str, len, pos, " seq="UTILS_PRI_MSG_SEQ,
+		    event->seq_number);
+	}
+
+	if (event->vote_set) {
+		pos = flight_recorder_str_appendf(str, len, pos, " vote=%s",
+		    tlv_vote_to_str(event->vote));
+	}
+}
+
+static uint64_t
+flight_recorder_get_no_stored_events(void)
+{
+
+	if (flight_recorder_no_events > flight_recorder_size) {
+		return (flight_recorder_size);
+	}
+
+	return (flight_recorder_no_events);
+}
+
+/*
+ * Calls cb for newest no_events stored events from the oldest one to the newest one
+ */
+static int
+flight_recorder_foreach_newest(uint64_t no_events,
+    int (*cb)(const char *line, void *user_data), void *user_data)
+{
+	char line[FLIGHT_RECORDER_LINE_LEN];
+	uint64_t first;
+	uint64_t i;
+
+	if (no_events > flight_recorder_get_no_stored_events()) {
+		no_events = flight_recorder_get_no_stored_events();
+	}
+
+	first = flight_recorder_no_events - no_events;
+
+	for (i = first; i < flight_recorder_no_events; i++) {
+		flight_recorder_event_to_str(&flight_recorder_events[i % flight_recorder_size],
+		    line, sizeof(line));
+
+		if (cb(line, user_data) != 0) {
+			return (-1);
+		}
+	}
+
+	return (0);
+}
+
+/*
+ * Calls cb for every stored event from the oldest one to the newest one
+ */
+static int
+flight_recorder_foreach(int (*cb)(const char *line, void *user_data), void *user_data)
+{
+
+	return (flight_recorder_foreach_newest(flight_recorder_get_no_stored_events(), cb,
+	    user_data));
+}
+
+static int
+flight_recorder_dump_dynar_cb(const char *line, void *user_data)
+{
+	struct dynar *outbuf = (struct dynar *)user_data;
+
+	return (dynar_str_catf(outbuf, "%s\n", line) == -1 ? -1 : 0);
+}
+
+/*
+ * Dump newest events which fit into outbuf (keeping FLIGHT_RECORDER_DUMP_RESERVE bytes
+ * free for the IPC reply header), so full recorder never overflows the IPC send buffer.
+ */
+int
+flight_recorder_dump(struct dynar *outbuf)
+{
+	char line[FLIGHT_RECORDER_LINE_LEN];
+	uint64_t no_stored_events;
+	uint64_t no_shown_events;
+	size_t avail;
+	size_t used;
+
+	if (dynar_str_catf(outbuf, "Flight recorder size:\t%zu\n", flight_recorder_size) == -1) {
+		return (-1);
+	}
+
+	if (dynar_str_catf(outbuf, "Recorded events:\t%"PRIu64"\n",
+	    flight_recorder_no_events) == -1) {
+		return (-1);
+	}
+
+	no_stored_events = flight_recorder_get_no_stored_events();
+
+	/*
+	 * Room for "Shown events" line and reply header
+	 */
+	used = dynar_size(outbuf) + FLIGHT_RECORDER_DUMP_RESERVE;
+	avail = (dynar_max_size(outbuf) > used ? dynar_max_size(outbuf) - used : 0);
+
+	used = 0;
+	for (no_shown_events = 0; no_shown_events < no_stored_events; no_shown_events++) {
+		flight_recorder_event_to_str(&flight_recorder_events[
+		    (flight_recorder_no_events - no_shown_events - 1) % flight_recorder_size],
+		    line, sizeof(line));
+
+		if (used + strlen(line) + 1 > avail) {
+			break;
+		}
+
+		used += strlen(line) + 1;
+	}
+
+	if (dynar_str_catf(outbuf, "Shown events:\t%"PRIu64"\n", no_shown_events) == -1) {
+		return (-1);
+	}
+
+	return (flight_recorder_foreach_newest(no_shown_events, flight_recorder_dump_dynar_cb,
+	    outbuf));
+}
+
+static int
+flight_recorder_dump_log_cb(const char *line, void *user_data)
+{
+	int priority = *(int *)user_data;
+
+	log(priority, "%s", line);
+
+	return (0);
+}
+
+void
+flight_recorder_dump_to_log(int priority)
+{
+
+	log(priority, "Flight recorder dump (size %zu, recorded events %"PRIu64"):",
+	    flight_recorder_size, flight_recorder_no_events);
+
+	(void)flight_recorder_foreach(flight_recorder_dump_log_cb, &priority);
+
+	log(priority, "Flight recorder dump end");
+}
+
+/*
+ * Dump request is used to dump events to log from the main loop when signal is received.
+ * Returned fd should be added to the main loop and flight_recorder_dump_request_process
+ * called when it becomes readable.
+ */
+int
+flight_recorder_dump_request_init(void)
+{
+
+	if (flight_recorder_dump_request_pipe[0] != -1) {
+		return (flight_recorder_dump_request_pipe[0]);
+	}
+
+	if (pipe(flight_recorder_dump_request_pipe) != 0) {
+		return (-1);
+	}
+
+	if (utils_fd_set_non_blocking(flight_recorder_dump_request_pipe[0]) != 0 ||
+	    utils_fd_set_non_blocking(flight_recorder_dump_request_pipe[1]) != 0) {
+		close(flight_recorder_dump_request_pipe[0]);
+		close(flight_recorder_dump_request_pipe[1]);
+		flight_recorder_dump_request_pipe[0] = flight_recorder_dump_request_pipe[1] = -1;
+
+		return (-1);
+	}
+
+	return (flight_recorder_dump_request_pipe[0]);
+}
+
+/*
+ * Async signal safe
+ */
+void
+flight_recorder_dump_request(void)
+{
+	int saved_errno;
+	char ch;
+
+	if (flight_recorder_dump_request_pipe[1] == -1) {
+		return ;
+	}
+
+	saved_errno = errno;
+	ch = 0;
+	if (write(flight_recorder_dump_request_pipe[1], &ch, sizeof(ch)) != sizeof(ch)) {
+		/*
+		 * Pipe is full so dump is already pending
+		 */
+	}
+	errno = saved_errno;
+}
+
+void
+flight_recorder_dump_request_process(int priority)
+{
+	char buf[64];
+
+	while (read(flight_recorder_dump_request_pipe[0], buf, sizeof(buf)) > 0) {
+	}
+
+	flight_recorder_dump_to_log(priority);
+}
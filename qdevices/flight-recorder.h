@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _FLIGHT_RECORDER_H_
+#define _FLIGHT_RECORDER_H_
+
+#include <sys/types.h>
+
+#include <inttypes.h>
+#include <time.h>
+
+#include "dynar.h"
+#include "msg.h"
+#include "tlv.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FLIGHT_RECORDER_CLUSTER_NAME_LEN	32
+
+enum flight_recorder_event_type {
+	FLIGHT_RECORDER_EVENT_TYPE_MSG_RECEIVED,
+	FLIGHT_RECORDER_EVENT_TYPE_MSG_SENT,
+	FLIGHT_RECORDER_EVENT_TYPE_CONNECTED,
+	FLIGHT_RECORDER_EVENT_TYPE_DISCONNECTED,
+	FLIGHT_RECORDER_EVENT_TYPE_VOTE_CAST,
+};
+
+struct flight_recorder_event {
+	struct timespec realtime;
+	struct timespec monotonic;
+	enum flight_recorder_event_type type;
+	uint8_t msg_type_set;
+	enum msg_type msg_type;
+	uint8_t seq_number_set;
+	uint32_t seq_number;
+	uint32_t node_id;
+	uint8_t vote_set;
+	enum tlv_vote vote;
+	char cluster_name[FLIGHT_RECORDER_CLUSTER_NAME_LEN];
+};
+
+extern int		flight_recorder_init(size_t size);
+
+extern void		flight_recorder_destroy(void);
+
+extern void		flight_recorder_record_msg(enum flight_recorder_event_type type,
+    const char *cluster_name, uint32_t node_id, const struct msg_decoded *msg);
+
+extern void		flight_recorder_record_msg_info(enum flight_recorder_event_type type,
+    const char *cluster_name, uint32_t node_id, enum msg_type msg_type, int seq_number_set,
+    uint32_t seq_number, int vote_set, enum tlv_vote vote);
+
+extern void		flight_recorder_record_event(enum flight_recorder_event_type type,
+    const char *cluster_name, uint32_t node_id);
+
+extern void		flight_recorder_record_vote(const char *cluster_name, uint32_t node_id,
+    enum tlv_vote vote);
+
+extern size_t		flight_recorder_get_size(void);
+
+extern uint64_t		flight_recorder_get_no_events(void);
+
+extern int		flight_recorder_dump(struct dynar *outbuf);
+
+extern void		flight_recorder_dump_to_log(int priority);
+
+extern int		flight_recorder_dump_request_init(void);
+
+extern void		flight_recorder_dump_request(void);
+
+extern void		flight_recorder_dump_request_process(int priority);
+
+extern const char	*flight_recorder_event_type_to_str(enum flight_recorder_event_type type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FLIGHT_RECORDER_H_ */
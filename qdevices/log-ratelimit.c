@@ -0,0 +1,301 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sys/types.h>
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "log-ratelimit.h"
+
+#define LOG_RATELIMIT_HASH_SIZE		256
+#define LOG_RATELIMIT_MAX_ENTRIES	4096
+#define LOG_RATELIMIT_KEY_LEN		64
+
+struct log_ratelimit_entry {
+	const char *file;
+	int line;
+	char key[LOG_RATELIMIT_KEY_LEN];
+	int priority;
+	/*
+	 * Token bucket is kept in ms. Every message costs interval, bucket is refilled by
+	 * elapsed time and its capacity is burst * interval.
+	 */
+	uint64_t credit;
+	uint64_t last_update;
+	uint64_t suppressed;
+	struct log_ratelimit_entry *next;
+};
+
+static struct log_ratelimit_entry *log_ratelimit_table[LOG_RATELIMIT_HASH_SIZE];
+static size_t log_ratelimit_no_entries = 0;
+static size_t log_ratelimit_burst = 0;
+static uint32_t log_ratelimit_interval = 0;
+static uint64_t log_ratelimit_last_flush = 0;
+
+static uint64_t
+log_ratelimit_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+static uint64_t
+log_ratelimit_capacity(void)
+{
+
+	return ((uint64_t)log_ratelimit_burst * log_ratelimit_interval);
+}
+
+static size_t
+log_ratelimit_hash(const char *file, int line, const char *key, size_t key_len)
+{
+	uint32_t hash;
+	size_t zi;
+
+	hash = 5381 + (uint32_t)(uintptr_t)file + (uint32_t)line;
+
+	for (zi = 0; zi < key_len; zi++) {
+		hash = hash * 33 + (unsigned char)key[zi];
+	}
+
+	return (hash % LOG_RATELIMIT_HASH_SIZE);
+}
+
+static struct log_ratelimit_entry *
+log_ratelimit_find(const char *file, int line, const char *key, size_t key_len, uint64_t now)
+{
+	struct log_ratelimit_entry *entry;
+	size_t hash;
+
+	if (key == NULL) {
+		key_len = 0;
+	}
+
+	if (key_len >= LOG_RATELIMIT_KEY_LEN) {
+		key_len = LOG_RATELIMIT_KEY_LEN - 1;
+	}
+
+	if (log_ratelimit_no_entries >= LOG_RATELIMIT_MAX_ENTRIES) {
+		/*
+		 * Too many keys (probably many peers). Limit only by call site.
+		 */
+		key_len = 0;
+	}
+
+	hash = log_ratelimit_hash(file, line, key, key_len);
+
+	for (entry = log_ratelimit_table[hash]; entry != NULL; entry = entry->next) {
+		if (entry->file == file && entry->line == line &&
+		    strlen(entry->key) == key_len &&
+		    (key_len == 0 || memcmp(entry->key, key, key_len) == 0)) {
+			return (entry);
+		}
+	}
+
+	entry = malloc(sizeof(*entry));
+	if (entry == NULL) {
+		return (NULL);
+	}
+
+	memset(entry, 0, sizeof(*entry));
+	entry->file = file;
+	entry->line = line;
+	if (key_len > 0) {
+		memcpy(entry->key, key, key_len);
+	}
+	entry->key[key_len] = '\0';
+	entry->credit = log_ratelimit_capacity();
+	entry->last_update = now;
+
+	entry->next = log_ratelimit_table[hash];
+	log_ratelimit_table[hash] = entry;
+	log_ratelimit_no_entries++;
+
+	return (entry);
+}
+
+static void
+log_ratelimit_refill(struct log_ratelimit_entry *entry, uint64_t now)
+{
+
+	entry->credit += now - entry->last_update;
+	if (entry->credit > log_ratelimit_capacity()) {
+		entry->credit = log_ratelimit_capacity();
+	}
+
+	entry->last_update = now;
+}
+
+static void
+log_ratelimit_log_suppressed(struct log_ratelimit_entry *entry)
+{
+
+	if (entry->suppressed == 0) {
+		return ;
+	}
+
+	log(entry->priority, "%s:%d: %"PRIu64" similar message%s suppressed%s%s",
+	    entry->file, entry->line, entry->suppressed, (entry->suppressed > 1 ? "s" : ""),
+	    (entry->key[0] != '\0' ? " for " : ""), entry->key);
+
+	entry->suppressed = 0;
+}
+
+/*
+ * burst is number of messages logged before limiting starts and interval (in ms) is
+ * time needed to allow one more message. Burst 0 disables limiting.
+ */
+void
+log_ratelimit_init(size_t burst, uint32_t interval)
+{
+
+	log_ratelimit_destroy();
+
+	log_ratelimit_burst = burst;
+	log_ratelimit_interval = interval;
+	log_ratelimit_last_flush = log_ratelimit_now();
+}
+
+void
+log_ratelimit_printf(const char *file, int line, const char *key, size_t key_len,
+    int priority, const char *format, ...)
+{
+	struct log_ratelimit_entry *entry;
+	va_list ap;
+	uint64_t now;
+
+	entry = NULL;
+	now = 0;
+
+	if (log_ratelimit_burst > 0) {
+		now = log_ratelimit_now();
+
+		entry = log_ratelimit_find(file, line, key, key_len, now);
+	}
+
+	if (entry != NULL) {
+		log_ratelimit_refill(entry, now);
+
+		if (entry->credit < log_ratelimit_interval) {
+			entry->suppressed++;
+			entry->priority = priority;
+
+			return ;
+		}
+
+		entry->credit -= log_ratelimit_interval;
+
+		log_ratelimit_log_suppressed(entry);
+	}
+
+	va_start(ap, format);
+	log_vprintf(priority, format, ap);
+	va_end(ap);
+}
+
+/*
+ * Log number of suppressed messages and free idle entries. Should be called regularly
+ * (cheap when called more often than needed), force is used during exit.
+ */
+void
+log_ratelimit_flush(int force)
+{
+	struct log_ratelimit_entry **entry_ptr;
+	struct log_ratelimit_entry *entry;
+	uint64_t now;
+	size_t zi;
+
+	if (log_ratelimit_no_entries == 0) {
+		return ;
+	}
+
+	now = log_ratelimit_now();
+
+	if (!force && now - log_ratelimit_last_flush < log_ratelimit_capacity()) {
+		return ;
+	}
+
+	log_ratelimit_last_flush = now;
+
+	for (zi = 0; zi < LOG_RATELIMIT_HASH_SIZE; zi++) {
+		entry_ptr = &log_ratelimit_table[zi];
+
+		while ((entry = *entry_ptr) != NULL) {
+			log_ratelimit_refill(entry, now);
+			log_ratelimit_log_suppressed(entry);
+
+			if (entry->credit == log_ratelimit_capacity()) {
+				/*
+				 * Idle entry
+				 */
+				*entry_ptr = entry->next;
+				free(entry);
+				log_ratelimit_no_entries--;
+			} else {
+				entry_ptr = &entry->next;
+			}
+		}
+	}
+}
+
+void
+log_ratelimit_destroy(void)
+{
+	struct log_ratelimit_entry *entry;
+	struct log_ratelimit_entry *entry_next;
+	size_t zi;
+
+	log_ratelimit_flush(1);
+
+	for (zi = 0; zi < LOG_RATELIMIT_HASH_SIZE; zi++) {
+		entry = log_ratelimit_table[zi];
+
+		while (entry != NULL) {
+			entry_next = entry->next;
+			free(entry);
+			entry = entry_next;
+		}
+
+		log_ratelimit_table[zi] = NULL;
+	}
+
+	log_ratelimit_no_entries = 0;
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _LOG_RATELIMIT_H_
+#define _LOG_RATELIMIT_H_
+
+#include <sys/types.h>
+
+#include <inttypes.h>
+
+#include "log.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Rate limited log. Messages are limited per call site and key (usually cluster name or peer
+ * address) by token bucket. Number of suppressed messages is logged later.
+ */
+#define log_ratelimit(key, key_len, priority, ...) \
+    log_ratelimit_printf(__FILE__, __LINE__, key, key_len, priority, __VA_ARGS__)
+
+#define log_ratelimit_nss(key, key_len, priority, str) \
+    log_ratelimit_printf(__FILE__, __LINE__, key, key_len, priority, "%s (%d): %s", \
+    str, PR_GetError(), PR_ErrorToString(PR_GetError(), PR_LANGUAGE_I_DEFAULT))
+
+extern void		log_ratelimit_init(size_t burst, uint32_t interval);
+
+extern void		log_ratelimit_printf(const char *file, int line, const char *key,
+    size_t key_len, int priority, const char *format, ...)
+    __attribute__((__format__(__printf__, 6, 7)));
+
+extern void		log_ratelimit_flush(int force);
+
+extern void		log_ratelimit_destroy(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _LOG_RATELIMIT_H_ */
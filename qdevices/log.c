@@ -32,6 +32,9 @@
  * THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <inttypes.h>
+#include <pthread.h>
+#include <signal.h>
 #include <stdlib.h>
 #include <syslog.h>
 #include <stdio.h>
@@ -40,12 +43,46 @@
 
 #include "log.h"
 
+/*
+ * Maximum length of one line (including timestamp and priority) stored in async queue
+ */
+#define LOG_ASYNC_MAX_LINE_LEN		1024
+#define LOG_TIMESTAMP_STR_LEN		32
+
+struct log_async_entry {
+	int priority;
+	size_t msg_offset;
+	char line[LOG_ASYNC_MAX_LINE_LEN];
+};
+
 static int log_config_target = 0;
 static int log_config_debug = 0;
 static int log_config_priority_bump = 0;
 static int log_config_syslog_facility = 0;
 static char *log_config_ident = NULL;
 
+/*
+ * Formatted timestamp is cached per thread and recomputed only when second changes
+ */
+static __thread time_t log_timestamp_cache_time = (time_t)-1;
+static __thread char log_timestamp_cache_str[LOG_TIMESTAMP_STR_LEN];
+
+static __thread struct log_async_entry log_thread_entry;
+static __thread int log_thread_in_progress = 0;
+
+static pthread_mutex_t log_async_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t log_async_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t log_async_thread;
+static int log_async_running = 0;
+static int log_async_exit_requested = 0;
+static int log_async_atexit_registered = 0;
+static struct log_async_entry *log_async_queue = NULL;
+static struct log_async_entry *log_async_writer_entry = NULL;
+static size_t log_async_queue_size = 0;
+static size_t log_async_queue_head = 0;
+static size_t log_async_queue_used = 0;
+static uint64_t log_async_dropped = 0;
+
 static const char log_month_str[][4] = {
     "Jan", "Feb", "Mar", "Apr", "May", "Jun",
     "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
@@ -94,22 +131,226 @@ log_syslog_prio_to_str(int priority)
 	}
 }
 
-void
-log_vprintf(int priority, const char *format, va_list ap)
+static const char *
+log_timestamp_str(void)
 {
 	time_t current_time;
 	struct tm tm_res;
+
+	current_time = time(NULL);
+
+	if (current_time != log_timestamp_cache_time) {
+		localtime_r(&current_time, &tm_res);
+
+		snprintf(log_timestamp_cache_str, sizeof(log_timestamp_cache_str),
+		    "%s %02d %02d:%02d:%02d",
+		    log_month_str[tm_res.tm_mon], tm_res.tm_mday, tm_res.tm_hour,
+		    tm_res.tm_min, tm_res.tm_sec);
+
+		log_timestamp_cache_time = current_time;
+	}
+
+	return (log_timestamp_cache_str);
+}
+
+static int
+log_final_priority(int priority)
+{
+
+	if (log_config_priority_bump && priority > LOG_INFO) {
+		return (LOG_INFO);
+	}
+
+	return (priority);
+}
+
+static void
+log_syslog(int priority, const char *format, ...)
+    __attribute__((__format__(__printf__, 2, 3)));
+
+static void
+log_async_entry_format(struct log_async_entry *entry, int priority, const char *format,
+    va_list ap) __attribute__((__format__(__printf__, 3, 0)));
+
+static void
+log_async_enqueue(int priority, const char *format, va_list ap)
+    __attribute__((__format__(__printf__, 2, 0)));
+
+static void
+log_syslog(int priority, const char *format, ...)
+{
+	va_list ap;
+
+	va_start(ap, format);
+	vsyslog(priority, format, ap);
+	va_end(ap);
+}
+
+static void
+log_async_entry_write(const struct log_async_entry *entry)
+{
+
+	if (log_config_target & LOG_TARGET_STDERR) {
+		fprintf(stderr, "%s\n", entry->line);
+	}
+
+	if (log_config_target & LOG_TARGET_SYSLOG) {
+		log_syslog(log_final_priority(entry->priority), "%s",
+		    entry->line + entry->msg_offset);
+	}
+}
+
+static void
+log_async_entry_format(struct log_async_entry *entry, int priority, const char *format,
+    va_list ap)
+{
+	int res;
+
+	entry->priority = priority;
+
+	res = snprintf(entry->line, sizeof(entry->line), "%s %-7s ", log_timestamp_str(),
+	    log_syslog_prio_to_str(priority));
+	if (res < 0 || (size_t)res >= sizeof(entry->line)) {
+		res = 0;
+	}
+	entry->msg_offset = res;
+
+	res = vsnprintf(entry->line + entry->msg_offset, sizeof(entry->line) - entry->msg_offset,
+	    format, ap);
+	if (res < 0) {
+		entry->line[entry->msg_offset] = '\0';
+	}
+}
+
+static void *
+log_async_thread_fn(void *arg)
+{
+	struct log_async_entry *entry;
+	uint64_t dropped;
+
+	/*
+	 * log_thread_entry of writer thread is used by messages generated by writer itself
+	 * (overflow report), so dequeued entry has its own buffer
+	 */
+	entry = (struct log_async_entry *)arg;
+	entry->line[0] = '\0';
+
+	pthread_mutex_lock(&log_async_mutex);
+
+	while (1) {
+		while (log_async_queue_used == 0 && !log_async_exit_requested &&
+		    __atomic_load_n(&log_async_dropped, __ATOMIC_RELAXED) == 0) {
+			pthread_cond_wait(&log_async_cond, &log_async_mutex);
+		}
+
+		dropped = __atomic_exchange_n(&log_async_dropped, 0, __ATOMIC_RELAXED);
+
+		if (log_async_queue_used == 0 && dropped == 0) {
+			/*
+			 * Queue is empty and exit was requested
+			 */
+			break;
+		}
+
+		if (log_async_queue_used > 0) {
+			memcpy(entry, &log_async_queue[log_async_queue_head], sizeof(*entry));
+			log_async_queue_head = (log_async_queue_head + 1) % log_async_queue_size;
+			log_async_queue_used--;
+		}
+
+		/*
+		 * Write is done without lock so main thread never waits for log I/O
+		 */
+		pthread_mutex_unlock(&log_async_mutex);
+
+		if (dropped > 0) {
+			log_printf(LOG_WARNING, "Log queue overflow - %"PRIu64" messages dropped",
+			    dropped);
+		}
+
+		if (entry->line[0] != '\0') {
+			log_async_entry_write(entry);
+			entry->line[0] = '\0';
+		}
+
+		pthread_mutex_lock(&log_async_mutex);
+	}
+
+	pthread_mutex_unlock(&log_async_mutex);
+
+	return (NULL);
+}
+
+static void
+log_async_enqueue(int priority, const char *format, va_list ap)
+{
+	struct log_async_entry *entry;
+	size_t tail;
+
+	entry = &log_thread_entry;
+
+	log_async_entry_format(entry, priority, format, ap);
+
+	pthread_mutex_lock(&log_async_mutex);
+
+	if (log_async_queue_used >= log_async_queue_size) {
+		__atomic_add_fetch(&log_async_dropped, 1, __ATOMIC_RELAXED);
+	} else {
+		tail = (log_async_queue_head + log_async_queue_used) % log_async_queue_size;
+		log_async_queue[tail].priority = entry->priority;
+		log_async_queue[tail].msg_offset = entry->msg_offset;
+		strcpy(log_async_queue[tail].line, entry->line);
+		log_async_queue_used++;
+
+		pthread_cond_signal(&log_async_cond);
+	}
+
+	pthread_mutex_unlock(&log_async_mutex);
+}
+
+void
+log_vprintf(int priority, const char *format, va_list ap)
+{
 	int final_priority;
 	va_list ap_copy;
 
 	if (priority != LOG_DEBUG || (log_config_debug)) {
-		if (log_config_target & LOG_TARGET_STDERR) {
-			current_time = time(NULL);
-			localtime_r(&current_time, &tm_res);
+		if (log_async_running && pthread_equal(pthread_self(), log_async_thread)) {
+			/*
+			 * Message generated by writer thread itself is written directly
+			 */
+			va_copy(ap_copy, ap);
+			log_async_entry_format(&log_thread_entry, priority, format, ap_copy);
+			va_end(ap_copy);
 
-			fprintf(stderr, "%s %02d %02d:%02d:%02d ",
-			    log_month_str[tm_res.tm_mon], tm_res.tm_mday, tm_res.tm_hour,
-			    tm_res.tm_min, tm_res.tm_sec);
+			log_async_entry_write(&log_thread_entry);
+			log_thread_entry.line[0] = '\0';
+
+			return ;
+		}
+
+		if (log_async_running) {
+			if (log_thread_in_progress) {
+				/*
+				 * Called from signal handler interrupting log_vprintf. Taking
+				 * mutex would deadlock so message is dropped.
+				 */
+				__atomic_add_fetch(&log_async_dropped, 1, __ATOMIC_RELAXED);
+
+				return ;
+			}
+
+			log_thread_in_progress = 1;
+			va_copy(ap_copy, ap);
+			log_async_enqueue(priority, format, ap_copy);
+			va_end(ap_copy);
+			log_thread_in_progress = 0;
+
+			return ;
+		}
+
+		if (log_config_target & LOG_TARGET_STDERR) {
+			fprintf(stderr, "%s ", log_timestamp_str());
 
 			fprintf(stderr, "%-7s ", log_syslog_prio_to_str(priority));
 
@@ -120,10 +361,7 @@ log_vprintf(int priority, const char *format, va_list ap)
 		}
 
 		if (log_config_target & LOG_TARGET_SYSLOG) {
-			final_priority = priority;
-			if (log_config_priority_bump && priority > LOG_INFO) {
-				final_priority = LOG_INFO;
-			}
+			final_priority = log_final_priority(priority);
 
 			va_copy(ap_copy, ap);
 			vsyslog(final_priority, format, ap);
@@ -144,10 +382,125 @@ log_printf(int priority, const char *format, ...)
 	va_end(ap);
 }
 
+static void
+log_async_atexit(void)
+{
+
+	log_async_stop();
+}
+
+static void
+log_async_atfork_child(void)
+{
+
+	/*
+	 * Writer thread doesn't exist in child so fall back to synchronous logging
+	 */
+	log_async_running = 0;
+	pthread_mutex_init(&log_async_mutex, NULL);
+	pthread_cond_init(&log_async_cond, NULL);
+}
+
+/*
+ * Start writer thread. Must be called after daemonization (fork) because thread
+ * doesn't survive fork.
+ */
+int
+log_async_start(size_t queue_size)
+{
+	sigset_t all_signals;
+	sigset_t old_signals;
+	int res;
+
+	if (log_async_running || queue_size == 0) {
+		return (-1);
+	}
+
+	log_async_queue = calloc(queue_size, sizeof(*log_async_queue));
+	if (log_async_queue == NULL) {
+		return (-1);
+	}
+
+	log_async_writer_entry = malloc(sizeof(*log_async_writer_entry));
+	if (log_async_writer_entry == NULL) {
+		goto exit_free;
+	}
+
+	log_async_queue_size = queue_size;
+	log_async_queue_head = 0;
+	log_async_queue_used = 0;
+	log_async_exit_requested = 0;
+	__atomic_store_n(&log_async_dropped, 0, __ATOMIC_RELAXED);
+
+	if (!log_async_atexit_registered) {
+		if (atexit(log_async_atexit) != 0 ||
+		    pthread_atfork(NULL, NULL, log_async_atfork_child) != 0) {
+			goto exit_free;
+		}
+
+		log_async_atexit_registered = 1;
+	}
+
+	/*
+	 * Signals must be delivered to main thread
+	 */
+	sigfillset(&all_signals);
+	pthread_sigmask(SIG_BLOCK, &all_signals, &old_signals);
+	res = pthread_create(&log_async_thread, NULL, log_async_thread_fn,
+	    log_async_writer_entry);
+	pthread_sigmask(SIG_SETMASK, &old_signals, NULL);
+
+	if (res != 0) {
+		goto exit_free;
+	}
+
+	log_async_running = 1;
+
+	return (0);
+
+exit_free:
+	free(log_async_writer_entry);
+	log_async_writer_entry = NULL;
+	free(log_async_queue);
+	log_async_queue = NULL;
+	log_async_queue_size = 0;
+
+	return (-1);
+}
+
+/*
+ * Write all queued messages and stop writer thread
+ */
+void
+log_async_stop(void)
+{
+
+	if (!log_async_running) {
+		return ;
+	}
+
+	pthread_mutex_lock(&log_async_mutex);
+	log_async_exit_requested = 1;
+	pthread_cond_signal(&log_async_cond);
+	pthread_mutex_unlock(&log_async_mutex);
+
+	pthread_join(log_async_thread, NULL);
+
+	log_async_running = 0;
+
+	free(log_async_writer_entry);
+	log_async_writer_entry = NULL;
+	free(log_async_queue);
+	log_async_queue = NULL;
+	log_async_queue_size = 0;
+}
+
 void
 log_close(void)
 {
 
+	log_async_stop();
+
 	if (log_config_target & LOG_TARGET_SYSLOG) {
 		closelog();
 	}
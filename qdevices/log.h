@@ -38,6 +38,7 @@
 #include <syslog.h>
 #include <stdarg.h>
 #include <errno.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -63,6 +64,10 @@ extern void		log_vprintf(int priority, const char *format, va_list ap)
 
 extern void		log_close(void);
 
+extern int		log_async_start(size_t queue_size);
+
+extern void		log_async_stop(void);
+
 extern void		log_set_debug(int enabled);
 
 extern void		log_set_priority_bump(int enabled);
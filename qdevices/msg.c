@@ -561,14 +561,16 @@ small_buf_err:
 	return (0);
 }
 
-size_t
-msg_create_node_list(struct dynar *msg,
+static size_t
+msg_create_node_list_common(struct dynar *msg,
     uint32_t msg_seq_number, enum tlv_node_list_type node_list_type,
     int add_ring_id, const struct tlv_ring_id *ring_id,
     int add_config_version, uint64_t config_version,
     int add_quorate, enum tlv_quorate quorate,
     int add_heuristics, enum tlv_heuristics heuristics,
-    const struct node_list *nodes)
+    int add_node_list_version, uint32_t node_list_version,
+    int add_node_list_base_version, uint32_t node_list_base_version,
+    const struct node_list *nodes, const struct node_list *removed_nodes)
 {
 	struct node_list_entry *node_info;
 	struct tlv_node_info tlv_ni;
@@ -606,6 +608,18 @@ msg_create_node_list(struct dynar *msg,
 		}
 	}
 
+	if (add_node_list_version) {
+		if (tlv_add_node_list_version(msg, node_list_version) == -1) {
+			goto small_buf_err;
+		}
+	}
+
+	if (add_node_list_base_version) {
+		if (tlv_add_node_list_base_version(msg, node_list_base_version) == -1) {
+			goto small_buf_err;
+		}
+	}
+
 	TAILQ_FOREACH(node_info, nodes, entries) {
 		node_list_entry_to_tlv_node_info(node_info, &tlv_ni);
 
@@ -614,6 +628,14 @@ msg_create_node_list(struct dynar *msg,
 		}
 	}
 
+	if (removed_nodes != NULL) {
+		TAILQ_FOREACH(node_info, removed_nodes, entries) {
+			if (tlv_add_removed_node_id(msg, node_info->node_id) == -1) {
+				goto small_buf_err;
+			}
+		}
+	}
+
 	if (add_heuristics && heuristics != TLV_HEURISTICS_UNDEFINED) {
 		if (tlv_add_heuristics(msg, heuristics) == -1) {
 			goto small_buf_err;
@@ -628,10 +650,48 @@ small_buf_err:
 	return (0);
 }
 
+size_t
+msg_create_node_list(struct dynar *msg,
+    uint32_t msg_seq_number, enum tlv_node_list_type node_list_type,
+    int add_ring_id, const struct tlv_ring_id *ring_id,
+    int add_config_version, uint64_t config_version,
+    int add_quorate, enum tlv_quorate quorate,
+    int add_heuristics, enum tlv_heuristics heuristics,
+    const struct node_list *nodes)
+{
+
+	return (msg_create_node_list_common(msg, msg_seq_number, node_list_type,
+	    add_ring_id, ring_id, add_config_version, config_version, add_quorate, quorate,
+	    add_heuristics, heuristics, 0, 0, 0, 0, nodes, NULL));
+}
+
+/*
+ * Create node list message with node list version. When add_node_list_base_version is set,
+ * message is delta against list with node_list_base_version. Nodes are then added or changed
+ * nodes and removed_nodes contains nodes removed from the base list.
+ */
+size_t
+msg_create_node_list_versioned(struct dynar *msg,
+    uint32_t msg_seq_number, enum tlv_node_list_type node_list_type,
+    int add_ring_id, const struct tlv_ring_id *ring_id,
+    int add_config_version, uint64_t config_version,
+    int add_quorate, enum tlv_quorate quorate,
+    int add_heuristics, enum tlv_heuristics heuristics,
+    uint32_t node_list_version,
+    int add_node_list_base_version, uint32_t node_list_base_version,
+    const struct node_list *nodes, const struct node_list *removed_nodes)
+{
+
+	return (msg_create_node_list_common(msg, msg_seq_number, node_list_type,
+	    add_ring_id, ring_id, add_config_version, config_version, add_quorate, quorate,
+	    add_heuristics, heuristics, 1, node_list_version,
+	    add_node_list_base_version, node_list_base_version, nodes, removed_nodes));
+}
+
 size_t
 msg_create_node_list_reply(struct dynar *msg, uint32_t msg_seq_number,
     enum tlv_node_list_type node_list_type, const struct tlv_ring_id *ring_id,
-    enum tlv_vote vote)
+    enum tlv_vote vote, int add_node_list_version, uint32_t node_list_version)
 {
 
 	dynar_clean(msg);
@@ -657,6 +717,12 @@ msg_create_node_list_reply(struct dynar *msg, uint32_t msg_seq_number,
 		goto small_buf_err;
 	}
 
+	if (add_node_list_version) {
+		if (tlv_add_node_list_version(msg, node_list_version) == -1) {
+			goto small_buf_err;
+		}
+	}
+
 	msg_set_len(msg, dynar_size(msg) - (MSG_TYPE_LENGTH + MSG_LENGTH_LENGTH));
 
 	return (dynar_size(msg));
@@ -863,6 +929,7 @@ msg_decoded_init(struct msg_decoded *decoded_msg)
 	memset(decoded_msg, 0, sizeof(*decoded_msg));
 
 	node_list_init(&decoded_msg->nodes);
+	node_list_init(&decoded_msg->removed_nodes);
 }
 
 void
@@ -874,6 +941,7 @@ msg_decoded_destroy(struct msg_decoded *decoded_msg)
 	free(decoded_msg->supported_options);
 	free(decoded_msg->supported_decision_algorithms);
 	node_list_free(&decoded_msg->nodes);
+	node_list_free(&decoded_msg->removed_nodes);
 
 	msg_decoded_init(decoded_msg);
 }
@@ -1113,6 +1181,32 @@ msg_decode(const struct dynar *msg, struct msg_decoded *decoded_msg)
 			decoded_msg->keep_active_partition_tie_breaker_set = 1;
 			decoded_msg->keep_active_partition_tie_breaker = keep_active_partition_tb;
 			break;
+		case TLV_OPT_NODE_LIST_VERSION:
+			if ((res = tlv_iter_decode_u32(&tlv_iter, &u32)) != 0) {
+				return (res);
+			}
+
+			decoded_msg->node_list_version_set = 1;
+			decoded_msg->node_list_version = u32;
+			break;
+		case TLV_OPT_NODE_LIST_BASE_VERSION:
+			if ((res = tlv_iter_decode_u32(&tlv_iter, &u32)) != 0) {
+				return (res);
+			}
+
+			decoded_msg->node_list_base_version_set = 1;
+			decoded_msg->node_list_base_version = u32;
+			break;
+		case TLV_OPT_REMOVED_NODE_ID:
+			if ((res = tlv_iter_decode_u32(&tlv_iter, &u32)) != 0) {
+				return (res);
+			}
+
+			if (node_list_add(&decoded_msg->removed_nodes, u32, 0,
+			    TLV_NODE_STATE_NOT_SET) == NULL) {
+				return (-2);
+			}
+			break;
 		/*
 		 * Default is not defined intentionally. Compiler shows warning when
 		 * new tlv option is added. Also protocol ignores unknown options so
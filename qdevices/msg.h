@@ -117,6 +117,12 @@ struct msg_decoded {
 	enum tlv_heuristics heuristics;	/* Always valid but can be TLV_HEURISTICS_UNDEFINED */
 	enum tlv_keep_active_partition_tie_breaker keep_active_partition_tie_breaker;
 	uint8_t keep_active_partition_tie_breaker_set;
+	uint8_t node_list_version_set;
+	uint32_t node_list_version;	/* Valid only if node_list_version_set != 0 */
+	uint8_t node_list_base_version_set;
+	/* Valid only if node_list_base_version_set != 0. Node list is then delta. */
+	uint32_t node_list_base_version;
+	struct node_list removed_nodes;	/* Node ids removed in delta node list */
 };
 
 extern size_t		msg_create_preinit(struct dynar *msg, const char *cluster_name,
@@ -172,9 +178,19 @@ extern size_t		msg_create_node_list(struct dynar *msg,
     int add_heuristics, enum tlv_heuristics heuristics,
     const struct node_list *nodes);
 
+extern size_t		msg_create_node_list_versioned(struct dynar *msg,
+    uint32_t msg_seq_number, enum tlv_node_list_type node_list_type,
+    int add_ring_id, const struct tlv_ring_id *ring_id,
+    int add_config_version, uint64_t config_version,
+    int add_quorate, enum tlv_quorate quorate,
+    int add_heuristics, enum tlv_heuristics heuristics,
+    uint32_t node_list_version,
+    int add_node_list_base_version, uint32_t node_list_base_version,
+    const struct node_list *nodes, const struct node_list *removed_nodes);
+
 extern size_t		msg_create_node_list_reply(struct dynar *msg, uint32_t msg_seq_number,
     enum tlv_node_list_type node_list_type, const struct tlv_ring_id *ring_id,
-    enum tlv_vote vote);
+    enum tlv_vote vote, int add_node_list_version, uint32_t node_list_version);
 
 extern size_t		msg_create_ask_for_vote(struct dynar *msg, uint32_t msg_seq_number);
 
@@ -209,3 +209,90 @@ node_list_size(const struct node_list *nlist)
 
 	return (res);
 }
+
+/*
+ * Compute delta between old_list and new_list. changed_nodes contains nodes which are
+ * not in old_list or have different data center id or state, removed_nodes contains
+ * nodes which are not in new_list. Both lists are initialized by this function.
+ * Returns 0 on success, -1 on allocation failure.
+ */
+int
+node_list_diff(const struct node_list *old_list, const struct node_list *new_list,
+    struct node_list *changed_nodes, struct node_list *removed_nodes)
+{
+	struct node_list_entry *node_entry;
+	struct node_list_entry *old_entry;
+
+	node_list_init(changed_nodes);
+	node_list_init(removed_nodes);
+
+	TAILQ_FOREACH(node_entry, new_list, entries) {
+		old_entry = node_list_find_node_id(old_list, node_entry->node_id);
+
+		if (old_entry != NULL && old_entry->data_center_id == node_entry->data_center_id &&
+		    old_entry->node_state == node_entry->node_state) {
+			continue;
+		}
+
+		if (node_list_add(changed_nodes, node_entry->node_id, node_entry->data_center_id,
+		    node_entry->node_state) == NULL) {
+			goto error_free;
+		}
+	}
+
+	TAILQ_FOREACH(node_entry, old_list, entries) {
+		if (node_list_find_node_id(new_list, node_entry->node_id) != NULL) {
+			continue;
+		}
+
+		if (node_list_add(removed_nodes, node_entry->node_id, 0,
+		    TLV_NODE_STATE_NOT_SET) == NULL) {
+			goto error_free;
+		}
+	}
+
+	return (0);
+
+error_free:
+	node_list_free(changed_nodes);
+	node_list_free(removed_nodes);
+
+	return (-1);
+}
+
+/*
+ * Apply delta computed by node_list_diff to the list. Changed nodes replace nodes with
+ * same node id (or are appended), removed nodes are deleted.
+ * Returns 0 on success, -1 on allocation failure.
+ */
+int
+node_list_apply_delta(struct node_list *list, const struct node_list *changed_nodes,
+    const struct node_list *removed_nodes)
+{
+	struct node_list_entry *node_entry;
+	struct node_list_entry *list_entry;
+
+	TAILQ_FOREACH(node_entry, removed_nodes, entries) {
+		list_entry = node_list_find_node_id(list, node_entry->node_id);
+
+		if (list_entry != NULL) {
+			node_list_del(list, list_entry);
+		}
+	}
+
+	TAILQ_FOREACH(node_entry, changed_nodes, entries) {
+		list_entry = node_list_find_node_id(list, node_entry->node_id);
+
+		if (list_entry != NULL) {
+			list_entry->data_center_id = node_entry->data_center_id;
+			list_entry->node_state = node_entry->node_state;
+		} else {
+			if (node_list_add(list, node_entry->node_id, node_entry->data_center_id,
+			    node_entry->node_state) == NULL) {
+				return (-1);
+			}
+		}
+	}
+
+	return (0);
+}
@@ -84,6 +84,13 @@ extern int				 node_list_eq(const struct node_list *list1,
 
 extern size_t				 node_list_size(const struct node_list *nlist);
 
+extern int				 node_list_diff(const struct node_list *old_list,
+    const struct node_list *new_list, struct node_list *changed_nodes,
+    struct node_list *removed_nodes);
+
+extern int				 node_list_apply_delta(struct node_list *list,
+    const struct node_list *changed_nodes, const struct node_list *removed_nodes);
+
 #ifdef __cplusplus
 }
 #endif
@@ -40,9 +40,9 @@
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
-#include <err.h>
 #include <errno.h>
 #include <poll.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "dynar.h"
@@ -50,12 +50,8 @@
 #include "dynar-simple-lex.h"
 #include "process-list.h"
 
-static void		process_list_free_argv(size_t no_params, char **argv);
-
 static void		process_list_entry_free(struct process_list_entry *entry);
 
-static char 		**process_list_parse_command(const char *command, size_t *no_params);
-
 static int		process_list_entry_exec(const struct process_list *plist,
     struct process_list_entry *entry);
 
@@ -76,7 +72,18 @@ process_list_init(struct process_list *plist, size_t max_list_entries, int use_e
 	TAILQ_INIT(&plist->to_kill_list);
 }
 
-static void
+/*
+ * When enabled, stdin and stdout of executed processes are connected to pipes
+ * (entry stdin_fd/stdout_fd, both non-blocking) instead of /dev/null
+ */
+void
+process_list_set_use_stdio_pipes(struct process_list *plist, int use_stdio_pipes)
+{
+
+	plist->use_stdio_pipes = use_stdio_pipes;
+}
+
+void
 process_list_free_argv(size_t no_params, char **argv)
 {
 	size_t zi;
@@ -87,16 +94,35 @@ process_list_free_argv(size_t no_params, char **argv)
 	free(argv);
 }
 
+static void
+process_list_entry_close_stdio_pipes(struct process_list_entry *entry)
+{
+
+	if (entry->stdin_fd != -1) {
+		close(entry->stdin_fd);
+		entry->stdin_fd = -1;
+	}
+
+	if (entry->stdout_fd != -1) {
+		close(entry->stdout_fd);
+		entry->stdout_fd = -1;
+	}
+}
+
 static void
 process_list_entry_free(struct process_list_entry *entry)
 {
 
-	process_list_free_argv(entry->exec_argc, entry->exec_argv);
+	process_list_entry_close_stdio_pipes(entry);
+
+	if (!entry->exec_argv_shared) {
+		process_list_free_argv(entry->exec_argc, entry->exec_argv);
+	}
 	free(entry->name);
 	free(entry);
 }
 
-static char **
+char **
 process_list_parse_command(const char *command, size_t *no_params)
 {
 	struct dynar command_dstr;
@@ -182,8 +208,8 @@ exit_res:
 	return (res_argv);
 }
 
-struct process_list_entry *
-process_list_add(struct process_list *plist, const char *name, const char *command)
+static struct process_list_entry *
+process_list_entry_alloc(struct process_list *plist, const char *name)
 {
 	struct process_list_entry *entry;
 
@@ -200,6 +226,8 @@ process_list_add(struct process_list *plist, const char *name, const char *comma
 	}
 
 	memset(entry, 0, sizeof(*entry));
+	entry->stdin_fd = -1;
+	entry->stdout_fd = -1;
 	entry->name = strdup(name);
 	if (entry->name == NULL) {
 		process_list_entry_free(entry);
@@ -208,6 +236,28 @@ process_list_add(struct process_list *plist, const char *name, const char *comma
 	}
 
 	entry->state = PROCESS_LIST_ENTRY_STATE_INITIALIZED;
+
+	return (entry);
+}
+
+static void
+process_list_entry_insert(struct process_list *plist, struct process_list_entry *entry)
+{
+
+	plist->allocated_list_entries++;
+	TAILQ_INSERT_TAIL(&plist->active_list, entry, entries);
+}
+
+struct process_list_entry *
+process_list_add(struct process_list *plist, const char *name, const char *command)
+{
+	struct process_list_entry *entry;
+
+	entry = process_list_entry_alloc(plist, name);
+	if (entry == NULL) {
+		return (NULL);
+	}
+
 	entry->exec_argv = process_list_parse_command(command, &entry->exec_argc);
 	if (entry->exec_argv == NULL) {
 		process_list_entry_free(entry);
@@ -215,8 +265,34 @@ process_list_add(struct process_list *plist, const char *name, const char *comma
 		return (NULL);
 	}
 
-	plist->allocated_list_entries++;
-	TAILQ_INSERT_TAIL(&plist->active_list, entry, entries);
+	process_list_entry_insert(plist, entry);
+
+	return (entry);
+}
+
+/*
+ * Add entry with already parsed argv (result of process_list_parse_command). Argv is
+ * not copied so it must stay valid until process is executed.
+ */
+struct process_list_entry *
+process_list_add_argv(struct process_list *plist, const char *name, size_t argc, char **argv)
+{
+	struct process_list_entry *entry;
+
+	if (argv == NULL || argc < 1) {
+		return (NULL);
+	}
+
+	entry = process_list_entry_alloc(plist, name);
+	if (entry == NULL) {
+		return (NULL);
+	}
+
+	entry->exec_argv = argv;
+	entry->exec_argc = argc;
+	entry->exec_argv_shared = 1;
+
+	process_list_entry_insert(plist, entry);
 
 	return (entry);
 }
@@ -253,38 +329,123 @@ process_list_free(struct process_list *plist)
 	TAILQ_INIT(&plist->to_kill_list);
 }
 
+/*
+ * Called in vforked child so only async-signal-safe functions may be used
+ * and memory must not be modified
+ */
 static void
-process_list_entry_exec_helper_set_stdfd(void)
+process_list_entry_exec_helper_set_stdfd(int stdin_fd, int stdout_fd)
 {
 	int devnull;
 
 	devnull = open("/dev/null", O_RDWR);
 	if (devnull == -1) {
-		err(EXIT_FAILURE, "Can't open /dev/null");
+		_exit(EXIT_FAILURE);
+	}
+
+	if (stdin_fd == -1) {
+		stdin_fd = devnull;
+	}
+
+	if (stdout_fd == -1) {
+		stdout_fd = devnull;
 	}
 
-	if (dup2(devnull, 0) < 0 || dup2(devnull, 1) < 0 || dup2(devnull, 2) < 0) {
+	if (dup2(stdin_fd, 0) < 0 || dup2(stdout_fd, 1) < 0 || dup2(devnull, 2) < 0) {
+		_exit(EXIT_FAILURE);
+	}
+
+	if (devnull > 2) {
 		close(devnull);
-		err(EXIT_FAILURE, "Can't dup2 stdin/out/err to /dev/null");
+	}
+}
+
+static int
+process_list_entry_exec_helper_set_fd_flags(int fd, int nonblock)
+{
+	int flags;
+
+	if (fcntl(fd, F_SETFD, FD_CLOEXEC) == -1) {
+		return (-1);
 	}
 
-	close(devnull);
+	if (nonblock) {
+		if ((flags = fcntl(fd, F_GETFL)) == -1 ||
+		    fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+			return (-1);
+		}
+	}
+
+	return (0);
+}
+
+/*
+ * Create pipes for stdin (in_pipe) and stdout (out_pipe) of child. Parent ends are
+ * non-blocking, all ends are close-on-exec (child dup2s its ends to 0 and 1)
+ */
+static int
+process_list_entry_exec_helper_create_pipes(int in_pipe[2], int out_pipe[2])
+{
+
+	if (pipe(in_pipe) != 0) {
+		return (-1);
+	}
+
+	if (pipe(out_pipe) != 0) {
+		close(in_pipe[0]);
+		close(in_pipe[1]);
+
+		return (-1);
+	}
+
+	if (process_list_entry_exec_helper_set_fd_flags(in_pipe[0], 0) != 0 ||
+	    process_list_entry_exec_helper_set_fd_flags(in_pipe[1], 1) != 0 ||
+	    process_list_entry_exec_helper_set_fd_flags(out_pipe[0], 1) != 0 ||
+	    process_list_entry_exec_helper_set_fd_flags(out_pipe[1], 0) != 0) {
+		close(in_pipe[0]);
+		close(in_pipe[1]);
+		close(out_pipe[0]);
+		close(out_pipe[1]);
+
+		return (-1);
+	}
+
+	return (0);
 }
 
 static int
 process_list_entry_exec(const struct process_list *plist, struct process_list_entry *entry)
 {
 	pid_t pid;
+	int in_pipe[2];
+	int out_pipe[2];
 
 	if (entry->state != PROCESS_LIST_ENTRY_STATE_INITIALIZED) {
 		return (-1);
 	}
 
-	pid = fork();
+	in_pipe[0] = in_pipe[1] = out_pipe[0] = out_pipe[1] = -1;
+
+	if (plist->use_stdio_pipes &&
+	    process_list_entry_exec_helper_create_pipes(in_pipe, out_pipe) != 0) {
+		return (-1);
+	}
+
+	/*
+	 * vfork avoids copying page tables of (possibly big) parent process
+	 */
+	pid = vfork();
 	if (pid == -1) {
+		if (plist->use_stdio_pipes) {
+			close(in_pipe[0]);
+			close(in_pipe[1]);
+			close(out_pipe[0]);
+			close(out_pipe[1]);
+		}
+
 		return (-1);
 	} else if (pid == 0) {
-		process_list_entry_exec_helper_set_stdfd();
+		process_list_entry_exec_helper_set_stdfd(in_pipe[0], out_pipe[1]);
 
 		if (!plist->use_execvp) {
 			execv(entry->exec_argv[0], entry->exec_argv);
@@ -293,12 +454,29 @@ process_list_entry_exec(const struct process_list *plist, struct process_list_en
 		}
 
 		/*
-		 * Exec returned -> exec failed
+		 * Exec returned -> exec failed. Stderr is already redirected to /dev/null
+		 * so there is nobody to report error to
 		 */
-		err(EXIT_FAILURE, "Can't execute command %s (%s)", entry->name, entry->exec_argv[0]);
+		_exit(EXIT_FAILURE);
 	} else {
 		entry->pid = pid;
 		entry->state = PROCESS_LIST_ENTRY_STATE_RUNNING;
+		(void)clock_gettime(CLOCK_MONOTONIC, &entry->start_time);
+
+		if (plist->use_stdio_pipes) {
+			close(in_pipe[0]);
+			close(out_pipe[1]);
+			entry->stdin_fd = in_pipe[1];
+			entry->stdout_fd = out_pipe[0];
+		}
+
+		if (entry->exec_argv_shared) {
+			/*
+			 * Shared argv may be freed by owner after exec
+			 */
+			entry->exec_argv = NULL;
+			entry->exec_argc = 0;
+		}
 
 		if (plist->notify_fn != NULL) {
 			plist->notify_fn(PROCESS_LIST_NOTIFY_REASON_EXECUTED, entry,
@@ -349,6 +527,7 @@ process_list_entry_waitpid(const struct process_list *plist, struct process_list
 	}
 
 	entry->exit_status = status;
+	(void)clock_gettime(CLOCK_MONOTONIC, &entry->end_time);
 
 	if (entry->state == PROCESS_LIST_ENTRY_STATE_RUNNING) {
 		if (plist->notify_fn != NULL) {
@@ -467,14 +646,94 @@ process_list_get_summary_result_short(struct process_list *plist)
 	return (res);
 }
 
+/*
+ * Returns time in ms the process was running (or is running if not yet finished)
+ */
+uint32_t
+process_list_entry_get_duration(const struct process_list_entry *entry)
+{
+	struct timespec end_time;
+	int64_t duration;
+
+	if (entry->state == PROCESS_LIST_ENTRY_STATE_INITIALIZED) {
+		return (0);
+	}
+
+	if (entry->state == PROCESS_LIST_ENTRY_STATE_FINISHED) {
+		end_time = entry->end_time;
+	} else {
+		(void)clock_gettime(CLOCK_MONOTONIC, &end_time);
+	}
+
+	duration = ((int64_t)end_time.tv_sec - entry->start_time.tv_sec) * 1000 +
+	    (end_time.tv_nsec - entry->start_time.tv_nsec) / 1000000;
+
+	if (duration < 0) {
+		return (0);
+	}
+
+	return ((duration > UINT32_MAX) ? UINT32_MAX : (uint32_t)duration);
+}
+
+/*
+ * Returns exit code of finished process or -1 if process is not finished or it was
+ * terminated by signal
+ */
+int
+process_list_entry_get_exit_code(const struct process_list_entry *entry)
+{
+
+	if (entry->state != PROCESS_LIST_ENTRY_STATE_FINISHED ||
+	    !WIFEXITED(entry->exit_status)) {
+		return (-1);
+	}
+
+	return (WEXITSTATUS(entry->exit_status));
+}
+
+/*
+ * Returns signal which terminated finished process or 0
+ */
+int
+process_list_entry_get_term_signal(const struct process_list_entry *entry)
+{
+
+	if (entry->state != PROCESS_LIST_ENTRY_STATE_FINISHED ||
+	    !WIFSIGNALED(entry->exit_status)) {
+		return (0);
+	}
+
+	return (WTERMSIG(entry->exit_status));
+}
+
 static void
 process_list_move_entry_to_kill_list(struct process_list *plist, struct process_list_entry *entry)
 {
 
+	process_list_entry_close_stdio_pipes(entry);
+
 	TAILQ_REMOVE(&plist->active_list, entry, entries);
 	TAILQ_INSERT_TAIL(&plist->to_kill_list, entry, entries);
 }
 
+/*
+ * Remove entry from active list. Entry which is not running is freed, running one
+ * is moved to kill list.
+ */
+void
+process_list_del(struct process_list *plist, struct process_list_entry *entry)
+{
+
+	if (entry->state == PROCESS_LIST_ENTRY_STATE_INITIALIZED ||
+	    entry->state == PROCESS_LIST_ENTRY_STATE_FINISHED) {
+		TAILQ_REMOVE(&plist->active_list, entry, entries);
+		process_list_entry_free(entry);
+		plist->allocated_list_entries--;
+	} else {
+		process_list_move_entry_to_kill_list(plist, entry);
+	}
+}
+
 void
 process_list_move_active_entries_to_kill_list(struct process_list *plist)
 {
@@ -486,14 +745,7 @@ process_list_move_active_entries_to_kill_list(struct process_list *plist)
 	while (entry != NULL) {
 		entry_next = TAILQ_NEXT(entry, entries);
 
-		if (entry->state == PROCESS_LIST_ENTRY_STATE_INITIALIZED ||
-		    entry->state == PROCESS_LIST_ENTRY_STATE_FINISHED) {
-			TAILQ_REMOVE(&plist->active_list, entry, entries);
-			process_list_entry_free(entry);
-			plist->allocated_list_entries--;
-		} else {
-			process_list_move_entry_to_kill_list(plist, entry);
-		}
+		process_list_del(plist, entry);
 
 		entry = entry_next;
 	}
@@ -551,6 +803,25 @@ process_list_process_kill_list_entry(struct process_list *plist, struct process_
 	return (res);
 }
 
+/*
+ * Send SIGTERM to processes in kill list which were not signaled yet, so they don't
+ * have to wait for next process_list_process_kill_list call
+ */
+int
+process_list_terminate_kill_list(struct process_list *plist)
+{
+	struct process_list_entry *entry;
+
+	TAILQ_FOREACH(entry, &plist->to_kill_list, entries) {
+		if (entry->state == PROCESS_LIST_ENTRY_STATE_RUNNING &&
+		    process_list_process_kill_list_entry(plist, entry) != 0) {
+			return (-1);
+		}
+	}
+
+	return (0);
+}
+
 int
 process_list_process_kill_list(struct process_list *plist)
 {
@@ -37,6 +37,8 @@
 
 #include <signal.h>
 #include <sys/queue.h>
+#include <inttypes.h>
+#include <time.h>
 
 #include "dynar.h"
 
@@ -62,8 +64,16 @@ struct process_list_entry {
 	enum process_list_entry_state state;
 	char **exec_argv;
 	size_t exec_argc;
+	int exec_argv_shared;
+	int stdin_fd;
+	int stdout_fd;
 	pid_t pid;
 	int exit_status;
+	/*
+	 * Monotonic time of exec and of exit (valid only in FINISHED state)
+	 */
+	struct timespec start_time;
+	struct timespec end_time;
 
 	TAILQ_ENTRY(process_list_entry) entries;
 };
@@ -73,6 +83,7 @@ typedef void (*process_list_notify_fn_t) (enum process_list_notify_reason reason
 
 struct process_list {
 	int use_execvp;
+	int use_stdio_pipes;
 	size_t max_list_entries;
 	size_t allocated_list_entries;
 	process_list_notify_fn_t notify_fn;
@@ -87,9 +98,20 @@ extern void				 process_list_init(struct process_list *plist,
     size_t max_list_entries, int use_execvp, process_list_notify_fn_t notify_fn,
     void *notify_fn_user_data);
 
+extern void				 process_list_set_use_stdio_pipes(
+    struct process_list *plist, int use_stdio_pipes);
+
 extern struct process_list_entry	*process_list_add(struct process_list *plist,
     const char *name, const char *command);
 
+extern struct process_list_entry	*process_list_add_argv(struct process_list *plist,
+    const char *name, size_t argc, char **argv);
+
+extern char				**process_list_parse_command(const char *command,
+    size_t *no_params);
+
+extern void				 process_list_free_argv(size_t no_params, char **argv);
+
 extern void				 process_list_free(struct process_list *plist);
 
 extern int				 process_list_exec_initialized(struct process_list *plist);
@@ -103,11 +125,25 @@ extern int				 process_list_get_summary_result(struct process_list *plist);
 extern int				 process_list_get_summary_result_short(
     struct process_list *plist);
 
+extern uint32_t				 process_list_entry_get_duration(
+    const struct process_list_entry *entry);
+
+extern int				 process_list_entry_get_exit_code(
+    const struct process_list_entry *entry);
+
+extern int				 process_list_entry_get_term_signal(
+    const struct process_list_entry *entry);
+
 extern void				 process_list_move_active_entries_to_kill_list(
     struct process_list *plist);
 
+extern void				 process_list_del(struct process_list *plist,
+    struct process_list_entry *entry);
+
 extern int				 process_list_process_kill_list(struct process_list *plist);
 
+extern int				 process_list_terminate_kill_list(struct process_list *plist);
+
 extern size_t				 process_list_get_kill_list_items(struct process_list *plist);
 
 extern int				 process_list_killall(struct process_list *plist,
@@ -70,6 +70,7 @@ qdevice_advanced_settings_init(struct qdevice_advanced_settings *settings)
 	settings->ipc_max_clients = QDEVICE_DEFAULT_IPC_MAX_CLIENTS;
 	settings->ipc_max_receive_size = QDEVICE_DEFAULT_IPC_MAX_RECEIVE_SIZE;
 	settings->ipc_max_send_size = QDEVICE_DEFAULT_IPC_MAX_SEND_SIZE;
+	settings->ipc_subscriber_buffer_size = QDEVICE_DEFAULT_IPC_SUBSCRIBER_BUFFER_SIZE;
 
 	settings->heuristics_ipc_max_send_buffers = QDEVICE_DEFAULT_HEURISTICS_IPC_MAX_SEND_BUFFERS;
 	settings->heuristics_ipc_max_send_receive_size = QDEVICE_DEFAULT_HEURISTICS_IPC_MAX_SEND_RECEIVE_SIZE;
@@ -84,6 +85,10 @@ qdevice_advanced_settings_init(struct qdevice_advanced_settings *settings)
 	settings->heuristics_use_execvp = QDEVICE_DEFAULT_HEURISTICS_USE_EXECVP;
 	settings->heuristics_max_processes = QDEVICE_DEFAULT_HEURISTICS_MAX_PROCESSES;
 	settings->heuristics_kill_list_interval = QDEVICE_DEFAULT_HEURISTICS_KILL_LIST_INTERVAL;
+	settings->heuristics_history_size = QDEVICE_DEFAULT_HEURISTICS_HISTORY_SIZE;
+	settings->flight_recorder_size = QDEVICE_DEFAULT_FLIGHT_RECORDER_SIZE;
+	settings->log_async = QDEVICE_DEFAULT_LOG_ASYNC;
+	settings->log_async_queue_size = QDEVICE_DEFAULT_LOG_ASYNC_QUEUE_SIZE;
 
 	if ((settings->net_nss_db_dir = strdup(QDEVICE_NET_DEFAULT_NSS_DB_DIR)) == NULL) {
 		return (-1);
@@ -102,9 +107,15 @@ qdevice_advanced_settings_init(struct qdevice_advanced_settings *settings)
 	}
 	settings->net_heartbeat_interval_min = QDEVICE_NET_DEFAULT_HEARTBEAT_INTERVAL_MIN;
 	settings->net_heartbeat_interval_max = QDEVICE_NET_DEFAULT_HEARTBEAT_INTERVAL_MAX;
+	settings->net_adaptive_heartbeat_min = QDEVICE_NET_DEFAULT_ADAPTIVE_HEARTBEAT_MIN;
+	settings->net_adaptive_heartbeat_max = QDEVICE_NET_DEFAULT_ADAPTIVE_HEARTBEAT_MAX;
+	settings->net_adaptive_heartbeat_rto_multiplier =
+	    QDEVICE_NET_DEFAULT_ADAPTIVE_HEARTBEAT_RTO_MULTIPLIER;
 	settings->net_min_connect_timeout = QDEVICE_NET_DEFAULT_MIN_CONNECT_TIMEOUT;
 	settings->net_max_connect_timeout = QDEVICE_NET_DEFAULT_MAX_CONNECT_TIMEOUT;
+	settings->net_connect_stagger = QDEVICE_NET_DEFAULT_CONNECT_STAGGER;
 	settings->net_test_algorithm_enabled = QDEVICE_NET_DEFAULT_TEST_ALGORITHM_ENABLED;
+	settings->net_node_list_delta = QDEVICE_NET_DEFAULT_NODE_LIST_DELTA;
 
 	settings->master_wins = QDEVICE_ADVANCED_SETTINGS_MASTER_WINS_MODEL;
 
@@ -193,6 +204,13 @@ qdevice_advanced_settings_set(struct qdevice_advanced_settings *settings,
 		}
 
 		settings->ipc_max_send_size = (size_t)tmpll;
+	} else if (strcasecmp(option, "ipc_subscriber_buffer_size") == 0) {
+		if (utils_strtonum(value, QDEVICE_MIN_IPC_SUBSCRIBER_BUFFER_SIZE, LLONG_MAX,
+		    &tmpll) == -1) {
+			return (-2);
+		}
+
+		settings->ipc_subscriber_buffer_size = (size_t)tmpll;
 	} else if (strcasecmp(option, "heuristics_ipc_max_send_buffers") == 0) {
 		if (utils_strtonum(value, QDEVICE_MIN_HEURISTICS_IPC_MAX_SEND_BUFFERS, LLONG_MAX,
 		    &tmpll) == -1) {
@@ -262,6 +280,33 @@ qdevice_advanced_settings_set(struct qdevice_advanced_settings *settings,
 		}
 
 		settings->heuristics_kill_list_interval = (uint32_t)tmpll;
+	} else if (strcasecmp(option, "heuristics_history_size") == 0) {
+		if (utils_strtonum(value, QDEVICE_MIN_HEURISTICS_HISTORY_SIZE,
+		    QDEVICE_MAX_HEURISTICS_HISTORY_SIZE, &tmpll) == -1) {
+			return (-2);
+		}
+
+		settings->heuristics_history_size = (size_t)tmpll;
+	} else if (strcasecmp(option, "flight_recorder_size") == 0) {
+		if (utils_strtonum(value, QDEVICE_MIN_FLIGHT_RECORDER_SIZE, LLONG_MAX,
+		    &tmpll) == -1) {
+			return (-2);
+		}
+
+		settings->flight_recorder_size = (size_t)tmpll;
+	} else if (strcasecmp(option, "log_async") == 0) {
+		if ((tmpll = utils_parse_bool_str(value)) == -1) {
+			return (-2);
+		}
+
+		settings->log_async = (uint8_t)tmpll;
+	} else if (strcasecmp(option, "log_async_queue_size") == 0) {
+		if (utils_strtonum(value, QDEVICE_MIN_LOG_ASYNC_QUEUE_SIZE, LLONG_MAX,
+		    &tmpll) == -1) {
+			return (-2);
+		}
+
+		settings->log_async_queue_size = (size_t)tmpll;
 	} else if (strcasecmp(option, "net_nss_db_dir") == 0) {
 		free(settings->net_nss_db_dir);
 
@@ -329,6 +374,27 @@ qdevice_advanced_settings_set(struct qdevice_advanced_settings *settings,
 		}
 
 		settings->net_heartbeat_interval_max = (uint32_t)tmpll;
+	} else if (strcasecmp(option, "net_adaptive_heartbeat_min") == 0) {
+		if (utils_strtonum(value, QDEVICE_NET_MIN_HEARTBEAT_INTERVAL, UINT32_MAX,
+		    &tmpll) == -1) {
+			return (-2);
+		}
+
+		settings->net_adaptive_heartbeat_min = (uint32_t)tmpll;
+	} else if (strcasecmp(option, "net_adaptive_heartbeat_max") == 0) {
+		if (utils_strtonum(value, QDEVICE_NET_MIN_HEARTBEAT_INTERVAL, UINT32_MAX,
+		    &tmpll) == -1) {
+			return (-2);
+		}
+
+		settings->net_adaptive_heartbeat_max = (uint32_t)tmpll;
+	} else if (strcasecmp(option, "net_adaptive_heartbeat_rto_multiplier") == 0) {
+		if (utils_strtonum(value, QDEVICE_NET_MIN_ADAPTIVE_HEARTBEAT_RTO_MULTIPLIER,
+		    QDEVICE_NET_MAX_ADAPTIVE_HEARTBEAT_RTO_MULTIPLIER, &tmpll) == -1) {
+			return (-2);
+		}
+
+		settings->net_adaptive_heartbeat_rto_multiplier = (uint32_t)tmpll;
 	} else if (strcasecmp(option, "net_min_connect_timeout") == 0) {
 		if (utils_strtonum(value, QDEVICE_NET_MIN_CONNECT_TIMEOUT, UINT32_MAX,
 		    &tmpll) == -1) {
@@ -343,12 +409,25 @@ qdevice_advanced_settings_set(struct qdevice_advanced_settings *settings,
 		}
 
 		settings->net_max_connect_timeout = (uint32_t)tmpll;
+	} else if (strcasecmp(option, "net_connect_stagger") == 0) {
+		if (utils_strtonum(value, QDEVICE_NET_MIN_CONNECT_STAGGER, UINT32_MAX,
+		    &tmpll) == -1) {
+			return (-2);
+		}
+
+		settings->net_connect_stagger = (uint32_t)tmpll;
 	} else if (strcasecmp(option, "net_test_algorithm_enabled") == 0) {
 		if ((tmpll = utils_parse_bool_str(value)) == -1) {
 			return (-2);
 		}
 
 		settings->net_test_algorithm_enabled = (uint8_t)tmpll;
+	} else if (strcasecmp(option, "net_node_list_delta") == 0) {
+		if ((tmpll = utils_parse_bool_str(value)) == -1) {
+			return (-2);
+		}
+
+		settings->net_node_list_delta = (uint8_t)tmpll;
 	} else if (strcasecmp(option, "master_wins") == 0) {
 		tmpll = utils_parse_bool_str(value);
 
@@ -58,6 +58,7 @@ struct qdevice_advanced_settings {
 	char *votequorum_device_name;
 	size_t ipc_max_clients;
 	size_t ipc_max_send_size;
+	size_t ipc_subscriber_buffer_size;
 	size_t ipc_max_receive_size;
 	enum qdevice_advanced_settings_master_wins master_wins;
 	size_t heuristics_ipc_max_send_buffers;
@@ -70,6 +71,10 @@ struct qdevice_advanced_settings {
 	int heuristics_use_execvp;
 	size_t heuristics_max_processes;
 	uint32_t heuristics_kill_list_interval;
+	size_t heuristics_history_size;
+	size_t flight_recorder_size;
+	uint8_t log_async;
+	size_t log_async_queue_size;
 
 	/*
 	 * Related to model NET
@@ -84,9 +89,14 @@ struct qdevice_advanced_settings {
 	char *net_nss_client_cert_nickname;
 	uint32_t net_heartbeat_interval_min;
 	uint32_t net_heartbeat_interval_max;
+	uint32_t net_adaptive_heartbeat_min;
+	uint32_t net_adaptive_heartbeat_max;
+	uint32_t net_adaptive_heartbeat_rto_multiplier;
 	uint32_t net_min_connect_timeout;
 	uint32_t net_max_connect_timeout;
+	uint32_t net_connect_stagger;
 	uint8_t net_test_algorithm_enabled;
+	uint8_t net_node_list_delta;
 };
 
 extern int		qdevice_advanced_settings_init(struct qdevice_advanced_settings *settings);
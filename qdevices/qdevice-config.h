@@ -71,6 +71,8 @@ extern "C" {
 #define QDEVICE_DEFAULT_IPC_MAX_RECEIVE_SIZE	(4*1024)
 #define QDEVICE_DEFAULT_IPC_MAX_SEND_SIZE	(64*1024)
 #define QDEVICE_MIN_IPC_RECEIVE_SEND_SIZE	1024
+#define QDEVICE_DEFAULT_IPC_SUBSCRIBER_BUFFER_SIZE	(64*1024)
+#define QDEVICE_MIN_IPC_SUBSCRIBER_BUFFER_SIZE		1024
 
 #define QDEVICE_DEFAULT_HEURISTICS_IPC_MAX_SEND_BUFFERS		128
 #define QDEVICE_MIN_HEURISTICS_IPC_MAX_SEND_BUFFERS		10
@@ -97,6 +99,19 @@ extern "C" {
 #define QDEVICE_DEFAULT_HEURISTICS_KILL_LIST_INTERVAL		(5 * 1000)
 #define QDEVICE_MIN_HEURISTICS_KILL_LIST_INTERVAL		QDEVICE_MIN_HEURISTICS_TIMEOUT
 
+#define QDEVICE_DEFAULT_HEURISTICS_HISTORY_SIZE			128
+#define QDEVICE_MIN_HEURISTICS_HISTORY_SIZE			0
+#define QDEVICE_MAX_HEURISTICS_HISTORY_SIZE			65536
+
+#define QDEVICE_HEURISTICS_WORKER_PROBE_MAX_LINE_SIZE		256
+
+#define QDEVICE_DEFAULT_FLIGHT_RECORDER_SIZE			256
+#define QDEVICE_MIN_FLIGHT_RECORDER_SIZE			0
+
+#define QDEVICE_DEFAULT_LOG_ASYNC				0
+#define QDEVICE_DEFAULT_LOG_ASYNC_QUEUE_SIZE			1024
+#define QDEVICE_MIN_LOG_ASYNC_QUEUE_SIZE			16
+
 #define QDEVICE_TOOL_PROGRAM_NAME		"corosync-qdevice-tool"
 
 #ifdef __cplusplus
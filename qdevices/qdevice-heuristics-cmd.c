@@ -35,32 +35,77 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 
 #include "dynar.h"
 #include "dynar-str.h"
 #include "log.h"
+#include "qdevice-heuristics.h"
 #include "qdevice-heuristics-exec-result.h"
 #include "qdevice-heuristics-cmd.h"
-#include "qdevice-heuristics-cmd-str.h"
 #include "qdevice-heuristics-io.h"
+#include "qdevice-heuristics-msg.h"
+
+/*
+ * Store result of every heuristics into exec_list so it can be reported
+ */
+static void
+qdevice_heuristics_cmd_process_entry_infos(struct qdevice_heuristics_instance *instance,
+    const struct qdevice_heuristics_msg_decoded *decoded_msg)
+{
+	const struct qdevice_heuristics_msg_entry_info *entry_info;
+	struct qdevice_heuristics_exec_list_entry *entry;
+	struct qdevice_heuristics_history_sample sample;
+	size_t zi;
+
+	for (zi = 0; zi < decoded_msg->no_entry_infos; zi++) {
+		entry_info = &decoded_msg->entry_infos[zi];
+
+		log(LOG_DEBUG, "  Heuristics %s: %s (exit status %"PRId32", signal %"PRId32
+		    ", %"PRIu32" ms)", entry_info->name,
+		    qdevice_heuristics_exec_entry_result_to_str(entry_info->result),
+		    entry_info->exit_status, entry_info->term_signal, entry_info->duration);
+
+		entry = qdevice_heuristics_exec_list_find_name(&instance->exec_list, entry_info->name);
+		if (entry == NULL) {
+			continue ;
+		}
+
+		entry->last_result = entry_info->result;
+		entry->last_exit_status = entry_info->exit_status;
+		entry->last_term_signal = entry_info->term_signal;
+		entry->last_duration = entry_info->duration;
+
+		sample.time = time(NULL);
+		sample.result = entry_info->result;
+		sample.exit_status = entry_info->exit_status;
+		sample.term_signal = entry_info->term_signal;
+		sample.duration = entry_info->duration;
+
+		if (qdevice_heuristics_history_add(&instance->history, entry->name,
+		    entry->command, &sample) != 0) {
+			log(LOG_WARNING, "Can't alloc heuristics history entry");
+		}
+	}
+}
 
 static int
 qdevice_heuristics_cmd_process_exec_result(struct qdevice_heuristics_instance *instance,
-    struct dynar *data)
+    const struct qdevice_heuristics_msg_decoded *decoded_msg)
 {
 	uint32_t seq_number;
-	char *str;
 	enum qdevice_heuristics_exec_result exec_result;
 
-	str = dynar_data(data);
-
-	if (sscanf(str, QDEVICE_HEURISTICS_CMD_STR_EXEC_RESULT_ADD_SPACE "%"PRIu32" %u", &seq_number,
-	    &exec_result) != 2) {
-		log(LOG_CRIT, "Can't parse exec result command (sscanf)");
+	if (!decoded_msg->seq_number_set || !decoded_msg->exec_result_set) {
+		log(LOG_CRIT, "Received heuristics exec result message doesn't contain "
+		    "required option");
 
 		return (-1);
 	}
 
+	seq_number = decoded_msg->seq_number;
+	exec_result = decoded_msg->exec_result;
+
 	log(LOG_DEBUG,
 	    "Received heuristics exec result command with seq_no \"%"PRIu32"\" and result \"%s\"", seq_number,
 	    qdevice_heuristics_exec_result_to_str(exec_result));
@@ -81,6 +126,10 @@ qdevice_heuristics_cmd_process_exec_result(struct qdevice_heuristics_instance *i
 
 	instance->waiting_for_result = 0;
 
+	qdevice_heuristics_cmd_process_entry_infos(instance, decoded_msg);
+
+	qdevice_heuristics_result_cache_set(instance, exec_result);
+
 	if (qdevice_heuristics_result_notifier_notify(&instance->exec_result_notifier_list,
 	    (void *)instance, seq_number, exec_result) != 0) {
 		log(LOG_DEBUG, "qdevice_heuristics_result_notifier_notify returned non-zero result");
@@ -91,63 +140,58 @@ qdevice_heuristics_cmd_process_exec_result(struct qdevice_heuristics_instance *i
 }
 
 /*
- * 1 - Line processed
- * 0 - No line to process - everything processed
+ * 1 - Message processed
+ * 0 - No message to process - everything processed
  * -1 - Error
  */
 static int
-qdevice_heuristics_cmd_process_one_line(struct qdevice_heuristics_instance *instance,
+qdevice_heuristics_cmd_process_one_msg(struct qdevice_heuristics_instance *instance,
     struct dynar *data)
 {
-	char *str;
-	size_t str_len;
-	size_t nl_pos;
-	size_t zi;
-
-	str = dynar_data(data);
-	str_len = dynar_size(data);
-
-	/*
-	 * Find valid line
-	 */
-	for (zi = 0; zi < str_len && str[zi] != '\r' && str[zi] != '\n'; zi++) ;
+	struct qdevice_heuristics_msg_decoded decoded_msg;
+	size_t msg_len;
+	int res;
 
-	if (zi >= str_len) {
+	msg_len = qdevice_heuristics_msg_get_complete_len(data);
+	if (msg_len == 0) {
 		/*
-		 * Command is not yet fully readed
+		 * Message is not yet fully readed
 		 */
 		return (0);
 	}
 
-	nl_pos = zi;
+	qdevice_heuristics_msg_decoded_init(&decoded_msg);
 
-	str[nl_pos] = '\0';
+	if (qdevice_heuristics_msg_decode(dynar_data(data), msg_len, &decoded_msg) != 0) {
+		log(LOG_CRIT, "Can't decode message from heuristics worker");
 
-	if (strncmp(str, QDEVICE_HEURISTICS_CMD_STR_EXEC_RESULT_ADD_SPACE,
-	    strlen(QDEVICE_HEURISTICS_CMD_STR_EXEC_RESULT_ADD_SPACE)) == 0) {
-		if (qdevice_heuristics_cmd_process_exec_result(instance, data) != 0) {
-			return (-1);
-		}
-	} else {
+		res = -1;
+		goto exit_destroy;
+	}
+
+	switch (decoded_msg.type) {
+	case QDEVICE_HEURISTICS_MSG_TYPE_EXEC_RESULT:
+		res = qdevice_heuristics_cmd_process_exec_result(instance, &decoded_msg);
+		break;
+	default:
 		log(LOG_CRIT,
-		    "Heuristics worker sent unknown command \"%s\"", str);
+		    "Heuristics worker sent unknown message type %u", decoded_msg.type);
 
-		    return (-1);
+		res = -1;
+		break;
 	}
 
-	/*
-	 * Find place where is begining of new "valid" line
-	 */
-	for (zi = nl_pos + 1; zi < str_len && (str[zi] == '\0' || str[zi] == '\n' || str[zi] == '\r'); zi++) ;
-
-	memmove(str, str + zi, str_len - zi);
-	if (dynar_set_size(data, str_len - zi) == -1) {
-		log(LOG_CRIT,
-		    "qdevice_heuristics_cmd_process_one_line: Can't set dynar size");
-		return (-1);
+	if (res != 0) {
+		goto exit_destroy;
 	}
 
-	return (1);
+	qdevice_heuristics_msg_remove_from_buffer(data, msg_len);
+	res = 1;
+
+exit_destroy:
+	qdevice_heuristics_msg_decoded_destroy(&decoded_msg);
+
+	return (res);
 }
 
 /*
@@ -160,7 +204,7 @@ qdevice_heuristics_cmd_process(struct qdevice_heuristics_instance *instance)
 	int res;
 
 	while ((res =
-	    qdevice_heuristics_cmd_process_one_line(instance, &instance->cmd_in_buffer)) == 1) ;
+	    qdevice_heuristics_cmd_process_one_msg(instance, &instance->cmd_in_buffer)) == 1) ;
 
 	return (res);
 }
@@ -199,7 +243,7 @@ qdevice_heuristics_cmd_read_from_pipe(struct qdevice_heuristics_instance *instan
 		break;
 	case 1:
 		/*
-		 * At least one cmd line received
+		 * At least one message received
 		 */
 		ret = qdevice_heuristics_cmd_process(instance);
 		break;
@@ -248,25 +292,6 @@ qdevice_heuristics_cmd_write(struct qdevice_heuristics_instance *instance)
 	return (0);
 }
 
-static int
-qdevice_heuristics_cmd_remove_newlines(struct dynar *str)
-{
-	size_t len;
-	size_t zi;
-	char *buf;
-
-	len = dynar_size(str);
-	buf = dynar_data(str);
-
-	for (zi = 0; zi < len ; zi++) {
-		if (buf[zi] == '\n' || buf[zi] == '\r') {
-			buf[zi] = ' ';
-		}
-	}
-
-	return (0);
-}
-
 int
 qdevice_heuristics_cmd_write_exec_list(struct qdevice_heuristics_instance *instance,
     const struct qdevice_heuristics_exec_list *new_exec_list)
@@ -281,8 +306,7 @@ qdevice_heuristics_cmd_write_exec_list(struct qdevice_heuristics_instance *insta
 		return (-1);
 	}
 
-	if (dynar_str_cpy(&send_buffer->buffer, QDEVICE_HEURISTICS_CMD_STR_EXEC_LIST_CLEAR) == -1 ||
-	    dynar_str_cat(&send_buffer->buffer, "\n") == -1) {
+	if (qdevice_heuristics_msg_create_exec_list_clear(&send_buffer->buffer) == 0) {
 		log(LOG_ERR, "Can't alloc list clear message");
 
 		send_buffer_list_discard_new(&instance->cmd_out_buffer_list, send_buffer);
@@ -307,13 +331,8 @@ qdevice_heuristics_cmd_write_exec_list(struct qdevice_heuristics_instance *insta
 			return (-1);
 		}
 
-		if (dynar_str_cpy(&send_buffer->buffer,
-		    QDEVICE_HEURISTICS_CMD_STR_EXEC_LIST_ADD_SPACE) == -1 ||
-		    dynar_str_cat(&send_buffer->buffer, entry->name) == -1 ||
-		    dynar_str_cat(&send_buffer->buffer, " ") == -1 ||
-		    dynar_str_cat(&send_buffer->buffer, entry->command) == -1 ||
-		    qdevice_heuristics_cmd_remove_newlines(&send_buffer->buffer) == -1 ||
-		    dynar_str_cat(&send_buffer->buffer, "\n") == -1) {
+		if (qdevice_heuristics_msg_create_exec_list_add(&send_buffer->buffer, entry->name,
+		    entry->command, entry->type) == 0) {
 			log(LOG_ERR, "Can't alloc list add message");
 
 			send_buffer_list_discard_new(&instance->cmd_out_buffer_list, send_buffer);
@@ -340,8 +359,7 @@ qdevice_heuristics_cmd_write_exec(struct qdevice_heuristics_instance *instance,
 		return (-1);
 	}
 
-	if (dynar_str_cpy(&send_buffer->buffer, QDEVICE_HEURISTICS_CMD_STR_EXEC_ADD_SPACE) == -1 ||
-	    dynar_str_catf(&send_buffer->buffer, "%"PRIu32" %"PRIu32"\n", timeout, seq_number) == -1) {
+	if (qdevice_heuristics_msg_create_exec(&send_buffer->buffer, timeout, seq_number) == 0) {
 		log(LOG_ERR, "Can't alloc exec message");
 
 		send_buffer_list_discard_new(&instance->cmd_out_buffer_list, send_buffer);
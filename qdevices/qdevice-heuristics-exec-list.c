@@ -58,6 +58,10 @@ qdevice_heuristics_exec_list_add(struct qdevice_heuristics_exec_list *list,
 
 	memset(entry, 0, sizeof(*entry));
 
+	entry->last_result = QDEVICE_HEURISTICS_EXEC_ENTRY_RESULT_NOT_FINISHED;
+	entry->last_exit_status = -1;
+	entry->last_term_signal = 0;
+
 	entry->name = strdup(name);
 	if (entry->name == NULL) {
 		free(entry);
@@ -78,6 +82,23 @@ qdevice_heuristics_exec_list_add(struct qdevice_heuristics_exec_list *list,
 	return (entry);
 }
 
+static void
+qdevice_heuristics_exec_list_entry_free(struct qdevice_heuristics_exec_list_entry *entry)
+{
+	size_t zi;
+
+	if (entry->exec_argv != NULL) {
+		for (zi = 0; zi < entry->exec_argc; zi++) {
+			free(entry->exec_argv[zi]);
+		}
+		free(entry->exec_argv);
+	}
+
+	free(entry->name);
+	free(entry->command);
+	free(entry);
+}
+
 void
 qdevice_heuristics_exec_list_free(struct qdevice_heuristics_exec_list *list)
 {
@@ -89,9 +110,7 @@ qdevice_heuristics_exec_list_free(struct qdevice_heuristics_exec_list *list)
 	while (entry != NULL) {
 		entry_next = TAILQ_NEXT(entry, entries);
 
-		free(entry->name);
-		free(entry->command);
-		free(entry);
+		qdevice_heuristics_exec_list_entry_free(entry);
 
 		entry = entry_next;
 	}
@@ -119,15 +138,19 @@ qdevice_heuristics_exec_list_clone(struct qdevice_heuristics_exec_list *dst_list
     const struct qdevice_heuristics_exec_list *src_list)
 {
 	struct qdevice_heuristics_exec_list_entry *entry;
+	struct qdevice_heuristics_exec_list_entry *dst_entry;
 
 	qdevice_heuristics_exec_list_init(dst_list);
 
 	TAILQ_FOREACH(entry, src_list, entries) {
-		if (qdevice_heuristics_exec_list_add(dst_list, entry->name, entry->command) == NULL) {
+		dst_entry = qdevice_heuristics_exec_list_add(dst_list, entry->name, entry->command);
+		if (dst_entry == NULL) {
 			qdevice_heuristics_exec_list_free(dst_list);
 
 			return (-1);
 		}
+
+		dst_entry->type = entry->type;
 	}
 
 	return (0);
@@ -140,9 +163,7 @@ qdevice_heuristics_exec_list_del(struct qdevice_heuristics_exec_list *list,
 
 	TAILQ_REMOVE(list, entry, entries);
 
-	free(entry->name);
-	free(entry->command);
-	free(entry);
+	qdevice_heuristics_exec_list_entry_free(entry);
 }
 
 int
@@ -189,7 +210,8 @@ qdevice_heuristics_exec_list_eq(const struct qdevice_heuristics_exec_list *list1
 			goto return_res;
 		}
 
-		if (strcmp(entry1->command, entry2->command) != 0) {
+		if (strcmp(entry1->command, entry2->command) != 0 ||
+		    entry1->type != entry2->type) {
 			res = 0;
 			goto return_res;
 		}
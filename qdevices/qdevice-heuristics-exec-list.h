@@ -40,13 +40,37 @@
 #include <sys/queue.h>
 #include <inttypes.h>
 
+#include "qdevice-heuristics-exec-result.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+enum qdevice_heuristics_exec_type {
+	QDEVICE_HEURISTICS_EXEC_TYPE_EXEC,
+	QDEVICE_HEURISTICS_EXEC_TYPE_PERSISTENT,
+	QDEVICE_HEURISTICS_EXEC_TYPE_BUILTIN,
+};
+
 struct qdevice_heuristics_exec_list_entry {
 	char *name;
 	char *command;
+	enum qdevice_heuristics_exec_type type;
+	/*
+	 * Parsed command (only used by heuristics worker)
+	 */
+	char **exec_argv;
+	size_t exec_argc;
+	/*
+	 * Result of last execution. Filled by heuristics worker and sent to qdevice
+	 * together with exec result. exit_status is -1 if not available (not finished,
+	 * killed by signal, persistent process or builtin check), term_signal is 0 if
+	 * process was not killed by signal.
+	 */
+	enum qdevice_heuristics_exec_entry_result last_result;
+	int32_t last_exit_status;
+	int32_t last_term_signal;
+	uint32_t last_duration;
 	TAILQ_ENTRY(qdevice_heuristics_exec_list_entry) entries;
 };
 
@@ -46,3 +46,17 @@ qdevice_heuristics_exec_result_to_str(enum qdevice_heuristics_exec_result exec_r
 
 	return ("Unknown heuristics exec result value");
 }
+
+const char *
+qdevice_heuristics_exec_entry_result_to_str(
+    enum qdevice_heuristics_exec_entry_result exec_entry_result)
+{
+
+	switch (exec_entry_result) {
+	case QDEVICE_HEURISTICS_EXEC_ENTRY_RESULT_NOT_FINISHED: return ("Not finished"); break;
+	case QDEVICE_HEURISTICS_EXEC_ENTRY_RESULT_PASS: return ("Pass"); break;
+	case QDEVICE_HEURISTICS_EXEC_ENTRY_RESULT_FAIL: return ("Fail"); break;
+	}
+
+	return ("Unknown heuristics exec entry result value");
+}
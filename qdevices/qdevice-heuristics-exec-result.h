@@ -55,9 +55,24 @@ enum qdevice_heuristics_exec_result {
 	QDEVICE_HEURISTICS_EXEC_RESULT_FAIL = 2,
 };
 
+/*
+ * Result of single heuristics (exec list entry)
+ */
+enum qdevice_heuristics_exec_entry_result {
+	/*
+	 * Not executed or not finished before result was reported (timeout)
+	 */
+	QDEVICE_HEURISTICS_EXEC_ENTRY_RESULT_NOT_FINISHED = 0,
+	QDEVICE_HEURISTICS_EXEC_ENTRY_RESULT_PASS = 1,
+	QDEVICE_HEURISTICS_EXEC_ENTRY_RESULT_FAIL = 2,
+};
+
 extern const char *	qdevice_heuristics_exec_result_to_str(
     enum qdevice_heuristics_exec_result exec_result);
 
+extern const char *	qdevice_heuristics_exec_entry_result_to_str(
+    enum qdevice_heuristics_exec_entry_result exec_entry_result);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "qdevice-heuristics-history.h"
+
+void
+qdevice_heuristics_history_init(struct qdevice_heuristics_history *history, size_t max_samples)
+{
+
+	memset(history, 0, sizeof(*history));
+
+	history->max_samples = max_samples;
+	TAILQ_INIT(&history->entries);
+}
+
+static void
+qdevice_heuristics_history_entry_free(struct qdevice_heuristics_history_entry *entry)
+{
+
+	free(entry->name);
+	free(entry->command);
+	free(entry->samples);
+	free(entry);
+}
+
+static void
+qdevice_heuristics_history_del(struct qdevice_heuristics_history *history,
+    struct qdevice_heuristics_history_entry *entry)
+{
+
+	TAILQ_REMOVE(&history->entries, entry, entries);
+	qdevice_heuristics_history_entry_free(entry);
+}
+
+void
+qdevice_heuristics_history_destroy(struct qdevice_heuristics_history *history)
+{
+	struct qdevice_heuristics_history_entry *entry;
+	struct qdevice_heuristics_history_entry *entry_next;
+
+	entry = TAILQ_FIRST(&history->entries);
+
+	while (entry != NULL) {
+		entry_next = TAILQ_NEXT(entry, entries);
+
+		qdevice_heuristics_history_entry_free(entry);
+
+		entry = entry_next;
+	}
+
+	TAILQ_INIT(&history->entries);
+}
+
+static struct qdevice_heuristics_history_entry *
+qdevice_heuristics_history_find_name(const struct qdevice_heuristics_history *history,
+    const char *name)
+{
+	struct qdevice_heuristics_history_entry *entry;
+
+	TAILQ_FOREACH(entry, &history->entries, entries) {
+		if (strcmp(entry->name, name) == 0) {
+			return (entry);
+		}
+	}
+
+	return (NULL);
+}
+
+static struct qdevice_heuristics_history_entry *
+qdevice_heuristics_history_entry_new(struct qdevice_heuristics_history *history,
+    const char *name, const char *command)
+{
+	struct qdevice_heuristics_history_entry *entry;
+
+	entry = malloc(sizeof(*entry));
+	if (entry == NULL) {
+		return (NULL);
+	}
+
+	memset(entry, 0, sizeof(*entry));
+
+	entry->name = strdup(name);
+	entry->command = strdup(command);
+	entry->max_samples = history->max_samples;
+	entry->samples = malloc(sizeof(*entry->samples) * entry->max_samples);
+
+	if (entry->name == NULL || entry->command == NULL || entry->samples == NULL) {
+		qdevice_heuristics_history_entry_free(entry);
+
+		return (NULL);
+	}
+
+	TAILQ_INSERT_TAIL(&history->entries, entry, entries);
+
+	return (entry);
+}
+
+/*
+ * Add sample to history of heuristics name. If command of heuristics changed, old
+ * history is discarded, because it's not comparable.
+ */
+int
+qdevice_heuristics_history_add(struct qdevice_heuristics_history *history, const char *name,
+    const char *command, const struct qdevice_heuristics_history_sample *sample)
+{
+	struct qdevice_heuristics_history_entry *entry;
+
+	if (history->max_samples == 0) {
+		return (0);
+	}
+
+	entry = qdevice_heuristics_history_find_name(history, name);
+	if (entry != NULL && strcmp(entry->command, command) != 0) {
+		qdevice_heuristics_history_del(history, entry);
+		entry = NULL;
+	}
+
+	if (entry == NULL) {
+		entry = qdevice_heuristics_history_entry_new(history, name, command);
+		if (entry == NULL) {
+			return (-1);
+		}
+	}
+
+	entry->samples[entry->next_sample] = *sample;
+	entry->next_sample = (entry->next_sample + 1) % entry->max_samples;
+	if (entry->no_samples < entry->max_samples) {
+		entry->no_samples++;
+	}
+	entry->total_execs++;
+
+	return (0);
+}
+
+/*
+ * Remove history of heuristics which are no longer in exec_list (exec_list can be NULL)
+ */
+void
+qdevice_heuristics_history_prune(struct qdevice_heuristics_history *history,
+    const struct qdevice_heuristics_exec_list *exec_list)
+{
+	struct qdevice_heuristics_history_entry *entry;
+	struct qdevice_heuristics_history_entry *entry_next;
+	const struct qdevice_heuristics_exec_list_entry *exec_entry;
+
+	entry = TAILQ_FIRST(&history->entries);
+
+	while (entry != NULL) {
+		entry_next = TAILQ_NEXT(entry, entries);
+
+		exec_entry = NULL;
+		if (exec_list != NULL) {
+			exec_entry = qdevice_heuristics_exec_list_find_name(exec_list, entry->name);
+		}
+
+		if (exec_entry == NULL || strcmp(exec_entry->command, entry->command) != 0) {
+			qdevice_heuristics_history_del(history, entry);
+		}
+
+		entry = entry_next;
+	}
+}
+
+/*
+ * Return sample with given index (0 is the newest one) or NULL if there is no such
+ * sample
+ */
+const struct qdevice_heuristics_history_sample *
+qdevice_heuristics_history_entry_get_sample(const struct qdevice_heuristics_history_entry *entry,
+    size_t index)
+{
+
+	if (index >= entry->no_samples) {
+		return (NULL);
+	}
+
+	return (&entry->samples[(entry->next_sample + entry->max_samples - index - 1) %
+	    entry->max_samples]);
+}
+
+static int
+qdevice_heuristics_history_duration_cmp(const void *a, const void *b)
+{
+	uint32_t da, db;
+
+	da = *(const uint32_t *)a;
+	db = *(const uint32_t *)b;
+
+	return ((da > db) - (da < db));
+}
+
+/*
+ * Compute statistics of samples in the ring. Not finished samples were killed on timeout
+ * so only their number is reported and duration statistics are computed from finished
+ * samples. p99 is the nearest-rank percentile.
+ */
+int
+qdevice_heuristics_history_entry_get_stats(const struct qdevice_heuristics_history_entry *entry,
+    struct qdevice_heuristics_history_stats *stats)
+{
+	uint32_t *durations;
+	uint64_t sum;
+	size_t no_finished;
+	size_t zi;
+
+	memset(stats, 0, sizeof(*stats));
+
+	if (entry->no_samples == 0) {
+		return (0);
+	}
+
+	durations = malloc(sizeof(*durations) * entry->no_samples);
+	if (durations == NULL) {
+		return (-1);
+	}
+
+	sum = 0;
+	no_finished = 0;
+	for (zi = 0; zi < entry->no_samples; zi++) {
+		switch (entry->samples[zi].result) {
+		case QDEVICE_HEURISTICS_EXEC_ENTRY_RESULT_PASS:
+			stats->no_pass++;
+			break;
+		case QDEVICE_HEURISTICS_EXEC_ENTRY_RESULT_FAIL:
+			stats->no_fail++;
+			break;
+		case QDEVICE_HEURISTICS_EXEC_ENTRY_RESULT_NOT_FINISHED:
+			stats->no_not_finished++;
+			continue;
+		}
+
+		durations[no_finished] = entry->samples[zi].duration;
+		sum += durations[no_finished];
+		no_finished++;
+	}
+
+	stats->no_samples = entry->no_samples;
+
+	if (no_finished > 0) {
+		qsort(durations, no_finished, sizeof(*durations),
+		    qdevice_heuristics_history_duration_cmp);
+
+		stats->min_duration = durations[0];
+		stats->max_duration = durations[no_finished - 1];
+		stats->avg_duration = (uint32_t)(sum / no_finished);
+		stats->p99_duration = durations[(no_finished * 99 + 99) / 100 - 1];
+	}
+
+	free(durations);
+
+	return (0);
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _QDEVICE_HEURISTICS_HISTORY_H_
+#define _QDEVICE_HEURISTICS_HISTORY_H_
+
+#include <sys/queue.h>
+#include <sys/types.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include "qdevice-heuristics-exec-list.h"
+#include "qdevice-heuristics-exec-result.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct qdevice_heuristics_history_sample {
+	time_t time;
+	enum qdevice_heuristics_exec_entry_result result;
+	int32_t exit_status;
+	int32_t term_signal;
+	uint32_t duration;
+};
+
+/*
+ * Ring of last max_samples samples of one heuristics
+ */
+struct qdevice_heuristics_history_entry {
+	char *name;
+	char *command;
+	struct qdevice_heuristics_history_sample *samples;
+	size_t max_samples;
+	size_t no_samples;
+	size_t next_sample;
+	uint64_t total_execs;
+	TAILQ_ENTRY(qdevice_heuristics_history_entry) entries;
+};
+
+struct qdevice_heuristics_history {
+	size_t max_samples;
+	TAILQ_HEAD(qdevice_heuristics_history_entry_head,
+	    qdevice_heuristics_history_entry) entries;
+};
+
+struct qdevice_heuristics_history_stats {
+	size_t no_samples;
+	size_t no_pass;
+	size_t no_fail;
+	size_t no_not_finished;
+	uint32_t min_duration;
+	uint32_t avg_duration;
+	uint32_t p99_duration;
+	uint32_t max_duration;
+};
+
+extern void		qdevice_heuristics_history_init(
+    struct qdevice_heuristics_history *history, size_t max_samples);
+
+extern void		qdevice_heuristics_history_destroy(
+    struct qdevice_heuristics_history *history);
+
+extern int		qdevice_heuristics_history_add(
+    struct qdevice_heuristics_history *history, const char *name, const char *command,
+    const struct qdevice_heuristics_history_sample *sample);
+
+extern void		qdevice_heuristics_history_prune(
+    struct qdevice_heuristics_history *history,
+    const struct qdevice_heuristics_exec_list *exec_list);
+
+extern const struct qdevice_heuristics_history_sample *qdevice_heuristics_history_entry_get_sample(
+    const struct qdevice_heuristics_history_entry *entry, size_t index);
+
+extern int		qdevice_heuristics_history_entry_get_stats(
+    const struct qdevice_heuristics_history_entry *entry,
+    struct qdevice_heuristics_history_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _QDEVICE_HEURISTICS_HISTORY_H_ */
@@ -45,6 +45,7 @@ qdevice_heuristics_instance_init(struct qdevice_heuristics_instance *instance)
 
 	qdevice_heuristics_exec_list_init(&instance->exec_list);
 	qdevice_heuristics_result_notifier_list_init(&instance->exec_result_notifier_list);
+	qdevice_heuristics_history_init(&instance->history, 0);
 
 	return (0);
 }
@@ -55,6 +56,7 @@ qdevice_heuristics_instance_destroy(struct qdevice_heuristics_instance *instance
 
 	qdevice_heuristics_result_notifier_list_free(&instance->exec_result_notifier_list);
 	qdevice_heuristics_exec_list_free(&instance->exec_list);
+	qdevice_heuristics_history_destroy(&instance->history);
 
 	return (0);
 }
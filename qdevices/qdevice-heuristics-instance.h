@@ -40,6 +40,7 @@
 #include "qdevice-heuristics-mode.h"
 #include "qdevice-heuristics-exec-list.h"
 #include "qdevice-heuristics-exec-result.h"
+#include "qdevice-heuristics-history.h"
 #include "qdevice-heuristics-result-notifier.h"
 
 #ifdef __cplusplus
@@ -67,6 +68,19 @@ struct qdevice_heuristics_instance {
 	struct qdevice_heuristics_exec_list exec_list;
 
 	struct qdevice_heuristics_result_notifier_list exec_result_notifier_list;
+
+	struct qdevice_heuristics_history history;
+
+	/*
+	 * Last received result. Connect and membership heuristics reuse it if it is
+	 * not older than result_max_age ms (0 = never reuse)
+	 */
+	uint32_t result_max_age;
+	int cached_result_valid;
+	enum qdevice_heuristics_exec_result cached_result;
+	uint64_t cached_result_time;
+	int cached_result_reuse_pending;
+	uint64_t cached_result_reused;
 };
 
 extern int	qdevice_heuristics_instance_init(struct qdevice_heuristics_instance *instance);
@@ -40,6 +40,7 @@
 #include <unistd.h>
 
 #include "qdevice-heuristics-io.h"
+#include "qdevice-heuristics-msg.h"
 
 #define QDEVICE_HEURISTICS_IO_BUFFER_SIZE	256
 
@@ -67,7 +68,7 @@ qdevice_heuristics_io_blocking_write(int fd, const void *buf, size_t count)
 }
 
 /*
- *  1 Full line readed (at least one \n found)
+ *  1 At least one full message readed
  *  0 Partial read (no error)
  * -1 End of connection
  * -2 Buffer too long
@@ -79,7 +80,6 @@ qdevice_heuristics_io_read(int fd, struct dynar *dest)
 	char buf[QDEVICE_HEURISTICS_IO_BUFFER_SIZE];
 	ssize_t readed;
 	int res;
-	size_t zi;
 
 	res = 0;
 	readed = read(fd, buf, sizeof(buf));
@@ -89,10 +89,8 @@ qdevice_heuristics_io_read(int fd, struct dynar *dest)
 			goto exit_err;
 		}
 
-		for (zi = 0; zi < (size_t)readed; zi++) {
-			if (buf[zi] == '\n') {
-				res = 1;
-			}
+		if (qdevice_heuristics_msg_get_complete_len(dest) > 0) {
+			res = 1;
 		}
 	}
 
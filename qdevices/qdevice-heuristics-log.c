@@ -37,86 +37,51 @@
 #include "log.h"
 #include "qdevice-heuristics-io.h"
 #include "qdevice-heuristics-log.h"
+#include "qdevice-heuristics-msg.h"
 
 /*
- * 1 - Line logged
- * 0 - No line to log - everything processed
+ * 1 - Message logged
+ * 0 - No message to log - everything processed
  * -1 - Error
  */
 static int
-qdevice_heuristics_log_process_one_line(struct dynar *data)
+qdevice_heuristics_log_process_one_msg(struct dynar *data)
 {
-	char *str;
-	char *log_str_start;
-	size_t str_len;
-	size_t nl_pos;
-	size_t zi;
-	int status;
-	unsigned int log_priority;
-
-	str = dynar_data(data);
-	str_len = dynar_size(data);
-	log_str_start = str;
-
-	status = 0;
-	log_priority = 0;
-	/*
-	 * Find start of log message and end of line
-	 */
-	for (zi = 0; zi < str_len && status != -1; zi++) {
-		switch (status) {
-		case 0:
-			if (str[zi] >= '0' && str[zi] <= '9') {
-				log_priority = log_priority * 10 + (str[zi] - '0');
-			} else if (str[zi] == ' ') {
-				status = 1;
-			} else {
-				log(LOG_ERR, "Parsing of heuristics log line failed. "
-				    "Unexpected char '%c'", str[zi]);
-				return (-1);
-			}
-			break;
-		case 1:
-			if (str[zi] != ' ') {
-				status = 2;
-				log_str_start = str + zi;
-			}
-			break;
-		case 2:
-			if (str[zi] == '\n' || str[zi] == '\r') {
-				str[zi] = '\0';
-				nl_pos = zi;
-				status = -1;
-			}
-			break;
-		}
-	}
+	struct qdevice_heuristics_msg_decoded decoded_msg;
+	size_t msg_len;
+	int res;
 
-	if (status != -1) {
+	msg_len = qdevice_heuristics_msg_get_complete_len(data);
+	if (msg_len == 0) {
 		return (0);
 	}
 
-	/*
-	 * Do actual logging
-	 */
-	log(log_priority, "worker: %s", log_str_start);
+	qdevice_heuristics_msg_decoded_init(&decoded_msg);
+
+	res = 1;
+
+	if (qdevice_heuristics_msg_decode(dynar_data(data), msg_len, &decoded_msg) != 0 ||
+	    decoded_msg.type != QDEVICE_HEURISTICS_MSG_TYPE_LOG ||
+	    !decoded_msg.log_priority_set || decoded_msg.log_message == NULL) {
+		log(LOG_ERR, "Parsing of heuristics log message failed");
+
+		res = -1;
+		goto exit_destroy;
+	}
 
 	/*
-	 * Find place where is begining of new "valid" line
+	 * Do actual logging
 	 */
-	for (zi = nl_pos + 1; zi < str_len && (str[zi] == '\0' || str[zi] == '\n' || str[zi] == '\r'); zi++) ;
+	log(decoded_msg.log_priority, "worker: %s", decoded_msg.log_message);
 
-	memmove(str, str + zi, str_len - zi);
-	if (dynar_set_size(data, str_len - zi) == -1) {
-		log(LOG_ERR, "qdevice_heuristics_log_process_one_line: Can't set dynar size");
-		return (-1);
-	}
+	qdevice_heuristics_msg_remove_from_buffer(data, msg_len);
 
-	return (1);
+exit_destroy:
+	qdevice_heuristics_msg_decoded_destroy(&decoded_msg);
 
+	return (res);
 }
 
-
 /*
  * 0 - No error
  * -1 - Error
@@ -126,7 +91,7 @@ qdevice_heuristics_log_process(struct qdevice_heuristics_instance *instance)
 {
 	int res;
 
-	while ((res = qdevice_heuristics_log_process_one_line(&instance->log_in_buffer)) == 1) ;
+	while ((res = qdevice_heuristics_log_process_one_msg(&instance->log_in_buffer)) == 1) ;
 
 	return (res);
 }
@@ -156,8 +121,8 @@ qdevice_heuristics_log_read_from_pipe(struct qdevice_heuristics_instance *instan
 		ret = -1;
 		break;
 	case -2:
-		log(LOG_ERR, "Heuristics worker sent too long log. Ignoring line");
-		dynar_clean(&instance->log_in_buffer);
+		log(LOG_ERR, "Heuristics worker sent too long log");
+		ret = -1;
 		break;
 	case -3:
 		log(LOG_ERR, "Unhandled error when reading from heuristics worker log fd");
@@ -165,7 +130,7 @@ qdevice_heuristics_log_read_from_pipe(struct qdevice_heuristics_instance *instan
 		break;
 	case 1:
 		/*
-		 * At least one log line received
+		 * At least one log message received
 		 */
 		ret = qdevice_heuristics_log_process(instance);
 		break;
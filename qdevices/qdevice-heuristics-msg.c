@@ -0,0 +1,496 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sys/types.h>
+#include <arpa/inet.h>
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tlv.h"
+#include "qdevice-heuristics-msg.h"
+
+#define QDEVICE_HEURISTICS_MSG_TYPE_LENGTH	2
+#define QDEVICE_HEURISTICS_MSG_LENGTH_LENGTH	4
+#define QDEVICE_HEURISTICS_MSG_HEADER_LENGTH	\
+    (QDEVICE_HEURISTICS_MSG_TYPE_LENGTH + QDEVICE_HEURISTICS_MSG_LENGTH_LENGTH)
+
+static int
+qdevice_heuristics_msg_add_header(struct dynar *msg, enum qdevice_heuristics_msg_type type)
+{
+	uint16_t ntype;
+	uint32_t len;
+
+	ntype = htons((uint16_t)type);
+	len = 0;
+
+	dynar_clean(msg);
+
+	if (dynar_cat(msg, &ntype, sizeof(ntype)) == -1 ||
+	    dynar_cat(msg, &len, sizeof(len)) == -1) {
+		return (-1);
+	}
+
+	return (0);
+}
+
+static size_t
+qdevice_heuristics_msg_finish(struct dynar *msg)
+{
+	uint32_t nlen;
+
+	nlen = htonl(dynar_size(msg) - QDEVICE_HEURISTICS_MSG_HEADER_LENGTH);
+	memcpy(dynar_data(msg) + QDEVICE_HEURISTICS_MSG_TYPE_LENGTH, &nlen, sizeof(nlen));
+
+	return (dynar_size(msg));
+}
+
+/*
+ * tlv.c functions take enum tlv_opt_type, heuristics options are private
+ */
+static int
+qdevice_heuristics_msg_add_u32(struct dynar *msg, enum qdevice_heuristics_msg_opt_type opt_type,
+    uint32_t u32)
+{
+
+	return (tlv_add_u32(msg, (enum tlv_opt_type)opt_type, u32));
+}
+
+static int
+qdevice_heuristics_msg_add_u8(struct dynar *msg, enum qdevice_heuristics_msg_opt_type opt_type,
+    uint8_t u8)
+{
+
+	return (tlv_add_u8(msg, (enum tlv_opt_type)opt_type, u8));
+}
+
+static int
+qdevice_heuristics_msg_add_string(struct dynar *msg,
+    enum qdevice_heuristics_msg_opt_type opt_type, const char *str)
+{
+
+	return (tlv_add_string(msg, (enum tlv_opt_type)opt_type, str));
+}
+
+static int
+qdevice_heuristics_msg_add_entry_info(struct dynar *msg,
+    const struct qdevice_heuristics_exec_list_entry *entry)
+{
+	struct dynar opt_value;
+	int res;
+
+	dynar_init(&opt_value, dynar_max_size(msg));
+
+	if ((res = qdevice_heuristics_msg_add_string(&opt_value,
+	    QDEVICE_HEURISTICS_MSG_OPT_EXEC_NAME, entry->name)) != 0 ||
+	    (res = qdevice_heuristics_msg_add_u8(&opt_value,
+	    QDEVICE_HEURISTICS_MSG_OPT_EXEC_ENTRY_RESULT, (uint8_t)entry->last_result)) != 0 ||
+	    (res = qdevice_heuristics_msg_add_u32(&opt_value,
+	    QDEVICE_HEURISTICS_MSG_OPT_EXIT_STATUS, (uint32_t)entry->last_exit_status)) != 0 ||
+	    (res = qdevice_heuristics_msg_add_u32(&opt_value,
+	    QDEVICE_HEURISTICS_MSG_OPT_TERM_SIGNAL, (uint32_t)entry->last_term_signal)) != 0 ||
+	    (res = qdevice_heuristics_msg_add_u32(&opt_value,
+	    QDEVICE_HEURISTICS_MSG_OPT_DURATION, entry->last_duration)) != 0) {
+		goto exit_dynar_destroy;
+	}
+
+	res = tlv_add(msg, (enum tlv_opt_type)QDEVICE_HEURISTICS_MSG_OPT_EXEC_ENTRY_INFO,
+	    dynar_size(&opt_value), dynar_data(&opt_value));
+
+exit_dynar_destroy:
+	dynar_destroy(&opt_value);
+
+	return (res);
+}
+
+size_t
+qdevice_heuristics_msg_create_exec_list_clear(struct dynar *msg)
+{
+
+	if (qdevice_heuristics_msg_add_header(msg,
+	    QDEVICE_HEURISTICS_MSG_TYPE_EXEC_LIST_CLEAR) == -1) {
+		return (0);
+	}
+
+	return (qdevice_heuristics_msg_finish(msg));
+}
+
+size_t
+qdevice_heuristics_msg_create_exec_list_add(struct dynar *msg, const char *exec_name,
+    const char *exec_command, enum qdevice_heuristics_exec_type exec_type)
+{
+
+	if (qdevice_heuristics_msg_add_header(msg,
+	    QDEVICE_HEURISTICS_MSG_TYPE_EXEC_LIST_ADD) == -1 ||
+	    qdevice_heuristics_msg_add_string(msg,
+	    QDEVICE_HEURISTICS_MSG_OPT_EXEC_NAME, exec_name) == -1 ||
+	    qdevice_heuristics_msg_add_string(msg,
+	    QDEVICE_HEURISTICS_MSG_OPT_EXEC_COMMAND, exec_command) == -1 ||
+	    qdevice_heuristics_msg_add_u8(msg,
+	    QDEVICE_HEURISTICS_MSG_OPT_EXEC_TYPE, (uint8_t)exec_type) == -1) {
+		return (0);
+	}
+
+	return (qdevice_heuristics_msg_finish(msg));
+}
+
+size_t
+qdevice_heuristics_msg_create_exec(struct dynar *msg, uint32_t timeout, uint32_t seq_number)
+{
+
+	if (qdevice_heuristics_msg_add_header(msg, QDEVICE_HEURISTICS_MSG_TYPE_EXEC) == -1 ||
+	    qdevice_heuristics_msg_add_u32(msg,
+	    QDEVICE_HEURISTICS_MSG_OPT_SEQ_NUMBER, seq_number) == -1 ||
+	    qdevice_heuristics_msg_add_u32(msg,
+	    QDEVICE_HEURISTICS_MSG_OPT_TIMEOUT, timeout) == -1) {
+		return (0);
+	}
+
+	return (qdevice_heuristics_msg_finish(msg));
+}
+
+/*
+ * Result of every entry of exec_list (if not NULL) is added to the message
+ */
+size_t
+qdevice_heuristics_msg_create_exec_result(struct dynar *msg, uint32_t seq_number,
+    enum qdevice_heuristics_exec_result exec_result,
+    const struct qdevice_heuristics_exec_list *exec_list)
+{
+	const struct qdevice_heuristics_exec_list_entry *entry;
+
+	if (qdevice_heuristics_msg_add_header(msg,
+	    QDEVICE_HEURISTICS_MSG_TYPE_EXEC_RESULT) == -1 ||
+	    qdevice_heuristics_msg_add_u32(msg,
+	    QDEVICE_HEURISTICS_MSG_OPT_SEQ_NUMBER, seq_number) == -1 ||
+	    qdevice_heuristics_msg_add_u8(msg,
+	    QDEVICE_HEURISTICS_MSG_OPT_EXEC_RESULT, (uint8_t)exec_result) == -1) {
+		return (0);
+	}
+
+	if (exec_list != NULL) {
+		TAILQ_FOREACH(entry, exec_list, entries) {
+			if (qdevice_heuristics_msg_add_entry_info(msg, entry) != 0) {
+				return (0);
+			}
+		}
+	}
+
+	return (qdevice_heuristics_msg_finish(msg));
+}
+
+size_t
+qdevice_heuristics_msg_create_log(struct dynar *msg, uint8_t log_priority,
+    const char *log_message)
+{
+
+	if (qdevice_heuristics_msg_add_header(msg, QDEVICE_HEURISTICS_MSG_TYPE_LOG) == -1 ||
+	    qdevice_heuristics_msg_add_u8(msg,
+	    QDEVICE_HEURISTICS_MSG_OPT_LOG_PRIORITY, log_priority) == -1 ||
+	    qdevice_heuristics_msg_add_string(msg,
+	    QDEVICE_HEURISTICS_MSG_OPT_LOG_MESSAGE, log_message) == -1) {
+		return (0);
+	}
+
+	return (qdevice_heuristics_msg_finish(msg));
+}
+
+/*
+ * Returns length (including header) of first message in the buffer if it was
+ * fully received, otherwise 0
+ */
+size_t
+qdevice_heuristics_msg_get_complete_len(const struct dynar *buffer)
+{
+	uint32_t nlen;
+	size_t len;
+
+	if (dynar_size(buffer) < QDEVICE_HEURISTICS_MSG_HEADER_LENGTH) {
+		return (0);
+	}
+
+	memcpy(&nlen, dynar_data(buffer) + QDEVICE_HEURISTICS_MSG_TYPE_LENGTH, sizeof(nlen));
+	len = QDEVICE_HEURISTICS_MSG_HEADER_LENGTH + (size_t)ntohl(nlen);
+
+	if (dynar_size(buffer) < len) {
+		return (0);
+	}
+
+	return (len);
+}
+
+void
+qdevice_heuristics_msg_remove_from_buffer(struct dynar *buffer, size_t len)
+{
+	char *data;
+
+	data = dynar_data(buffer);
+
+	memmove(data, data + len, dynar_size(buffer) - len);
+	(void)dynar_set_size(buffer, dynar_size(buffer) - len);
+}
+
+void
+qdevice_heuristics_msg_decoded_init(struct qdevice_heuristics_msg_decoded *decoded_msg)
+{
+
+	memset(decoded_msg, 0, sizeof(*decoded_msg));
+}
+
+void
+qdevice_heuristics_msg_decoded_destroy(struct qdevice_heuristics_msg_decoded *decoded_msg)
+{
+	size_t zi;
+
+	free(decoded_msg->exec_name);
+	free(decoded_msg->exec_command);
+	free(decoded_msg->log_message);
+
+	for (zi = 0; zi < decoded_msg->no_entry_infos; zi++) {
+		free(decoded_msg->entry_infos[zi].name);
+	}
+	free(decoded_msg->entry_infos);
+
+	qdevice_heuristics_msg_decoded_init(decoded_msg);
+}
+
+static int
+qdevice_heuristics_msg_decode_entry_info(struct tlv_iterator *tlv_iter,
+    struct qdevice_heuristics_msg_decoded *decoded_msg)
+{
+	struct tlv_iterator data_tlv_iter;
+	struct qdevice_heuristics_msg_entry_info entry_info;
+	struct qdevice_heuristics_msg_entry_info *new_entry_infos;
+	size_t str_len;
+	uint32_t u32;
+	uint8_t u8;
+	int iter_res;
+
+	memset(&entry_info, 0, sizeof(entry_info));
+	entry_info.exit_status = -1;
+
+	tlv_iter_init_str(tlv_iter_get_data(tlv_iter), tlv_iter_get_len(tlv_iter), 0,
+	    &data_tlv_iter);
+
+	while ((iter_res = tlv_iter_next(&data_tlv_iter)) > 0) {
+		switch ((enum qdevice_heuristics_msg_opt_type)tlv_iter_get_type(&data_tlv_iter)) {
+		case QDEVICE_HEURISTICS_MSG_OPT_EXEC_NAME:
+			free(entry_info.name);
+			entry_info.name = NULL;
+
+			if (tlv_iter_decode_str(&data_tlv_iter, &entry_info.name, &str_len) != 0) {
+				return (-2);
+			}
+			break;
+		case QDEVICE_HEURISTICS_MSG_OPT_EXEC_ENTRY_RESULT:
+			if (tlv_iter_decode_u8(&data_tlv_iter, &u8) != 0) {
+				goto err_free;
+			}
+
+			entry_info.result = (enum qdevice_heuristics_exec_entry_result)u8;
+			break;
+		case QDEVICE_HEURISTICS_MSG_OPT_EXIT_STATUS:
+			if (tlv_iter_decode_u32(&data_tlv_iter, &u32) != 0) {
+				goto err_free;
+			}
+
+			entry_info.exit_status = (int32_t)u32;
+			break;
+		case QDEVICE_HEURISTICS_MSG_OPT_TERM_SIGNAL:
+			if (tlv_iter_decode_u32(&data_tlv_iter, &u32) != 0) {
+				goto err_free;
+			}
+
+			entry_info.term_signal = (int32_t)u32;
+			break;
+		case QDEVICE_HEURISTICS_MSG_OPT_DURATION:
+			if (tlv_iter_decode_u32(&data_tlv_iter, &entry_info.duration) != 0) {
+				goto err_free;
+			}
+			break;
+		default:
+			/*
+			 * Other options are not processed
+			 */
+			break;
+		}
+	}
+
+	if (iter_res != 0 || entry_info.name == NULL) {
+		goto err_free;
+	}
+
+	new_entry_infos = realloc(decoded_msg->entry_infos,
+	    sizeof(*new_entry_infos) * (decoded_msg->no_entry_infos + 1));
+	if (new_entry_infos == NULL) {
+		free(entry_info.name);
+
+		return (-2);
+	}
+
+	decoded_msg->entry_infos = new_entry_infos;
+	memcpy(&decoded_msg->entry_infos[decoded_msg->no_entry_infos], &entry_info,
+	    sizeof(entry_info));
+	decoded_msg->no_entry_infos++;
+
+	return (0);
+
+err_free:
+	free(entry_info.name);
+
+	return (-1);
+}
+
+/*
+ *  0 - No error
+ * -1 - Invalid message or option
+ * -2 - Memory allocation failed
+ */
+int
+qdevice_heuristics_msg_decode(const char *msg, size_t msg_len,
+    struct qdevice_heuristics_msg_decoded *decoded_msg)
+{
+	struct tlv_iterator tlv_iter;
+	uint16_t ntype;
+	uint16_t type;
+	size_t str_len;
+	uint8_t u8;
+	int iter_res;
+	int res;
+
+	qdevice_heuristics_msg_decoded_destroy(decoded_msg);
+
+	if (msg_len < QDEVICE_HEURISTICS_MSG_HEADER_LENGTH) {
+		return (-1);
+	}
+
+	memcpy(&ntype, msg, sizeof(ntype));
+	type = ntohs(ntype);
+	decoded_msg->type = (enum qdevice_heuristics_msg_type)type;
+
+	if (msg_len == QDEVICE_HEURISTICS_MSG_HEADER_LENGTH) {
+		/*
+		 * Message without options
+		 */
+		return (0);
+	}
+
+	tlv_iter_init_str(msg, msg_len, QDEVICE_HEURISTICS_MSG_HEADER_LENGTH, &tlv_iter);
+
+	while ((iter_res = tlv_iter_next(&tlv_iter)) > 0) {
+		switch ((enum qdevice_heuristics_msg_opt_type)tlv_iter_get_type(&tlv_iter)) {
+		case QDEVICE_HEURISTICS_MSG_OPT_SEQ_NUMBER:
+			if (tlv_iter_decode_u32(&tlv_iter, &decoded_msg->seq_number) != 0) {
+				return (-1);
+			}
+
+			decoded_msg->seq_number_set = 1;
+			break;
+		case QDEVICE_HEURISTICS_MSG_OPT_TIMEOUT:
+			if (tlv_iter_decode_u32(&tlv_iter, &decoded_msg->timeout) != 0) {
+				return (-1);
+			}
+
+			decoded_msg->timeout_set = 1;
+			break;
+		case QDEVICE_HEURISTICS_MSG_OPT_EXEC_NAME:
+			free(decoded_msg->exec_name);
+			decoded_msg->exec_name = NULL;
+
+			if (tlv_iter_decode_str(&tlv_iter, &decoded_msg->exec_name, &str_len) != 0) {
+				return (-2);
+			}
+			break;
+		case QDEVICE_HEURISTICS_MSG_OPT_EXEC_COMMAND:
+			free(decoded_msg->exec_command);
+			decoded_msg->exec_command = NULL;
+
+			if (tlv_iter_decode_str(&tlv_iter, &decoded_msg->exec_command,
+			    &str_len) != 0) {
+				return (-2);
+			}
+			break;
+		case QDEVICE_HEURISTICS_MSG_OPT_EXEC_TYPE:
+			if (tlv_iter_decode_u8(&tlv_iter, &u8) != 0) {
+				return (-1);
+			}
+
+			decoded_msg->exec_type = (enum qdevice_heuristics_exec_type)u8;
+			decoded_msg->exec_type_set = 1;
+			break;
+		case QDEVICE_HEURISTICS_MSG_OPT_EXEC_RESULT:
+			if (tlv_iter_decode_u8(&tlv_iter, &u8) != 0) {
+				return (-1);
+			}
+
+			decoded_msg->exec_result = (enum qdevice_heuristics_exec_result)u8;
+			decoded_msg->exec_result_set = 1;
+			break;
+		case QDEVICE_HEURISTICS_MSG_OPT_EXEC_ENTRY_INFO:
+			if ((res = qdevice_heuristics_msg_decode_entry_info(&tlv_iter,
+			    decoded_msg)) != 0) {
+				return (res);
+			}
+			break;
+		case QDEVICE_HEURISTICS_MSG_OPT_LOG_PRIORITY:
+			if (tlv_iter_decode_u8(&tlv_iter, &decoded_msg->log_priority) != 0) {
+				return (-1);
+			}
+
+			decoded_msg->log_priority_set = 1;
+			break;
+		case QDEVICE_HEURISTICS_MSG_OPT_LOG_MESSAGE:
+			free(decoded_msg->log_message);
+			decoded_msg->log_message = NULL;
+
+			if (tlv_iter_decode_str(&tlv_iter, &decoded_msg->log_message,
+			    &str_len) != 0) {
+				return (-2);
+			}
+			break;
+		default:
+			/*
+			 * Unknown options are ignored
+			 */
+			break;
+		}
+	}
+
+	if (iter_res != 0) {
+		return (-1);
+	}
+
+	return (0);
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _QDEVICE_HEURISTICS_MSG_H_
+#define _QDEVICE_HEURISTICS_MSG_H_
+
+#include <sys/types.h>
+#include <inttypes.h>
+
+#include "dynar.h"
+#include "qdevice-heuristics-exec-list.h"
+#include "qdevice-heuristics-exec-result.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Messages exchanged between qdevice and heuristics worker. Framing is the same
+ * as for msg.c (16-bit type, 32-bit length, TLV options encoded by tlv.c), only
+ * message and option types are private to the heuristics pipes.
+ */
+enum qdevice_heuristics_msg_type {
+	QDEVICE_HEURISTICS_MSG_TYPE_EXEC_LIST_CLEAR = 0,
+	QDEVICE_HEURISTICS_MSG_TYPE_EXEC_LIST_ADD = 1,
+	QDEVICE_HEURISTICS_MSG_TYPE_EXEC = 2,
+	QDEVICE_HEURISTICS_MSG_TYPE_EXEC_RESULT = 3,
+	QDEVICE_HEURISTICS_MSG_TYPE_LOG = 4,
+};
+
+enum qdevice_heuristics_msg_opt_type {
+	QDEVICE_HEURISTICS_MSG_OPT_SEQ_NUMBER = 0,
+	QDEVICE_HEURISTICS_MSG_OPT_TIMEOUT = 1,
+	QDEVICE_HEURISTICS_MSG_OPT_EXEC_NAME = 2,
+	QDEVICE_HEURISTICS_MSG_OPT_EXEC_COMMAND = 3,
+	QDEVICE_HEURISTICS_MSG_OPT_EXEC_TYPE = 4,
+	QDEVICE_HEURISTICS_MSG_OPT_EXEC_RESULT = 5,
+	/*
+	 * Result of one exec list entry. Value is encoded as nested options
+	 * (EXEC_NAME, EXEC_ENTRY_RESULT, EXIT_STATUS, TERM_SIGNAL and DURATION)
+	 */
+	QDEVICE_HEURISTICS_MSG_OPT_EXEC_ENTRY_INFO = 6,
+	QDEVICE_HEURISTICS_MSG_OPT_EXEC_ENTRY_RESULT = 7,
+	QDEVICE_HEURISTICS_MSG_OPT_EXIT_STATUS = 8,
+	QDEVICE_HEURISTICS_MSG_OPT_DURATION = 9,
+	QDEVICE_HEURISTICS_MSG_OPT_LOG_PRIORITY = 10,
+	QDEVICE_HEURISTICS_MSG_OPT_LOG_MESSAGE = 11,
+	QDEVICE_HEURISTICS_MSG_OPT_TERM_SIGNAL = 12,
+};
+
+struct qdevice_heuristics_msg_entry_info {
+	char *name;
+	enum qdevice_heuristics_exec_entry_result result;
+	int32_t exit_status;
+	int32_t term_signal;
+	uint32_t duration;
+};
+
+struct qdevice_heuristics_msg_decoded {
+	enum qdevice_heuristics_msg_type type;
+	uint8_t seq_number_set;
+	uint32_t seq_number;		/* Valid only if seq_number_set != 0 */
+	uint8_t timeout_set;
+	uint32_t timeout;		/* Valid only if timeout_set != 0 */
+	char *exec_name;		/* Valid only if != NULL */
+	char *exec_command;		/* Valid only if != NULL */
+	uint8_t exec_type_set;
+	enum qdevice_heuristics_exec_type exec_type;	/* Valid only if exec_type_set != 0 */
+	uint8_t exec_result_set;
+	/* Valid only if exec_result_set != 0 */
+	enum qdevice_heuristics_exec_result exec_result;
+	size_t no_entry_infos;
+	struct qdevice_heuristics_msg_entry_info *entry_infos;	/* Valid only if != NULL */
+	uint8_t log_priority_set;
+	uint8_t log_priority;		/* Valid only if log_priority_set != 0 */
+	char *log_message;		/* Valid only if != NULL */
+};
+
+extern size_t		qdevice_heuristics_msg_create_exec_list_clear(struct dynar *msg);
+
+extern size_t		qdevice_heuristics_msg_create_exec_list_add(struct dynar *msg,
+    const char *exec_name, const char *exec_command,
+    enum qdevice_heuristics_exec_type exec_type);
+
+extern size_t		qdevice_heuristics_msg_create_exec(struct dynar *msg,
+    uint32_t timeout, uint32_t seq_number);
+
+extern size_t		qdevice_heuristics_msg_create_exec_result(struct dynar *msg,
+    uint32_t seq_number, enum qdevice_heuristics_exec_result exec_result,
+    const struct qdevice_heuristics_exec_list *exec_list);
+
+extern size_t		qdevice_heuristics_msg_create_log(struct dynar *msg,
+    uint8_t log_priority, const char *log_message);
+
+extern size_t		qdevice_heuristics_msg_get_complete_len(const struct dynar *buffer);
+
+extern void		qdevice_heuristics_msg_remove_from_buffer(struct dynar *buffer,
+    size_t len);
+
+extern void		qdevice_heuristics_msg_decoded_init(
+    struct qdevice_heuristics_msg_decoded *decoded_msg);
+
+extern void		qdevice_heuristics_msg_decoded_destroy(
+    struct qdevice_heuristics_msg_decoded *decoded_msg);
+
+extern int		qdevice_heuristics_msg_decode(const char *msg, size_t msg_len,
+    struct qdevice_heuristics_msg_decoded *decoded_msg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _QDEVICE_HEURISTICS_MSG_H_ */
@@ -0,0 +1,974 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+#include <netinet/in.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "qdevice-heuristics-worker-check.h"
+#include "qdevice-heuristics-worker-instance.h"
+#include "qdevice-heuristics-worker-log.h"
+
+#define QDEVICE_HEURISTICS_WORKER_CHECK_ICMP_ECHO_REQUEST		8
+#define QDEVICE_HEURISTICS_WORKER_CHECK_ICMP_ECHO_REPLY			0
+#define QDEVICE_HEURISTICS_WORKER_CHECK_ICMPV6_ECHO_REQUEST		128
+#define QDEVICE_HEURISTICS_WORKER_CHECK_ICMPV6_ECHO_REPLY		129
+
+#define QDEVICE_HEURISTICS_WORKER_CHECK_ICMP_PACKET_SIZE		16
+#define QDEVICE_HEURISTICS_WORKER_CHECK_READ_SIZE			4096
+
+/*
+ * Resolved address is cached for this number of seconds
+ */
+#define QDEVICE_HEURISTICS_WORKER_CHECK_ADDR_TTL			60
+
+struct qdevice_heuristics_worker_check_thread_data {
+	char *path;
+	int do_read;
+	int fd;
+};
+
+struct qdevice_heuristics_worker_check_resolve_thread_data {
+	char *host;
+	char *service;
+	int socktype;
+	int fd;
+};
+
+/*
+ * Result of resolving sent by helper thread. Size is smaller than PIPE_BUF so
+ * write is atomic.
+ */
+struct qdevice_heuristics_worker_check_resolve_result {
+	int gai_res;
+	socklen_t addr_len;
+	struct sockaddr_storage addr;
+};
+
+void
+qdevice_heuristics_worker_check_list_init(struct qdevice_heuristics_worker_check_list *list)
+{
+
+	TAILQ_INIT(list);
+}
+
+static void
+qdevice_heuristics_worker_check_close(struct qdevice_heuristics_worker_check *check)
+{
+
+	if (check->fd != -1) {
+		close(check->fd);
+		check->fd = -1;
+	}
+}
+
+static void
+qdevice_heuristics_worker_check_set_result(struct qdevice_heuristics_worker_instance *instance,
+    struct qdevice_heuristics_worker_check *check, int passed)
+{
+
+	qdevice_heuristics_worker_check_close(check);
+
+	if (check->check_state != QDEVICE_HEURISTICS_WORKER_CHECK_STATE_PENDING) {
+		return ;
+	}
+
+	if (passed) {
+		check->check_state = QDEVICE_HEURISTICS_WORKER_CHECK_STATE_PASS;
+	} else {
+		qdevice_heuristics_worker_log_printf(instance, LOG_WARNING,
+		    "Builtin check %s failed", check->name);
+
+		check->check_state = QDEVICE_HEURISTICS_WORKER_CHECK_STATE_FAIL;
+	}
+}
+
+void
+qdevice_heuristics_worker_check_list_free(struct qdevice_heuristics_worker_instance *instance)
+{
+	struct qdevice_heuristics_worker_check *check;
+	struct qdevice_heuristics_worker_check *check_next;
+
+	check = TAILQ_FIRST(&instance->check_list);
+
+	while (check != NULL) {
+		check_next = TAILQ_NEXT(check, entries);
+
+		/*
+		 * Helper thread which is still running gets EPIPE and exits
+		 */
+		qdevice_heuristics_worker_check_close(check);
+		free(check->name);
+		free(check);
+
+		check = check_next;
+	}
+
+	TAILQ_INIT(&instance->check_list);
+}
+
+static int
+qdevice_heuristics_worker_check_parse_type(const struct qdevice_heuristics_exec_list_entry *entry,
+    enum qdevice_heuristics_worker_check_type *type)
+{
+	const char *str;
+
+	if (entry->exec_argv == NULL || entry->exec_argc < 1) {
+		return (-1);
+	}
+
+	str = entry->exec_argv[0];
+
+	if (strcmp(str, "tcp") == 0 && entry->exec_argc == 3) {
+		*type = QDEVICE_HEURISTICS_WORKER_CHECK_TYPE_TCP;
+	} else if (strcmp(str, "ping") == 0 && entry->exec_argc == 2) {
+		*type = QDEVICE_HEURISTICS_WORKER_CHECK_TYPE_PING;
+	} else if (strcmp(str, "stat") == 0 && entry->exec_argc == 2) {
+		*type = QDEVICE_HEURISTICS_WORKER_CHECK_TYPE_STAT;
+	} else if (strcmp(str, "read") == 0 && entry->exec_argc == 2) {
+		*type = QDEVICE_HEURISTICS_WORKER_CHECK_TYPE_READ;
+	} else {
+		return (-1);
+	}
+
+	return (0);
+}
+
+static struct qdevice_heuristics_worker_check *
+qdevice_heuristics_worker_check_get(struct qdevice_heuristics_worker_instance *instance,
+    const char *name, enum qdevice_heuristics_worker_check_type type)
+{
+	struct qdevice_heuristics_worker_check *check;
+
+	TAILQ_FOREACH(check, &instance->check_list, entries) {
+		if (strcmp(check->name, name) == 0) {
+			return (check);
+		}
+	}
+
+	check = malloc(sizeof(*check));
+	if (check == NULL) {
+		return (NULL);
+	}
+
+	memset(check, 0, sizeof(*check));
+
+	check->name = strdup(name);
+	if (check->name == NULL) {
+		free(check);
+
+		return (NULL);
+	}
+
+	check->type = type;
+	check->fd = -1;
+	check->resolving = 0;
+	check->check_state = QDEVICE_HEURISTICS_WORKER_CHECK_STATE_IDLE;
+
+	TAILQ_INSERT_TAIL(&instance->check_list, check, entries);
+
+	return (check);
+}
+
+static int
+qdevice_heuristics_worker_check_socket(int family, int type, int protocol)
+{
+	int fd;
+	int flags;
+
+	fd = socket(family, type, protocol);
+	if (fd == -1) {
+		return (-1);
+	}
+
+	if ((flags = fcntl(fd, F_GETFL, 0)) == -1 ||
+	    fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1 ||
+	    fcntl(fd, F_SETFD, FD_CLOEXEC) == -1) {
+		close(fd);
+
+		return (-1);
+	}
+
+	return (fd);
+}
+
+/*
+ * -1 - Check failed
+ *  0 - Connect in progress
+ *  1 - Connected
+ */
+static int
+qdevice_heuristics_worker_check_tcp_start(struct qdevice_heuristics_worker_check *check)
+{
+
+	check->fd = qdevice_heuristics_worker_check_socket(check->addr.ss_family, SOCK_STREAM, 0);
+	if (check->fd == -1) {
+		return (-1);
+	}
+
+	if (connect(check->fd, (struct sockaddr *)&check->addr, check->addr_len) == 0) {
+		return (1);
+	}
+
+	if (errno == EINPROGRESS) {
+		return (0);
+	}
+
+	return (-1);
+}
+
+static void
+qdevice_heuristics_worker_check_tcp_process(struct qdevice_heuristics_worker_instance *instance,
+    struct qdevice_heuristics_worker_check *check)
+{
+	int sock_err;
+	socklen_t sock_err_len;
+
+	sock_err_len = sizeof(sock_err);
+
+	if (getsockopt(check->fd, SOL_SOCKET, SO_ERROR, &sock_err, &sock_err_len) != 0) {
+		sock_err = errno;
+	}
+
+	qdevice_heuristics_worker_check_set_result(instance, check, sock_err == 0);
+}
+
+static uint16_t
+qdevice_heuristics_worker_check_icmp_checksum(const unsigned char *buf, size_t len)
+{
+	uint32_t sum;
+	size_t zi;
+
+	sum = 0;
+
+	for (zi = 0; zi + 1 < len; zi += 2) {
+		sum += (buf[zi] << 8) | buf[zi + 1];
+	}
+
+	if (zi < len) {
+		sum += buf[zi] << 8;
+	}
+
+	while (sum >> 16) {
+		sum = (sum & 0xffff) + (sum >> 16);
+	}
+
+	return (~sum & 0xffff);
+}
+
+/*
+ * Send ICMP echo request using unprivileged datagram ICMP socket. Kernel
+ * fills identifier (and ICMPv6 checksum), so only sequence number is matched.
+ */
+static int
+qdevice_heuristics_worker_check_ping_start(struct qdevice_heuristics_worker_check *check)
+{
+	unsigned char packet[QDEVICE_HEURISTICS_WORKER_CHECK_ICMP_PACKET_SIZE];
+	uint16_t icmp_seq;
+	uint16_t checksum;
+	int is_ipv6;
+
+	is_ipv6 = (check->addr.ss_family == AF_INET6);
+
+	check->fd = qdevice_heuristics_worker_check_socket(check->addr.ss_family, SOCK_DGRAM,
+	    (is_ipv6 ? IPPROTO_ICMPV6 : IPPROTO_ICMP));
+	if (check->fd == -1) {
+		return (-1);
+	}
+
+	icmp_seq = (uint16_t)check->check_seq_number;
+
+	memset(packet, 0, sizeof(packet));
+	packet[0] = (is_ipv6 ? QDEVICE_HEURISTICS_WORKER_CHECK_ICMPV6_ECHO_REQUEST :
+	    QDEVICE_HEURISTICS_WORKER_CHECK_ICMP_ECHO_REQUEST);
+	packet[6] = icmp_seq >> 8;
+	packet[7] = icmp_seq & 0xff;
+	memcpy(&packet[8], &check->check_seq_number, sizeof(check->check_seq_number));
+
+	if (!is_ipv6) {
+		checksum = qdevice_heuristics_worker_check_icmp_checksum(packet, sizeof(packet));
+		packet[2] = checksum >> 8;
+		packet[3] = checksum & 0xff;
+	}
+
+	if (sendto(check->fd, packet, sizeof(packet), 0, (struct sockaddr *)&check->addr,
+	    check->addr_len) != sizeof(packet)) {
+		return (-1);
+	}
+
+	return (0);
+}
+
+static void
+qdevice_heuristics_worker_check_ping_process(struct qdevice_heuristics_worker_instance *instance,
+    struct qdevice_heuristics_worker_check *check)
+{
+	unsigned char packet[QDEVICE_HEURISTICS_WORKER_CHECK_ICMP_PACKET_SIZE * 4];
+	unsigned char reply_type;
+	uint16_t icmp_seq;
+	ssize_t received;
+
+	reply_type = (check->addr.ss_family == AF_INET6 ?
+	    QDEVICE_HEURISTICS_WORKER_CHECK_ICMPV6_ECHO_REPLY :
+	    QDEVICE_HEURISTICS_WORKER_CHECK_ICMP_ECHO_REPLY);
+
+	while ((received = recv(check->fd, packet, sizeof(packet), 0)) != 0) {
+		if (received < 0) {
+			if (errno == EINTR) {
+				continue ;
+			}
+
+			if (errno != EAGAIN && errno != EWOULDBLOCK) {
+				qdevice_heuristics_worker_check_set_result(instance, check, 0);
+			}
+
+			return ;
+		}
+
+		if (received < 8 || packet[0] != reply_type) {
+			continue ;
+		}
+
+		icmp_seq = (packet[6] << 8) | packet[7];
+
+		if (icmp_seq == (uint16_t)check->check_seq_number) {
+			qdevice_heuristics_worker_check_set_result(instance, check, 1);
+
+			return ;
+		}
+	}
+}
+
+static void *
+qdevice_heuristics_worker_check_file_thread(void *arg)
+{
+	struct qdevice_heuristics_worker_check_thread_data *data;
+	char buf[QDEVICE_HEURISTICS_WORKER_CHECK_READ_SIZE];
+	struct stat st;
+	char result;
+	int fd;
+
+	data = (struct qdevice_heuristics_worker_check_thread_data *)arg;
+
+	result = 0;
+
+	if (data->do_read) {
+		fd = open(data->path, O_RDONLY | O_CLOEXEC);
+		if (fd != -1) {
+			if (read(fd, buf, sizeof(buf)) >= 0) {
+				result = 1;
+			}
+
+			close(fd);
+		}
+	} else {
+		if (stat(data->path, &st) == 0) {
+			result = 1;
+		}
+	}
+
+	if (write(data->fd, &result, sizeof(result)) != sizeof(result)) {
+		/*
+		 * Check list was freed, result is not needed anymore
+		 */
+	}
+
+	close(data->fd);
+	free(data->path);
+	free(data);
+
+	return (NULL);
+}
+
+/*
+ * Create pipe used by helper thread to report result. Read end is non-blocking.
+ */
+static int
+qdevice_heuristics_worker_check_pipe_create(int pipe_fd[2])
+{
+	int flags;
+
+	if (pipe(pipe_fd) != 0) {
+		return (-1);
+	}
+
+	if ((flags = fcntl(pipe_fd[0], F_GETFL, 0)) == -1 ||
+	    fcntl(pipe_fd[0], F_SETFL, flags | O_NONBLOCK) == -1 ||
+	    fcntl(pipe_fd[0], F_SETFD, FD_CLOEXEC) == -1 ||
+	    fcntl(pipe_fd[1], F_SETFD, FD_CLOEXEC) == -1) {
+		close(pipe_fd[0]);
+		close(pipe_fd[1]);
+
+		return (-1);
+	}
+
+	return (0);
+}
+
+static int
+qdevice_heuristics_worker_check_thread_create(void *(*start_routine)(void *), void *arg)
+{
+	pthread_attr_t thread_attr;
+	pthread_t thread;
+	sigset_t all_signals;
+	sigset_t old_signals;
+	int res;
+
+	pthread_attr_init(&thread_attr);
+	pthread_attr_setdetachstate(&thread_attr, PTHREAD_CREATE_DETACHED);
+
+	/*
+	 * Signals are handled only by main thread
+	 */
+	sigfillset(&all_signals);
+	pthread_sigmask(SIG_BLOCK, &all_signals, &old_signals);
+	res = pthread_create(&thread, &thread_attr, start_routine, arg);
+	pthread_sigmask(SIG_SETMASK, &old_signals, NULL);
+
+	pthread_attr_destroy(&thread_attr);
+
+	if (res != 0) {
+		errno = res;
+
+		return (-1);
+	}
+
+	return (0);
+}
+
+/*
+ * Start detached helper thread doing stat/read of path. Thread owns write end
+ * of the pipe, read end is kept by check until thread reports result - even
+ * after timeout, so next check can find out previous thread is still blocked.
+ */
+static int
+qdevice_heuristics_worker_check_file_start(struct qdevice_heuristics_worker_check *check,
+    const char *path)
+{
+	struct qdevice_heuristics_worker_check_thread_data *data;
+	int pipe_fd[2];
+
+	data = malloc(sizeof(*data));
+	if (data == NULL) {
+		return (-1);
+	}
+
+	data->path = strdup(path);
+	data->do_read = (check->type == QDEVICE_HEURISTICS_WORKER_CHECK_TYPE_READ);
+	if (data->path == NULL) {
+		free(data);
+
+		return (-1);
+	}
+
+	if (qdevice_heuristics_worker_check_pipe_create(pipe_fd) != 0) {
+		free(data->path);
+		free(data);
+
+		return (-1);
+	}
+
+	data->fd = pipe_fd[1];
+
+	if (qdevice_heuristics_worker_check_thread_create(
+	    qdevice_heuristics_worker_check_file_thread, data) != 0) {
+		close(pipe_fd[0]);
+		close(pipe_fd[1]);
+		free(data->path);
+		free(data);
+
+		return (-1);
+	}
+
+	check->fd = pipe_fd[0];
+
+	return (0);
+}
+
+static void
+qdevice_heuristics_worker_check_file_process(struct qdevice_heuristics_worker_instance *instance,
+    struct qdevice_heuristics_worker_check *check)
+{
+	char result;
+	ssize_t readed;
+
+	do {
+		readed = read(check->fd, &result, sizeof(result));
+	} while (readed < 0 && errno == EINTR);
+
+	if (readed < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+		return ;
+	}
+
+	qdevice_heuristics_worker_check_set_result(instance, check, readed == 1 && result);
+}
+
+static void *
+qdevice_heuristics_worker_check_resolve_thread(void *arg)
+{
+	struct qdevice_heuristics_worker_check_resolve_thread_data *data;
+	struct qdevice_heuristics_worker_check_resolve_result result;
+	struct addrinfo hints;
+	struct addrinfo *ai;
+
+	data = (struct qdevice_heuristics_worker_check_resolve_thread_data *)arg;
+
+	memset(&result, 0, sizeof(result));
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = data->socktype;
+
+	result.gai_res = getaddrinfo(data->host, data->service, &hints, &ai);
+	if (result.gai_res == 0) {
+		memcpy(&result.addr, ai->ai_addr, ai->ai_addrlen);
+		result.addr_len = ai->ai_addrlen;
+
+		freeaddrinfo(ai);
+	}
+
+	if (write(data->fd, &result, sizeof(result)) != sizeof(result)) {
+		/*
+		 * Check list was freed, result is not needed anymore
+		 */
+	}
+
+	close(data->fd);
+	free(data->host);
+	free(data->service);
+	free(data);
+
+	return (NULL);
+}
+
+/*
+ * Start detached helper thread resolving address of TCP/ICMP check. Pipe is
+ * handled same way as for stat/read check, so DNS server which doesn't answer
+ * is bound by heuristics timeout.
+ */
+static int
+qdevice_heuristics_worker_check_resolve_start(struct qdevice_heuristics_worker_check *check,
+    const struct qdevice_heuristics_exec_list_entry *exec_list_entry)
+{
+	struct qdevice_heuristics_worker_check_resolve_thread_data *data;
+	int pipe_fd[2];
+
+	data = malloc(sizeof(*data));
+	if (data == NULL) {
+		return (-1);
+	}
+
+	memset(data, 0, sizeof(*data));
+
+	data->host = strdup(exec_list_entry->exec_argv[1]);
+	if (check->type == QDEVICE_HEURISTICS_WORKER_CHECK_TYPE_TCP) {
+		data->socktype = SOCK_STREAM;
+		data->service = strdup(exec_list_entry->exec_argv[2]);
+	} else {
+		data->socktype = SOCK_DGRAM;
+	}
+
+	if (data->host == NULL ||
+	    (check->type == QDEVICE_HEURISTICS_WORKER_CHECK_TYPE_TCP && data->service == NULL)) {
+		free(data->host);
+		free(data->service);
+		free(data);
+
+		return (-1);
+	}
+
+	if (qdevice_heuristics_worker_check_pipe_create(pipe_fd) != 0) {
+		free(data->host);
+		free(data->service);
+		free(data);
+
+		return (-1);
+	}
+
+	data->fd = pipe_fd[1];
+
+	if (qdevice_heuristics_worker_check_thread_create(
+	    qdevice_heuristics_worker_check_resolve_thread, data) != 0) {
+		close(pipe_fd[0]);
+		close(pipe_fd[1]);
+		free(data->host);
+		free(data->service);
+		free(data);
+
+		return (-1);
+	}
+
+	check->fd = pipe_fd[0];
+	check->resolving = 1;
+
+	return (0);
+}
+
+/*
+ * Resolved address is cached for QDEVICE_HEURISTICS_WORKER_CHECK_ADDR_TTL
+ * seconds, so change of DNS record is noticed without restarting qdevice.
+ */
+static int
+qdevice_heuristics_worker_check_addr_is_valid(const struct qdevice_heuristics_worker_check *check)
+{
+	struct timespec ts;
+
+	if (!check->addr_resolved) {
+		return (0);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (ts.tv_sec - check->addr_resolved_time < QDEVICE_HEURISTICS_WORKER_CHECK_ADDR_TTL);
+}
+
+/*
+ * -1 - Check failed
+ *  0 - Check in progress
+ *  1 - Check passed
+ */
+static int
+qdevice_heuristics_worker_check_net_start(struct qdevice_heuristics_worker_check *check)
+{
+
+	if (check->type == QDEVICE_HEURISTICS_WORKER_CHECK_TYPE_TCP) {
+		return (qdevice_heuristics_worker_check_tcp_start(check));
+	}
+
+	return (qdevice_heuristics_worker_check_ping_start(check));
+}
+
+static void
+qdevice_heuristics_worker_check_start_result(struct qdevice_heuristics_worker_instance *instance,
+    struct qdevice_heuristics_worker_check *check, int res)
+{
+
+	if (res != 0) {
+		if (res < 0) {
+			qdevice_heuristics_worker_log_printf(instance, LOG_WARNING,
+			    "Can't start builtin check %s: %s", check->name, strerror(errno));
+		}
+
+		qdevice_heuristics_worker_check_set_result(instance, check, res > 0);
+	}
+}
+
+/*
+ * Store address reported by resolve helper thread and, if check didn't time out
+ * in the meantime, continue with TCP connect/ICMP echo.
+ */
+static void
+qdevice_heuristics_worker_check_resolve_process(struct qdevice_heuristics_worker_instance *instance,
+    struct qdevice_heuristics_worker_check *check)
+{
+	struct qdevice_heuristics_worker_check_resolve_result result;
+	struct timespec ts;
+	ssize_t readed;
+
+	do {
+		readed = read(check->fd, &result, sizeof(result));
+	} while (readed < 0 && errno == EINTR);
+
+	if (readed < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+		return ;
+	}
+
+	qdevice_heuristics_worker_check_close(check);
+	check->resolving = 0;
+
+	if (readed != sizeof(result)) {
+		qdevice_heuristics_worker_check_set_result(instance, check, 0);
+
+		return ;
+	}
+
+	if (result.gai_res != 0) {
+		qdevice_heuristics_worker_log_printf(instance, LOG_WARNING,
+		    "Builtin check %s can't resolve address: %s", check->name,
+		    gai_strerror(result.gai_res));
+
+		qdevice_heuristics_worker_check_set_result(instance, check, 0);
+
+		return ;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	memcpy(&check->addr, &result.addr, sizeof(check->addr));
+	check->addr_len = result.addr_len;
+	check->addr_resolved = 1;
+	check->addr_resolved_time = ts.tv_sec;
+
+	if (check->check_state != QDEVICE_HEURISTICS_WORKER_CHECK_STATE_PENDING) {
+		/*
+		 * Check timed out, address is used by next check
+		 */
+		return ;
+	}
+
+	qdevice_heuristics_worker_check_start_result(instance, check,
+	    qdevice_heuristics_worker_check_net_start(check));
+}
+
+/*
+ * Start builtin check. Failure to start check is not fatal, only check result is
+ * set to fail.
+ *
+ * -1 - Fatal error (memory allocation)
+ *  0 - Check started or failed
+ */
+int
+qdevice_heuristics_worker_check_start(struct qdevice_heuristics_worker_instance *instance,
+    const struct qdevice_heuristics_exec_list_entry *exec_list_entry, uint32_t seq_number)
+{
+	struct qdevice_heuristics_worker_check *check;
+	enum qdevice_heuristics_worker_check_type type;
+	int res;
+
+	if (qdevice_heuristics_worker_check_parse_type(exec_list_entry, &type) != 0) {
+		qdevice_heuristics_worker_log_printf(instance, LOG_ERR,
+		    "Builtin check %s has invalid definition \"%s\"", exec_list_entry->name,
+		    exec_list_entry->command);
+
+		/*
+		 * Check with invalid definition always fails
+		 */
+		type = QDEVICE_HEURISTICS_WORKER_CHECK_TYPE_STAT;
+		check = qdevice_heuristics_worker_check_get(instance, exec_list_entry->name, type);
+		if (check == NULL) {
+			return (-1);
+		}
+
+		check->check_seq_number = seq_number;
+		check->check_state = QDEVICE_HEURISTICS_WORKER_CHECK_STATE_FAIL;
+
+		return (0);
+	}
+
+	check = qdevice_heuristics_worker_check_get(instance, exec_list_entry->name, type);
+	if (check == NULL) {
+		return (-1);
+	}
+
+	check->check_seq_number = seq_number;
+	check->check_state = QDEVICE_HEURISTICS_WORKER_CHECK_STATE_PENDING;
+
+	res = -1;
+
+	switch (check->type) {
+	case QDEVICE_HEURISTICS_WORKER_CHECK_TYPE_TCP:
+	case QDEVICE_HEURISTICS_WORKER_CHECK_TYPE_PING:
+		if (check->resolving) {
+			qdevice_heuristics_worker_log_printf(instance, LOG_WARNING,
+			    "Previous resolving of builtin check %s address is still running",
+			    check->name);
+
+			check->check_state = QDEVICE_HEURISTICS_WORKER_CHECK_STATE_FAIL;
+
+			return (0);
+		}
+
+		qdevice_heuristics_worker_check_close(check);
+
+		if (!qdevice_heuristics_worker_check_addr_is_valid(check)) {
+			res = qdevice_heuristics_worker_check_resolve_start(check, exec_list_entry);
+			break;
+		}
+
+		res = qdevice_heuristics_worker_check_net_start(check);
+		break;
+	case QDEVICE_HEURISTICS_WORKER_CHECK_TYPE_STAT:
+	case QDEVICE_HEURISTICS_WORKER_CHECK_TYPE_READ:
+		if (check->fd != -1) {
+			qdevice_heuristics_worker_log_printf(instance, LOG_WARNING,
+			    "Previous builtin check %s is still running", check->name);
+
+			check->check_state = QDEVICE_HEURISTICS_WORKER_CHECK_STATE_FAIL;
+
+			return (0);
+		}
+
+		res = qdevice_heuristics_worker_check_file_start(check, exec_list_entry->exec_argv[1]);
+		break;
+	/*
+	 * Default is not defined intentionally. Compiler shows warning when new check type is added
+	 */
+	}
+
+	qdevice_heuristics_worker_check_start_result(instance, check, res);
+
+	return (0);
+}
+
+/*
+ * Fill fds with sockets/pipes of running checks. Returns number of used fds.
+ */
+size_t
+qdevice_heuristics_worker_check_list_poll_fds_set(
+    struct qdevice_heuristics_worker_instance *instance, struct pollfd *fds, size_t max_fds)
+{
+	struct qdevice_heuristics_worker_check *check;
+	size_t no_fds;
+
+	no_fds = 0;
+
+	TAILQ_FOREACH(check, &instance->check_list, entries) {
+		if (no_fds >= max_fds) {
+			break;
+		}
+
+		if (check->fd == -1) {
+			continue ;
+		}
+
+		fds[no_fds].fd = check->fd;
+		fds[no_fds].events = (check->type == QDEVICE_HEURISTICS_WORKER_CHECK_TYPE_TCP &&
+		    !check->resolving ? POLLOUT : POLLIN);
+		fds[no_fds].revents = 0;
+		no_fds++;
+	}
+
+	return (no_fds);
+}
+
+void
+qdevice_heuristics_worker_check_list_poll_fds_process(
+    struct qdevice_heuristics_worker_instance *instance, const struct pollfd *fds, size_t no_fds)
+{
+	struct qdevice_heuristics_worker_check *check;
+	size_t zi;
+
+	TAILQ_FOREACH(check, &instance->check_list, entries) {
+		if (check->fd == -1) {
+			continue ;
+		}
+
+		for (zi = 0; zi < no_fds; zi++) {
+			if (fds[zi].fd == check->fd) {
+				break;
+			}
+		}
+
+		if (zi >= no_fds || fds[zi].revents == 0) {
+			continue ;
+		}
+
+		if (check->resolving) {
+			qdevice_heuristics_worker_check_resolve_process(instance, check);
+			continue ;
+		}
+
+		switch (check->type) {
+		case QDEVICE_HEURISTICS_WORKER_CHECK_TYPE_TCP:
+			qdevice_heuristics_worker_check_tcp_process(instance, check);
+			break;
+		case QDEVICE_HEURISTICS_WORKER_CHECK_TYPE_PING:
+			qdevice_heuristics_worker_check_ping_process(instance, check);
+			break;
+		case QDEVICE_HEURISTICS_WORKER_CHECK_TYPE_STAT:
+		case QDEVICE_HEURISTICS_WORKER_CHECK_TYPE_READ:
+			qdevice_heuristics_worker_check_file_process(instance, check);
+			break;
+		}
+	}
+}
+
+/*
+ *  0 = All checks passed
+ *  1 = Some check failed
+ * -1 = Not all checks finished and none of finished failed
+ */
+int
+qdevice_heuristics_worker_check_list_get_summary_result_short(
+    struct qdevice_heuristics_worker_instance *instance)
+{
+	struct qdevice_heuristics_worker_check *check;
+	int res;
+
+	res = 0;
+
+	TAILQ_FOREACH(check, &instance->check_list, entries) {
+		switch (check->check_state) {
+		case QDEVICE_HEURISTICS_WORKER_CHECK_STATE_IDLE:
+		case QDEVICE_HEURISTICS_WORKER_CHECK_STATE_PASS:
+			break;
+		case QDEVICE_HEURISTICS_WORKER_CHECK_STATE_PENDING:
+			res = -1;
+			break;
+		case QDEVICE_HEURISTICS_WORKER_CHECK_STATE_FAIL:
+			return (1);
+			break;
+		}
+	}
+
+	return (res);
+}
+
+/*
+ * Result of check was reported. Sockets of unfinished checks are closed, pipes
+ * of blocked helper threads (stat/read/resolve) are kept open.
+ */
+void
+qdevice_heuristics_worker_check_list_check_finish(
+    struct qdevice_heuristics_worker_instance *instance, int timeout_expired)
+{
+	struct qdevice_heuristics_worker_check *check;
+
+	TAILQ_FOREACH(check, &instance->check_list, entries) {
+		if (check->check_state == QDEVICE_HEURISTICS_WORKER_CHECK_STATE_PENDING) {
+			if (timeout_expired) {
+				qdevice_heuristics_worker_log_printf(instance, LOG_WARNING,
+				    "Builtin check %s didn't finish on time", check->name);
+			}
+
+			if ((check->type == QDEVICE_HEURISTICS_WORKER_CHECK_TYPE_TCP ||
+			    check->type == QDEVICE_HEURISTICS_WORKER_CHECK_TYPE_PING) &&
+			    !check->resolving) {
+				qdevice_heuristics_worker_check_close(check);
+			}
+		}
+
+		check->check_state = QDEVICE_HEURISTICS_WORKER_CHECK_STATE_IDLE;
+	}
+}
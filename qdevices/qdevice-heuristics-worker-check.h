@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _QDEVICE_HEURISTICS_WORKER_CHECK_H_
+#define _QDEVICE_HEURISTICS_WORKER_CHECK_H_
+
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#include <sys/queue.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <time.h>
+
+#include "qdevice-heuristics-exec-list.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Builtin heuristics check is executed directly by worker without starting any
+ * process. TCP connect and ICMP echo use non-blocking socket polled together
+ * with other worker fds, stat/read of path and resolving of host address are
+ * done by helper thread (so hung filesystem or DNS server can't block worker)
+ * which reports result using pipe.
+ */
+enum qdevice_heuristics_worker_check_type {
+	QDEVICE_HEURISTICS_WORKER_CHECK_TYPE_TCP,
+	QDEVICE_HEURISTICS_WORKER_CHECK_TYPE_PING,
+	QDEVICE_HEURISTICS_WORKER_CHECK_TYPE_STAT,
+	QDEVICE_HEURISTICS_WORKER_CHECK_TYPE_READ,
+};
+
+enum qdevice_heuristics_worker_check_state {
+	QDEVICE_HEURISTICS_WORKER_CHECK_STATE_IDLE,
+	QDEVICE_HEURISTICS_WORKER_CHECK_STATE_PENDING,
+	QDEVICE_HEURISTICS_WORKER_CHECK_STATE_PASS,
+	QDEVICE_HEURISTICS_WORKER_CHECK_STATE_FAIL,
+};
+
+struct qdevice_heuristics_worker_check {
+	char *name;
+	enum qdevice_heuristics_worker_check_type type;
+	struct sockaddr_storage addr;
+	socklen_t addr_len;
+	int addr_resolved;
+	time_t addr_resolved_time;
+	/*
+	 * Helper thread is resolving address of TCP/ICMP check and fd is read end
+	 * of its pipe
+	 */
+	int resolving;
+	/*
+	 * Socket for TCP/ICMP or read end of helper thread pipe for stat/read/resolve
+	 */
+	int fd;
+	uint32_t check_seq_number;
+	enum qdevice_heuristics_worker_check_state check_state;
+	TAILQ_ENTRY(qdevice_heuristics_worker_check) entries;
+};
+
+TAILQ_HEAD(qdevice_heuristics_worker_check_list, qdevice_heuristics_worker_check);
+
+struct qdevice_heuristics_worker_instance;
+
+extern void		qdevice_heuristics_worker_check_list_init(
+    struct qdevice_heuristics_worker_check_list *list);
+
+extern void		qdevice_heuristics_worker_check_list_free(
+    struct qdevice_heuristics_worker_instance *instance);
+
+extern int		qdevice_heuristics_worker_check_start(
+    struct qdevice_heuristics_worker_instance *instance,
+    const struct qdevice_heuristics_exec_list_entry *exec_list_entry, uint32_t seq_number);
+
+extern size_t		qdevice_heuristics_worker_check_list_poll_fds_set(
+    struct qdevice_heuristics_worker_instance *instance, struct pollfd *fds, size_t max_fds);
+
+extern void		qdevice_heuristics_worker_check_list_poll_fds_process(
+    struct qdevice_heuristics_worker_instance *instance, const struct pollfd *fds,
+    size_t no_fds);
+
+extern int		qdevice_heuristics_worker_check_list_get_summary_result_short(
+    struct qdevice_heuristics_worker_instance *instance);
+
+extern void		qdevice_heuristics_worker_check_list_check_finish(
+    struct qdevice_heuristics_worker_instance *instance, int timeout_expired);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _QDEVICE_HEURISTICS_WORKER_CHECK_H_ */
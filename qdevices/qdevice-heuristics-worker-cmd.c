@@ -41,88 +41,53 @@
 #include "qdevice-heuristics-io.h"
 #include "qdevice-heuristics-worker.h"
 #include "qdevice-heuristics-worker-cmd.h"
-#include "qdevice-heuristics-cmd-str.h"
+#include "qdevice-heuristics-msg.h"
 #include "qdevice-heuristics-worker-log.h"
 
 static int
 qdevice_heuristics_worker_cmd_process_exec_list_add(struct qdevice_heuristics_worker_instance *instance,
-    struct dynar *data)
+    const struct qdevice_heuristics_msg_decoded *decoded_msg)
 {
-	size_t zi;
 	char *exec_name;
 	char *exec_command;
-	char *str;
-
-	str = dynar_data(data);
-
-	/*
-	 * Skip to first space
-	 */
-	for (zi = 0; str[zi] != ' ' && str[zi] != '\0'; zi++) ;
-
-	if (str[zi] == '\0') {
-		qdevice_heuristics_worker_log_printf(instance, LOG_CRIT,
-		    "qdevice_heuristics_worker_cmd_process_exec_list_add: Can't find first space");
-		return (-1);
-	}
-
-	/*
-	 * Skip to the end of spaces
-	 */
-	for (; str[zi] == ' '; zi++) ;
+	enum qdevice_heuristics_exec_type exec_type;
+	struct qdevice_heuristics_exec_list_entry *exec_list_entry;
 
-	if (str[zi] == '\0') {
+	if (decoded_msg->exec_name == NULL || decoded_msg->exec_command == NULL ||
+	    !decoded_msg->exec_type_set) {
 		qdevice_heuristics_worker_log_printf(instance, LOG_CRIT,
-		    "qdevice_heuristics_worker_cmd_process_exec_list_add: Can't find start of exec name");
+		    "qdevice_heuristics_worker_cmd_process_exec_list_add: Message doesn't "
+		    "contain required option");
 		return (-1);
 	}
 
-	/*
-	 * Found exec name
-	 */
-	exec_name = str + zi;
+	exec_name = decoded_msg->exec_name;
+	exec_command = decoded_msg->exec_command;
+	exec_type = decoded_msg->exec_type;
 
-	/*
-	 * Skip to the next spaces
-	 */
-	for (; str[zi] != ' ' && str[zi] != '\0'; zi++) ;
+	qdevice_heuristics_worker_log_printf(instance, LOG_DEBUG,
+	    "qdevice_heuristics_worker_cmd_process_one_msg: Received exec-list-add command "
+	    "with name \"%s\", type %u and command \"%s\"", exec_name, exec_type,
+	    exec_command);
 
-	if (str[zi] == '\0') {
+	if ((exec_list_entry = qdevice_heuristics_exec_list_add(&instance->exec_list, exec_name,
+	    exec_command)) == NULL) {
 		qdevice_heuristics_worker_log_printf(instance, LOG_CRIT,
-		    "qdevice_heuristics_worker_cmd_process_exec_list_add: Can't find second space");
+		    "qdevice_heuristics_worker_cmd_process_exec_list_add: Can't alloc exec list entry");
 		return (-1);
 	}
 
-	/*
-	 * Put trailing \0 into exec_name
-	 */
-	str[zi] = '\0';
-	zi++;
+	exec_list_entry->type = exec_type;
 
 	/*
-	 * Skip to the end of next spaces
+	 * Parse command only once. Failure is reported when exec is requested
 	 */
-	for (; str[zi] == ' '; zi++) ;
-
-	if (str[zi] == '\0') {
-		qdevice_heuristics_worker_log_printf(instance, LOG_CRIT,
-		    "qdevice_heuristics_worker_cmd_process_exec_list_add: Can't find start of exec command");
-		return (-1);
-	}
-
-	/*
-	 * Found exec_command
-	 */
-	exec_command = str + zi;
-
-	qdevice_heuristics_worker_log_printf(instance, LOG_DEBUG,
-	    "qdevice_heuristics_worker_cmd_process_one_line: Received exec-list-add command "
-	    "with name \"%s\" and command \"%s\"", exec_name, exec_command);
-
-	if (qdevice_heuristics_exec_list_add(&instance->exec_list, exec_name, exec_command) == NULL) {
-		qdevice_heuristics_worker_log_printf(instance, LOG_CRIT,
-		    "qdevice_heuristics_worker_cmd_process_exec_list_add: Can't alloc exec list entry");
-		return (-1);
+	exec_list_entry->exec_argv = process_list_parse_command(exec_command,
+	    &exec_list_entry->exec_argc);
+	if (exec_list_entry->exec_argv == NULL) {
+		qdevice_heuristics_worker_log_printf(instance, LOG_WARNING,
+		    "qdevice_heuristics_worker_cmd_process_exec_list_add: Can't parse "
+		    "exec command \"%s\"", exec_command);
 	}
 
 	return (0);
@@ -130,23 +95,24 @@ qdevice_heuristics_worker_cmd_process_exec_list_add(struct qdevice_heuristics_wo
 
 static int
 qdevice_heuristics_worker_cmd_process_exec(struct qdevice_heuristics_worker_instance *instance,
-    struct dynar *data)
+    const struct qdevice_heuristics_msg_decoded *decoded_msg)
 {
 	uint32_t timeout;
 	uint32_t seq_number;
-	char *str;
 	struct qdevice_heuristics_exec_list_entry *exec_list_entry;
 	struct process_list_entry *plist_entry;
+	int res;
 
-	str = dynar_data(data);
-
-	if (sscanf(str, QDEVICE_HEURISTICS_CMD_STR_EXEC_ADD_SPACE "%"PRIu32" %"PRIu32, &timeout,
-	    &seq_number) != 2) {
+	if (!decoded_msg->timeout_set || !decoded_msg->seq_number_set) {
 		qdevice_heuristics_worker_log_printf(instance, LOG_CRIT,
-		    "qdevice_heuristics_worker_cmd_process_exec: Can't parse command (sscanf)");
+		    "qdevice_heuristics_worker_cmd_process_exec: Message doesn't contain "
+		    "required option");
 		return (-1);
 	}
 
+	timeout = decoded_msg->timeout;
+	seq_number = decoded_msg->seq_number;
+
 	qdevice_heuristics_worker_log_printf(instance, LOG_DEBUG,
 	    "qdevice_heuristics_worker_cmd_process_exec: Received exec command "
 	    "with seq_no \"%"PRIu32"\" and timeout \"%"PRIu32"\"", seq_number, timeout);
@@ -159,6 +125,7 @@ qdevice_heuristics_worker_cmd_process_exec(struct qdevice_heuristics_worker_inst
 	}
 
 	instance->last_exec_seq_number = seq_number;
+	qdevice_heuristics_worker_exec_list_results_reset(instance);
 
 	if (qdevice_heuristics_exec_list_is_empty(&instance->exec_list)) {
 		if (qdevice_heuristics_worker_cmd_write_exec_result(instance,
@@ -168,11 +135,44 @@ qdevice_heuristics_worker_cmd_process_exec(struct qdevice_heuristics_worker_inst
 		}
 	} else {
 		/*
-		 * Initialize process list (from exec list)
+		 * Initialize process list (from exec list), request check from
+		 * persistent processes and start builtin checks
 		 */
 		TAILQ_FOREACH(exec_list_entry, &instance->exec_list, entries) {
-			plist_entry = process_list_add(&instance->main_process_list,
-			    exec_list_entry->name, exec_list_entry->command);
+			if (exec_list_entry->type != QDEVICE_HEURISTICS_EXEC_TYPE_EXEC) {
+				if (exec_list_entry->type == QDEVICE_HEURISTICS_EXEC_TYPE_PERSISTENT) {
+					res = qdevice_heuristics_worker_probe_check(instance,
+					    exec_list_entry, seq_number);
+				} else {
+					res = qdevice_heuristics_worker_check_start(instance,
+					    exec_list_entry, seq_number);
+				}
+
+				if (res != 0) {
+					qdevice_heuristics_worker_log_printf(instance, LOG_ERR,
+					    "qdevice_heuristics_worker_cmd_process_exec: Can't "
+					    "allocate persistent process or builtin check");
+
+					process_list_move_active_entries_to_kill_list(
+					    &instance->main_process_list);
+					qdevice_heuristics_worker_probe_list_check_finish(instance, 0);
+					qdevice_heuristics_worker_check_list_check_finish(instance, 0);
+
+					if (qdevice_heuristics_worker_cmd_write_exec_result(instance,
+					    instance->last_exec_seq_number,
+					    QDEVICE_HEURISTICS_EXEC_RESULT_FAIL) != 0) {
+						return (-1);
+					}
+
+					return (0);
+				}
+
+				continue ;
+			}
+
+			plist_entry = process_list_add_argv(&instance->main_process_list,
+			    exec_list_entry->name, exec_list_entry->exec_argc,
+			    exec_list_entry->exec_argv);
 
 			if (plist_entry == NULL) {
 				qdevice_heuristics_worker_log_printf(instance, LOG_ERR,
@@ -181,6 +181,8 @@ qdevice_heuristics_worker_cmd_process_exec(struct qdevice_heuristics_worker_inst
 
 				process_list_move_active_entries_to_kill_list(
 				    &instance->main_process_list);
+				qdevice_heuristics_worker_probe_list_check_finish(instance, 0);
+				qdevice_heuristics_worker_check_list_check_finish(instance, 0);
 
 				if (qdevice_heuristics_worker_cmd_write_exec_result(instance,
 				    instance->last_exec_seq_number,
@@ -198,6 +200,8 @@ qdevice_heuristics_worker_cmd_process_exec(struct qdevice_heuristics_worker_inst
 			    "process list");
 
 			process_list_move_active_entries_to_kill_list(&instance->main_process_list);
+			qdevice_heuristics_worker_probe_list_check_finish(instance, 0);
+			qdevice_heuristics_worker_check_list_check_finish(instance, 0);
 
 			if (qdevice_heuristics_worker_cmd_write_exec_result(instance,
 			    instance->last_exec_seq_number,
@@ -217,6 +221,8 @@ qdevice_heuristics_worker_cmd_process_exec(struct qdevice_heuristics_worker_inst
 			    "timer to timer list");
 
 			process_list_move_active_entries_to_kill_list(&instance->main_process_list);
+			qdevice_heuristics_worker_probe_list_check_finish(instance, 0);
+			qdevice_heuristics_worker_check_list_check_finish(instance, 0);
 
 			if (qdevice_heuristics_worker_cmd_write_exec_result(instance,
 			    instance->last_exec_seq_number,
@@ -232,74 +238,75 @@ qdevice_heuristics_worker_cmd_process_exec(struct qdevice_heuristics_worker_inst
 }
 
 /*
- * 1 - Line processed
- * 0 - No line to process - everything processed
+ * 1 - Message processed
+ * 0 - No message to process - everything processed
  * -1 - Error
  */
 static int
-qdevice_heuristics_worker_cmd_process_one_line(struct qdevice_heuristics_worker_instance *instance,
+qdevice_heuristics_worker_cmd_process_one_msg(struct qdevice_heuristics_worker_instance *instance,
     struct dynar *data)
 {
-	char *str;
-	size_t str_len;
-	size_t nl_pos;
-	size_t zi;
-
-	str = dynar_data(data);
-	str_len = dynar_size(data);
-
-	/*
-	 * Find valid line
-	 */
-	for (zi = 0; zi < str_len && str[zi] != '\r' && str[zi] != '\n'; zi++) ;
+	struct qdevice_heuristics_msg_decoded decoded_msg;
+	size_t msg_len;
+	int res;
 
-	if (zi >= str_len) {
+	msg_len = qdevice_heuristics_msg_get_complete_len(data);
+	if (msg_len == 0) {
 		/*
-		 * Command is not yet fully readed
+		 * Message is not yet fully readed
 		 */
 		return (0);
 	}
 
-	nl_pos = zi;
+	qdevice_heuristics_msg_decoded_init(&decoded_msg);
 
-	str[nl_pos] = '\0';
+	if (qdevice_heuristics_msg_decode(dynar_data(data), msg_len, &decoded_msg) != 0) {
+		qdevice_heuristics_worker_log_printf(instance, LOG_CRIT,
+		    "qdevice_heuristics_worker_cmd_process_one_msg: Can't decode message "
+		    "received from main qdevice process");
 
-	if (strcmp(str, QDEVICE_HEURISTICS_CMD_STR_EXEC_LIST_CLEAR) == 0) {
+		res = -1;
+		goto exit_destroy;
+	}
+
+	res = 0;
+
+	switch (decoded_msg.type) {
+	case QDEVICE_HEURISTICS_MSG_TYPE_EXEC_LIST_CLEAR:
 		qdevice_heuristics_worker_log_printf(instance, LOG_DEBUG,
-		    "qdevice_heuristics_worker_cmd_process_one_line: Received exec-list-clear command");
+		    "qdevice_heuristics_worker_cmd_process_one_msg: Received exec-list-clear command");
 
 		qdevice_heuristics_exec_list_free(&instance->exec_list);
-	} else if (strncmp(str, QDEVICE_HEURISTICS_CMD_STR_EXEC_LIST_ADD_SPACE,
-	    strlen(QDEVICE_HEURISTICS_CMD_STR_EXEC_LIST_ADD)) == 0) {
-		if (qdevice_heuristics_worker_cmd_process_exec_list_add(instance, data) != 0) {
-			return (-1);
-		}
-	} else if (strncmp(str, QDEVICE_HEURISTICS_CMD_STR_EXEC_ADD_SPACE,
-	    strlen(QDEVICE_HEURISTICS_CMD_STR_EXEC_ADD_SPACE)) == 0) {
-		if (qdevice_heuristics_worker_cmd_process_exec(instance, data) != 0) {
-			return (-1);
-		}
-	} else {
+		qdevice_heuristics_worker_probe_list_free(instance);
+		qdevice_heuristics_worker_check_list_free(instance);
+		break;
+	case QDEVICE_HEURISTICS_MSG_TYPE_EXEC_LIST_ADD:
+		res = qdevice_heuristics_worker_cmd_process_exec_list_add(instance, &decoded_msg);
+		break;
+	case QDEVICE_HEURISTICS_MSG_TYPE_EXEC:
+		res = qdevice_heuristics_worker_cmd_process_exec(instance, &decoded_msg);
+		break;
+	default:
 		qdevice_heuristics_worker_log_printf(instance, LOG_CRIT,
-		    "qdevice_heuristics_worker_cmd_process_one_line: Unknown command \"%s\" "
-		    "received from main qdevice process", str);
+		    "qdevice_heuristics_worker_cmd_process_one_msg: Unknown message type %u "
+		    "received from main qdevice process", decoded_msg.type);
 
-		    return (-1);
+		res = -1;
+		break;
 	}
 
-	/*
-	 * Find place where is begining of new "valid" line
-	 */
-	for (zi = nl_pos + 1; zi < str_len && (str[zi] == '\0' || str[zi] == '\n' || str[zi] == '\r'); zi++) ;
-
-	memmove(str, str + zi, str_len - zi);
-	if (dynar_set_size(data, str_len - zi) == -1) {
-		qdevice_heuristics_worker_log_printf(instance, LOG_CRIT,
-		    "qdevice_heuristics_worker_cmd_process_one_line: Can't set dynar size");
-		return (-1);
+	if (res != 0) {
+		res = -1;
+		goto exit_destroy;
 	}
 
-	return (1);
+	qdevice_heuristics_msg_remove_from_buffer(data, msg_len);
+	res = 1;
+
+exit_destroy:
+	qdevice_heuristics_msg_decoded_destroy(&decoded_msg);
+
+	return (res);
 }
 
 /*
@@ -312,7 +319,7 @@ qdevice_heuristics_worker_cmd_process(struct qdevice_heuristics_worker_instance
 	int res;
 
 	while ((res =
-	    qdevice_heuristics_worker_cmd_process_one_line(instance, &instance->cmd_in_buffer)) == 1) ;
+	    qdevice_heuristics_worker_cmd_process_one_msg(instance, &instance->cmd_in_buffer)) == 1) ;
 
 	return (res);
 }
@@ -344,7 +351,7 @@ qdevice_heuristics_worker_cmd_read_from_pipe(struct qdevice_heuristics_worker_in
 		break;
 	case -2:
 		qdevice_heuristics_worker_log_printf(instance, LOG_ERR,
-		    "Heuristics sent too long command line");
+		    "Heuristics sent too long command");
 		ret = -1;
 		break;
 	case -3:
@@ -354,7 +361,7 @@ qdevice_heuristics_worker_cmd_read_from_pipe(struct qdevice_heuristics_worker_in
 		break;
 	case 1:
 		/*
-		 * At least one log line received
+		 * At least one message received
 		 */
 		ret = qdevice_heuristics_worker_cmd_process(instance);
 		break;
@@ -367,10 +374,11 @@ int
 qdevice_heuristics_worker_cmd_write_exec_result(struct qdevice_heuristics_worker_instance *instance,
     uint32_t seq_number, enum qdevice_heuristics_exec_result exec_result)
 {
-	if (dynar_str_cpy(&instance->cmd_out_buffer,
-	    QDEVICE_HEURISTICS_CMD_STR_EXEC_RESULT_ADD_SPACE) != -1 &&
-	    dynar_str_catf(&instance->cmd_out_buffer, "%"PRIu32" %u\n", seq_number,
-	    (int)exec_result) != -1) {
+
+	qdevice_heuristics_worker_exec_list_results_update(instance);
+
+	if (qdevice_heuristics_msg_create_exec_result(&instance->cmd_out_buffer, seq_number,
+	    exec_result, &instance->exec_list) != 0) {
 		(void)qdevice_heuristics_io_blocking_write(QDEVICE_HEURISTICS_WORKER_CMD_OUT_FD,
 		    dynar_data(&instance->cmd_out_buffer), dynar_size(&instance->cmd_out_buffer));
 	} else {
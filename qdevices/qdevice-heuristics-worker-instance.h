@@ -38,6 +38,8 @@
 #include "dynar.h"
 
 #include "qdevice-heuristics-exec-list.h"
+#include "qdevice-heuristics-worker-check.h"
+#include "qdevice-heuristics-worker-probe.h"
 #include "process-list.h"
 #include "timer-list.h"
 
@@ -48,16 +50,30 @@ extern "C" {
 struct qdevice_heuristics_worker_instance {
 	struct dynar cmd_in_buffer;
 	struct dynar cmd_out_buffer;
+	struct dynar log_str_buffer;
 	struct dynar log_out_buffer;
 
 	struct qdevice_heuristics_exec_list exec_list;
 	struct process_list main_process_list;
+	struct process_list probe_process_list;
+	struct qdevice_heuristics_worker_probe_list probe_list;
+	struct qdevice_heuristics_worker_check_list check_list;
 	struct timer_list main_timer_list;
 
 	struct timer_list_entry *kill_list_timer;
 	struct timer_list_entry *exec_timeout_timer;
 
 	uint32_t last_exec_seq_number;
+	uint64_t exec_start_time;	/* Monotonic time (ms) when last exec was started */
+
+	/*
+	 * Self-pipe written by SIGCHLD handler. Read end is polled together with
+	 * command input so finished processes are reaped without delay
+	 */
+	int sigchld_pipe[2];
+
+	struct pollfd *poll_fds;
+	size_t max_poll_fds;
 
 	int schedule_exit;
 };
@@ -39,28 +39,10 @@
 #include "dynar.h"
 #include "dynar-str.h"
 #include "qdevice-heuristics-io.h"
+#include "qdevice-heuristics-msg.h"
 #include "qdevice-heuristics-worker.h"
 #include "qdevice-heuristics-worker-log.h"
 
-static int
-qdevice_heuristics_worker_log_remove_newlines(struct dynar *str)
-{
-	size_t len;
-	size_t zi;
-	char *buf;
-
-	len = dynar_size(str);
-	buf = dynar_data(str);
-
-	for (zi = 0; zi < len ; zi++) {
-		if (buf[zi] == '\n' || buf[zi] == '\r') {
-			buf[zi] = ' ';
-		}
-	}
-
-	return (0);
-}
-
 void
 qdevice_heuristics_worker_log_printf(struct qdevice_heuristics_worker_instance *instance,
     int priority, const char *format, ...)
@@ -70,11 +52,11 @@ qdevice_heuristics_worker_log_printf(struct qdevice_heuristics_worker_instance *
 
 	va_start(ap, format);
 
-	if (dynar_str_cpy(&instance->log_out_buffer, "") != -1 &&
-	    dynar_str_catf(&instance->log_out_buffer, "%u ", priority) != -1 &&
-	    dynar_str_vcatf(&instance->log_out_buffer, format, ap) != -1 &&
-	    qdevice_heuristics_worker_log_remove_newlines(&instance->log_out_buffer) != -1 &&
-	    dynar_str_cat(&instance->log_out_buffer, "\n") != -1) {
+	if (dynar_str_cpy(&instance->log_str_buffer, "") != -1 &&
+	    dynar_str_vcatf(&instance->log_str_buffer, format, ap) != -1 &&
+	    dynar_cat(&instance->log_str_buffer, "\0", 1) != -1 &&
+	    qdevice_heuristics_msg_create_log(&instance->log_out_buffer, (uint8_t)priority,
+	    dynar_data(&instance->log_str_buffer)) != 0) {
 		/*
 		 * It was possible to log everything
 		 */
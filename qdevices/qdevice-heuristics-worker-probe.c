@@ -0,0 +1,442 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "qdevice-config.h"
+#include "qdevice-heuristics-worker-probe.h"
+#include "qdevice-heuristics-worker-instance.h"
+#include "qdevice-heuristics-worker-log.h"
+
+void
+qdevice_heuristics_worker_probe_list_init(struct qdevice_heuristics_worker_probe_list *list)
+{
+
+	TAILQ_INIT(list);
+}
+
+/*
+ * Stop probe process. Running process is moved to kill list.
+ */
+static void
+qdevice_heuristics_worker_probe_stop(struct qdevice_heuristics_worker_instance *instance,
+    struct qdevice_heuristics_worker_probe *probe)
+{
+
+	if (probe->plist_entry != NULL) {
+		process_list_del(&instance->probe_process_list, probe->plist_entry);
+		probe->plist_entry = NULL;
+	}
+
+	dynar_clean(&probe->read_buffer);
+}
+
+static void
+qdevice_heuristics_worker_probe_fail(struct qdevice_heuristics_worker_instance *instance,
+    struct qdevice_heuristics_worker_probe *probe)
+{
+
+	qdevice_heuristics_worker_probe_stop(instance, probe);
+
+	if (probe->check_state == QDEVICE_HEURISTICS_WORKER_PROBE_CHECK_STATE_PENDING) {
+		probe->check_state = QDEVICE_HEURISTICS_WORKER_PROBE_CHECK_STATE_FAIL;
+	}
+}
+
+void
+qdevice_heuristics_worker_probe_list_free(struct qdevice_heuristics_worker_instance *instance)
+{
+	struct qdevice_heuristics_worker_probe *probe;
+	struct qdevice_heuristics_worker_probe *probe_next;
+
+	probe = TAILQ_FIRST(&instance->probe_list);
+
+	while (probe != NULL) {
+		probe_next = TAILQ_NEXT(probe, entries);
+
+		qdevice_heuristics_worker_probe_stop(instance, probe);
+		dynar_destroy(&probe->read_buffer);
+		free(probe->name);
+		free(probe);
+
+		probe = probe_next;
+	}
+
+	TAILQ_INIT(&instance->probe_list);
+}
+
+static struct qdevice_heuristics_worker_probe *
+qdevice_heuristics_worker_probe_get(struct qdevice_heuristics_worker_instance *instance,
+    const char *name)
+{
+	struct qdevice_heuristics_worker_probe *probe;
+
+	TAILQ_FOREACH(probe, &instance->probe_list, entries) {
+		if (strcmp(probe->name, name) == 0) {
+			return (probe);
+		}
+	}
+
+	probe = malloc(sizeof(*probe));
+	if (probe == NULL) {
+		return (NULL);
+	}
+
+	memset(probe, 0, sizeof(*probe));
+
+	probe->name = strdup(name);
+	if (probe->name == NULL) {
+		free(probe);
+
+		return (NULL);
+	}
+
+	dynar_init(&probe->read_buffer, QDEVICE_HEURISTICS_WORKER_PROBE_MAX_LINE_SIZE);
+	probe->check_state = QDEVICE_HEURISTICS_WORKER_PROBE_CHECK_STATE_IDLE;
+
+	TAILQ_INSERT_TAIL(&instance->probe_list, probe, entries);
+
+	return (probe);
+}
+
+static int
+qdevice_heuristics_worker_probe_start(struct qdevice_heuristics_worker_instance *instance,
+    struct qdevice_heuristics_worker_probe *probe,
+    const struct qdevice_heuristics_exec_list_entry *exec_list_entry)
+{
+	struct process_list_entry *plist_entry;
+
+	if (exec_list_entry->exec_argv == NULL) {
+		qdevice_heuristics_worker_log_printf(instance, LOG_ERR,
+		    "Can't start persistent process %s: invalid command", probe->name);
+
+		return (-1);
+	}
+
+	plist_entry = process_list_add_argv(&instance->probe_process_list, probe->name,
+	    exec_list_entry->exec_argc, exec_list_entry->exec_argv);
+	if (plist_entry == NULL) {
+		qdevice_heuristics_worker_log_printf(instance, LOG_ERR,
+		    "Can't allocate process list entry for persistent process %s", probe->name);
+
+		return (-1);
+	}
+
+	if (process_list_exec_initialized(&instance->probe_process_list) != 0) {
+		qdevice_heuristics_worker_log_printf(instance, LOG_ERR,
+		    "Can't execute persistent process %s", probe->name);
+
+		process_list_del(&instance->probe_process_list, plist_entry);
+
+		return (-1);
+	}
+
+	probe->plist_entry = plist_entry;
+	dynar_clean(&probe->read_buffer);
+
+	return (0);
+}
+
+/*
+ * Request check from probe (start it first if it is not running). Failure to start probe
+ * or to send the request is not fatal, only probe check result is set to fail.
+ *
+ * -1 - Fatal error (memory allocation)
+ *  0 - Check requested or failed
+ */
+int
+qdevice_heuristics_worker_probe_check(struct qdevice_heuristics_worker_instance *instance,
+    const struct qdevice_heuristics_exec_list_entry *exec_list_entry, uint32_t seq_number)
+{
+	struct qdevice_heuristics_worker_probe *probe;
+	char buf[32];
+	int len;
+
+	probe = qdevice_heuristics_worker_probe_get(instance, exec_list_entry->name);
+	if (probe == NULL) {
+		return (-1);
+	}
+
+	probe->check_seq_number = seq_number;
+	probe->check_state = QDEVICE_HEURISTICS_WORKER_PROBE_CHECK_STATE_PENDING;
+
+	if (probe->plist_entry != NULL &&
+	    probe->plist_entry->state != PROCESS_LIST_ENTRY_STATE_RUNNING) {
+		qdevice_heuristics_worker_probe_stop(instance, probe);
+	}
+
+	if (probe->plist_entry == NULL &&
+	    qdevice_heuristics_worker_probe_start(instance, probe, exec_list_entry) != 0) {
+		probe->check_state = QDEVICE_HEURISTICS_WORKER_PROBE_CHECK_STATE_FAIL;
+
+		return (0);
+	}
+
+	len = snprintf(buf, sizeof(buf), "check %"PRIu32"\n", seq_number);
+
+	if (write(probe->plist_entry->stdin_fd, buf, len) != len) {
+		qdevice_heuristics_worker_log_printf(instance, LOG_WARNING,
+		    "Can't send check request to persistent process %s", probe->name);
+
+		qdevice_heuristics_worker_probe_fail(instance, probe);
+	}
+
+	return (0);
+}
+
+static void
+qdevice_heuristics_worker_probe_process_line(struct qdevice_heuristics_worker_instance *instance,
+    struct qdevice_heuristics_worker_probe *probe, const char *line)
+{
+	char result[8];
+	uint32_t seq_number;
+
+	if (sscanf(line, "%7s %"SCNu32, result, &seq_number) != 2 ||
+	    (strcmp(result, "pass") != 0 && strcmp(result, "fail") != 0)) {
+		qdevice_heuristics_worker_log_printf(instance, LOG_WARNING,
+		    "Persistent process %s sent invalid reply \"%s\"", probe->name, line);
+
+		qdevice_heuristics_worker_probe_fail(instance, probe);
+
+		return ;
+	}
+
+	if (probe->check_state != QDEVICE_HEURISTICS_WORKER_PROBE_CHECK_STATE_PENDING ||
+	    seq_number != probe->check_seq_number) {
+		/*
+		 * Late reply to previous check
+		 */
+		return ;
+	}
+
+	if (strcmp(result, "pass") == 0) {
+		probe->check_state = QDEVICE_HEURISTICS_WORKER_PROBE_CHECK_STATE_PASS;
+	} else {
+		qdevice_heuristics_worker_log_printf(instance, LOG_WARNING,
+		    "Persistent process %s check failed", probe->name);
+
+		probe->check_state = QDEVICE_HEURISTICS_WORKER_PROBE_CHECK_STATE_FAIL;
+	}
+}
+
+static void
+qdevice_heuristics_worker_probe_read(struct qdevice_heuristics_worker_instance *instance,
+    struct qdevice_heuristics_worker_probe *probe)
+{
+	char buf[QDEVICE_HEURISTICS_WORKER_PROBE_MAX_LINE_SIZE];
+	char *str;
+	char *nl;
+	ssize_t readed;
+	size_t line_len;
+
+	while (probe->plist_entry != NULL &&
+	    (readed = read(probe->plist_entry->stdout_fd, buf, sizeof(buf))) != 0) {
+		if (readed < 0) {
+			if (errno == EINTR) {
+				continue ;
+			}
+
+			if (errno != EAGAIN && errno != EWOULDBLOCK) {
+				qdevice_heuristics_worker_probe_fail(instance, probe);
+			}
+
+			return ;
+		}
+
+		if (dynar_cat(&probe->read_buffer, buf, readed) != 0) {
+			qdevice_heuristics_worker_log_printf(instance, LOG_WARNING,
+			    "Persistent process %s sent too long line", probe->name);
+
+			qdevice_heuristics_worker_probe_fail(instance, probe);
+
+			return ;
+		}
+
+		while (probe->plist_entry != NULL &&
+		    (nl = memchr(dynar_data(&probe->read_buffer), '\n',
+		    dynar_size(&probe->read_buffer))) != NULL) {
+			str = dynar_data(&probe->read_buffer);
+			*nl = '\0';
+			line_len = nl - str + 1;
+
+			qdevice_heuristics_worker_probe_process_line(instance, probe, str);
+
+			if (probe->plist_entry == NULL) {
+				return ;
+			}
+
+			memmove(str, str + line_len, dynar_size(&probe->read_buffer) - line_len);
+			(void)dynar_set_size(&probe->read_buffer,
+			    dynar_size(&probe->read_buffer) - line_len);
+		}
+	}
+
+	if (probe->plist_entry != NULL) {
+		/*
+		 * EOF
+		 */
+		qdevice_heuristics_worker_log_printf(instance, LOG_WARNING,
+		    "Persistent process %s closed its stdout", probe->name);
+
+		qdevice_heuristics_worker_probe_fail(instance, probe);
+	}
+}
+
+/*
+ * Fill fds with stdout of running probes. Returns number of used fds.
+ */
+size_t
+qdevice_heuristics_worker_probe_list_poll_fds_set(
+    struct qdevice_heuristics_worker_instance *instance, struct pollfd *fds, size_t max_fds)
+{
+	struct qdevice_heuristics_worker_probe *probe;
+	size_t no_fds;
+
+	no_fds = 0;
+
+	TAILQ_FOREACH(probe, &instance->probe_list, entries) {
+		if (no_fds >= max_fds) {
+			break;
+		}
+
+		if (probe->plist_entry == NULL || probe->plist_entry->stdout_fd == -1) {
+			continue ;
+		}
+
+		fds[no_fds].fd = probe->plist_entry->stdout_fd;
+		fds[no_fds].events = POLLIN;
+		fds[no_fds].revents = 0;
+		no_fds++;
+	}
+
+	return (no_fds);
+}
+
+void
+qdevice_heuristics_worker_probe_list_poll_fds_process(
+    struct qdevice_heuristics_worker_instance *instance, const struct pollfd *fds, size_t no_fds)
+{
+	struct qdevice_heuristics_worker_probe *probe;
+	size_t zi;
+
+	TAILQ_FOREACH(probe, &instance->probe_list, entries) {
+		if (probe->plist_entry == NULL) {
+			continue ;
+		}
+
+		for (zi = 0; zi < no_fds; zi++) {
+			if (fds[zi].fd == probe->plist_entry->stdout_fd) {
+				break;
+			}
+		}
+
+		if (zi < no_fds && fds[zi].revents != 0) {
+			qdevice_heuristics_worker_probe_read(instance, probe);
+		}
+	}
+}
+
+/*
+ * Handle probes which exited. Has to be called after process_list_waitpid.
+ */
+void
+qdevice_heuristics_worker_probe_list_update(struct qdevice_heuristics_worker_instance *instance)
+{
+	struct qdevice_heuristics_worker_probe *probe;
+
+	TAILQ_FOREACH(probe, &instance->probe_list, entries) {
+		if (probe->plist_entry != NULL &&
+		    probe->plist_entry->state == PROCESS_LIST_ENTRY_STATE_FINISHED) {
+			qdevice_heuristics_worker_probe_fail(instance, probe);
+		}
+	}
+}
+
+/*
+ *  0 = All checks passed
+ *  1 = Some check failed
+ * -1 = Not all checks finished and none of finished failed
+ */
+int
+qdevice_heuristics_worker_probe_list_get_summary_result_short(
+    struct qdevice_heuristics_worker_instance *instance)
+{
+	struct qdevice_heuristics_worker_probe *probe;
+	int res;
+
+	res = 0;
+
+	TAILQ_FOREACH(probe, &instance->probe_list, entries) {
+		switch (probe->check_state) {
+		case QDEVICE_HEURISTICS_WORKER_PROBE_CHECK_STATE_IDLE:
+		case QDEVICE_HEURISTICS_WORKER_PROBE_CHECK_STATE_PASS:
+			break;
+		case QDEVICE_HEURISTICS_WORKER_PROBE_CHECK_STATE_PENDING:
+			res = -1;
+			break;
+		case QDEVICE_HEURISTICS_WORKER_PROBE_CHECK_STATE_FAIL:
+			return (1);
+			break;
+		}
+	}
+
+	return (res);
+}
+
+/*
+ * Result of check was reported. Probes which didn't answer before timeout are
+ * stopped (and restarted by next check).
+ */
+void
+qdevice_heuristics_worker_probe_list_check_finish(
+    struct qdevice_heuristics_worker_instance *instance, int timeout_expired)
+{
+	struct qdevice_heuristics_worker_probe *probe;
+
+	TAILQ_FOREACH(probe, &instance->probe_list, entries) {
+		if (timeout_expired &&
+		    probe->check_state == QDEVICE_HEURISTICS_WORKER_PROBE_CHECK_STATE_PENDING) {
+			qdevice_heuristics_worker_log_printf(instance, LOG_WARNING,
+			    "Persistent process %s didn't answer on time", probe->name);
+
+			qdevice_heuristics_worker_probe_stop(instance, probe);
+		}
+
+		probe->check_state = QDEVICE_HEURISTICS_WORKER_PROBE_CHECK_STATE_IDLE;
+	}
+}
@@ -32,12 +32,16 @@
  * THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <sys/wait.h>
+
 #include <limits.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <poll.h>
 #include <signal.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "dynar-str.h"
@@ -60,6 +64,8 @@ static void		qdevice_heuristics_worker_process_list_notify(
 
 static void		qdevice_heuristics_worker_signal_handlers_register(void);
 
+static int		qdevice_heuristics_worker_sigchld_pipe_fd = -1;
+
 
 /*
  * Definitions
@@ -99,14 +105,74 @@ qdevice_heuristics_worker_process_list_notify(enum process_list_notify_reason re
 	}
 }
 
+static void
+qdevice_heuristics_worker_sigchld_handler(int sig)
+{
+	int saved_errno;
+	char c;
+
+	saved_errno = errno;
+
+	c = 0;
+	/*
+	 * Pipe is non-blocking. Full pipe means wakeup is already pending
+	 */
+	(void)write(qdevice_heuristics_worker_sigchld_pipe_fd, &c, sizeof(c));
+
+	errno = saved_errno;
+}
+
+static int
+qdevice_heuristics_worker_sigchld_pipe_init(struct qdevice_heuristics_worker_instance *instance)
+{
+	int i;
+	int flags;
+
+	if (pipe(instance->sigchld_pipe) != 0) {
+		instance->sigchld_pipe[0] = instance->sigchld_pipe[1] = -1;
+
+		return (-1);
+	}
+
+	for (i = 0; i < 2; i++) {
+		if ((flags = fcntl(instance->sigchld_pipe[i], F_GETFL)) == -1 ||
+		    fcntl(instance->sigchld_pipe[i], F_SETFL, flags | O_NONBLOCK) == -1 ||
+		    fcntl(instance->sigchld_pipe[i], F_SETFD, FD_CLOEXEC) == -1) {
+			close(instance->sigchld_pipe[0]);
+			close(instance->sigchld_pipe[1]);
+			instance->sigchld_pipe[0] = instance->sigchld_pipe[1] = -1;
+
+			return (-1);
+		}
+	}
+
+	qdevice_heuristics_worker_sigchld_pipe_fd = instance->sigchld_pipe[1];
+
+	return (0);
+}
+
+static void
+qdevice_heuristics_worker_sigchld_pipe_drain(struct qdevice_heuristics_worker_instance *instance)
+{
+	char buf[64];
+
+	while (read(instance->sigchld_pipe[0], buf, sizeof(buf)) > 0) {
+	}
+}
+
 static void
 qdevice_heuristics_worker_signal_handlers_register(void)
 {
 	struct sigaction act;
 
-	act.sa_handler = SIG_DFL;
+	if (qdevice_heuristics_worker_sigchld_pipe_fd != -1) {
+		act.sa_handler = qdevice_heuristics_worker_sigchld_handler;
+		act.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+	} else {
+		act.sa_handler = SIG_DFL;
+		act.sa_flags = SA_RESTART;
+	}
 	sigemptyset(&act.sa_mask);
-	act.sa_flags = SA_RESTART;
 
 	sigaction(SIGCHLD, &act, NULL);
 
@@ -131,7 +197,8 @@ qdevice_heuristics_worker_kill_list_timer_callback(void *data1, void *data2)
 
 	instance = (struct qdevice_heuristics_worker_instance *)data1;
 
-	if (process_list_process_kill_list(&instance->main_process_list) != 0) {
+	if (process_list_process_kill_list(&instance->main_process_list) != 0 ||
+	    process_list_process_kill_list(&instance->probe_process_list) != 0) {
 		qdevice_heuristics_worker_log_printf(instance, LOG_CRIT,
 		    "qdevice_heuristics_worker_kill_list_timer_callback: process kill list failed. "
 		    "Shutting down worker");
@@ -140,7 +207,8 @@ qdevice_heuristics_worker_kill_list_timer_callback(void *data1, void *data2)
 		return (0);
 	}
 
-	kill_list_size = process_list_get_kill_list_items(&instance->main_process_list);
+	kill_list_size = process_list_get_kill_list_items(&instance->main_process_list) +
+	    process_list_get_kill_list_items(&instance->probe_process_list);
 
 	if (kill_list_size > 0) {
 		qdevice_heuristics_worker_log_printf(instance, LOG_DEBUG,
@@ -153,6 +221,27 @@ qdevice_heuristics_worker_kill_list_timer_callback(void *data1, void *data2)
 	return (-1);
 }
 
+/*
+ * Stop processes of current exec once result is known. Processes which are still
+ * running are moved to the kill list and SIGTERM is sent right away. SIGKILL is sent
+ * by kill list timer if they don't exit in kill_list_interval.
+ */
+static void
+qdevice_heuristics_worker_exec_stop_processes(struct qdevice_heuristics_worker_instance *instance)
+{
+
+	process_list_move_active_entries_to_kill_list(&instance->main_process_list);
+
+	if (process_list_terminate_kill_list(&instance->main_process_list) != 0) {
+		qdevice_heuristics_worker_log_printf(instance, LOG_WARNING,
+		    "Can't send SIGTERM to processes in kill list");
+	}
+
+	if (instance->kill_list_timer != NULL) {
+		timer_list_entry_reschedule(&instance->main_timer_list, instance->kill_list_timer);
+	}
+}
+
 int
 qdevice_heuristics_worker_exec_timeout_timer_callback(void *data1, void *data2)
 {
@@ -163,7 +252,9 @@ qdevice_heuristics_worker_exec_timeout_timer_callback(void *data1, void *data2)
 	qdevice_heuristics_worker_log_printf(instance, LOG_WARNING,
 	    "Not all heuristics execs finished on time");
 
-	process_list_move_active_entries_to_kill_list(&instance->main_process_list);
+	qdevice_heuristics_worker_exec_stop_processes(instance);
+	qdevice_heuristics_worker_probe_list_check_finish(instance, 1);
+	qdevice_heuristics_worker_check_list_check_finish(instance, 1);
 
 	instance->exec_timeout_timer = NULL;
 
@@ -177,28 +268,236 @@ qdevice_heuristics_worker_exec_timeout_timer_callback(void *data1, void *data2)
 	return (0);
 }
 
+static uint64_t
+qdevice_heuristics_worker_now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+void
+qdevice_heuristics_worker_exec_list_results_reset(struct qdevice_heuristics_worker_instance *instance)
+{
+	struct qdevice_heuristics_exec_list_entry *entry;
+
+	instance->exec_start_time = qdevice_heuristics_worker_now_ms();
+
+	TAILQ_FOREACH(entry, &instance->exec_list, entries) {
+		entry->last_result = QDEVICE_HEURISTICS_EXEC_ENTRY_RESULT_NOT_FINISHED;
+		entry->last_exit_status = -1;
+		entry->last_term_signal = 0;
+		entry->last_duration = 0;
+	}
+}
+
+/*
+ * Update result of exec list entry from process list, probe or builtin check.
+ * Duration of processes is taken from process list, duration of persistent processes
+ * and builtin checks (and of not finished processes) is time elapsed since exec start.
+ */
+static void
+qdevice_heuristics_worker_exec_list_entry_update_result(
+    struct qdevice_heuristics_worker_instance *instance,
+    struct qdevice_heuristics_exec_list_entry *entry, uint64_t now)
+{
+	struct process_list_entry *plist_entry;
+	struct qdevice_heuristics_worker_probe *probe;
+	struct qdevice_heuristics_worker_check *check;
+
+	entry->last_duration = (uint32_t)(now - instance->exec_start_time);
+
+	switch (entry->type) {
+	case QDEVICE_HEURISTICS_EXEC_TYPE_EXEC:
+		TAILQ_FOREACH(plist_entry, &instance->main_process_list.active_list, entries) {
+			if (strcmp(plist_entry->name, entry->name) == 0) {
+				break;
+			}
+		}
+
+		if (plist_entry == NULL ||
+		    plist_entry->state != PROCESS_LIST_ENTRY_STATE_FINISHED) {
+			return ;
+		}
+
+		entry->last_exit_status = process_list_entry_get_exit_code(plist_entry);
+		entry->last_term_signal = process_list_entry_get_term_signal(plist_entry);
+		entry->last_duration = process_list_entry_get_duration(plist_entry);
+		entry->last_result = (entry->last_exit_status == 0 ?
+		    QDEVICE_HEURISTICS_EXEC_ENTRY_RESULT_PASS :
+		    QDEVICE_HEURISTICS_EXEC_ENTRY_RESULT_FAIL);
+		break;
+	case QDEVICE_HEURISTICS_EXEC_TYPE_PERSISTENT:
+		TAILQ_FOREACH(probe, &instance->probe_list, entries) {
+			if (strcmp(probe->name, entry->name) == 0) {
+				break;
+			}
+		}
+
+		if (probe == NULL || probe->check_seq_number != instance->last_exec_seq_number) {
+			return ;
+		}
+
+		if (probe->check_state == QDEVICE_HEURISTICS_WORKER_PROBE_CHECK_STATE_PASS) {
+			entry->last_result = QDEVICE_HEURISTICS_EXEC_ENTRY_RESULT_PASS;
+		} else if (probe->check_state == QDEVICE_HEURISTICS_WORKER_PROBE_CHECK_STATE_FAIL) {
+			entry->last_result = QDEVICE_HEURISTICS_EXEC_ENTRY_RESULT_FAIL;
+		}
+		break;
+	case QDEVICE_HEURISTICS_EXEC_TYPE_BUILTIN:
+		TAILQ_FOREACH(check, &instance->check_list, entries) {
+			if (strcmp(check->name, entry->name) == 0) {
+				break;
+			}
+		}
+
+		if (check == NULL || check->check_seq_number != instance->last_exec_seq_number) {
+			return ;
+		}
+
+		if (check->check_state == QDEVICE_HEURISTICS_WORKER_CHECK_STATE_PASS) {
+			entry->last_result = QDEVICE_HEURISTICS_EXEC_ENTRY_RESULT_PASS;
+		} else if (check->check_state == QDEVICE_HEURISTICS_WORKER_CHECK_STATE_FAIL) {
+			entry->last_result = QDEVICE_HEURISTICS_EXEC_ENTRY_RESULT_FAIL;
+		}
+		break;
+	}
+}
+
+/*
+ * Store result, exit status and duration of newly finished exec list entries
+ */
+void
+qdevice_heuristics_worker_exec_list_results_update(struct qdevice_heuristics_worker_instance *instance)
+{
+	struct qdevice_heuristics_exec_list_entry *entry;
+	uint64_t now;
+
+	now = qdevice_heuristics_worker_now_ms();
+
+	TAILQ_FOREACH(entry, &instance->exec_list, entries) {
+		if (entry->last_result == QDEVICE_HEURISTICS_EXEC_ENTRY_RESULT_NOT_FINISHED) {
+			qdevice_heuristics_worker_exec_list_entry_update_result(instance, entry, now);
+		}
+	}
+}
+
+/*
+ * Make sure poll_fds can hold command input, SIGCHLD pipe and fd of every probe and
+ * builtin check
+ */
+static int
+qdevice_heuristics_worker_poll_fds_ensure_size(struct qdevice_heuristics_worker_instance *instance)
+{
+	struct qdevice_heuristics_worker_probe *probe;
+	struct qdevice_heuristics_worker_check *check;
+	struct pollfd *new_poll_fds;
+	size_t needed;
+
+	needed = 2;
+
+	TAILQ_FOREACH(probe, &instance->probe_list, entries) {
+		needed++;
+	}
+
+	TAILQ_FOREACH(check, &instance->check_list, entries) {
+		needed++;
+	}
+
+	if (needed <= instance->max_poll_fds) {
+		return (0);
+	}
+
+	new_poll_fds = realloc(instance->poll_fds, sizeof(*instance->poll_fds) * needed);
+	if (new_poll_fds == NULL) {
+		return (-1);
+	}
+
+	instance->poll_fds = new_poll_fds;
+	instance->max_poll_fds = needed;
+
+	return (0);
+}
+
 static int
 qdevice_heuristics_worker_poll(struct qdevice_heuristics_worker_instance *instance)
 {
 	int poll_res;
-	struct pollfd poll_input_fd;
+	struct pollfd *poll_fds;
+	struct pollfd *poll_input_fd;
+	nfds_t no_poll_fds;
+	nfds_t probe_poll_fds_start;
+	nfds_t check_poll_fds_start;
 	uint32_t timeout;
 	int plist_summary;
+	int probe_summary;
+	int check_summary;
+
+	if (qdevice_heuristics_worker_poll_fds_ensure_size(instance) != 0) {
+		qdevice_heuristics_worker_log_printf(instance, LOG_CRIT,
+		    "qdevice_heuristics_worker_poll: Can't alloc poll fds. Shutting down worker");
+
+		return (-1);
+	}
 
 	/*
 	 * Poll command input
 	 */
-	poll_input_fd.fd = QDEVICE_HEURISTICS_WORKER_CMD_IN_FD;
-	poll_input_fd.events = POLLIN;
-	poll_input_fd.revents = 0;
+	poll_fds = instance->poll_fds;
+	poll_input_fd = &poll_fds[0];
+	poll_input_fd->fd = QDEVICE_HEURISTICS_WORKER_CMD_IN_FD;
+	poll_input_fd->events = POLLIN;
+	poll_input_fd->revents = 0;
+	no_poll_fds = 1;
 
 	timeout = timer_list_time_to_expire_ms(&instance->main_timer_list);
-	if (timeout > QDEVICE_MIN_HEURISTICS_TIMEOUT) {
+
+	if (instance->sigchld_pipe[0] != -1) {
+		/*
+		 * Exit of child process wakes up poll
+		 */
+		poll_fds[1].fd = instance->sigchld_pipe[0];
+		poll_fds[1].events = POLLIN;
+		poll_fds[1].revents = 0;
+		no_poll_fds++;
+	} else if (timeout > QDEVICE_MIN_HEURISTICS_TIMEOUT) {
+		/*
+		 * SIGCHLD notification is not available, check processes periodically
+		 */
 		timeout = QDEVICE_MIN_HEURISTICS_TIMEOUT;
 	}
 
-	if ((poll_res = poll(&poll_input_fd, 1, timeout)) >= 0) {
-		if (poll_input_fd.revents & POLLIN) {
+	if (timeout > INT_MAX) {
+		timeout = INT_MAX;
+	}
+
+	/*
+	 * Stdout of persistent processes
+	 */
+	probe_poll_fds_start = no_poll_fds;
+	no_poll_fds += qdevice_heuristics_worker_probe_list_poll_fds_set(instance,
+	    &poll_fds[probe_poll_fds_start], instance->max_poll_fds - probe_poll_fds_start);
+
+	/*
+	 * Sockets and pipes of builtin checks
+	 */
+	check_poll_fds_start = no_poll_fds;
+	no_poll_fds += qdevice_heuristics_worker_check_list_poll_fds_set(instance,
+	    &poll_fds[check_poll_fds_start], instance->max_poll_fds - check_poll_fds_start);
+
+	if ((poll_res = poll(poll_fds, no_poll_fds, (int)timeout)) >= 0) {
+		if (probe_poll_fds_start > 1 && poll_fds[1].revents & POLLIN) {
+			qdevice_heuristics_worker_sigchld_pipe_drain(instance);
+		}
+
+		qdevice_heuristics_worker_probe_list_poll_fds_process(instance,
+		    &poll_fds[probe_poll_fds_start], check_poll_fds_start - probe_poll_fds_start);
+		qdevice_heuristics_worker_check_list_poll_fds_process(instance,
+		    &poll_fds[check_poll_fds_start], no_poll_fds - check_poll_fds_start);
+
+		if (poll_input_fd->revents & POLLIN) {
 			/*
 			 * POLLIN
 			 */
@@ -207,7 +506,7 @@ qdevice_heuristics_worker_poll(struct qdevice_heuristics_worker_instance *instan
 			}
 		}
 
-		if (poll_input_fd.revents & POLLOUT) {
+		if (poll_input_fd->revents & POLLOUT) {
 			/*
 			 * Pollout shouldn't happen (critical error)
 			 */
@@ -217,8 +516,8 @@ qdevice_heuristics_worker_poll(struct qdevice_heuristics_worker_instance *instan
 			return (-1);
 		}
 
-		if (poll_input_fd.revents & (POLLERR|POLLHUP|POLLNVAL) &&
-		    !(poll_input_fd.revents & (POLLIN|POLLOUT))) {
+		if (poll_input_fd->revents & (POLLERR|POLLHUP|POLLNVAL) &&
+		    !(poll_input_fd->revents & (POLLIN|POLLOUT))) {
 			/*
 			 * Qdevice closed pipe
 			 */
@@ -227,15 +526,28 @@ qdevice_heuristics_worker_poll(struct qdevice_heuristics_worker_instance *instan
 		}
 	}
 
-	if (process_list_waitpid(&instance->main_process_list) != 0) {
+	if (process_list_waitpid(&instance->main_process_list) != 0 ||
+	    process_list_waitpid(&instance->probe_process_list) != 0) {
 		qdevice_heuristics_worker_log_printf(instance, LOG_CRIT,
 		    "qdevice_heuristics_worker_poll: Waitpid failed. Shutting down worker");
 
 		return (-1);
 	}
 
+	qdevice_heuristics_worker_probe_list_update(instance);
+
 	if (instance->exec_timeout_timer != NULL) {
+		qdevice_heuristics_worker_exec_list_results_update(instance);
+
 		plist_summary = process_list_get_summary_result_short(&instance->main_process_list);
+		probe_summary = qdevice_heuristics_worker_probe_list_get_summary_result_short(instance);
+		check_summary = qdevice_heuristics_worker_check_list_get_summary_result_short(instance);
+
+		if (plist_summary == 1 || probe_summary == 1 || check_summary == 1) {
+			plist_summary = 1;
+		} else if (plist_summary == -1 || probe_summary == -1 || check_summary == -1) {
+			plist_summary = -1;
+		}
 
 		switch (plist_summary) {
 		case -1:
@@ -253,6 +565,8 @@ qdevice_heuristics_worker_poll(struct qdevice_heuristics_worker_instance *instan
 			}
 
 			process_list_move_active_entries_to_kill_list(&instance->main_process_list);
+			qdevice_heuristics_worker_probe_list_check_finish(instance, 0);
+			qdevice_heuristics_worker_check_list_check_finish(instance, 0);
 
 			timer_list_entry_delete(&instance->main_timer_list, instance->exec_timeout_timer);
 			instance->exec_timeout_timer = NULL;
@@ -260,14 +574,17 @@ qdevice_heuristics_worker_poll(struct qdevice_heuristics_worker_instance *instan
 			break;
 		case 1:
 			/*
-			 * Some processes failed
+			 * Some process or check failed. Heuristics pass only if all of
+			 * them pass, so report fail right away and stop the rest
 			 */
 			if (qdevice_heuristics_worker_cmd_write_exec_result(instance,
 			    instance->last_exec_seq_number, QDEVICE_HEURISTICS_EXEC_RESULT_FAIL) != 0) {
 				return (-1);
 			}
 
-			process_list_move_active_entries_to_kill_list(&instance->main_process_list);
+			qdevice_heuristics_worker_exec_stop_processes(instance);
+			qdevice_heuristics_worker_probe_list_check_finish(instance, 0);
+			qdevice_heuristics_worker_check_list_check_finish(instance, 0);
 
 			timer_list_entry_delete(&instance->main_timer_list, instance->exec_timeout_timer);
 			instance->exec_timeout_timer = NULL;
@@ -303,11 +620,30 @@ qdevice_heuristics_worker_start(size_t ipc_max_send_receive_size, int use_execvp
 
 	dynar_init(&instance.cmd_in_buffer, ipc_max_send_receive_size);
 	dynar_init(&instance.cmd_out_buffer, ipc_max_send_receive_size);
+	dynar_init(&instance.log_str_buffer, ipc_max_send_receive_size);
 	dynar_init(&instance.log_out_buffer, ipc_max_send_receive_size);
 
 	process_list_init(&instance.main_process_list, max_processes, use_execvp,
 	    qdevice_heuristics_worker_process_list_notify, (void *)&instance);
 
+	process_list_init(&instance.probe_process_list, max_processes, use_execvp,
+	    qdevice_heuristics_worker_process_list_notify, (void *)&instance);
+	process_list_set_use_stdio_pipes(&instance.probe_process_list, 1);
+	qdevice_heuristics_worker_probe_list_init(&instance.probe_list);
+	qdevice_heuristics_worker_check_list_init(&instance.check_list);
+
+	/*
+	 * Command input, SIGCHLD pipe and stdout of every persistent process. Grown
+	 * when more builtin checks are configured
+	 */
+	instance.max_poll_fds = 2 + max_processes;
+	instance.poll_fds = malloc(sizeof(*instance.poll_fds) * instance.max_poll_fds);
+	if (instance.poll_fds == NULL) {
+		qdevice_heuristics_worker_log_printf(&instance, LOG_CRIT,
+		    "Can't alloc poll fds");
+		return ;
+	}
+
 	timer_list_init(&instance.main_timer_list);
 	instance.kill_list_timer = timer_list_add(&instance.main_timer_list,
 	    kill_list_interval, qdevice_heuristics_worker_kill_list_timer_callback,
@@ -323,6 +659,11 @@ qdevice_heuristics_worker_start(size_t ipc_max_send_receive_size, int use_execvp
 
 	qdevice_heuristics_exec_list_init(&instance.exec_list);
 
+	if (qdevice_heuristics_worker_sigchld_pipe_init(&instance) != 0) {
+		qdevice_heuristics_worker_log_printf(&instance, LOG_WARNING,
+		    "Can't create SIGCHLD pipe. Falling back to periodic process check");
+	}
+
 	qdevice_heuristics_worker_signal_handlers_register();
 
 	qdevice_heuristics_worker_log_printf(&instance, LOG_DEBUG, "Heuristic worker initialized");
@@ -334,6 +675,8 @@ qdevice_heuristics_worker_start(size_t ipc_max_send_receive_size, int use_execvp
 	    "requested");
 
 	qdevice_heuristics_exec_list_free(&instance.exec_list);
+	qdevice_heuristics_worker_probe_list_free(&instance);
+	qdevice_heuristics_worker_check_list_free(&instance);
 
 	timer_list_free(&instance.main_timer_list);
 
@@ -345,9 +688,23 @@ qdevice_heuristics_worker_start(size_t ipc_max_send_receive_size, int use_execvp
 		    "Not all process exited");
 	}
 
+	if (process_list_killall(&instance.probe_process_list, kill_list_interval) != 0) {
+		qdevice_heuristics_worker_log_printf(&instance, LOG_WARNING,
+		    "Not all persistent process exited");
+	}
+
 	process_list_free(&instance.main_process_list);
+	process_list_free(&instance.probe_process_list);
+	free(instance.poll_fds);
+
+	if (instance.sigchld_pipe[0] != -1) {
+		qdevice_heuristics_worker_sigchld_pipe_fd = -1;
+		close(instance.sigchld_pipe[0]);
+		close(instance.sigchld_pipe[1]);
+	}
 
 	dynar_destroy(&instance.cmd_in_buffer);
 	dynar_destroy(&instance.cmd_out_buffer);
+	dynar_destroy(&instance.log_str_buffer);
 	dynar_destroy(&instance.log_out_buffer);
 }
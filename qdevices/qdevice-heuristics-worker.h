@@ -35,6 +35,8 @@
 #ifndef _QDEVICE_HEURISTICS_WORKER_H_
 #define _QDEVICE_HEURISTICS_WORKER_H_
 
+#include "qdevice-heuristics-worker-instance.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -48,6 +50,12 @@ void		qdevice_heuristics_worker_start(size_t ipc_max_send_receive_size,
 
 int		qdevice_heuristics_worker_exec_timeout_timer_callback(void *data1, void *data2);
 
+void		qdevice_heuristics_worker_exec_list_results_reset(
+    struct qdevice_heuristics_worker_instance *instance);
+
+void		qdevice_heuristics_worker_exec_list_results_update(
+    struct qdevice_heuristics_worker_instance *instance);
+
 #ifdef __cplusplus
 }
 #endif
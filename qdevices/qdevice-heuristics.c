@@ -39,6 +39,7 @@
 #include <poll.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "log.h"
@@ -132,6 +133,8 @@ qdevice_heuristics_init(struct qdevice_heuristics_instance *instance,
 		    advanced_settings->heuristics_ipc_max_send_receive_size);
 		dynar_init(&instance->cmd_in_buffer,
 		    advanced_settings->heuristics_ipc_max_send_receive_size);
+		qdevice_heuristics_history_init(&instance->history,
+		    advanced_settings->heuristics_history_size);
 	}
 }
 
@@ -179,6 +182,7 @@ qdevice_heuristics_exec(struct qdevice_heuristics_instance *instance, int sync_i
 
 	instance->expected_reply_seq_number++;
 	instance->waiting_for_result = 1;
+	instance->cached_result_reuse_pending = 0;
 
 	if (sync_in_progress) {
 		timeout = instance->sync_timeout;
@@ -190,6 +194,99 @@ qdevice_heuristics_exec(struct qdevice_heuristics_instance *instance, int sync_i
 	    instance->expected_reply_seq_number));
 }
 
+static uint64_t
+qdevice_heuristics_now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+/*
+ * Same as qdevice_heuristics_exec, but if cached result is fresh enough, it is
+ * reused instead of executing heuristics. Result is delivered to notifiers by
+ * qdevice_heuristics_result_cache_deliver (called before next poll), so callers
+ * see the same asynchronous behavior as for executed heuristics.
+ */
+int
+qdevice_heuristics_exec_or_reuse(struct qdevice_heuristics_instance *instance,
+    int sync_in_progress)
+{
+	uint64_t age;
+
+	if (instance->result_max_age == 0 ||
+	    qdevice_heuristics_result_cache_get_age(instance, &age) != 0 ||
+	    age > instance->result_max_age) {
+		return (qdevice_heuristics_exec(instance, sync_in_progress));
+	}
+
+	log(LOG_DEBUG, "Reusing heuristics result %s received %"PRIu64" ms ago",
+	    qdevice_heuristics_exec_result_to_str(instance->cached_result), age);
+
+	instance->expected_reply_seq_number++;
+	instance->waiting_for_result = 1;
+	instance->cached_result_reuse_pending = 1;
+
+	return (0);
+}
+
+void
+qdevice_heuristics_result_cache_set(struct qdevice_heuristics_instance *instance,
+    enum qdevice_heuristics_exec_result exec_result)
+{
+
+	instance->cached_result_valid = 1;
+	instance->cached_result = exec_result;
+	instance->cached_result_time = qdevice_heuristics_now_ms();
+}
+
+/*
+ * Returns 0 and age of cached result in ms, or -1 if there is no cached result
+ */
+int
+qdevice_heuristics_result_cache_get_age(const struct qdevice_heuristics_instance *instance,
+    uint64_t *age)
+{
+
+	if (!instance->cached_result_valid) {
+		return (-1);
+	}
+
+	*age = qdevice_heuristics_now_ms() - instance->cached_result_time;
+
+	return (0);
+}
+
+int
+qdevice_heuristics_result_cache_deliver(struct qdevice_heuristics_instance *instance)
+{
+
+	if (!instance->cached_result_reuse_pending) {
+		return (0);
+	}
+
+	instance->cached_result_reuse_pending = 0;
+
+	if (!instance->waiting_for_result) {
+		return (0);
+	}
+
+	instance->waiting_for_result = 0;
+	instance->cached_result_reused++;
+
+	if (qdevice_heuristics_result_notifier_notify(&instance->exec_result_notifier_list,
+	    (void *)instance, instance->expected_reply_seq_number,
+	    instance->cached_result) != 0) {
+		log(LOG_DEBUG, "qdevice_heuristics_result_notifier_notify returned non-zero result");
+
+		return (-1);
+	}
+
+	return (0);
+}
+
 int
 qdevice_heuristics_waiting_for_result(const struct qdevice_heuristics_instance *instance)
 {
@@ -208,6 +305,13 @@ qdevice_heuristics_change_exec_list(struct qdevice_heuristics_instance *instance
 
 	qdevice_heuristics_exec_list_free(&instance->exec_list);
 
+	/*
+	 * Result of previous exec list must not be reused
+	 */
+	instance->cached_result_valid = 0;
+
+	qdevice_heuristics_history_prune(&instance->history, new_exec_list);
+
 	if (new_exec_list != NULL) {
 		if (qdevice_heuristics_exec_list_clone(&instance->exec_list, new_exec_list) != 0) {
 			log(LOG_ERR, "Can't clone exec list");
@@ -54,6 +54,19 @@ extern void		qdevice_heuristics_destroy(struct qdevice_heuristics_instance *inst
 extern int		qdevice_heuristics_exec(struct qdevice_heuristics_instance *instance,
     int sync_in_progress);
 
+extern int		qdevice_heuristics_exec_or_reuse(
+    struct qdevice_heuristics_instance *instance, int sync_in_progress);
+
+extern void		qdevice_heuristics_result_cache_set(
+    struct qdevice_heuristics_instance *instance,
+    enum qdevice_heuristics_exec_result exec_result);
+
+extern int		qdevice_heuristics_result_cache_get_age(
+    const struct qdevice_heuristics_instance *instance, uint64_t *age);
+
+extern int		qdevice_heuristics_result_cache_deliver(
+    struct qdevice_heuristics_instance *instance);
+
 extern int		qdevice_heuristics_waiting_for_result(
     const struct qdevice_heuristics_instance *instance);
 
@@ -68,23 +68,80 @@ qdevice_instance_destroy(struct qdevice_instance *instance)
 	return (0);
 }
 
-int
-qdevice_instance_configure_from_cmap_heuristics(struct qdevice_instance *instance)
+/*
+ * Add commands from keys with given prefix (quorum.device.heuristics.exec_ or
+ * quorum.device.heuristics.persistent_exec_ or quorum.device.heuristics.check_) into
+ * exec_list
+ */
+static int
+qdevice_instance_configure_from_cmap_heuristics_execs(struct qdevice_instance *instance,
+    const char *prefix, enum qdevice_heuristics_exec_type exec_type,
+    struct qdevice_heuristics_exec_list *exec_list)
 {
-	char *str;
-	long long int lli;
-	int i;
-	int res;
 	cs_error_t cs_err;
 	cmap_iter_handle_t iter_handle;
 	char key_name[CMAP_KEYNAME_MAXLEN + 1];
 	size_t value_len;
 	cmap_value_types_t type;
+	struct qdevice_heuristics_exec_list_entry *entry;
+	char *command;
+	const char *exec_name;
+
+	cs_err = cmap_iter_init(instance->cmap_handle, prefix, &iter_handle);
+	if (cs_err != CS_OK) {
+		log(LOG_ERR, "Can't iterate %s keys. Error %s", prefix, cs_strerror(cs_err));
+
+		return (-1);
+	}
+
+	while ((cs_err = cmap_iter_next(instance->cmap_handle, iter_handle, key_name,
+	    &value_len, &type)) == CS_OK) {
+		if (type != CMAP_VALUETYPE_STRING) {
+			log(LOG_WARNING, "%s key is not of string type. Ignoring", key_name);
+			continue ;
+		}
+
+		exec_name = key_name + strlen(prefix);
+		if (exec_name[0] == '\0' || strchr(exec_name, '.') != NULL) {
+			log(LOG_WARNING, "%s key is not correct heuristics exec name. Ignoring", key_name);
+			continue ;
+		}
+
+		if (qdevice_heuristics_exec_list_find_name(exec_list, exec_name) != NULL) {
+			log(LOG_WARNING, "Heuristics exec name of %s key is already used. Ignoring",
+			    key_name);
+			continue ;
+		}
+
+		cs_err = cmap_get_string(instance->cmap_handle, key_name, &command);
+		if (cs_err != CS_OK) {
+			log(LOG_WARNING, "Can't get value of %s key. Ignoring", key_name);
+			continue ;
+		}
+
+		if ((entry = qdevice_heuristics_exec_list_add(exec_list, (char *)exec_name,
+		    command)) == NULL) {
+			log(LOG_WARNING, "Can't store value of %s key into list. Ignoring", key_name);
+		} else {
+			entry->type = exec_type;
+		}
+
+		free(command);
+	}
+
+	cmap_iter_finalize(instance->cmap_handle, iter_handle);
+
+	return (0);
+}
+
+int
+qdevice_instance_configure_from_cmap_heuristics(struct qdevice_instance *instance)
+{
+	char *str;
+	long long int lli;
+	int i;
 	struct qdevice_heuristics_exec_list tmp_exec_list;
 	struct qdevice_heuristics_exec_list *exec_list;
-	char *command;
-	char exec_name[CMAP_KEYNAME_MAXLEN + 1];
-	char tmp_key[CMAP_KEYNAME_MAXLEN + 1];
 	size_t no_execs;
 	int send_exec_list;
 
@@ -145,6 +202,24 @@ qdevice_instance_configure_from_cmap_heuristics(struct qdevice_instance *instanc
 		free(str);
 	}
 
+	instance->heuristics_instance.result_max_age = 0;
+	if (cmap_get_string(instance->cmap_handle,
+	    "quorum.device.heuristics.result_max_age", &str) == CS_OK) {
+		if (utils_strtonum(str, 0,
+		    instance->advanced_settings->heuristics_max_interval, &lli) == -1) {
+			log(LOG_ERR, "heuristics.result_max_age must be valid number in "
+			    "range <0,%"PRIu32">",
+			    instance->advanced_settings->heuristics_max_interval);
+
+			free(str);
+			return (-1);
+		} else {
+			instance->heuristics_instance.result_max_age = lli;
+		}
+
+		free(str);
+	}
+
 	instance->heuristics_instance.mode = QDEVICE_DEFAULT_HEURISTICS_MODE;
 
 	if (cmap_get_string(instance->cmap_handle, "quorum.device.heuristics.mode", &str) == CS_OK) {
@@ -180,40 +255,20 @@ qdevice_instance_configure_from_cmap_heuristics(struct qdevice_instance *instanc
 		/*
 		 * Walk thru list of commands to exec
 		 */
-		cs_err = cmap_iter_init(instance->cmap_handle, "quorum.device.heuristics.exec_", &iter_handle);
-		if (cs_err != CS_OK) {
-			log(LOG_ERR, "Can't iterate quorum.device.heuristics.exec_ keys. "
-			    "Error %s", cs_strerror(cs_err));
+		if (qdevice_instance_configure_from_cmap_heuristics_execs(instance,
+		    "quorum.device.heuristics.exec_", QDEVICE_HEURISTICS_EXEC_TYPE_EXEC,
+		    &tmp_exec_list) != 0 ||
+		    qdevice_instance_configure_from_cmap_heuristics_execs(instance,
+		    "quorum.device.heuristics.persistent_exec_",
+		    QDEVICE_HEURISTICS_EXEC_TYPE_PERSISTENT, &tmp_exec_list) != 0 ||
+		    qdevice_instance_configure_from_cmap_heuristics_execs(instance,
+		    "quorum.device.heuristics.check_", QDEVICE_HEURISTICS_EXEC_TYPE_BUILTIN,
+		    &tmp_exec_list) != 0) {
+			qdevice_heuristics_exec_list_free(&tmp_exec_list);
 
 			return (-1);
 		}
 
-		while ((cs_err = cmap_iter_next(instance->cmap_handle, iter_handle, key_name,
-		    &value_len, &type)) == CS_OK) {
-			if (type != CMAP_VALUETYPE_STRING) {
-				log(LOG_WARNING, "%s key is not of string type. Ignoring", key_name);
-				continue ;
-			}
-
-			res = sscanf(key_name, "quorum.device.heuristics.exec_%[^.]%s", exec_name, tmp_key);
-			if (res != 1) {
-				log(LOG_WARNING, "%s key is not correct heuristics exec name. Ignoring", key_name);
-				continue ;
-			}
-
-			cs_err = cmap_get_string(instance->cmap_handle, key_name, &command);
-			if (cs_err != CS_OK) {
-				log(LOG_WARNING, "Can't get value of %s key. Ignoring", key_name);
-				continue ;
-			}
-
-			if (qdevice_heuristics_exec_list_add(&tmp_exec_list, exec_name, command) == NULL) {
-				log(LOG_WARNING, "Can't store value of %s key into list. Ignoring", key_name);
-			}
-
-			free(command);
-		}
-
 		no_execs = qdevice_heuristics_exec_list_size(&tmp_exec_list);
 
 		if (no_execs == 0) {
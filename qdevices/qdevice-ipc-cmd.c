@@ -33,6 +33,7 @@
  */
 
 #include "log.h"
+#include "qdevice-heuristics.h"
 #include "qdevice-ipc-cmd.h"
 #include "qdevice-model.h"
 #include "dynar-str.h"
@@ -248,18 +249,311 @@ qdevice_ipc_cmd_status_add_heuristics(struct qdevice_instance *instance, struct
     int verbose)
 {
 
+	struct qdevice_heuristics_instance *heuristics_instance;
+	struct qdevice_heuristics_exec_list_entry *entry;
+	uint64_t age;
+
 	if (!verbose) {
 		return (1);
 	}
 
-	return (dynar_str_catf(outbuf, "Heuristics:\t\t%s\n",
-	    qdevice_heuristics_mode_to_str(instance->heuristics_instance.mode)) != 0);
+	heuristics_instance = &instance->heuristics_instance;
+
+	if (dynar_str_catf(outbuf, "Heuristics:\t\t%s\n",
+	    qdevice_heuristics_mode_to_str(heuristics_instance->mode)) == -1) {
+		return (0);
+	}
+
+	TAILQ_FOREACH(entry, &heuristics_instance->exec_list, entries) {
+		if (dynar_str_catf(outbuf, "    %s:\t%s", entry->name,
+		    qdevice_heuristics_exec_entry_result_to_str(entry->last_result)) == -1) {
+			return (0);
+		}
+
+		if (entry->last_exit_status != -1 &&
+		    dynar_str_catf(outbuf, " (exit status %"PRId32")",
+		    entry->last_exit_status) == -1) {
+			return (0);
+		}
+
+		if (entry->last_term_signal != 0 &&
+		    dynar_str_catf(outbuf, " (signal %"PRId32")",
+		    entry->last_term_signal) == -1) {
+			return (0);
+		}
+
+		if (dynar_str_catf(outbuf, ", %"PRIu32" ms\n", entry->last_duration) == -1) {
+			return (0);
+		}
+	}
+
+	if (heuristics_instance->result_max_age == 0) {
+		return (1);
+	}
+
+	if (dynar_str_catf(outbuf, "Heuristics cache:\tmax age %"PRIu32" ms, reused %"PRIu64
+	    " times", heuristics_instance->result_max_age,
+	    heuristics_instance->cached_result_reused) == -1) {
+		return (0);
+	}
+
+	if (qdevice_heuristics_result_cache_get_age(heuristics_instance, &age) == 0 &&
+	    dynar_str_catf(outbuf, ", last result %s %"PRIu64" ms ago",
+	    qdevice_heuristics_exec_result_to_str(heuristics_instance->cached_result), age) == -1) {
+		return (0);
+	}
+
+	return (dynar_str_catf(outbuf, "\n") != -1);
+}
+
+static int
+qdevice_ipc_cmd_status_json_add_heuristics_cache(struct qdevice_instance *instance,
+    struct dynar *outbuf)
+{
+	struct qdevice_heuristics_instance *heuristics_instance;
+	uint64_t age;
+
+	heuristics_instance = &instance->heuristics_instance;
+
+	if (heuristics_instance->result_max_age == 0) {
+		return (1);
+	}
+
+	if (dynar_str_catf(outbuf, ",\"heuristics_cache\":{\"max_age\":%"PRIu32
+	    ",\"reused\":%"PRIu64, heuristics_instance->result_max_age,
+	    heuristics_instance->cached_result_reused) == -1) {
+		return (0);
+	}
+
+	if (qdevice_heuristics_result_cache_get_age(heuristics_instance, &age) == 0 &&
+	    dynar_str_catf(outbuf, ",\"last_result\":\"%s\",\"last_result_age\":%"PRIu64,
+	    qdevice_heuristics_exec_result_to_str(heuristics_instance->cached_result), age) == -1) {
+		return (0);
+	}
+
+	return (dynar_str_cat(outbuf, "}") == 0);
+}
+
+static int
+qdevice_ipc_cmd_status_json_add_heuristics_exec_list(struct qdevice_instance *instance,
+    struct dynar *outbuf)
+{
+	struct qdevice_heuristics_exec_list_entry *entry;
+	int first;
+
+	if (dynar_str_cat(outbuf, ",\"heuristics_exec_list\":[") != 0) {
+		return (0);
+	}
+
+	first = 1;
+	TAILQ_FOREACH(entry, &instance->heuristics_instance.exec_list, entries) {
+		if (dynar_str_cat(outbuf, (first ? "{\"name\":" : ",{\"name\":")) != 0 ||
+		    dynar_str_json_quote_cat(outbuf, entry->name) != 0 ||
+		    dynar_str_catf(outbuf, ",\"result\":\"%s\",\"exit_status\":%"PRId32
+		    ",\"term_signal\":%"PRId32",\"duration\":%"PRIu32"}",
+		    qdevice_heuristics_exec_entry_result_to_str(entry->last_result),
+		    entry->last_exit_status, entry->last_term_signal, entry->last_duration) == -1) {
+			return (0);
+		}
+
+		first = 0;
+	}
+
+	return (dynar_str_cat(outbuf, "]") == 0);
+}
+
+static int
+qdevice_ipc_cmd_status_json_add_config_node_list(struct qdevice_instance *instance,
+    struct dynar *outbuf)
+{
+	struct node_list_entry *node_info;
+	size_t zi;
+
+	if (instance->config_node_list_version_set) {
+		if (dynar_str_catf(outbuf, ",\"config_version\":%"PRIu64,
+		    instance->config_node_list_version) == -1) {
+			return (0);
+		}
+	}
+
+	if (dynar_str_cat(outbuf, ",\"configured_node_list\":[") != 0) {
+		return (0);
+	}
+
+	zi = 0;
+
+	TAILQ_FOREACH(node_info, &instance->config_node_list, entries) {
+		if ((dynar_str_catf(outbuf, "%s{\"node_id\":%"PRIu32, (zi != 0 ? "," : ""),
+		    node_info->node_id) == -1) ||
+		    (node_info->data_center_id != 0 && dynar_str_catf(outbuf,
+		    ",\"data_center_id\":%"PRIu32, node_info->data_center_id) == -1) ||
+		    (dynar_str_cat(outbuf, "}") != 0)) {
+			return (0);
+		}
+
+		zi++;
+	}
+
+	return (dynar_str_cat(outbuf, "]") == 0);
+}
+
+static int
+qdevice_ipc_cmd_status_json_add_membership_node_list(struct qdevice_instance *instance,
+    struct dynar *outbuf, int verbose)
+{
+	uint32_t u32;
+
+	if (verbose && dynar_str_catf(outbuf, ",\"ring_id\":{\"node_id\":%"PRIu32
+	    ",\"seq\":%"PRIu64"}",
+	    instance->vq_node_list_ring_id.nodeid, instance->vq_node_list_ring_id.seq) == -1) {
+		return (0);
+	}
+
+	if (dynar_str_cat(outbuf, ",\"membership_node_list\":[") != 0) {
+		return (0);
+	}
+
+	for (u32 = 0; u32 < instance->vq_node_list_entries; u32++) {
+		if (dynar_str_catf(outbuf, "%s%"PRIu32, (u32 != 0 ? "," : ""),
+		    instance->vq_node_list[u32]) == -1) {
+			return (0);
+		}
+	}
+
+	return (dynar_str_cat(outbuf, "]") == 0);
+}
+
+static int
+qdevice_ipc_cmd_status_json_add_quorum_node_list(struct qdevice_instance *instance,
+    struct dynar *outbuf, int verbose)
+{
+	uint32_t u32;
+	votequorum_node_t *node;
+	int first;
+
+	if (!verbose) {
+		return (1);
+	}
+
+	if (dynar_str_catf(outbuf, ",\"quorate\":%s,\"quorum_node_list\":[",
+	    (instance->vq_quorum_quorate ? "true" : "false")) == -1) {
+		return (0);
+	}
+
+	first = 1;
+
+	for (u32 = 0; u32 < instance->vq_quorum_node_list_entries; u32++) {
+		node = &instance->vq_quorum_node_list[u32];
+
+		if (node->nodeid == 0) {
+			continue;
+		}
+
+		if (dynar_str_catf(outbuf, "%s{\"node_id\":%"PRIu32",\"state\":\"%s\"}",
+		    (first ? "" : ","), node->nodeid,
+		    qdevice_ipc_cmd_vq_nodestate_to_str(node->state)) == -1) {
+			return (0);
+		}
+
+		first = 0;
+	}
+
+	return (dynar_str_cat(outbuf, "]") == 0);
+}
+
+static int
+qdevice_ipc_cmd_status_json_add_last_poll(struct qdevice_instance *instance,
+    struct dynar *outbuf, int verbose)
+{
+	struct tm tm_res;
+
+	if (!verbose) {
+		return (1);
+	}
+
+	if (instance->vq_last_poll == ((time_t) -1)) {
+		return (dynar_str_cat(outbuf, ",\"last_poll_call\":null") == 0);
+	}
+
+	localtime_r(&instance->vq_last_poll, &tm_res);
+
+	if (dynar_str_catf(outbuf, ",\"last_poll_call\":\"%04d-%02d-%02dT%02d:%02d:%02d\","
+	    "\"last_poll_cast_vote\":%s",
+	    tm_res.tm_year + 1900, tm_res.tm_mon + 1, tm_res.tm_mday,
+	    tm_res.tm_hour, tm_res.tm_min, tm_res.tm_sec,
+	    (instance->vq_last_poll_cast_vote ? "true" : "false")) == -1) {
+		return (0);
+	}
+
+	return (1);
+}
+
+static int
+qdevice_ipc_cmd_status_json(struct qdevice_instance *instance, struct dynar *outbuf, int verbose)
+{
+
+	if (dynar_str_catf(outbuf, "{\"model\":\"%s\",\"node_id\":%"PRIu32,
+	    qdevice_model_type_to_str(instance->model_type), instance->node_id) == -1) {
+		return (-1);
+	}
+
+	if (verbose) {
+		if (dynar_str_catf(outbuf, ",\"hb_interval\":%"PRIu32",\"sync_hb_interval\":%"PRIu32,
+		    instance->heartbeat_interval, instance->sync_heartbeat_interval) == -1) {
+			return (-1);
+		}
+	}
+
+	if (!qdevice_ipc_cmd_status_json_add_config_node_list(instance, outbuf)) {
+		return (-1);
+	}
+
+	if (verbose) {
+		if (dynar_str_catf(outbuf, ",\"heuristics\":\"%s\"",
+		    qdevice_heuristics_mode_to_str(instance->heuristics_instance.mode)) == -1) {
+			return (-1);
+		}
+
+		if (!qdevice_ipc_cmd_status_json_add_heuristics_exec_list(instance, outbuf) ||
+		    !qdevice_ipc_cmd_status_json_add_heuristics_cache(instance, outbuf)) {
+			return (-1);
+		}
+	}
+
+	if (!qdevice_ipc_cmd_status_json_add_membership_node_list(instance, outbuf, verbose) ||
+	    !qdevice_ipc_cmd_status_json_add_quorum_node_list(instance, outbuf, verbose)) {
+		return (-1);
+	}
+
+	if (verbose) {
+		if (dynar_str_catf(outbuf, ",\"expected_votes\":%"PRIu32,
+		    instance->vq_expected_votes) == -1) {
+			return (-1);
+		}
+	}
+
+	if (!qdevice_ipc_cmd_status_json_add_last_poll(instance, outbuf, verbose)) {
+		return (-1);
+	}
+
+	if (dynar_str_cat(outbuf, ",\"model_info\":") != 0 ||
+	    qdevice_model_ipc_cmd_status(instance, outbuf, verbose, 1) == -1 ||
+	    dynar_str_cat(outbuf, "}\n") != 0) {
+		return (-1);
+	}
+
+	return (0);
 }
 
 int
-qdevice_ipc_cmd_status(struct qdevice_instance *instance, struct dynar *outbuf, int verbose)
+qdevice_ipc_cmd_status(struct qdevice_instance *instance, struct dynar *outbuf, int verbose,
+    int json)
 {
 
+	if (json) {
+		return (qdevice_ipc_cmd_status_json(instance, outbuf, verbose));
+	}
+
 	if (qdevice_ipc_cmd_status_add_header(instance, outbuf, verbose) &&
 	    qdevice_ipc_cmd_status_add_model(instance, outbuf, verbose) &&
 	    qdevice_ipc_cmd_status_add_nodeid(instance, outbuf, verbose) &&
@@ -271,9 +565,166 @@ qdevice_ipc_cmd_status(struct qdevice_instance *instance, struct dynar *outbuf,
 	    qdevice_ipc_cmd_status_add_expected_votes(instance, outbuf, verbose) &&
 	    qdevice_ipc_cmd_status_add_last_poll(instance, outbuf, verbose) &&
 	    dynar_str_catf(outbuf, "\n") != -1 &&
-	    qdevice_model_ipc_cmd_status(instance, outbuf, verbose) != -1) {
+	    qdevice_model_ipc_cmd_status(instance, outbuf, verbose, 0) != -1) {
 		return (0);
 	}
 
 	return (-1);
 }
+
+static int
+qdevice_ipc_cmd_heuristics_history_add_sample(struct dynar *outbuf,
+    const struct qdevice_heuristics_history_sample *sample, int json)
+{
+	struct tm tm_res;
+
+	localtime_r(&sample->time, &tm_res);
+
+	if (json) {
+		return (dynar_str_catf(outbuf, "{\"time\":\"%04d-%02d-%02dT%02d:%02d:%02d\","
+		    "\"result\":\"%s\",\"exit_status\":%"PRId32",\"term_signal\":%"PRId32
+		    ",\"duration\":%"PRIu32"}",
+		    tm_res.tm_year + 1900, tm_res.tm_mon + 1, tm_res.tm_mday,
+		    tm_res.tm_hour, tm_res.tm_min, tm_res.tm_sec,
+		    qdevice_heuristics_exec_entry_result_to_str(sample->result),
+		    sample->exit_status, sample->term_signal, sample->duration) != -1);
+	}
+
+	if (dynar_str_catf(outbuf, "        %04d-%02d-%02dT%02d:%02d:%02d\t%s",
+	    tm_res.tm_year + 1900, tm_res.tm_mon + 1, tm_res.tm_mday,
+	    tm_res.tm_hour, tm_res.tm_min, tm_res.tm_sec,
+	    qdevice_heuristics_exec_entry_result_to_str(sample->result)) == -1) {
+		return (0);
+	}
+
+	if (sample->exit_status != -1 &&
+	    dynar_str_catf(outbuf, " (exit status %"PRId32")", sample->exit_status) == -1) {
+		return (0);
+	}
+
+	if (sample->term_signal != 0 &&
+	    dynar_str_catf(outbuf, " (signal %"PRId32")", sample->term_signal) == -1) {
+		return (0);
+	}
+
+	return (dynar_str_catf(outbuf, ", %"PRIu32" ms\n", sample->duration) != -1);
+}
+
+static int
+qdevice_ipc_cmd_heuristics_history_add_entry(struct dynar *outbuf,
+    const struct qdevice_heuristics_history_entry *entry, int verbose, int json)
+{
+	struct qdevice_heuristics_history_stats stats;
+	const struct qdevice_heuristics_history_sample *sample;
+	size_t zi;
+
+	if (qdevice_heuristics_history_entry_get_stats(entry, &stats) != 0) {
+		return (0);
+	}
+
+	if (json) {
+		if (dynar_str_cat(outbuf, "{\"name\":") != 0 ||
+		    dynar_str_json_quote_cat(outbuf, entry->name) != 0 ||
+		    dynar_str_cat(outbuf, ",\"command\":") != 0 ||
+		    dynar_str_json_quote_cat(outbuf, entry->command) != 0 ||
+		    dynar_str_catf(outbuf, ",\"total_execs\":%"PRIu64",\"samples\":%zu"
+		    ",\"pass\":%zu,\"fail\":%zu,\"not_finished\":%zu,\"min_duration\":%"PRIu32
+		    ",\"avg_duration\":%"PRIu32",\"p99_duration\":%"PRIu32
+		    ",\"max_duration\":%"PRIu32, entry->total_execs, stats.no_samples,
+		    stats.no_pass, stats.no_fail, stats.no_not_finished, stats.min_duration,
+		    stats.avg_duration, stats.p99_duration, stats.max_duration) == -1) {
+			return (0);
+		}
+
+		if (verbose) {
+			if (dynar_str_cat(outbuf, ",\"history\":[") != 0) {
+				return (0);
+			}
+
+			for (zi = 0; (sample =
+			    qdevice_heuristics_history_entry_get_sample(entry, zi)) != NULL; zi++) {
+				if ((zi > 0 && dynar_str_cat(outbuf, ",") != 0) ||
+				    !qdevice_ipc_cmd_heuristics_history_add_sample(outbuf, sample, 1)) {
+					return (0);
+				}
+			}
+
+			if (dynar_str_cat(outbuf, "]") != 0) {
+				return (0);
+			}
+		}
+
+		return (dynar_str_cat(outbuf, "}") == 0);
+	}
+
+	if (dynar_str_catf(outbuf, "%s:\n", entry->name) == -1 ||
+	    dynar_str_catf(outbuf, "    Executions:\t\t%zu (pass %zu, fail %zu, not finished %zu)"
+	    ", %"PRIu64" total\n", stats.no_samples, stats.no_pass, stats.no_fail,
+	    stats.no_not_finished, entry->total_execs) == -1 ||
+	    dynar_str_catf(outbuf, "    Duration:\t\tmin %"PRIu32" ms, avg %"PRIu32" ms, p99 %"PRIu32
+	    " ms, max %"PRIu32" ms\n", stats.min_duration, stats.avg_duration,
+	    stats.p99_duration, stats.max_duration) == -1) {
+		return (0);
+	}
+
+	if (verbose) {
+		if (dynar_str_catf(outbuf, "    History:\n") == -1) {
+			return (0);
+		}
+
+		for (zi = 0; (sample = qdevice_heuristics_history_entry_get_sample(entry, zi)) != NULL;
+		    zi++) {
+			if (!qdevice_ipc_cmd_heuristics_history_add_sample(outbuf, sample, 0)) {
+				return (0);
+			}
+		}
+	}
+
+	return (1);
+}
+
+/*
+ * Show per-heuristics history of executions (newest first) and statistics
+ */
+int
+qdevice_ipc_cmd_heuristics_history(struct qdevice_instance *instance, struct dynar *outbuf,
+    int verbose, int json)
+{
+	const struct qdevice_heuristics_history *history;
+	const struct qdevice_heuristics_history_entry *entry;
+	int first;
+
+	history = &instance->heuristics_instance.history;
+
+	if (json) {
+		if (dynar_str_catf(outbuf, "{\"size\":%zu,\"heuristics\":[",
+		    history->max_samples) == -1) {
+			return (-1);
+		}
+	} else {
+		if (dynar_str_catf(outbuf, "Heuristics history\n") == -1 ||
+		    dynar_str_catf(outbuf, "------------------\n") == -1 ||
+		    dynar_str_catf(outbuf, "Size:\t\t\t%zu\n", history->max_samples) == -1) {
+			return (-1);
+		}
+	}
+
+	first = 1;
+	TAILQ_FOREACH(entry, &history->entries, entries) {
+		if (json && !first && dynar_str_cat(outbuf, ",") != 0) {
+			return (-1);
+		}
+
+		if (!qdevice_ipc_cmd_heuristics_history_add_entry(outbuf, entry, verbose, json)) {
+			return (-1);
+		}
+
+		first = 0;
+	}
+
+	if (json && dynar_str_cat(outbuf, "]}\n") != 0) {
+		return (-1);
+	}
+
+	return (0);
+}
@@ -43,7 +43,10 @@ extern "C" {
 #endif
 
 extern int	qdevice_ipc_cmd_status(struct qdevice_instance *instance, struct dynar *outbuf,
-    int verbose);
+    int verbose, int json);
+
+extern int	qdevice_ipc_cmd_heuristics_history(struct qdevice_instance *instance,
+    struct dynar *outbuf, int verbose, int json);
 
 #ifdef __cplusplus
 }
@@ -32,6 +32,9 @@
  * THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <time.h>
+
+#include "flight-recorder.h"
 #include "log.h"
 #include "qdevice-config.h"
 #include "qdevice-ipc.h"
@@ -357,6 +360,7 @@ qdevice_ipc_parse_line(struct qdevice_instance *instance, struct unix_socket_cli
 	char *str;
 	struct qdevice_ipc_user_data *ipc_user_data;
 	int verbose;
+	int json;
 
 	ipc_user_data = (struct qdevice_ipc_user_data *)client->user_data;
 
@@ -364,6 +368,7 @@ qdevice_ipc_parse_line(struct qdevice_instance *instance, struct unix_socket_cli
 	token = dynar_simple_lex_token_next(&lex);
 
 	verbose = 0;
+	json = 0;
 
 	if (token == NULL) {
 		log(LOG_ERR, "Can't alloc memory for simple lex");
@@ -390,15 +395,18 @@ qdevice_ipc_parse_line(struct qdevice_instance *instance, struct unix_socket_cli
 			client->schedule_disconnect = 1;
 		}
 	} else if (strcasecmp(str, "status") == 0) {
-		token = dynar_simple_lex_token_next(&lex);
-
-		if (token != NULL && (str = dynar_data(token), strcmp(str, "")) != 0) {
+		while ((token = dynar_simple_lex_token_next(&lex)) != NULL &&
+		    (str = dynar_data(token), strcmp(str, "")) != 0) {
 			if (strcasecmp(str, "verbose") == 0) {
 				verbose = 1;
+			} else if (strcasecmp(str, "json") == 0) {
+				json = 1;
+			} else {
+				break;
 			}
 		}
 
-		if (qdevice_ipc_cmd_status(instance, &client->send_buffer, verbose) != 0) {
+		if (qdevice_ipc_cmd_status(instance, &client->send_buffer, verbose, json) != 0) {
 			if (qdevice_ipc_send_error(instance, client, "Can't get QDevice status") != 0) {
 				client->schedule_disconnect = 1;
 			}
@@ -407,6 +415,55 @@ qdevice_ipc_parse_line(struct qdevice_instance *instance, struct unix_socket_cli
 				client->schedule_disconnect = 1;
 			}
 		}
+	} else if (strcasecmp(str, "heuristics-history") == 0) {
+		while ((token = dynar_simple_lex_token_next(&lex)) != NULL &&
+		    (str = dynar_data(token), strcmp(str, "")) != 0) {
+			if (strcasecmp(str, "verbose") == 0) {
+				verbose = 1;
+			} else if (strcasecmp(str, "json") == 0) {
+				json = 1;
+			} else {
+				break;
+			}
+		}
+
+		if (qdevice_ipc_cmd_heuristics_history(instance, &client->send_buffer, verbose,
+		    json) != 0) {
+			if (qdevice_ipc_send_error(instance, client,
+			    "Can't get QDevice heuristics history") != 0) {
+				client->schedule_disconnect = 1;
+			}
+		} else {
+			if (qdevice_ipc_send_buffer(instance, client) != 0) {
+				client->schedule_disconnect = 1;
+			}
+		}
+	} else if (strcasecmp(str, "subscribe") == 0) {
+		log(LOG_DEBUG, "IPC client subscribed for events");
+
+		dynar_clean(&client->send_buffer);
+		if (qdevice_ipc_send_buffer(instance, client) != 0) {
+			client->schedule_disconnect = 1;
+		} else {
+			/*
+			 * Keep connection open. Reading is enabled only to detect closed connection.
+			 */
+			client->subscribed = 1;
+			dynar_set_max_size(&client->send_buffer,
+			    instance->advanced_settings->ipc_subscriber_buffer_size);
+			unix_socket_client_read_line(client, 1);
+		}
+	} else if (strcasecmp(str, "flight-recorder") == 0) {
+		if (flight_recorder_dump(&client->send_buffer) != 0) {
+			if (qdevice_ipc_send_error(instance, client,
+			    "Can't get QDevice flight recorder events") != 0) {
+				client->schedule_disconnect = 1;
+			}
+		} else {
+			if (qdevice_ipc_send_buffer(instance, client) != 0) {
+				client->schedule_disconnect = 1;
+			}
+		}
 	} else {
 		log(LOG_DEBUG, "IPC client sent unknown command");
 		if (qdevice_ipc_send_error(instance, client, "Unknown command '%s'", str) != 0) {
@@ -446,6 +503,14 @@ qdevice_ipc_io_read(struct qdevice_instance *instance, struct unix_socket_client
 		/*
 		 * Full message received
 		 */
+		if (client->subscribed) {
+			/*
+			 * Subscriber is not expected to send anything else
+			 */
+			dynar_clean(&client->receive_buffer);
+			break;
+		}
+
 		unix_socket_client_read_line(client, 0);
 
 		qdevice_ipc_parse_line(instance, client);
@@ -482,6 +547,12 @@ qdevice_ipc_io_write(struct qdevice_instance *instance, struct unix_socket_clien
 		 * Full message sent
 		 */
 		unix_socket_client_write_buffer(client, 0);
+
+		if (client->subscribed) {
+			dynar_clean(&client->send_buffer);
+			break;
+		}
+
 		client->schedule_disconnect = 1;
 
 		if (ipc_user_data->shutdown_requested) {
@@ -491,3 +562,69 @@ qdevice_ipc_io_write(struct qdevice_instance *instance, struct unix_socket_clien
 		break;
 	}
 }
+
+static int
+qdevice_ipc_event_header(struct dynar *line, const char *event)
+{
+	struct timespec ts;
+	struct tm tm_res;
+	char time_str[32];
+
+	(void)clock_gettime(CLOCK_REALTIME, &ts);
+	localtime_r(&ts.tv_sec, &tm_res);
+
+	if (strftime(time_str, sizeof(time_str), "%Y-%m-%dT%H:%M:%S", &tm_res) == 0) {
+		return (-1);
+	}
+
+	return ((dynar_str_catf(line, "{\"time\":\"%s.%03ld\",\"event\":\"%s\"",
+	    time_str, (long)(ts.tv_nsec / 1000000), event) > 0) ? 0 : -1);
+}
+
+/*
+ * Send event to all IPC subscribers. fields_fmt (if not NULL) is appended
+ * to the JSON object and must start with comma.
+ */
+void
+qdevice_ipc_send_event(struct qdevice_instance *instance, const char *event,
+    const char *fields_fmt, ...)
+{
+	struct dynar line;
+	va_list ap;
+	size_t dropped;
+	int res;
+
+	if (!unix_socket_ipc_has_subscribers(&instance->local_ipc)) {
+		return ;
+	}
+
+	dynar_init(&line, instance->local_ipc.max_send_size);
+
+	res = (qdevice_ipc_event_header(&line, event) == 0 &&
+	    dynar_str_catf(&line, ",\"node_id\":%"PRIu32, instance->node_id) > 0);
+
+	if (res && fields_fmt != NULL) {
+		va_start(ap, fields_fmt);
+		res = (dynar_str_vcatf(&line, fields_fmt, ap) > 0);
+		va_end(ap);
+	}
+
+	if (res) {
+		res = (dynar_str_cat(&line, "}\n") == 0);
+	}
+
+	if (!res) {
+		log(LOG_ERR, "Can't create IPC event %s", event);
+		dynar_destroy(&line);
+
+		return ;
+	}
+
+	dropped = unix_socket_ipc_send_event(&instance->local_ipc, dynar_data(&line),
+	    dynar_size(&line));
+	if (dropped > 0) {
+		log(LOG_WARNING, "%zu IPC event subscriber(s) too slow. Disconnecting", dropped);
+	}
+
+	dynar_destroy(&line);
+}
@@ -51,6 +51,10 @@ extern int		qdevice_ipc_close(struct qdevice_instance *instance);
 
 extern int		qdevice_ipc_destroy(struct qdevice_instance *instance);
 
+extern void		qdevice_ipc_send_event(struct qdevice_instance *instance,
+    const char *event, const char *fields_fmt, ...)
+    __attribute__((__format__(__printf__, 3, 4)));
+
 extern int		qdevice_ipc_accept(struct qdevice_instance *instance,
     struct unix_socket_client **res_client);
 
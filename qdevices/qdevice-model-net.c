@@ -34,7 +34,9 @@
 
 #include <poll.h>
 
+#include "flight-recorder.h"
 #include "log.h"
+#include "qdevice-ipc.h"
 #include "qdevice-model.h"
 #include "qdevice-model-net.h"
 #include "qdevice-net-cast-vote-timer.h"
@@ -60,6 +62,16 @@ check_schedule_disconnect_cb(void *user_data1, void *user_data2)
 		return (-1);
 	}
 
+	if (instance->state != QDEVICE_NET_INSTANCE_STATE_WAITING_CONNECT &&
+	    qdevice_net_socket_is_connecting(instance)) {
+		/*
+		 * Connection to one of the server addresses was established, close the other ones
+		 */
+		if (qdevice_net_socket_close_non_blocking_clients(instance) != 0) {
+			return (-1);
+		}
+	}
+
 	return (0);
 }
 
@@ -80,6 +92,30 @@ qdevice_model_net_timer_connect_timeout(void *data1, void *data2)
 	return (0);
 }
 
+static int
+qdevice_model_net_timer_connect_stagger(void *data1, void *data2)
+{
+	struct qdevice_net_instance *instance;
+
+	instance = (struct qdevice_net_instance *)data1;
+
+	if (qdevice_net_socket_connect_next_addr(instance) != 0) {
+		instance->schedule_disconnect = 1;
+		instance->disconnect_reason = QDEVICE_NET_DISCONNECT_REASON_CANT_CONNECT_TO_THE_SERVER;
+	}
+
+	if (instance->schedule_disconnect || instance->non_blocking_client.destroyed) {
+		instance->connect_stagger_timer = NULL;
+
+		return (0);
+	}
+
+	/*
+	 * Schedule this function again
+	 */
+	return (-1);
+}
+
 /*
  * Exported functions
  */
@@ -156,23 +192,6 @@ qdevice_model_net_destroy(struct qdevice_instance *instance)
 }
 
 
-static PRIntn
-qdevice_model_net_get_af(const struct qdevice_net_instance *instance)
-{
-	PRIntn af;
-
-	af = PR_AF_UNSPEC;
-	if (instance->force_ip_version == 4) {
-		af = PR_AF_INET;
-	}
-
-	if (instance->force_ip_version == 6) {
-		af = PR_AF_INET6;
-	}
-
-	return (af);
-}
-
 /*
  *  0 - Continue
  * -1 - End loop
@@ -198,28 +217,28 @@ qdevice_model_net_pre_poll_loop(struct qdevice_instance *instance)
 		return (-1);
 	}
 
-	log(LOG_DEBUG, "Trying connect to qnetd server %s:%u (timeout = %ums)",
-	    net_instance->host_addr, net_instance->host_port, net_instance->connect_timeout);
+	log(LOG_DEBUG, "Connecting to qnetd (timeout = %ums)", net_instance->connect_timeout);
 
-	res = nss_sock_non_blocking_client_init(net_instance->host_addr,
-	    net_instance->host_port, qdevice_model_net_get_af(net_instance),
-	    &net_instance->non_blocking_client);
+	/*
+	 * Failed connect is not fatal. Loop keeps running and other addresses
+	 * of the server are tried (if any) or connect timer expires
+	 */
+	res = qdevice_net_socket_connect(net_instance);
 	if (res == -1) {
-		log_nss(LOG_ERR, "Can't initialize non blocking client connection");
+		goto error_free_non_blocking_client;
 	}
 
-	res = nss_sock_non_blocking_client_try_next(&net_instance->non_blocking_client);
-	if (res == -1) {
-		log_nss(LOG_ERR, "Can't connect to qnetd host");
-		/*
-		 * To prevent adding non_blocking_client into loop but still keep loop running
-		 */
-		nss_sock_non_blocking_client_destroy(&net_instance->non_blocking_client);
-	}
+	if (!net_instance->non_blocking_client.destroyed) {
+		net_instance->connect_stagger_timer = timer_list_add(
+		    pr_poll_loop_get_timer_list(&instance->main_poll_loop),
+		    net_instance->advanced_settings->net_connect_stagger,
+		    qdevice_model_net_timer_connect_stagger, (void *)net_instance, NULL);
 
-	res = qdevice_net_socket_add_to_main_poll_loop(net_instance);
-	if (res == -1) {
-		goto error_free_non_blocking_client;
+		if (net_instance->connect_stagger_timer == NULL) {
+			log(LOG_CRIT, "Can't schedule connect stagger timer");
+
+			goto error_free_non_blocking_client;
+		}
 	}
 
 	res = pr_poll_loop_add_pre_poll_cb(&instance->main_poll_loop, check_schedule_disconnect_cb,
@@ -232,10 +251,14 @@ qdevice_model_net_pre_poll_loop(struct qdevice_instance *instance)
 	return (0);
 
 error_del_from_main_poll_loop:
-	(void)qdevice_net_socket_del_from_main_poll_loop(net_instance);
+	if (net_instance->connect_stagger_timer != NULL) {
+		timer_list_entry_delete(pr_poll_loop_get_timer_list(&instance->main_poll_loop),
+		    net_instance->connect_stagger_timer);
+		net_instance->connect_stagger_timer = NULL;
+	}
 
 error_free_non_blocking_client:
-	nss_sock_non_blocking_client_destroy(&net_instance->non_blocking_client);
+	(void)qdevice_net_socket_close_non_blocking_clients(net_instance);
 	return (-1);
 }
 
@@ -265,6 +288,12 @@ qdevice_model_net_post_poll_loop(struct qdevice_instance *instance,
 		net_instance->connect_timer = NULL;
 	}
 
+	if (net_instance->connect_stagger_timer != NULL) {
+		timer_list_entry_delete(pr_poll_loop_get_timer_list(&instance->main_poll_loop),
+		    net_instance->connect_stagger_timer);
+		net_instance->connect_stagger_timer = NULL;
+	}
+
 	if (net_instance->echo_request_timer != NULL) {
 		timer_list_entry_delete(pr_poll_loop_get_timer_list(&instance->main_poll_loop),
 		    net_instance->echo_request_timer);
@@ -297,6 +326,11 @@ qdevice_model_net_post_poll_loop(struct qdevice_instance *instance,
 	 */
 	}
 
+	flight_recorder_record_event(FLIGHT_RECORDER_EVENT_TYPE_DISCONNECTED,
+	    net_instance->cluster_name, instance->node_id);
+	qdevice_ipc_send_event(instance, "qnetd_disconnected", ",\"reason\":%u",
+	    (unsigned int)net_instance->disconnect_reason);
+
 	restart_loop = qdevice_net_disconnect_reason_try_reconnect(net_instance->disconnect_reason);
 
 	/*
@@ -324,6 +358,11 @@ qdevice_model_net_post_poll_loop(struct qdevice_instance *instance,
 		restart_loop = 0;
 	}
 
+	if (restart_loop &&
+	    qdevice_net_disconnect_reason_try_next_server(net_instance->disconnect_reason)) {
+		qdevice_net_instance_select_next_server(net_instance);
+	}
+
 	/*
 	 * Return 0 only when local socket was closed -> regular exit
 	 */
@@ -343,6 +382,11 @@ qdevice_model_net_post_poll_loop(struct qdevice_instance *instance,
 	/*
 	 * Remove socket from loop
 	 */
+	if (qdevice_net_socket_close_non_blocking_clients(net_instance) == -1) {
+		restart_loop = 0;
+		ret_val = -1;
+	}
+
 	if (qdevice_net_socket_del_from_main_poll_loop(net_instance) == -1) {
 		restart_loop = 0;
 		ret_val = -1;
@@ -355,17 +399,6 @@ qdevice_model_net_post_poll_loop(struct qdevice_instance *instance,
 		net_instance->socket = NULL;
 	}
 
-	if (!net_instance->non_blocking_client.destroyed) {
-		nss_sock_non_blocking_client_destroy(&net_instance->non_blocking_client);
-	}
-
-	if (net_instance->non_blocking_client.socket != NULL) {
-		if (PR_Close(net_instance->non_blocking_client.socket) != PR_SUCCESS) {
-			log_nss(LOG_WARNING, "Unable to close non-blocking client connection");
-		}
-		net_instance->non_blocking_client.socket = NULL;
-	}
-
 	if (restart_loop &&
 	    net_instance->state != QDEVICE_NET_INSTANCE_STATE_WAITING_CONNECT) {
 		/*
@@ -768,13 +801,13 @@ qdevice_model_net_cmap_changed(struct qdevice_instance *instance,
 
 int
 qdevice_model_net_ipc_cmd_status(struct qdevice_instance *instance,
-    struct dynar *outbuf, int verbose)
+    struct dynar *outbuf, int verbose, int json)
 {
 	struct qdevice_net_instance *net_instance;
 
 	net_instance = instance->model_data;
 
-	if (!qdevice_net_ipc_cmd_status(net_instance, outbuf, verbose)) {
+	if (!qdevice_net_ipc_cmd_status(net_instance, outbuf, verbose, json)) {
 		return (-1);
 	}
 
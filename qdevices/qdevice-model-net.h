@@ -74,7 +74,7 @@ extern int      qdevice_model_net_cmap_changed(struct qdevice_instance *instance
     const struct qdevice_cmap_change_events *events);
 
 extern int	qdevice_model_net_ipc_cmd_status(struct qdevice_instance *instance,
-    struct dynar *outbuf, int verbose);
+    struct dynar *outbuf, int verbose, int json);
 
 extern int	qdevice_model_net_register(void);
 
@@ -182,7 +182,8 @@ qdevice_model_votequorum_expected_votes_notify(struct qdevice_instance *instance
 }
 
 int
-qdevice_model_ipc_cmd_status(struct qdevice_instance *instance, struct dynar *outbuf, int verbose)
+qdevice_model_ipc_cmd_status(struct qdevice_instance *instance, struct dynar *outbuf, int verbose,
+    int json)
 {
 
 	if (instance->model_type >= QDEVICE_MODEL_TYPE_ARRAY_SIZE ||
@@ -192,7 +193,7 @@ qdevice_model_ipc_cmd_status(struct qdevice_instance *instance, struct dynar *ou
 	}
 
 	return (qdevice_model_array[instance->model_type]->
-	    ipc_cmd_status(instance, outbuf, verbose));
+	    ipc_cmd_status(instance, outbuf, verbose, json));
 }
 
 int
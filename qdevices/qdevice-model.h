@@ -91,7 +91,7 @@ extern int 	qdevice_model_votequorum_expected_votes_notify(struct qdevice_instan
     uint32_t expected_votes);
 
 extern int	qdevice_model_ipc_cmd_status(struct qdevice_instance *instance,
-    struct dynar *outbuf, int verbose);
+    struct dynar *outbuf, int verbose, int json);
 
 extern int	qdevice_model_cmap_changed(struct qdevice_instance *instance,
     const struct qdevice_cmap_change_events *events);
@@ -116,7 +116,8 @@ struct qdevice_model {
 	    uint32_t node_list[], enum qdevice_heuristics_exec_result heuristics_exec_result);
 	int (*votequorum_expected_votes_notify)(struct qdevice_instance *instance,
 	    uint32_t expected_votes);
-	int (*ipc_cmd_status)(struct qdevice_instance *instance, struct dynar *outbuf, int verbose);
+	int (*ipc_cmd_status)(struct qdevice_instance *instance, struct dynar *outbuf, int verbose,
+	    int json);
 	int (*cmap_changed)(struct qdevice_instance *instance,
 	    const struct qdevice_cmap_change_events *events);
 };
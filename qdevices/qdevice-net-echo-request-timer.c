@@ -32,11 +32,23 @@
  * THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <time.h>
+
 #include "log.h"
 #include "qdevice-net-algorithm.h"
 #include "qdevice-net-echo-request-timer.h"
 #include "qdevice-net-send.h"
 
+static uint64_t
+qdevice_net_echo_request_timer_now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+}
+
 static int
 qdevice_net_echo_request_timer_callback(void *data1, void *data2)
 {
@@ -72,6 +84,8 @@ qdevice_net_echo_request_timer_callback(void *data1, void *data2)
 		return (0);
 	}
 
+	instance->echo_request_sent_time = qdevice_net_echo_request_timer_now_us();
+
 	/*
 	 * Schedule this function callback again
 	 */
@@ -91,10 +105,13 @@ qdevice_net_echo_request_timer_schedule(struct qdevice_net_instance *instance)
 		instance->echo_request_timer = NULL;
 	}
 
-	log(LOG_DEBUG, "Scheduling send of heartbeat every %"PRIu32"ms", instance->heartbeat_interval);
+	instance->echo_request_sent_time = 0;
+
+	log(LOG_DEBUG, "Scheduling send of heartbeat every %"PRIu32"ms",
+	    instance->current_heartbeat_interval);
 	instance->echo_request_timer = timer_list_add(
 	    pr_poll_loop_get_timer_list(&instance->qdevice_instance_ptr->main_poll_loop),
-	    instance->heartbeat_interval, qdevice_net_echo_request_timer_callback,
+	    instance->current_heartbeat_interval, qdevice_net_echo_request_timer_callback,
 	    (void *)instance, NULL);
 
 	if (instance->echo_request_timer == NULL) {
@@ -107,3 +124,136 @@ qdevice_net_echo_request_timer_schedule(struct qdevice_net_instance *instance)
 
 	return (0);
 }
+
+/*
+ * Change interval of running echo request timer. Called when server accepted new
+ * heartbeat interval.
+ */
+int
+qdevice_net_echo_request_timer_set_interval(struct qdevice_net_instance *instance,
+    uint32_t heartbeat_interval)
+{
+
+	instance->requested_heartbeat_interval = 0;
+	instance->current_heartbeat_interval = heartbeat_interval;
+
+	if (instance->echo_request_timer == NULL) {
+		return (0);
+	}
+
+	log(LOG_DEBUG, "Changing heartbeat interval to %"PRIu32"ms", heartbeat_interval);
+
+	if (timer_list_entry_set_interval(
+	    pr_poll_loop_get_timer_list(&instance->qdevice_instance_ptr->main_poll_loop),
+	    instance->echo_request_timer, heartbeat_interval) != 0) {
+		log(LOG_ERR, "Can't change heartbeat interval to %"PRIu32"ms", heartbeat_interval);
+
+		instance->disconnect_reason = QDEVICE_NET_DISCONNECT_REASON_CANT_SCHEDULE_HB_TIMER;
+
+		return (-1);
+	}
+
+	return (0);
+}
+
+static int
+qdevice_net_echo_request_timer_adapt(struct qdevice_net_instance *instance)
+{
+	uint32_t new_interval, diff;
+	uint32_t min_interval, max_interval;
+
+	if (instance->requested_heartbeat_interval != 0 ||
+	    instance->adaptive_heartbeat_refused ||
+	    instance->echo_rtt.no_samples < QDEVICE_NET_ADAPTIVE_HEARTBEAT_MIN_SAMPLES) {
+		return (0);
+	}
+
+	min_interval = instance->advanced_settings->net_adaptive_heartbeat_min;
+	max_interval = instance->advanced_settings->net_adaptive_heartbeat_max;
+	if (max_interval > instance->advanced_settings->net_heartbeat_interval_max) {
+		max_interval = instance->advanced_settings->net_heartbeat_interval_max;
+	}
+	if (max_interval < min_interval) {
+		max_interval = min_interval;
+	}
+
+	/*
+	 * Stable RTT yields short interval (faster detection of lost server), jittery RTT
+	 * long one (more tolerance), possibly longer than configured one.
+	 */
+	new_interval = rtt_estimator_get_timeout_ms(&instance->echo_rtt,
+	    instance->advanced_settings->net_adaptive_heartbeat_rto_multiplier,
+	    min_interval, max_interval);
+
+	if (new_interval > instance->current_heartbeat_interval) {
+		diff = new_interval - instance->current_heartbeat_interval;
+	} else {
+		diff = instance->current_heartbeat_interval - new_interval;
+	}
+
+	if ((uint64_t)diff * 100 <
+	    (uint64_t)instance->current_heartbeat_interval * QDEVICE_NET_ADAPTIVE_HEARTBEAT_MIN_CHANGE) {
+		return (0);
+	}
+
+	log(LOG_DEBUG, "Echo RTT srtt = %"PRIu64"us, rttvar = %"PRIu64"us. "
+	    "Requesting heartbeat interval change from %"PRIu32"ms to %"PRIu32"ms",
+	    instance->echo_rtt.srtt, instance->echo_rtt.rttvar,
+	    instance->current_heartbeat_interval, new_interval);
+
+	if (qdevice_net_send_set_option(instance, 1, new_interval, 0,
+	    instance->keep_active_partition_tie_breaker) != 0) {
+		instance->disconnect_reason = QDEVICE_NET_DISCONNECT_REASON_CANT_ALLOCATE_MSG_BUFFER;
+
+		return (-1);
+	}
+
+	/*
+	 * New interval is used after server accepts it, so qnetd never expects heartbeat
+	 * more often than it is sent
+	 */
+	instance->requested_heartbeat_interval = new_interval;
+	instance->requested_heartbeat_interval_msg_seq_num = instance->last_msg_seq_num;
+
+	return (0);
+}
+
+/*
+ * Called when server refused heartbeat interval requested by adaptation. Connection is kept
+ * with current interval and adaptation is disabled for the rest of the connection, so
+ * refused interval is not requested again.
+ */
+void
+qdevice_net_echo_request_timer_interval_refused(struct qdevice_net_instance *instance)
+{
+
+	log(LOG_WARNING, "Server refused heartbeat interval %"PRIu32"ms. "
+	    "Keeping %"PRIu32"ms and disabling adaptive heartbeat for this connection",
+	    instance->requested_heartbeat_interval, instance->current_heartbeat_interval);
+
+	instance->requested_heartbeat_interval = 0;
+	instance->adaptive_heartbeat_refused = 1;
+}
+
+/*
+ * Called when expected echo reply is received. Updates echo RTT estimation and, when
+ * adaptive heartbeat is enabled, negotiates new heartbeat interval with server.
+ */
+int
+qdevice_net_echo_request_timer_reply_received(struct qdevice_net_instance *instance)
+{
+
+	if (instance->echo_request_sent_time == 0) {
+		return (0);
+	}
+
+	rtt_estimator_add_sample(&instance->echo_rtt,
+	    qdevice_net_echo_request_timer_now_us() - instance->echo_request_sent_time);
+	instance->echo_request_sent_time = 0;
+
+	if (!instance->adaptive_heartbeat) {
+		return (0);
+	}
+
+	return (qdevice_net_echo_request_timer_adapt(instance));
+}
@@ -43,6 +43,15 @@ extern "C" {
 
 extern int	qdevice_net_echo_request_timer_schedule(struct qdevice_net_instance *instance);
 
+extern int	qdevice_net_echo_request_timer_set_interval(struct qdevice_net_instance *instance,
+    uint32_t heartbeat_interval);
+
+extern int	qdevice_net_echo_request_timer_reply_received(
+    struct qdevice_net_instance *instance);
+
+extern void	qdevice_net_echo_request_timer_interval_refused(
+    struct qdevice_net_instance *instance);
+
 #ifdef __cplusplus
 }
 #endif
@@ -33,6 +33,7 @@
  */
 
 #include "log.h"
+#include "qdevice-ipc.h"
 #include "qdevice-net-algorithm.h"
 #include "qdevice-net-cast-vote-timer.h"
 #include "qdevice-net-heuristics.h"
@@ -99,6 +100,10 @@ qdevice_net_regular_heuristics_exec_result_callback(uint32_t seq_number,
 		    tlv_heuristics_to_str(net_instance->latest_heuristics_result),
 		    tlv_heuristics_to_str(heuristics));
 
+		qdevice_ipc_send_event(instance, "heuristics_result",
+		    ",\"type\":\"regular\",\"result\":\"%s\"",
+		    tlv_heuristics_to_str(heuristics));
+
 		if (net_instance->state != QDEVICE_NET_INSTANCE_STATE_WAITING_VOTEQUORUM_CMAP_EVENTS) {
 			/*
 			 * Not connected to qnetd
@@ -473,7 +478,7 @@ qdevice_net_heuristics_exec_after_connect(struct qdevice_net_instance *net_insta
 		return (-1);
 	}
 
-	if (qdevice_heuristics_exec(heuristics_instance,
+	if (qdevice_heuristics_exec_or_reuse(heuristics_instance,
 	    instance->sync_in_progress) != 0) {
 		log(LOG_ERR, "Can't execute connect heuristics.");
 
@@ -33,6 +33,7 @@
  */
 
 #include <limits.h>
+#include <stdlib.h>
 
 #include "log.h"
 #include "qdevice-config.h"
@@ -41,6 +42,29 @@
 #include "utils.h"
 #include "qdevice-ipc.h"
 
+static void
+qdevice_net_instance_node_list_states_init(struct qdevice_net_instance *instance)
+{
+	size_t zi;
+
+	for (zi = 0; zi < QDEVICE_NET_NODE_LIST_KIND_COUNT; zi++) {
+		memset(&instance->node_list_states[zi], 0, sizeof(instance->node_list_states[zi]));
+		node_list_init(&instance->node_list_states[zi].sent_list);
+		node_list_init(&instance->node_list_states[zi].acked_list);
+	}
+}
+
+static void
+qdevice_net_instance_node_list_states_free(struct qdevice_net_instance *instance)
+{
+	size_t zi;
+
+	for (zi = 0; zi < QDEVICE_NET_NODE_LIST_KIND_COUNT; zi++) {
+		node_list_free(&instance->node_list_states[zi].sent_list);
+		node_list_free(&instance->node_list_states[zi].acked_list);
+	}
+}
+
 int
 qdevice_net_instance_init(struct qdevice_net_instance *instance,
     enum tlv_tls_supported tls_supported,
@@ -49,21 +73,59 @@ qdevice_net_instance_init(struct qdevice_net_instance *instance,
     const char *host_addr, uint16_t host_port, const char *cluster_name,
     const struct tlv_tie_breaker *tie_breaker, uint32_t connect_timeout,
     int force_ip_version, enum tlv_keep_active_partition_tie_breaker keep_active_partition_tie_breaker,
-    int cmap_fd, int votequorum_fd, int local_socket_fd,
+    int adaptive_heartbeat, int cmap_fd, int votequorum_fd, int local_socket_fd,
     const struct qdevice_advanced_settings *advanced_settings,
     int heuristics_pipe_cmd_send_fd, int heuristics_pipe_cmd_recv_fd,
     int heuristics_pipe_log_recv_fd)
 {
+	const char *addr;
+	size_t addr_len;
 
 	memset(instance, 0, sizeof(*instance));
 
+	/*
+	 * host_addr is whitespace separated list of servers
+	 */
+	addr = host_addr;
+	while (*addr != '\0') {
+		addr += strspn(addr, " \t");
+		addr_len = strcspn(addr, " \t");
+
+		if (addr_len == 0) {
+			break;
+		}
+
+		if (instance->no_servers >= QDEVICE_NET_MAX_SERVERS) {
+			log(LOG_ERR, "Too many qnetd servers. Maximum is %u",
+			    QDEVICE_NET_MAX_SERVERS);
+			goto error_free_servers;
+		}
+
+		instance->servers[instance->no_servers] = strndup(addr, addr_len);
+		if (instance->servers[instance->no_servers] == NULL) {
+			goto error_free_servers;
+		}
+		instance->no_servers++;
+
+		addr += addr_len;
+	}
+
+	if (instance->no_servers == 0) {
+		log(LOG_ERR, "No qnetd server address is defined");
+		return (-1);
+	}
+
 	instance->advanced_settings = advanced_settings;
 	instance->decision_algorithm = decision_algorithm;
 	instance->heartbeat_interval = heartbeat_interval;
 	instance->sync_heartbeat_interval = sync_heartbeat_interval;
+	instance->adaptive_heartbeat = adaptive_heartbeat;
+	instance->current_heartbeat_interval = heartbeat_interval;
+	rtt_estimator_init(&instance->echo_rtt);
+	qdevice_net_instance_node_list_states_init(instance);
 	instance->cast_vote_timer_interval = cast_vote_timer_interval;
 	instance->cast_vote_timer = NULL;
-	instance->host_addr = host_addr;
+	instance->host_addr = instance->servers[0];
 	instance->host_port = host_port;
 	instance->cluster_name = cluster_name;
 	instance->connect_timeout = connect_timeout;
@@ -85,6 +147,13 @@ qdevice_net_instance_init(struct qdevice_net_instance *instance,
 	instance->tls_supported = tls_supported;
 
 	return (0);
+
+error_free_servers:
+	while (instance->no_servers > 0) {
+		free(instance->servers[--instance->no_servers]);
+	}
+
+	return (-1);
 }
 
 void
@@ -106,6 +175,22 @@ qdevice_net_instance_clean(struct qdevice_net_instance *instance)
 	instance->disconnect_reason = QDEVICE_NET_DISCONNECT_REASON_UNDEFINED;
 	instance->last_echo_reply_received_time = ((time_t) -1);
 	instance->connected_since_time = ((time_t) -1);
+
+	/*
+	 * New connection starts with configured heartbeat interval
+	 */
+	instance->current_heartbeat_interval = instance->heartbeat_interval;
+	instance->requested_heartbeat_interval = 0;
+	instance->requested_heartbeat_interval_msg_seq_num = 0;
+	instance->adaptive_heartbeat_refused = 0;
+	rtt_estimator_init(&instance->echo_rtt);
+
+	/*
+	 * Server has no node lists of new connection
+	 */
+	instance->server_supports_node_list_delta = 0;
+	qdevice_net_instance_node_list_states_free(instance);
+	qdevice_net_instance_node_list_states_init(instance);
 }
 
 int
@@ -116,12 +201,31 @@ qdevice_net_instance_destroy(struct qdevice_net_instance *instance)
 
 	send_buffer_list_free(&instance->send_buffer_list);
 
+	qdevice_net_instance_node_list_states_free(instance);
+
 	free((void *)instance->cluster_name);
-	free((void *)instance->host_addr);
+	while (instance->no_servers > 0) {
+		free(instance->servers[--instance->no_servers]);
+	}
 
 	return (0);
 }
 
+void
+qdevice_net_instance_select_next_server(struct qdevice_net_instance *instance)
+{
+
+	if (instance->no_servers <= 1) {
+		return ;
+	}
+
+	instance->current_server = (instance->current_server + 1) % instance->no_servers;
+	instance->host_addr = instance->servers[instance->current_server];
+
+	log(LOG_INFO, "Switching to qnetd server %s:%"PRIu16,
+	    instance->host_addr, instance->host_port);
+}
+
 int
 qdevice_net_instance_init_from_cmap(struct qdevice_instance *instance)
 {
@@ -142,6 +246,7 @@ qdevice_net_instance_init_from_cmap(struct qdevice_instance *instance)
 	struct qdevice_net_instance *net_instance;
 	int force_ip_version;
 	enum tlv_keep_active_partition_tie_breaker keep_active_partition_tb;
+	int adaptive_heartbeat;
 
 	cmap_handle = instance->cmap_handle;
 
@@ -337,6 +442,20 @@ qdevice_net_instance_init_from_cmap(struct qdevice_instance *instance)
 		free(str);
 	}
 
+	adaptive_heartbeat = QDEVICE_NET_DEFAULT_ADAPTIVE_HEARTBEAT;
+
+	if (cmap_get_string(cmap_handle, "quorum.device.net.adaptive_heartbeat", &str) == CS_OK) {
+		if ((i = utils_parse_bool_str(str)) == -1) {
+			log(LOG_ERR, "quorum.device.net.adaptive_heartbeat value is not valid.");
+			free(str);
+			goto error_free_cluster_name;
+		}
+
+		adaptive_heartbeat = i;
+
+		free(str);
+	}
+
 	/*
 	 * Really initialize instance
 	 */
@@ -344,16 +463,18 @@ qdevice_net_instance_init_from_cmap(struct qdevice_instance *instance)
 	    tls_supported, decision_algorithm,
 	    heartbeat_interval, sync_heartbeat_interval, cast_vote_timer_interval,
 	    host_addr, host_port, cluster_name, &tie_breaker, connect_timeout,
-	    force_ip_version, keep_active_partition_tb,
+	    force_ip_version, keep_active_partition_tb, adaptive_heartbeat,
 	    instance->cmap_poll_fd, instance->votequorum_poll_fd,
 	    instance->local_ipc.socket, instance->advanced_settings,
 	    instance->heuristics_instance.pipe_cmd_send,
 	    instance->heuristics_instance.pipe_cmd_recv,
 	    instance->heuristics_instance.pipe_log_recv) == -1) {
 		log(LOG_ERR, "Can't initialize qdevice-net instance");
-		goto error_free_instance;
+		goto error_free_cluster_name;
 	}
 
+	free(host_addr);
+
 	net_instance->qdevice_instance_ptr = instance;
 	instance->model_data = net_instance;
 
@@ -367,3 +488,37 @@ error_free_instance:
 	free(net_instance);
 	return (-1);
 }
+
+struct qdevice_net_node_list_state *
+qdevice_net_instance_get_node_list_state(struct qdevice_net_instance *instance,
+    enum tlv_node_list_type node_list_type)
+{
+	struct qdevice_net_node_list_state *res;
+
+	res = NULL;
+
+	switch (node_list_type) {
+	case TLV_NODE_LIST_TYPE_INITIAL_CONFIG:
+	case TLV_NODE_LIST_TYPE_CHANGED_CONFIG:
+		res = &instance->node_list_states[QDEVICE_NET_NODE_LIST_KIND_CONFIG];
+		break;
+	case TLV_NODE_LIST_TYPE_MEMBERSHIP:
+		res = &instance->node_list_states[QDEVICE_NET_NODE_LIST_KIND_MEMBERSHIP];
+		break;
+	case TLV_NODE_LIST_TYPE_QUORUM:
+		res = &instance->node_list_states[QDEVICE_NET_NODE_LIST_KIND_QUORUM];
+		break;
+	/*
+	 * Default is not defined intentionally. Compiler shows warning when new node list type
+	 * is added
+	 */
+	}
+
+	if (res == NULL) {
+		log(LOG_CRIT, "qdevice_net_instance_get_node_list_state fatal error. "
+		    "Unhandled node_list_type");
+		exit(EXIT_FAILURE);
+	}
+
+	return (res);
+}
@@ -47,6 +47,8 @@
 #include "dynar.h"
 #include "node-list.h"
 #include "qdevice-net-disconnect-reason.h"
+#include "qnet-config.h"
+#include "rtt-estimator.h"
 #include "send-buffer-list.h"
 #include "tlv.h"
 #include "timer-list.h"
@@ -64,6 +66,34 @@ enum qdevice_net_instance_state {
 	QDEVICE_NET_INSTANCE_STATE_WAITING_VOTEQUORUM_CMAP_EVENTS,
 };
 
+enum qdevice_net_node_list_kind {
+	QDEVICE_NET_NODE_LIST_KIND_CONFIG = 0,
+	QDEVICE_NET_NODE_LIST_KIND_MEMBERSHIP = 1,
+	QDEVICE_NET_NODE_LIST_KIND_QUORUM = 2,
+	QDEVICE_NET_NODE_LIST_KIND_COUNT = 3,
+};
+
+/*
+ * Node list of one kind sent to server supporting delta node lists. Deltas are computed
+ * against acked_list. Rest of the items is needed to resend sent_list as a full list.
+ */
+struct qdevice_net_node_list_state {
+	uint32_t version;		/* Version of last sent list, 0 - nothing sent */
+	uint32_t acked_version;		/* Version of list acknowledged by server, 0 - none */
+	uint32_t msg_seq_num;		/* Seq number of message with last sent list */
+	struct node_list sent_list;
+	struct node_list acked_list;
+	enum tlv_node_list_type node_list_type;
+	int add_ring_id;
+	struct tlv_ring_id ring_id;
+	int add_config_version;
+	uint64_t config_version;
+	int add_quorate;
+	enum tlv_quorate quorate;
+	int add_heuristics;
+	enum tlv_heuristics heuristics;
+};
+
 struct qdevice_net_instance {
 	PRFileDesc *socket;
 	struct dynar receive_buffer;
@@ -79,13 +109,23 @@ struct qdevice_net_instance {
 	int tls_client_cert_sent;
 	uint32_t heartbeat_interval;		/* Adjusted heartbeat interval during normal operation */
 	uint32_t sync_heartbeat_interval;	/* Adjusted heartbeat interval during corosync sync */
+	int adaptive_heartbeat;
+	uint32_t current_heartbeat_interval;	/* Heartbeat interval accepted by server */
+	uint32_t requested_heartbeat_interval;	/* Non zero when waiting for set option reply */
+	uint32_t requested_heartbeat_interval_msg_seq_num;
+	int adaptive_heartbeat_refused;		/* Server refused adapted interval */
+	struct rtt_estimator echo_rtt;
+	uint64_t echo_request_sent_time;	/* Monotonic time in us */
 	uint32_t cast_vote_timer_interval;	/* Timer for cast vote */
 	uint32_t connect_timeout;
 	struct timer_list_entry *cast_vote_timer;
 	enum tlv_vote cast_vote_timer_vote;
 	int cast_vote_timer_paused;
-	const char *host_addr;
+	const char *host_addr;			/* Currently used server (one of servers) */
 	uint16_t host_port;
+	char *servers[QDEVICE_NET_MAX_SERVERS];
+	size_t no_servers;
+	size_t current_server;
 	const char *cluster_name;
 	enum tlv_decision_algorithm_type decision_algorithm;
 	struct timer_list_entry *echo_request_timer;
@@ -95,8 +135,10 @@ struct qdevice_net_instance {
 	void *algorithm_data;
 	enum qdevice_net_disconnect_reason disconnect_reason;
 	struct qdevice_instance *qdevice_instance_ptr;
-	struct nss_sock_non_blocking_client non_blocking_client;
+	struct nss_sock_non_blocking_client non_blocking_client;	/* Addresses of current server */
+	PRFileDesc *connecting_sockets[QDEVICE_NET_MAX_PARALLEL_CONNECTS];
 	struct timer_list_entry *connect_timer;
+	struct timer_list_entry *connect_stagger_timer;
 	int force_ip_version;
 	time_t last_echo_reply_received_time;
 	time_t connected_since_time;
@@ -104,6 +146,8 @@ struct qdevice_net_instance {
 	struct timer_list_entry *regular_heuristics_timer;
 	int server_supports_heuristics;
 	int server_supports_keep_active_partition_tie_breaker;
+	int server_supports_node_list_delta;
+	struct qdevice_net_node_list_state node_list_states[QDEVICE_NET_NODE_LIST_KIND_COUNT];
 	enum tlv_keep_active_partition_tie_breaker keep_active_partition_tie_breaker;
 	enum tlv_heuristics latest_regular_heuristics_result;
 	enum tlv_heuristics latest_connect_heuristics_result;
@@ -118,7 +162,7 @@ extern int		qdevice_net_instance_init(struct qdevice_net_instance *instance,
     const char *host_addr, uint16_t host_port, const char *cluster_name,
     const struct tlv_tie_breaker *tie_breaker, uint32_t connect_timeout, int force_ip_version,
     enum tlv_keep_active_partition_tie_breaker keep_active_partition_tie_breaker,
-    int cmap_fd, int votequorum_fd, int local_socket_fd,
+    int adaptive_heartbeat, int cmap_fd, int votequorum_fd, int local_socket_fd,
     const struct qdevice_advanced_settings *advanced_settings,
     int heuristics_pipe_cmd_send_fd, int heuristics_pipe_cmd_recv_fd,
     int heuristics_pipe_log_recv_fd);
@@ -129,6 +173,12 @@ extern int		qdevice_net_instance_destroy(struct qdevice_net_instance *instance);
 
 extern int		qdevice_net_instance_init_from_cmap(struct qdevice_instance *instance);
 
+extern void		qdevice_net_instance_select_next_server(
+    struct qdevice_net_instance *instance);
+
+extern struct qdevice_net_node_list_state *qdevice_net_instance_get_node_list_state(
+    struct qdevice_net_instance *instance, enum tlv_node_list_type node_list_type);
+
 #ifdef __cplusplus
 }
 #endif
@@ -36,6 +36,7 @@
 #include "qdevice-net-ipc-cmd.h"
 #include "dynar-str.h"
 #include "qdevice-net-algorithm.h"
+#include "qdevice-net-socket.h"
 #include "utils.h"
 
 static int
@@ -77,16 +78,11 @@ qdevice_net_ipc_cmd_status_add_tie_breaker(struct qdevice_net_instance *instance
 	return (dynar_str_catf(outbuf, "\n") != -1);
 }
 
-static int
-qdevice_net_ipc_cmd_status_add_kap_tb_info(struct qdevice_net_instance *instance,
-    struct dynar *outbuf, int verbose)
+static const char *
+qdevice_net_ipc_cmd_kap_tb_str(struct qdevice_net_instance *instance)
 {
 	const char *kap_tb_str;
 
-	if (!verbose) {
-		return (1);
-	}
-
 	kap_tb_str = "";
 
 	switch (instance->decision_algorithm) {
@@ -112,7 +108,20 @@ qdevice_net_ipc_cmd_status_add_kap_tb_info(struct qdevice_net_instance *instance
 		break;
 	}
 
-	return (dynar_str_catf(outbuf, "KAP Tie-breaker:\t%s\n", kap_tb_str) != -1);
+	return (kap_tb_str);
+}
+
+static int
+qdevice_net_ipc_cmd_status_add_kap_tb_info(struct qdevice_net_instance *instance,
+    struct dynar *outbuf, int verbose)
+{
+
+	if (!verbose) {
+		return (1);
+	}
+
+	return (dynar_str_catf(outbuf, "KAP Tie-breaker:\t%s\n",
+	    qdevice_net_ipc_cmd_kap_tb_str(instance)) != -1);
 }
 
 static int
@@ -151,6 +160,25 @@ qdevice_net_ipc_cmd_status_add_basic_info(struct qdevice_net_instance *instance,
 			return (0);
 		}
 
+		if (dynar_str_catf(outbuf, "Adaptive HB:\t\t%s\n",
+		    (instance->adaptive_heartbeat ? "Enabled" : "Disabled")) == -1) {
+			return (0);
+		}
+
+		if (instance->adaptive_heartbeat &&
+		    dynar_str_catf(outbuf, "Current HB interval:\t%"PRIu32"ms\n",
+		    instance->current_heartbeat_interval) == -1) {
+			return (0);
+		}
+
+		if (instance->echo_rtt.no_samples > 0 &&
+		    dynar_str_catf(outbuf, "Echo RTT:\t\tlast %"PRIu64"us, srtt %"PRIu64"us, "
+		    "rttvar %"PRIu64"us, min %"PRIu64"us, max %"PRIu64"us\n",
+		    instance->echo_rtt.last_rtt, instance->echo_rtt.srtt,
+		    instance->echo_rtt.rttvar, instance->echo_rtt.min_rtt,
+		    instance->echo_rtt.max_rtt) == -1) {
+			return (0);
+		}
 	}
 
 	if (dynar_str_catf(outbuf, "Algorithm:\t\t%s\n",
@@ -184,9 +212,8 @@ qdevice_net_ipc_cmd_status_add_poll_timer_status(struct qdevice_net_instance *in
 	return (dynar_str_catf(outbuf, "\n") != -1);
 }
 
-static int
-qdevice_net_ipc_cmd_status_add_state(struct qdevice_net_instance *instance,
-    struct dynar *outbuf, int verbose)
+static const char *
+qdevice_net_ipc_cmd_state_str(struct qdevice_net_instance *instance)
 {
 	const char *state;
 
@@ -197,7 +224,7 @@ qdevice_net_ipc_cmd_status_add_state(struct qdevice_net_instance *instance,
 			state = "Connected";
 		} else {
 			if (instance->state != QDEVICE_NET_INSTANCE_STATE_WAITING_CONNECT ||
-			    !instance->non_blocking_client.destroyed) {
+			    qdevice_net_socket_is_connecting(instance)) {
 				state = "Connecting";
 			} else {
 				state = "Connect failed";
@@ -205,7 +232,16 @@ qdevice_net_ipc_cmd_status_add_state(struct qdevice_net_instance *instance,
 		}
 	}
 
-	return (dynar_str_catf(outbuf, "State:\t\t\t%s\n", state) != -1);
+	return (state);
+}
+
+static int
+qdevice_net_ipc_cmd_status_add_state(struct qdevice_net_instance *instance,
+    struct dynar *outbuf, int verbose)
+{
+
+	return (dynar_str_catf(outbuf, "State:\t\t\t%s\n",
+	    qdevice_net_ipc_cmd_state_str(instance)) != -1);
 }
 
 static int
@@ -293,10 +329,170 @@ qdevice_net_ipc_cmd_status_add_times(struct qdevice_net_instance *instance,
 	return (1);
 }
 
+static int
+qdevice_net_ipc_cmd_status_json_add_tie_breaker(struct qdevice_net_instance *instance,
+    struct dynar *outbuf)
+{
+	int res;
+
+	res = 0;
+
+	switch (instance->tie_breaker.mode) {
+	case TLV_TIE_BREAKER_MODE_LOWEST:
+		res = dynar_str_catf(outbuf, ",\"tie_breaker\":{\"mode\":\"lowest\"}");
+		break;
+	case TLV_TIE_BREAKER_MODE_HIGHEST:
+		res = dynar_str_catf(outbuf, ",\"tie_breaker\":{\"mode\":\"highest\"}");
+		break;
+	case TLV_TIE_BREAKER_MODE_NODE_ID:
+		res = dynar_str_catf(outbuf, ",\"tie_breaker\":{\"mode\":\"node_id\","
+		    "\"node_id\":%"PRIu32"}", instance->tie_breaker.node_id);
+		break;
+	}
+
+	return (res != -1);
+}
+
+static int
+qdevice_net_ipc_cmd_status_json_add_time(struct dynar *outbuf, const char *key, time_t t)
+{
+	struct tm tm_res;
+
+	if (t == ((time_t) -1)) {
+		return (1);
+	}
+
+	localtime_r(&t, &tm_res);
+
+	return (dynar_str_catf(outbuf, ",\"%s\":\"%04d-%02d-%02dT%02d:%02d:%02d\"", key,
+	    tm_res.tm_year + 1900, tm_res.tm_mon + 1, tm_res.tm_mday,
+	    tm_res.tm_hour, tm_res.tm_min, tm_res.tm_sec) != -1);
+}
+
+static int
+qdevice_net_ipc_cmd_status_json(struct qdevice_net_instance *instance, struct dynar *outbuf,
+    int verbose)
+{
+	enum qdevice_heuristics_mode active_heuristics_mode;
+	int connected;
+
+	connected = (instance->state == QDEVICE_NET_INSTANCE_STATE_WAITING_VOTEQUORUM_CMAP_EVENTS);
+
+	if (dynar_str_cat(outbuf, "{\"cluster_name\":") != 0 ||
+	    dynar_str_json_quote_cat(outbuf, instance->cluster_name) != 0 ||
+	    dynar_str_cat(outbuf, ",\"qnetd_host\":") != 0 ||
+	    dynar_str_json_quote_cat(outbuf, instance->host_addr) != 0 ||
+	    dynar_str_catf(outbuf, ",\"qnetd_port\":%"PRIu16, instance->host_port) == -1) {
+		return (0);
+	}
+
+	if (verbose) {
+		if (instance->force_ip_version != 0 &&
+		    dynar_str_catf(outbuf, ",\"force_ip_version\":%u",
+		    instance->force_ip_version) == -1) {
+			return (0);
+		}
+
+		if (dynar_str_catf(outbuf, ",\"connect_timeout\":%"PRIu32
+		    ",\"hb_interval\":%"PRIu32",\"vq_vote_timer_interval\":%"PRIu32
+		    ",\"tls\":\"%s\"",
+		    instance->connect_timeout, instance->heartbeat_interval,
+		    instance->cast_vote_timer_interval,
+		    tlv_tls_supported_to_str(instance->tls_supported)) == -1) {
+			return (0);
+		}
+
+		if (dynar_str_catf(outbuf, ",\"adaptive_hb\":%s,\"current_hb_interval\":%"PRIu32,
+		    (instance->adaptive_heartbeat ? "true" : "false"),
+		    instance->current_heartbeat_interval) == -1) {
+			return (0);
+		}
+
+		if (instance->echo_rtt.no_samples > 0 &&
+		    dynar_str_catf(outbuf, ",\"echo_rtt\":{\"last\":%"PRIu64",\"srtt\":%"PRIu64
+		    ",\"rttvar\":%"PRIu64",\"min\":%"PRIu64",\"max\":%"PRIu64
+		    ",\"samples\":%"PRIu32"}",
+		    instance->echo_rtt.last_rtt, instance->echo_rtt.srtt,
+		    instance->echo_rtt.rttvar, instance->echo_rtt.min_rtt,
+		    instance->echo_rtt.max_rtt, instance->echo_rtt.no_samples) == -1) {
+			return (0);
+		}
+	}
+
+	if (dynar_str_catf(outbuf, ",\"algorithm\":\"%s\"",
+	    tlv_decision_algorithm_type_to_str(instance->decision_algorithm)) == -1) {
+		return (0);
+	}
+
+	if (!qdevice_net_ipc_cmd_status_json_add_tie_breaker(instance, outbuf)) {
+		return (0);
+	}
+
+	if (verbose) {
+		if (dynar_str_catf(outbuf, ",\"kap_tie_breaker\":\"%s\"",
+		    qdevice_net_ipc_cmd_kap_tb_str(instance)) == -1) {
+			return (0);
+		}
+
+		if (dynar_str_catf(outbuf, ",\"poll_timer_running\":%s"
+		    ",\"poll_timer_cast_vote\":%s",
+		    (instance->cast_vote_timer != NULL ? "true" : "false"),
+		    (instance->cast_vote_timer != NULL &&
+		    instance->cast_vote_timer_vote == TLV_VOTE_ACK ? "true" : "false")) == -1) {
+			return (0);
+		}
+	}
+
+	if (dynar_str_catf(outbuf, ",\"state\":\"%s\"",
+	    qdevice_net_ipc_cmd_state_str(instance)) == -1) {
+		return (0);
+	}
+
+	active_heuristics_mode = instance->qdevice_instance_ptr->heuristics_instance.mode;
+	if (active_heuristics_mode == QDEVICE_HEURISTICS_MODE_ENABLED ||
+	    active_heuristics_mode == QDEVICE_HEURISTICS_MODE_SYNC) {
+		if (dynar_str_catf(outbuf, ",\"heuristics_result\":\"%s\"",
+		    tlv_heuristics_to_str(instance->latest_heuristics_result)) == -1) {
+			return (0);
+		}
+
+		if (verbose && dynar_str_catf(outbuf, ",\"regular_heuristics_result\":\"%s\""
+		    ",\"membership_heuristics_result\":\"%s\""
+		    ",\"connect_heuristics_result\":\"%s\"",
+		    tlv_heuristics_to_str(instance->latest_regular_heuristics_result),
+		    tlv_heuristics_to_str(instance->latest_vq_heuristics_result),
+		    tlv_heuristics_to_str(instance->latest_connect_heuristics_result)) == -1) {
+			return (0);
+		}
+	}
+
+	if (verbose && connected) {
+		if (dynar_str_catf(outbuf, ",\"tls_active\":%s,\"client_certificate_sent\":%s",
+		    (instance->using_tls ? "true" : "false"),
+		    (instance->using_tls && instance->tls_client_cert_sent ? "true" : "false")) == -1) {
+			return (0);
+		}
+
+		if (!qdevice_net_ipc_cmd_status_json_add_time(outbuf, "connected_since",
+		    instance->connected_since_time) ||
+		    !qdevice_net_ipc_cmd_status_json_add_time(outbuf, "echo_reply_received",
+		    instance->last_echo_reply_received_time)) {
+			return (0);
+		}
+	}
+
+	return (dynar_str_cat(outbuf, "}") == 0);
+}
+
 int
-qdevice_net_ipc_cmd_status(struct qdevice_net_instance *instance, struct dynar *outbuf, int verbose)
+qdevice_net_ipc_cmd_status(struct qdevice_net_instance *instance, struct dynar *outbuf, int verbose,
+    int json)
 {
 
+	if (json) {
+		return (qdevice_net_ipc_cmd_status_json(instance, outbuf, verbose));
+	}
+
 	if (qdevice_net_ipc_cmd_status_add_header(outbuf, verbose) &&
 	    qdevice_net_ipc_cmd_status_add_basic_info(instance, outbuf, verbose) &&
 	    qdevice_net_ipc_cmd_status_add_tie_breaker(instance, outbuf, verbose) &&
@@ -43,7 +43,7 @@ extern "C" {
 #endif
 
 extern int	qdevice_net_ipc_cmd_status(struct qdevice_net_instance *instance,
-    struct dynar *outbuf, int verbose);
+    struct dynar *outbuf, int verbose, int json);
 
 #ifdef __cplusplus
 }
@@ -32,8 +32,10 @@
  * THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "flight-recorder.h"
 #include "log.h"
 #include "log-common.h"
+#include "qdevice-ipc.h"
 #include "qdevice-net-algorithm.h"
 #include "qdevice-net-cast-vote-timer.h"
 #include "qdevice-net-heuristics.h"
@@ -352,6 +354,7 @@ qdevice_net_msg_received_init_reply(struct qdevice_net_instance *instance,
 	 */
 	instance->server_supports_heuristics = 0;
 	instance->server_supports_keep_active_partition_tie_breaker = 0;
+	instance->server_supports_node_list_delta = 0;
 
 	for (zi = 0; zi < msg->no_supported_options; zi++) {
 		if (msg->supported_options[zi] == TLV_OPT_HEURISTICS) {
@@ -361,6 +364,11 @@ qdevice_net_msg_received_init_reply(struct qdevice_net_instance *instance,
 		if (msg->supported_options[zi] == TLV_OPT_KEEP_ACTIVE_PARTITION_TIE_BREAKER) {
 			instance->server_supports_keep_active_partition_tie_breaker = 1;
 		}
+
+		if (msg->supported_options[zi] == TLV_OPT_NODE_LIST_BASE_VERSION &&
+		    instance->advanced_settings->net_node_list_delta) {
+			instance->server_supports_node_list_delta = 1;
+		}
 	}
 
 	if (!instance->server_supports_heuristics) {
@@ -380,6 +388,10 @@ qdevice_net_msg_received_init_reply(struct qdevice_net_instance *instance,
 	/*
 	 * Finally fully connected so it's possible to remove connection timer
 	 */
+	flight_recorder_record_event(FLIGHT_RECORDER_EVENT_TYPE_CONNECTED, instance->cluster_name,
+	    instance->qdevice_instance_ptr->node_id);
+	qdevice_ipc_send_event(instance->qdevice_instance_ptr, "qnetd_connected", NULL);
+
 	if (instance->connect_timer != NULL) {
 		timer_list_entry_delete(
 		    pr_poll_loop_get_timer_list(&instance->qdevice_instance_ptr->main_poll_loop),
@@ -418,6 +430,19 @@ qdevice_net_msg_received_server_error(struct qdevice_net_instance *instance,
     const struct msg_decoded *msg)
 {
 
+	if (msg->reply_error_code_set &&
+	    msg->reply_error_code == TLV_REPLY_ERROR_CODE_INVALID_HEARTBEAT_INTERVAL &&
+	    instance->requested_heartbeat_interval != 0 && msg->seq_number_set &&
+	    msg->seq_number == instance->requested_heartbeat_interval_msg_seq_num) {
+		/*
+		 * Interval requested by adaptive heartbeat is out of server limits. This is
+		 * not fatal, current interval is kept.
+		 */
+		qdevice_net_echo_request_timer_interval_refused(instance);
+
+		return (0);
+	}
+
 	if (!msg->reply_error_code_set) {
 		log(LOG_ERR, "Received server error without error code set. "
 		    "Disconnecting from server");
@@ -463,7 +488,8 @@ qdevice_net_msg_received_set_option_reply(struct qdevice_net_instance *instance,
 	    tlv_keep_active_partition_tie_breaker_to_str(msg->keep_active_partition_tie_breaker));
 
 	if (msg->heartbeat_interval_set) {
-		if (qdevice_net_echo_request_timer_schedule(instance) != 0) {
+		if (qdevice_net_echo_request_timer_set_interval(instance,
+		    msg->heartbeat_interval) != 0) {
 			return (-1);
 		}
 	}
@@ -503,6 +529,11 @@ qdevice_net_msg_received_echo_reply(struct qdevice_net_instance *instance,
 		return (-1);
 	}
 
+	if (msg->seq_number == instance->echo_request_expected_msg_seq_num &&
+	    qdevice_net_echo_request_timer_reply_received(instance) != 0) {
+		return (-1);
+	}
+
 	instance->echo_reply_received_msg_seq_num = msg->seq_number;
 	instance->last_echo_reply_received_time = time(NULL);
 
@@ -576,6 +607,23 @@ qdevice_net_msg_received_node_list_reply(struct qdevice_net_instance *instance,
 	log(LOG_DEBUG, "  ring id = ("UTILS_PRI_RING_ID")",
 		    msg->ring_id.node_id, msg->ring_id.seq);
 
+	if (instance->server_supports_node_list_delta && msg->node_list_version_set) {
+		res = qdevice_net_send_node_list_reply_received(instance, msg->node_list_type,
+		    msg->seq_number, msg->node_list_version);
+
+		if (res == -1) {
+			instance->disconnect_reason =
+			    QDEVICE_NET_DISCONNECT_REASON_CANT_ALLOCATE_MSG_BUFFER;
+			return (-1);
+		} else if (res == 1) {
+			/*
+			 * Server couldn't apply delta and full node list was resent.
+			 * Vote is sent in reply to the full node list.
+			 */
+			return (0);
+		}
+	}
+
 	/*
 	 * Call algorithm
 	 */
@@ -875,6 +923,9 @@ qdevice_net_msg_received(struct qdevice_net_instance *instance)
 		return (-1);
 	}
 
+	flight_recorder_record_msg(FLIGHT_RECORDER_EVENT_TYPE_MSG_RECEIVED, instance->cluster_name,
+	    instance->qdevice_instance_ptr->node_id, &msg);
+
 	ret_val = 0;
 
 	msg_processed = 0;
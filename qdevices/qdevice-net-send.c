@@ -32,6 +32,7 @@
  * THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "flight-recorder.h"
 #include "log.h"
 #include "log-common.h"
 #include "qdevice-net-send.h"
@@ -39,6 +40,16 @@
 #include "msg.h"
 #include "utils.h"
 
+static void
+qdevice_net_send_flight_recorder_record(struct qdevice_net_instance *instance,
+    enum msg_type msg_type, uint32_t msg_seq_number)
+{
+
+	flight_recorder_record_msg_info(FLIGHT_RECORDER_EVENT_TYPE_MSG_SENT, instance->cluster_name,
+	    instance->qdevice_instance_ptr->node_id, msg_type, 1, msg_seq_number, 0,
+	    TLV_VOTE_UNDEFINED);
+}
+
 int
 qdevice_net_send_echo_request(struct qdevice_net_instance *instance)
 {
@@ -64,6 +75,9 @@ qdevice_net_send_echo_request(struct qdevice_net_instance *instance)
 
 	send_buffer_list_put(&instance->send_buffer_list, send_buffer);
 
+	qdevice_net_send_flight_recorder_record(instance, MSG_TYPE_ECHO_REQUEST,
+	    instance->echo_request_expected_msg_seq_num);
+
 	return (0);
 }
 
@@ -89,6 +103,9 @@ qdevice_net_send_preinit(struct qdevice_net_instance *instance)
 
 	send_buffer_list_put(&instance->send_buffer_list, send_buffer);
 
+	qdevice_net_send_flight_recorder_record(instance, MSG_TYPE_PREINIT,
+	    instance->last_msg_seq_num);
+
 	instance->state = QDEVICE_NET_INSTANCE_STATE_WAITING_PREINIT_REPLY;
 
 	return (0);
@@ -133,6 +150,9 @@ qdevice_net_send_init(struct qdevice_net_instance *instance)
 
 	send_buffer_list_put(&instance->send_buffer_list, send_buffer);
 
+	qdevice_net_send_flight_recorder_record(instance, MSG_TYPE_INIT,
+	    instance->last_msg_seq_num);
+
 	instance->state = QDEVICE_NET_INSTANCE_STATE_WAITING_INIT_REPLY;
 
 	return (0);
@@ -164,9 +184,212 @@ qdevice_net_send_ask_for_vote(struct qdevice_net_instance *instance)
 
 	send_buffer_list_put(&instance->send_buffer_list, send_buffer);
 
+	qdevice_net_send_flight_recorder_record(instance, MSG_TYPE_ASK_FOR_VOTE,
+	    instance->last_msg_seq_num);
+
 	return (0);
 }
 
+/*
+ * Create node list message. When server supports delta node lists, message contains
+ * node list version and, if previous list of same kind was acknowledged and no other is
+ * waiting for reply, only changes against acknowledged list.
+ */
+static size_t
+qdevice_net_send_create_node_list_msg(struct qdevice_net_instance *instance, struct dynar *msg,
+    enum tlv_node_list_type node_list_type,
+    int add_ring_id, const struct tlv_ring_id *ring_id,
+    int add_config_version, uint64_t config_version,
+    int add_quorate, enum tlv_quorate quorate,
+    int add_heuristics, enum tlv_heuristics heuristics,
+    const struct node_list *nlist, int force_full)
+{
+	struct qdevice_net_node_list_state *state;
+	struct node_list changed_nodes, removed_nodes;
+	uint32_t version;
+	int use_delta;
+	size_t res;
+
+	if (!instance->server_supports_node_list_delta) {
+		return (msg_create_node_list(msg, instance->last_msg_seq_num, node_list_type,
+		    add_ring_id, ring_id, add_config_version, config_version, add_quorate, quorate,
+		    add_heuristics, heuristics, nlist));
+	}
+
+	state = qdevice_net_instance_get_node_list_state(instance, node_list_type);
+
+	version = state->version + 1;
+	if (version == 0) {
+		version = 1;
+	}
+
+	use_delta = (!force_full && state->acked_version != 0 &&
+	    state->acked_version == state->version);
+
+	if (use_delta) {
+		if (node_list_diff(&state->acked_list, nlist, &changed_nodes, &removed_nodes) != 0) {
+			return (0);
+		}
+
+		if (node_list_size(&changed_nodes) + node_list_size(&removed_nodes) >=
+		    node_list_size(nlist)) {
+			node_list_free(&changed_nodes);
+			node_list_free(&removed_nodes);
+			use_delta = 0;
+		}
+	}
+
+	if (use_delta) {
+		log(LOG_DEBUG, "Sending node list version %"PRIu32" as delta against version "
+		    "%"PRIu32" (%zu changed, %zu removed)", version, state->acked_version,
+		    node_list_size(&changed_nodes), node_list_size(&removed_nodes));
+
+		res = msg_create_node_list_versioned(msg, instance->last_msg_seq_num,
+		    node_list_type, add_ring_id, ring_id, add_config_version, config_version,
+		    add_quorate, quorate, add_heuristics, heuristics,
+		    version, 1, state->acked_version, &changed_nodes, &removed_nodes);
+
+		node_list_free(&changed_nodes);
+		node_list_free(&removed_nodes);
+	} else {
+		log(LOG_DEBUG, "Sending node list version %"PRIu32" as full list", version);
+
+		res = msg_create_node_list_versioned(msg, instance->last_msg_seq_num,
+		    node_list_type, add_ring_id, ring_id, add_config_version, config_version,
+		    add_quorate, quorate, add_heuristics, heuristics,
+		    version, 0, 0, nlist, NULL);
+	}
+
+	if (res == 0) {
+		return (0);
+	}
+
+	node_list_free(&state->sent_list);
+	if (node_list_clone(&state->sent_list, nlist) != 0) {
+		log(LOG_ERR, "Can't alloc copy of sent node list");
+
+		return (0);
+	}
+
+	state->version = version;
+	state->msg_seq_num = instance->last_msg_seq_num;
+	state->node_list_type = node_list_type;
+	state->add_ring_id = add_ring_id;
+	if (add_ring_id) {
+		memcpy(&state->ring_id, ring_id, sizeof(state->ring_id));
+	}
+	state->add_config_version = add_config_version;
+	state->config_version = config_version;
+	state->add_quorate = add_quorate;
+	state->quorate = quorate;
+	state->add_heuristics = add_heuristics;
+	state->heuristics = heuristics;
+
+	return (res);
+}
+
+/*
+ * Resend last sent node list of given kind as full list
+ */
+static int
+qdevice_net_send_node_list_full(struct qdevice_net_instance *instance,
+    struct qdevice_net_node_list_state *state)
+{
+	struct send_buffer_list_entry *send_buffer;
+	struct node_list nlist;
+	size_t res;
+
+	if (node_list_clone(&nlist, &state->sent_list) != 0) {
+		log(LOG_ERR, "Can't alloc node list for full resend");
+
+		return (-1);
+	}
+
+	send_buffer = send_buffer_list_get_new(&instance->send_buffer_list);
+	if (send_buffer == NULL) {
+		log(LOG_ERR, "Can't allocate send list buffer for node list msg");
+
+		node_list_free(&nlist);
+
+		return (-1);
+	}
+
+	instance->last_msg_seq_num++;
+
+	log(LOG_DEBUG, "Resending full node list seq = "UTILS_PRI_MSG_SEQ,
+	    instance->last_msg_seq_num);
+	log_common_debug_dump_node_list(&nlist);
+
+	res = qdevice_net_send_create_node_list_msg(instance, &send_buffer->buffer,
+	    state->node_list_type, state->add_ring_id, &state->ring_id,
+	    state->add_config_version, state->config_version,
+	    state->add_quorate, state->quorate, state->add_heuristics, state->heuristics,
+	    &nlist, 1);
+
+	node_list_free(&nlist);
+
+	if (res == 0) {
+		log(LOG_ERR, "Can't allocate send buffer for node list msg");
+
+		send_buffer_list_discard_new(&instance->send_buffer_list, send_buffer);
+		return (-1);
+	}
+
+	send_buffer_list_put(&instance->send_buffer_list, send_buffer);
+
+	qdevice_net_send_flight_recorder_record(instance, MSG_TYPE_NODE_LIST,
+	    instance->last_msg_seq_num);
+
+	return (0);
+}
+
+/*
+ * Process node list version sent by server in node list reply.
+ * Returns 0 if reply should be processed as usual, 1 if server couldn't apply delta
+ * so full node list was resent and reply should be ignored and -1 on error.
+ */
+int
+qdevice_net_send_node_list_reply_received(struct qdevice_net_instance *instance,
+    enum tlv_node_list_type node_list_type, uint32_t msg_seq_num, uint32_t node_list_version)
+{
+	struct qdevice_net_node_list_state *state;
+
+	state = qdevice_net_instance_get_node_list_state(instance, node_list_type);
+
+	if (state->version == 0 || msg_seq_num != state->msg_seq_num) {
+		/*
+		 * Reply to older node list. Newer one was sent as full list.
+		 */
+		return (0);
+	}
+
+	if (node_list_version == state->version) {
+		node_list_free(&state->acked_list);
+		if (node_list_clone(&state->acked_list, &state->sent_list) != 0) {
+			log(LOG_WARNING, "Can't alloc copy of acknowledged node list. "
+			    "Next node list is sent as full list");
+
+			state->acked_version = 0;
+		} else {
+			state->acked_version = node_list_version;
+		}
+
+		return (0);
+	}
+
+	log(LOG_WARNING, "Server has node list version %"PRIu32" but version %"PRIu32
+	    " was sent. Sending full node list", node_list_version, state->version);
+
+	state->acked_version = 0;
+	node_list_free(&state->acked_list);
+
+	if (qdevice_net_send_node_list_full(instance, state) != 0) {
+		return (-1);
+	}
+
+	return (1);
+}
+
 int
 qdevice_net_send_config_node_list(struct qdevice_net_instance *instance,
     const struct node_list *nlist, int config_version_set, uint64_t config_version,
@@ -188,10 +411,10 @@ qdevice_net_send_config_node_list(struct qdevice_net_instance *instance,
 	    instance->last_msg_seq_num);
 	log_common_debug_dump_node_list(nlist);
 
-	if (msg_create_node_list(&send_buffer->buffer, instance->last_msg_seq_num,
+	if (qdevice_net_send_create_node_list_msg(instance, &send_buffer->buffer,
 	    (initial ? TLV_NODE_LIST_TYPE_INITIAL_CONFIG : TLV_NODE_LIST_TYPE_CHANGED_CONFIG),
 	    0, NULL, config_version_set, config_version, 0, TLV_QUORATE_INQUORATE,
-	    0, TLV_HEURISTICS_UNDEFINED, nlist) == 0) {
+	    0, TLV_HEURISTICS_UNDEFINED, nlist, initial) == 0) {
 		log(LOG_ERR, "Can't allocate send buffer for config list msg");
 
 		send_buffer_list_discard_new(&instance->send_buffer_list, send_buffer);
@@ -200,6 +423,9 @@ qdevice_net_send_config_node_list(struct qdevice_net_instance *instance,
 
 	send_buffer_list_put(&instance->send_buffer_list, send_buffer);
 
+	qdevice_net_send_flight_recorder_record(instance, MSG_TYPE_NODE_LIST,
+	    instance->last_msg_seq_num);
+
 	return (0);
 }
 
@@ -232,6 +458,9 @@ qdevice_net_send_heuristics_change(struct qdevice_net_instance *instance,
 
 	send_buffer_list_put(&instance->send_buffer_list, send_buffer);
 
+	qdevice_net_send_flight_recorder_record(instance, MSG_TYPE_HEURISTICS_CHANGE,
+	    instance->last_msg_seq_num);
+
 	return (0);
 }
 
@@ -273,9 +502,9 @@ qdevice_net_send_membership_node_list(struct qdevice_net_instance *instance,
 	    ring_id->node_id, ring_id->seq, tlv_heuristics_to_str(heuristics));
 	log_common_debug_dump_node_list(&nlist);
 
-	if (msg_create_node_list(&send_buffer->buffer, instance->last_msg_seq_num,
+	if (qdevice_net_send_create_node_list_msg(instance, &send_buffer->buffer,
 	    TLV_NODE_LIST_TYPE_MEMBERSHIP,
-	    1, ring_id, 0, 0, 0, 0, 1, heuristics, &nlist) == 0) {
+	    1, ring_id, 0, 0, 0, 0, 1, heuristics, &nlist, 0) == 0) {
 		log(LOG_ERR, "Can't allocate send buffer for membership list msg");
 
 		node_list_free(&nlist);
@@ -290,6 +519,9 @@ qdevice_net_send_membership_node_list(struct qdevice_net_instance *instance,
 
 	send_buffer_list_put(&instance->send_buffer_list, send_buffer);
 
+	qdevice_net_send_flight_recorder_record(instance, MSG_TYPE_NODE_LIST,
+	    instance->last_msg_seq_num);
+
 	return (0);
 }
 
@@ -335,9 +567,9 @@ qdevice_net_send_quorum_node_list(struct qdevice_net_instance *instance,
 	    instance->last_msg_seq_num, quorate);
 	log_common_debug_dump_node_list(&nlist);
 
-	if (msg_create_node_list(&send_buffer->buffer, instance->last_msg_seq_num,
+	if (qdevice_net_send_create_node_list_msg(instance, &send_buffer->buffer,
 	    TLV_NODE_LIST_TYPE_QUORUM,
-	    0, NULL, 0, 0, 1, quorate, 0, TLV_HEURISTICS_UNDEFINED, &nlist) == 0) {
+	    0, NULL, 0, 0, 1, quorate, 0, TLV_HEURISTICS_UNDEFINED, &nlist, 0) == 0) {
 		log(LOG_ERR, "Can't allocate send buffer for quorum list msg");
 
 		node_list_free(&nlist);
@@ -350,6 +582,9 @@ qdevice_net_send_quorum_node_list(struct qdevice_net_instance *instance,
 
 	send_buffer_list_put(&instance->send_buffer_list, send_buffer);
 
+	qdevice_net_send_flight_recorder_record(instance, MSG_TYPE_NODE_LIST,
+	    instance->last_msg_seq_num);
+
 	return (0);
 }
 
@@ -387,5 +622,8 @@ qdevice_net_send_set_option(struct qdevice_net_instance *instance,
 
 	send_buffer_list_put(&instance->send_buffer_list, send_buffer);
 
+	qdevice_net_send_flight_recorder_record(instance, MSG_TYPE_SET_OPTION,
+	    instance->last_msg_seq_num);
+
 	return (0);
 }
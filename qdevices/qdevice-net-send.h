@@ -55,6 +55,10 @@ extern int		qdevice_net_send_config_node_list(struct qdevice_net_instance *insta
     const struct node_list *nlist, int config_version_set, uint64_t config_version,
     int initial);
 
+extern int		qdevice_net_send_node_list_reply_received(
+    struct qdevice_net_instance *instance, enum tlv_node_list_type node_list_type,
+    uint32_t msg_seq_num, uint32_t node_list_version);
+
 extern int		qdevice_net_send_heuristics_change(struct qdevice_net_instance *instance,
     enum tlv_heuristics heuristics);
 
@@ -84,6 +84,27 @@ socket_write_cb(PRFileDesc *prfd, const PRPollDesc *pd, void *user_data1, void *
 	return (0);
 }
 
+static PRIntn
+socket_get_af(const struct qdevice_net_instance *instance)
+{
+	PRIntn af;
+
+	af = PR_AF_UNSPEC;
+	if (instance->force_ip_version == 4) {
+		af = PR_AF_INET;
+	}
+
+	if (instance->force_ip_version == 6) {
+		af = PR_AF_INET6;
+	}
+
+	return (af);
+}
+
+static int
+non_blocking_client_add_to_main_poll_loop(struct qdevice_net_instance *instance,
+    PRFileDesc **connecting_socket);
+
 static int
 non_blocking_client_socket_write_cb(PRFileDesc *prfd, const PRPollDesc *pd, void *user_data1,
     void *user_data2)
@@ -91,27 +112,38 @@ non_blocking_client_socket_write_cb(PRFileDesc *prfd, const PRPollDesc *pd, void
 	int res;
 
 	struct qdevice_net_instance *instance = (struct qdevice_net_instance *)user_data1;
+	PRFileDesc **connecting_socket = (PRFileDesc **)user_data2;
+
+	if (instance->state != QDEVICE_NET_INSTANCE_STATE_WAITING_CONNECT) {
+		/*
+		 * Connection to other address was already established. This one is
+		 * closed by check_schedule_disconnect_cb
+		 */
+		return (0);
+	}
 
 	res = nss_sock_non_blocking_client_succeeded(pd);
 	if (res == -1) {
 		/*
-		 * Connect failed -> remove this fd from main loop and try next
+		 * Connect failed -> remove this fd from main loop and try next address
 		 */
-		res = qdevice_net_socket_del_from_main_poll_loop(instance);
-		if (res == -1) {
+		if (pr_poll_loop_del_prfd(&instance->qdevice_instance_ptr->main_poll_loop,
+		    *connecting_socket) != 0) {
+			log(LOG_ERR, "Can't remove net socket (non_blocking_client) "
+			    "fd from main poll loop");
+
 			return (-1);
 		}
 
-		res = nss_sock_non_blocking_client_try_next(&instance->non_blocking_client);
-		if (res == -1) {
-			log_nss(LOG_ERR, "Can't connect to qnetd host.");
-			nss_sock_non_blocking_client_destroy(&instance->non_blocking_client);
+		if (PR_Close(*connecting_socket) != PR_SUCCESS) {
+			log_nss(LOG_WARNING, "Unable to close non-blocking client connection");
 		}
+		*connecting_socket = NULL;
 
-		res = qdevice_net_socket_add_to_main_poll_loop(instance);
-		if (res == -1) {
-			return (-1);
-		}
+		/*
+		 * Don't wait for stagger timer, start connecting to next address now
+		 */
+		return (qdevice_net_socket_connect_next_addr(instance));
 	} else if (res == 0) {
 		/*
 		 * Poll again
@@ -120,14 +152,24 @@ non_blocking_client_socket_write_cb(PRFileDesc *prfd, const PRPollDesc *pd, void
 		/*
 		 * Connect success -> delete socket from main loop and add final one
 		 */
-		res = qdevice_net_socket_del_from_main_poll_loop(instance);
-		if (res == -1) {
+		if (pr_poll_loop_del_prfd(&instance->qdevice_instance_ptr->main_poll_loop,
+		    *connecting_socket) != 0) {
+			log(LOG_ERR, "Can't remove net socket (non_blocking_client) "
+			    "fd from main poll loop");
+
 			return (-1);
 		}
 
-		instance->socket = instance->non_blocking_client.socket;
+		instance->socket = *connecting_socket;
+		*connecting_socket = NULL;
 		nss_sock_non_blocking_client_destroy(&instance->non_blocking_client);
-		instance->non_blocking_client.socket = NULL;
+
+		if (instance->connect_stagger_timer != NULL) {
+			timer_list_entry_delete(pr_poll_loop_get_timer_list(
+			    &instance->qdevice_instance_ptr->main_poll_loop),
+			    instance->connect_stagger_timer);
+			instance->connect_stagger_timer = NULL;
+		}
 
 		instance->state = QDEVICE_NET_INSTANCE_STATE_SENDING_PREINIT_REPLY;
 
@@ -136,6 +178,9 @@ non_blocking_client_socket_write_cb(PRFileDesc *prfd, const PRPollDesc *pd, void
 			return (-1);
 		}
 
+		log(LOG_DEBUG, "Connected to qnetd server %s:%u", instance->host_addr,
+		    instance->host_port);
+
 		log(LOG_DEBUG, "Sending preinit msg to qnetd");
 		if (qdevice_net_send_preinit(instance) != 0) {
 			instance->disconnect_reason = QDEVICE_NET_DISCONNECT_REASON_CANT_ALLOCATE_MSG_BUFFER;
@@ -166,21 +211,42 @@ static int
 non_blocking_client_socket_err_cb(PRFileDesc *prfd, short revents, const PRPollDesc *pd,
     void *user_data1, void *user_data2)
 {
-	struct qdevice_net_instance *instance = (struct qdevice_net_instance *)user_data1;
+	PRFileDesc **connecting_socket = (PRFileDesc **)user_data2;
 
 	/*
 	 * Workaround for RHEL<7. Pollout is never set for nonblocking connect (doesn't work
 	 * only with poll, select works as expected!???).
-	 * So test if client is still valid and if pollout was not already called (ensured
+	 * So test if connect is still pending and if pollout was not already called (ensured
 	 * by default because of order in PR_Poll).
 	 * If both applies it's possible to emulate pollout set by calling poll_write.
 	 */
-	if (!instance->non_blocking_client.destroyed) {
+	if (*connecting_socket == prfd) {
 		return (non_blocking_client_socket_write_cb(prfd, pd, user_data1, user_data2));
 	}
 
 	return (0);
 }
+
+static int
+non_blocking_client_add_to_main_poll_loop(struct qdevice_net_instance *instance,
+    PRFileDesc **connecting_socket)
+{
+
+	if (pr_poll_loop_add_prfd(&instance->qdevice_instance_ptr->main_poll_loop,
+	    *connecting_socket,
+	    POLLOUT|POLLPRI,
+	    NULL, NULL, non_blocking_client_socket_write_cb,
+	    non_blocking_client_socket_err_cb,
+	    instance, connecting_socket) != 0) {
+		log(LOG_ERR, "Can't add net socket (non_blocking_client) "
+		    "fd to main poll loop");
+
+		return (-1);
+	}
+
+	return (0);
+}
+
 /*
  * Exported functions
  */
@@ -359,32 +425,29 @@ qdevice_net_socket_write(struct qdevice_net_instance *instance)
 int
 qdevice_net_socket_add_to_main_poll_loop(struct qdevice_net_instance *instance)
 {
+	size_t i;
 
-	if (instance->state != QDEVICE_NET_INSTANCE_STATE_WAITING_CONNECT ||
-	    !instance->non_blocking_client.destroyed) {
-		if (instance->state == QDEVICE_NET_INSTANCE_STATE_WAITING_CONNECT) {
-			if (pr_poll_loop_add_prfd(&instance->qdevice_instance_ptr->main_poll_loop,
-			    instance->non_blocking_client.socket,
-			    POLLOUT|POLLPRI,
-			    NULL, NULL, non_blocking_client_socket_write_cb,
-			    non_blocking_client_socket_err_cb,
-			    instance, NULL) != 0) {
-				log(LOG_ERR, "Can't add net socket (non_blocking_client) "
-				    "fd to main poll loop");
-
-				return (-1);
+	if (instance->state == QDEVICE_NET_INSTANCE_STATE_WAITING_CONNECT) {
+		for (i = 0; i < QDEVICE_NET_MAX_PARALLEL_CONNECTS; i++) {
+			if (instance->connecting_sockets[i] == NULL) {
+				continue;
 			}
-		} else {
-			if (pr_poll_loop_add_prfd(&instance->qdevice_instance_ptr->main_poll_loop,
-			    instance->socket,
-			    POLLIN,
-			    socket_set_events_cb, socket_read_cb, socket_write_cb, socket_err_cb,
-			    instance, NULL) != 0) {
-				log(LOG_ERR, "Can't add net socket fd to main poll loop");
 
+			if (non_blocking_client_add_to_main_poll_loop(instance,
+			    &instance->connecting_sockets[i]) != 0) {
 				return (-1);
 			}
 		}
+	} else {
+		if (pr_poll_loop_add_prfd(&instance->qdevice_instance_ptr->main_poll_loop,
+		    instance->socket,
+		    POLLIN,
+		    socket_set_events_cb, socket_read_cb, socket_write_cb, socket_err_cb,
+		    instance, NULL) != 0) {
+			log(LOG_ERR, "Can't add net socket fd to main poll loop");
+
+			return (-1);
+		}
 	}
 
 	return (0);
@@ -393,10 +456,15 @@ qdevice_net_socket_add_to_main_poll_loop(struct qdevice_net_instance *instance)
 int
 qdevice_net_socket_del_from_main_poll_loop(struct qdevice_net_instance *instance)
 {
+	size_t i;
+
+	for (i = 0; i < QDEVICE_NET_MAX_PARALLEL_CONNECTS; i++) {
+		if (instance->connecting_sockets[i] == NULL) {
+			continue;
+		}
 
-	if (!instance->non_blocking_client.destroyed) {
 		if (pr_poll_loop_del_prfd(&instance->qdevice_instance_ptr->main_poll_loop,
-		    instance->non_blocking_client.socket) != 0) {
+		    instance->connecting_sockets[i]) != 0) {
 			log(LOG_ERR, "Can't remove net socket (non_blocking_client) "
 			    "fd from main poll loop");
 
@@ -415,3 +483,130 @@ qdevice_net_socket_del_from_main_poll_loop(struct qdevice_net_instance *instance
 
 	return (0);
 }
+
+/*
+ * Resolve current server and start connecting to its first address. Only one
+ * server is connected at a time (servers don't share state, so connecting to more
+ * of them could give vote to more partitions). Next server from the list is
+ * selected by qdevice_net_instance_select_next_server when connection fails.
+ */
+int
+qdevice_net_socket_connect(struct qdevice_net_instance *instance)
+{
+	size_t i;
+
+	for (i = 0; i < QDEVICE_NET_MAX_PARALLEL_CONNECTS; i++) {
+		instance->connecting_sockets[i] = NULL;
+	}
+
+	log(LOG_DEBUG, "Trying connect to qnetd server %s:%u", instance->host_addr,
+	    instance->host_port);
+
+	if (nss_sock_non_blocking_client_init(instance->host_addr, instance->host_port,
+	    socket_get_af(instance), &instance->non_blocking_client) == -1) {
+		log_nss(LOG_ERR, "Can't initialize non blocking client connection");
+
+		return (0);
+	}
+
+	return (qdevice_net_socket_connect_next_addr(instance));
+}
+
+/*
+ * Start connecting to next address of current server. Connections to addresses
+ * are raced and first established one is used. When all addresses were tried,
+ * connect timer decides.
+ */
+int
+qdevice_net_socket_connect_next_addr(struct qdevice_net_instance *instance)
+{
+	PRFileDesc **connecting_socket;
+	size_t i;
+
+	connecting_socket = NULL;
+	for (i = 0; i < QDEVICE_NET_MAX_PARALLEL_CONNECTS; i++) {
+		if (instance->connecting_sockets[i] == NULL) {
+			connecting_socket = &instance->connecting_sockets[i];
+			break;
+		}
+	}
+
+	/*
+	 * When all parallel connects are pending, wait until one of them fails
+	 */
+	if (!instance->non_blocking_client.destroyed && connecting_socket != NULL) {
+		if (nss_sock_non_blocking_client_try_next(&instance->non_blocking_client) == -1) {
+			nss_sock_non_blocking_client_destroy(&instance->non_blocking_client);
+		} else {
+			/*
+			 * Socket is taken from non_blocking_client so next try_next
+			 * doesn't close it
+			 */
+			*connecting_socket = instance->non_blocking_client.socket;
+			instance->non_blocking_client.socket = NULL;
+
+			if (non_blocking_client_add_to_main_poll_loop(instance,
+			    connecting_socket) != 0) {
+				return (-1);
+			}
+		}
+	}
+
+	if (!qdevice_net_socket_is_connecting(instance)) {
+		log_nss(LOG_ERR, "Can't connect to qnetd host.");
+	}
+
+	return (0);
+}
+
+int
+qdevice_net_socket_is_connecting(const struct qdevice_net_instance *instance)
+{
+	size_t i;
+
+	if (!instance->non_blocking_client.destroyed) {
+		return (1);
+	}
+
+	for (i = 0; i < QDEVICE_NET_MAX_PARALLEL_CONNECTS; i++) {
+		if (instance->connecting_sockets[i] != NULL) {
+			return (1);
+		}
+	}
+
+	return (0);
+}
+
+/*
+ * Remove pending connections from main poll loop and close them
+ */
+int
+qdevice_net_socket_close_non_blocking_clients(struct qdevice_net_instance *instance)
+{
+	int ret_val;
+	size_t i;
+
+	ret_val = 0;
+
+	for (i = 0; i < QDEVICE_NET_MAX_PARALLEL_CONNECTS; i++) {
+		if (instance->connecting_sockets[i] == NULL) {
+			continue;
+		}
+
+		if (pr_poll_loop_del_prfd(&instance->qdevice_instance_ptr->main_poll_loop,
+		    instance->connecting_sockets[i]) != 0) {
+			log(LOG_ERR, "Can't remove net socket (non_blocking_client) "
+			    "fd from main poll loop");
+			ret_val = -1;
+		}
+
+		if (PR_Close(instance->connecting_sockets[i]) != PR_SUCCESS) {
+			log_nss(LOG_WARNING, "Unable to close non-blocking client connection");
+		}
+		instance->connecting_sockets[i] = NULL;
+	}
+
+	nss_sock_non_blocking_client_destroy(&instance->non_blocking_client);
+
+	return (ret_val);
+}
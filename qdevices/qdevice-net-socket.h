@@ -49,6 +49,16 @@ extern int		qdevice_net_socket_add_to_main_poll_loop(struct qdevice_net_instance
 
 extern int		qdevice_net_socket_del_from_main_poll_loop(struct qdevice_net_instance *instance);
 
+extern int		qdevice_net_socket_connect(struct qdevice_net_instance *instance);
+
+extern int		qdevice_net_socket_connect_next_addr(struct qdevice_net_instance *instance);
+
+extern int		qdevice_net_socket_is_connecting(
+    const struct qdevice_net_instance *instance);
+
+extern int		qdevice_net_socket_close_non_blocking_clients(
+    struct qdevice_net_instance *instance);
+
 #ifdef __cplusplus
 }
 #endif
@@ -32,8 +32,10 @@
  * THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "flight-recorder.h"
 #include "log.h"
 #include "qdevice-cmap.h"
+#include "qdevice-heuristics.h"
 #include "qdevice-heuristics-cmd.h"
 #include "qdevice-heuristics-log.h"
 #include "qdevice-pr-poll-loop-cb.h"
@@ -91,6 +93,22 @@ heuristics_pipe_cmd_recv_read_cb(int fd, void *user_data1, void *user_data2)
 	return (0);
 }
 
+/*
+ * Deliver heuristics result reused by qdevice_heuristics_exec_or_reuse
+ */
+static int
+heuristics_result_cache_pre_poll_cb(void *user_data1, void *user_data2)
+{
+	struct qdevice_instance *instance = (struct qdevice_instance *)user_data1;
+
+	if (qdevice_heuristics_result_cache_deliver(&instance->heuristics_instance) != 0) {
+		instance->heuristics_closed = 1;
+		return (-1);
+	}
+
+	return (0);
+}
+
 static int
 heuristics_pipe_cmd_send_set_events_cb(int fd, short *events, void *user_data1, void *user_data2)
 {
@@ -193,9 +211,19 @@ cmap_err_cb(int fd, short revents, void *user_data1, void *user_data2)
 	return (-1);
 }
 
+static int
+flight_recorder_dump_request_read_cb(int fd, void *user_data1, void *user_data2)
+{
+
+	flight_recorder_dump_request_process(LOG_INFO);
+
+	return (0);
+}
+
 int
 qdevice_pr_poll_loop_cb_register(struct qdevice_instance *instance)
 {
+	int flight_recorder_fd;
 
 	if (pr_poll_loop_add_fd(&instance->main_poll_loop, instance->heuristics_instance.pipe_log_recv,
 	    POLLIN, NULL, heuristics_pipe_log_recv_read_cb, NULL, heuristics_pipe_err_cb,
@@ -222,6 +250,13 @@ qdevice_pr_poll_loop_cb_register(struct qdevice_instance *instance)
 		return (-1);
 	}
 
+	if (pr_poll_loop_add_pre_poll_cb(&instance->main_poll_loop,
+	    heuristics_result_cache_pre_poll_cb, instance, NULL) != 0) {
+		log(LOG_ERR, "Can't add heuristics result cache pre poll callback");
+
+		return (-1);
+	}
+
 	if (pr_poll_loop_add_fd(&instance->main_poll_loop, instance->votequorum_poll_fd,
 	    POLLIN, NULL, votequorum_read_cb, NULL, votequorum_err_cb,
 	    instance, NULL) != 0) {
@@ -238,5 +273,19 @@ qdevice_pr_poll_loop_cb_register(struct qdevice_instance *instance)
 		return (-1);
 	}
 
+	if ((flight_recorder_fd = flight_recorder_dump_request_init()) == -1) {
+		log_err(LOG_ERR, "Can't create flight recorder dump request pipe");
+
+		return (-1);
+	}
+
+	if (pr_poll_loop_add_fd(&instance->main_poll_loop, flight_recorder_fd,
+	    POLLIN, NULL, flight_recorder_dump_request_read_cb, NULL, NULL,
+	    instance, NULL) != 0) {
+		log(LOG_ERR, "Can't add flight recorder dump request pipe to main poll loop");
+
+		return (-1);
+	}
+
 	return (0);
 }
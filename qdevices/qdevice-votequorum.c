@@ -34,8 +34,10 @@
 
 #include <poll.h>
 
+#include "flight-recorder.h"
 #include "log.h"
 #include "qdevice-config.h"
+#include "qdevice-ipc.h"
 #include "qdevice-votequorum.h"
 #include "qdevice-model.h"
 #include "utils.h"
@@ -109,6 +111,10 @@ qdevice_votequorum_heuristics_exec_result_callback(
 	instance->vq_node_list_initial_heuristics_finished = 1;
 	instance->vq_node_list_heuristics_result = exec_result;
 
+	qdevice_ipc_send_event(instance, "heuristics_result",
+	    ",\"type\":\"membership\",\"result\":\"%s\"",
+	    qdevice_heuristics_exec_result_to_str(exec_result));
+
 	return (0);
 }
 
@@ -128,6 +134,10 @@ qdevice_votequorum_node_list_notify_callback(votequorum_handle_t votequorum_hand
 	instance->sync_in_progress = 1;
 	memcpy(&instance->vq_poll_ring_id, &votequorum_ring_id, sizeof(votequorum_ring_id));
 
+	qdevice_ipc_send_event(instance, "ring_id_changed",
+	    ",\"ring_id\":{\"node_id\":%"PRIu32",\"seq\":%"PRIu64"}",
+	    votequorum_ring_id.nodeid, (uint64_t)votequorum_ring_id.seq);
+
 	log(LOG_DEBUG, "Votequorum nodelist notify callback:");
 	log(LOG_DEBUG, "  Ring_id = ("UTILS_PRI_RING_ID")",
 	    votequorum_ring_id.nodeid, votequorum_ring_id.seq);
@@ -151,7 +161,8 @@ qdevice_votequorum_node_list_notify_callback(votequorum_handle_t votequorum_hand
 		exit(EXIT_FAILURE);
 	}
 
-	if (qdevice_heuristics_exec(&instance->heuristics_instance, instance->sync_in_progress) != 0) {
+	if (qdevice_heuristics_exec_or_reuse(&instance->heuristics_instance,
+	    instance->sync_in_progress) != 0) {
 		log(LOG_CRIT, "Can't start heuristics -> exit");
 		exit(EXIT_FAILURE);
 	}
@@ -328,6 +339,16 @@ qdevice_votequorum_poll(struct qdevice_instance *instance, int cast_vote)
 {
 	cs_error_t res;
 
+	if (instance->vq_last_poll == 0 || instance->vq_last_poll_cast_vote != cast_vote) {
+		/*
+		 * Record only changes, regular polls would flood flight recorder
+		 */
+		flight_recorder_record_vote(NULL, instance->node_id,
+		    (cast_vote ? TLV_VOTE_ACK : TLV_VOTE_NACK));
+		qdevice_ipc_send_event(instance, "vote_cast", ",\"vote\":\"%s\"",
+		    tlv_vote_to_str(cast_vote ? TLV_VOTE_ACK : TLV_VOTE_NACK));
+	}
+
 	instance->vq_last_poll = time(NULL);
 	instance->vq_last_poll_cast_vote = cast_vote;
 
@@ -85,9 +85,37 @@ extern "C" {
 #define QNETD_DEFAULT_IPC_MAX_RECEIVE_SIZE		(4*1024)
 #define QNETD_DEFAULT_IPC_MAX_SEND_SIZE			(10*1024*1024)
 #define QNETD_MIN_IPC_RECEIVE_SEND_SIZE			1024
+#define QNETD_DEFAULT_IPC_LIST_CHUNK_SIZE		(16*1024)
+#define QNETD_MIN_IPC_LIST_CHUNK_SIZE			256
+
+#define QNETD_DEFAULT_IPC_SUBSCRIBER_BUFFER_SIZE	(64*1024)
+#define QNETD_MIN_IPC_SUBSCRIBER_BUFFER_SIZE		1024
+
+#define QNETD_DEFAULT_FLIGHT_RECORDER_SIZE		4096
+#define QNETD_MIN_FLIGHT_RECORDER_SIZE			0
+
+#define QNETD_DEFAULT_LOG_ASYNC				0
+#define QNETD_DEFAULT_LOG_ASYNC_QUEUE_SIZE		1024
+#define QNETD_MIN_LOG_ASYNC_QUEUE_SIZE			16
+
+#define QNETD_DEFAULT_LOG_RATELIMIT_BURST		10
+#define QNETD_MIN_LOG_RATELIMIT_BURST			0
+#define QNETD_DEFAULT_LOG_RATELIMIT_INTERVAL		1000
+#define QNETD_MIN_LOG_RATELIMIT_INTERVAL		1
 
 #define QNETD_DEFAULT_KEEP_ACTIVE_PARTITION_TB		TLV_KEEP_ACTIVE_PARTITION_TIE_BREAKER_DISABLED
 
+#define QNETD_DEFAULT_BATCH_ALGORITHM_EVALUATION	0
+
+#define QNETD_DEFAULT_STATE_FILE			""
+#define QNETD_DEFAULT_STATE_FILE_SAVE_INTERVAL		(10*1000)
+#define QNETD_MIN_STATE_FILE_SAVE_INTERVAL		0
+#define QNETD_MAX_STATE_FILE_SAVE_INTERVAL		(60*60*1000)
+#define QNETD_DEFAULT_STATE_FILE_MAX_AGE		(10*60)
+#define QNETD_MIN_STATE_FILE_MAX_AGE			0
+#define QNETD_DEFAULT_STATE_FILE_RESTORE_GRACE		(2*60)
+#define QNETD_MIN_STATE_FILE_RESTORE_GRACE		1
+
 #define QNETD_TOOL_PROGRAM_NAME				"corosync-qnetd-tool"
 
 #define QDEVICE_NET_DEFAULT_NSS_DB_DIR			COROSYSCONFDIR "/qdevice/net/nssdb"
@@ -115,12 +143,33 @@ extern "C" {
 #define QDEVICE_NET_DEFAULT_HEARTBEAT_INTERVAL_MAX	QNETD_DEFAULT_HEARTBEAT_INTERVAL_MAX
 #define QDEVICE_NET_MIN_HEARTBEAT_INTERVAL		1
 
+#define QDEVICE_NET_DEFAULT_ADAPTIVE_HEARTBEAT		0
+#define QDEVICE_NET_DEFAULT_ADAPTIVE_HEARTBEAT_MIN	QNETD_DEFAULT_HEARTBEAT_INTERVAL_MIN
+#define QDEVICE_NET_DEFAULT_ADAPTIVE_HEARTBEAT_MAX	QNETD_DEFAULT_HEARTBEAT_INTERVAL_MAX
+#define QDEVICE_NET_DEFAULT_ADAPTIVE_HEARTBEAT_RTO_MULTIPLIER	4
+#define QDEVICE_NET_MIN_ADAPTIVE_HEARTBEAT_RTO_MULTIPLIER	1
+#define QDEVICE_NET_MAX_ADAPTIVE_HEARTBEAT_RTO_MULTIPLIER	1000
+/*
+ * Number of echo RTT samples needed before heartbeat interval is adapted and minimal
+ * change (in percent) of computed interval which is negotiated with server
+ */
+#define QDEVICE_NET_ADAPTIVE_HEARTBEAT_MIN_SAMPLES	8
+#define QDEVICE_NET_ADAPTIVE_HEARTBEAT_MIN_CHANGE	20
+
 #define QDEVICE_NET_DEFAULT_MIN_CONNECT_TIMEOUT		(1*1000)
 #define QDEVICE_NET_DEFAULT_MAX_CONNECT_TIMEOUT		(2*60*1000)
 #define QDEVICE_NET_MIN_CONNECT_TIMEOUT			1
 
+#define QDEVICE_NET_DEFAULT_CONNECT_STAGGER		250
+#define QDEVICE_NET_MIN_CONNECT_STAGGER			1
+#define QDEVICE_NET_MAX_PARALLEL_CONNECTS		4
+
 #define QDEVICE_NET_DEFAULT_KEEP_ACTIVE_PARTITION_TB	TLV_KEEP_ACTIVE_PARTITION_TIE_BREAKER_ENABLED
 
+#define QDEVICE_NET_DEFAULT_NODE_LIST_DELTA		1
+
+#define QDEVICE_NET_MAX_SERVERS				8
+
 #ifdef DEBUG
 #define QDEVICE_NET_DEFAULT_TEST_ALGORITHM_ENABLED	1
 #else
@@ -79,8 +79,23 @@ qnetd_advanced_settings_init(struct qnetd_advanced_settings *settings)
 	settings->ipc_max_clients = QNETD_DEFAULT_IPC_MAX_CLIENTS;
 	settings->ipc_max_receive_size = QNETD_DEFAULT_IPC_MAX_RECEIVE_SIZE;
 	settings->ipc_max_send_size = QNETD_DEFAULT_IPC_MAX_SEND_SIZE;
+	settings->ipc_list_chunk_size = QNETD_DEFAULT_IPC_LIST_CHUNK_SIZE;
+	settings->ipc_subscriber_buffer_size = QNETD_DEFAULT_IPC_SUBSCRIBER_BUFFER_SIZE;
 
 	settings->keep_active_partition_tie_breaker = QNETD_DEFAULT_KEEP_ACTIVE_PARTITION_TB;
+	settings->batch_algorithm_evaluation = QNETD_DEFAULT_BATCH_ALGORITHM_EVALUATION;
+	if ((settings->state_file = strdup(QNETD_DEFAULT_STATE_FILE)) == NULL) {
+		return (-1);
+	}
+	settings->state_file_save_interval = QNETD_DEFAULT_STATE_FILE_SAVE_INTERVAL;
+	settings->state_file_max_age = QNETD_DEFAULT_STATE_FILE_MAX_AGE;
+	settings->state_file_restore_grace = QNETD_DEFAULT_STATE_FILE_RESTORE_GRACE;
+
+	settings->flight_recorder_size = QNETD_DEFAULT_FLIGHT_RECORDER_SIZE;
+	settings->log_async = QNETD_DEFAULT_LOG_ASYNC;
+	settings->log_async_queue_size = QNETD_DEFAULT_LOG_ASYNC_QUEUE_SIZE;
+	settings->log_ratelimit_burst = QNETD_DEFAULT_LOG_RATELIMIT_BURST;
+	settings->log_ratelimit_interval = QNETD_DEFAULT_LOG_RATELIMIT_INTERVAL;
 
 	return (0);
 }
@@ -93,6 +108,7 @@ qnetd_advanced_settings_destroy(struct qnetd_advanced_settings *settings)
 	free(settings->cert_nickname);
 	free(settings->lock_file);
 	free(settings->local_socket_file);
+	free(settings->state_file);
 }
 
 /*
@@ -216,12 +232,88 @@ qnetd_advanced_settings_set(struct qnetd_advanced_settings *settings,
 		}
 
 		settings->ipc_max_send_size = (size_t)tmpll;
+	} else if (strcasecmp(option, "ipc_list_chunk_size") == 0) {
+		if (utils_strtonum(value, QNETD_MIN_IPC_LIST_CHUNK_SIZE, LLONG_MAX, &tmpll) == -1) {
+			return (-2);
+		}
+
+		settings->ipc_list_chunk_size = (size_t)tmpll;
+	} else if (strcasecmp(option, "ipc_subscriber_buffer_size") == 0) {
+		if (utils_strtonum(value, QNETD_MIN_IPC_SUBSCRIBER_BUFFER_SIZE, LLONG_MAX,
+		    &tmpll) == -1) {
+			return (-2);
+		}
+
+		settings->ipc_subscriber_buffer_size = (size_t)tmpll;
 	} else if (strcasecmp(option, "keep_active_partition_tie_breaker") == 0) {
 		if ((tmpll = utils_parse_bool_str(value)) == -1) {
 			return (-2);
 		}
 
 		settings->keep_active_partition_tie_breaker = (uint8_t)tmpll;
+	} else if (strcasecmp(option, "batch_algorithm_evaluation") == 0) {
+		if ((tmpll = utils_parse_bool_str(value)) == -1) {
+			return (-2);
+		}
+
+		settings->batch_algorithm_evaluation = (uint8_t)tmpll;
+	} else if (strcasecmp(option, "state_file") == 0) {
+		free(settings->state_file);
+
+		if ((settings->state_file = strdup(value)) == NULL) {
+			return (-1);
+		}
+	} else if (strcasecmp(option, "state_file_save_interval") == 0) {
+		if (utils_strtonum(value, QNETD_MIN_STATE_FILE_SAVE_INTERVAL,
+		    QNETD_MAX_STATE_FILE_SAVE_INTERVAL, &tmpll) == -1) {
+			return (-2);
+		}
+
+		settings->state_file_save_interval = (uint32_t)tmpll;
+	} else if (strcasecmp(option, "state_file_max_age") == 0) {
+		if (utils_strtonum(value, QNETD_MIN_STATE_FILE_MAX_AGE, UINT32_MAX, &tmpll) == -1) {
+			return (-2);
+		}
+
+		settings->state_file_max_age = (uint32_t)tmpll;
+	} else if (strcasecmp(option, "state_file_restore_grace") == 0) {
+		if (utils_strtonum(value, QNETD_MIN_STATE_FILE_RESTORE_GRACE, UINT32_MAX,
+		    &tmpll) == -1) {
+			return (-2);
+		}
+
+		settings->state_file_restore_grace = (uint32_t)tmpll;
+	} else if (strcasecmp(option, "flight_recorder_size") == 0) {
+		if (utils_strtonum(value, QNETD_MIN_FLIGHT_RECORDER_SIZE, LLONG_MAX, &tmpll) == -1) {
+			return (-2);
+		}
+
+		settings->flight_recorder_size = (size_t)tmpll;
+	} else if (strcasecmp(option, "log_async") == 0) {
+		if ((tmpll = utils_parse_bool_str(value)) == -1) {
+			return (-2);
+		}
+
+		settings->log_async = (uint8_t)tmpll;
+	} else if (strcasecmp(option, "log_async_queue_size") == 0) {
+		if (utils_strtonum(value, QNETD_MIN_LOG_ASYNC_QUEUE_SIZE, LLONG_MAX, &tmpll) == -1) {
+			return (-2);
+		}
+
+		settings->log_async_queue_size = (size_t)tmpll;
+	} else if (strcasecmp(option, "log_ratelimit_burst") == 0) {
+		if (utils_strtonum(value, QNETD_MIN_LOG_RATELIMIT_BURST, LLONG_MAX, &tmpll) == -1) {
+			return (-2);
+		}
+
+		settings->log_ratelimit_burst = (size_t)tmpll;
+	} else if (strcasecmp(option, "log_ratelimit_interval") == 0) {
+		if (utils_strtonum(value, QNETD_MIN_LOG_RATELIMIT_INTERVAL, UINT32_MAX,
+		    &tmpll) == -1) {
+			return (-2);
+		}
+
+		settings->log_ratelimit_interval = (uint32_t)tmpll;
 	} else {
 		return (-1);
 	}
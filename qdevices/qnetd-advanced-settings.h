@@ -60,8 +60,20 @@ struct qnetd_advanced_settings {
 	size_t ipc_max_clients;
 	size_t ipc_max_send_size;
 	size_t ipc_max_receive_size;
+	size_t ipc_list_chunk_size;
+	size_t ipc_subscriber_buffer_size;
 	enum tlv_keep_active_partition_tie_breaker keep_active_partition_tie_breaker;
+	uint8_t batch_algorithm_evaluation;
+	char *state_file;
+	uint32_t state_file_save_interval;
+	uint32_t state_file_max_age;
+	uint32_t state_file_restore_grace;
 	double dpd_interval_coefficient;
+	size_t flight_recorder_size;
+	uint8_t log_async;
+	size_t log_async_queue_size;
+	size_t log_ratelimit_burst;
+	uint32_t log_ratelimit_interval;
 };
 
 extern int		qnetd_advanced_settings_init(struct qnetd_advanced_settings *settings);
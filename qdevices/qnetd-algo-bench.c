@@ -0,0 +1,376 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sys/types.h>
+
+#include <err.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "qnetd-algo-harness.h"
+#include "utils.h"
+
+/*
+ * Every size runs at most events (-e) events and stops after the first event which
+ * exceeds time budget (-b), so big sizes run with fewer events. Sizes are skipped
+ * when one event of the next size is not expected to fit into the budget. With
+ * default budget lms reaches 1024 nodes, but ffsplit evaluation grows roughly with
+ * fourth power of nodes so it stops at 64 nodes. Use -b (and -n) to measure
+ * bigger ffsplit clusters.
+ */
+#define ALGO_BENCH_DEFAULT_EVENTS	100
+#define ALGO_BENCH_DEFAULT_SEED		1
+#define ALGO_BENCH_DEFAULT_BUDGET	30
+#define ALGO_BENCH_MAX_SIZES		64
+#define ALGO_BENCH_MAX_NODES		4096
+
+struct algo_bench_settings {
+	enum tlv_decision_algorithm_type algorithms[3];
+	size_t no_algorithms;
+	size_t sizes[ALGO_BENCH_MAX_SIZES];
+	size_t no_sizes;
+	size_t events;
+	uint32_t seed;
+	uint64_t budget_ns;
+	FILE *trace;
+	int batch_evaluation;
+	int vary_tie_breakers;
+};
+
+static const size_t algo_bench_default_sizes[] = {2, 4, 8, 16, 32, 64, 128, 256, 512, 1024};
+
+/*
+ * Allocation counting. Binary is linked with --wrap so allocations done by
+ * objects linked into the binary go thru these functions.
+ */
+extern void	*__real_malloc(size_t size);
+extern void	*__real_calloc(size_t nmemb, size_t size);
+extern void	*__real_realloc(void *ptr, size_t size);
+
+extern void	*__wrap_malloc(size_t size);
+extern void	*__wrap_calloc(size_t nmemb, size_t size);
+extern void	*__wrap_realloc(void *ptr, size_t size);
+
+void *
+__wrap_malloc(size_t size)
+{
+
+	if (qnetd_algo_harness_alloc_counting) {
+		qnetd_algo_harness_no_allocs++;
+		qnetd_algo_harness_alloc_bytes += size;
+	}
+
+	return (__real_malloc(size));
+}
+
+void *
+__wrap_calloc(size_t nmemb, size_t size)
+{
+
+	if (qnetd_algo_harness_alloc_counting) {
+		qnetd_algo_harness_no_allocs++;
+		qnetd_algo_harness_alloc_bytes += nmemb * size;
+	}
+
+	return (__real_calloc(nmemb, size));
+}
+
+void *
+__wrap_realloc(void *ptr, size_t size)
+{
+
+	if (qnetd_algo_harness_alloc_counting) {
+		qnetd_algo_harness_no_allocs++;
+		qnetd_algo_harness_alloc_bytes += size;
+	}
+
+	return (__real_realloc(ptr, size));
+}
+
+static uint64_t
+algo_bench_now_ns(void)
+{
+	struct timespec ts;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+}
+
+static void
+usage(void)
+{
+
+	printf("usage: qnetd-algo-bench [-hBK] [-a algorithm] [-b budget_s] [-e events] "
+	    "[-n nodes[,nodes...]] [-s seed] [-t trace_file]\n");
+}
+
+static void
+algo_bench_add_algorithm(struct algo_bench_settings *settings, const char *str)
+{
+	enum tlv_decision_algorithm_type algorithm;
+
+	if (strcmp(str, "ffsplit") == 0) {
+		algorithm = TLV_DECISION_ALGORITHM_TYPE_FFSPLIT;
+	} else if (strcmp(str, "lms") == 0) {
+		algorithm = TLV_DECISION_ALGORITHM_TYPE_LMS;
+	} else if (strcmp(str, "2nodelms") == 0) {
+		algorithm = TLV_DECISION_ALGORITHM_TYPE_2NODELMS;
+	} else {
+		errx(EXIT_FAILURE, "Unknown algorithm %s. Supported are ffsplit, lms and 2nodelms",
+		    str);
+	}
+
+	if (settings->no_algorithms >=
+	    sizeof(settings->algorithms) / sizeof(settings->algorithms[0])) {
+		errx(EXIT_FAILURE, "Too many algorithms");
+	}
+
+	settings->algorithms[settings->no_algorithms++] = algorithm;
+}
+
+static void
+algo_bench_parse_sizes(struct algo_bench_settings *settings, char *str)
+{
+	char *token;
+	char *saveptr;
+	long long int tmpll;
+
+	settings->no_sizes = 0;
+
+	for (token = strtok_r(str, ",", &saveptr); token != NULL;
+	    token = strtok_r(NULL, ",", &saveptr)) {
+		if (utils_strtonum(token, 1, ALGO_BENCH_MAX_NODES, &tmpll) == -1) {
+			errx(EXIT_FAILURE, "Number of nodes must be between 1 and %u",
+			    ALGO_BENCH_MAX_NODES);
+		}
+
+		if (settings->no_sizes >= ALGO_BENCH_MAX_SIZES) {
+			errx(EXIT_FAILURE, "Too many sizes");
+		}
+
+		settings->sizes[settings->no_sizes++] = (size_t)tmpll;
+	}
+}
+
+static void
+cli_parse(int argc, char * const argv[], struct algo_bench_settings *settings)
+{
+	int ch;
+	long long int tmpll;
+	size_t zi;
+
+	memset(settings, 0, sizeof(*settings));
+	settings->events = ALGO_BENCH_DEFAULT_EVENTS;
+	settings->seed = ALGO_BENCH_DEFAULT_SEED;
+	settings->budget_ns = ALGO_BENCH_DEFAULT_BUDGET * 1000000000ULL;
+
+	for (zi = 0; zi < sizeof(algo_bench_default_sizes) / sizeof(algo_bench_default_sizes[0]);
+	    zi++) {
+		settings->sizes[settings->no_sizes++] = algo_bench_default_sizes[zi];
+	}
+
+	while ((ch = getopt(argc, argv, "hBKa:b:e:n:s:t:")) != -1) {
+		switch (ch) {
+		case 'a':
+			algo_bench_add_algorithm(settings, optarg);
+			break;
+		case 'B':
+			settings->batch_evaluation = 1;
+			break;
+		case 'K':
+			settings->vary_tie_breakers = 1;
+			break;
+		case 'b':
+			if (utils_strtonum(optarg, 1, 24 * 3600, &tmpll) == -1) {
+				errx(EXIT_FAILURE, "Budget must be positive number of seconds");
+			}
+			settings->budget_ns = (uint64_t)tmpll * 1000000000ULL;
+			break;
+		case 'e':
+			if (utils_strtonum(optarg, 1, 1000000, &tmpll) == -1) {
+				errx(EXIT_FAILURE, "Number of events must be between 1 and 1000000");
+			}
+			settings->events = (size_t)tmpll;
+			break;
+		case 'n':
+			algo_bench_parse_sizes(settings, optarg);
+			break;
+		case 's':
+			if (utils_strtonum(optarg, 1, UINT32_MAX, &tmpll) == -1) {
+				errx(EXIT_FAILURE, "Seed must be positive 32-bit number");
+			}
+			settings->seed = (uint32_t)tmpll;
+			break;
+		case 't':
+			settings->trace = fopen(optarg, "w");
+			if (settings->trace == NULL) {
+				err(EXIT_FAILURE, "Can't open trace file %s", optarg);
+			}
+			break;
+		case 'h':
+		case '?':
+			usage();
+			exit(EXIT_FAILURE);
+			break;
+		}
+	}
+
+	if (settings->no_algorithms == 0) {
+		algo_bench_add_algorithm(settings, "ffsplit");
+		algo_bench_add_algorithm(settings, "lms");
+		algo_bench_add_algorithm(settings, "2nodelms");
+	}
+}
+
+/*
+ * Run all events for given algorithm and size. Errors are fatal.
+ */
+static void
+algo_bench_run(const struct algo_bench_settings *settings,
+    enum tlv_decision_algorithm_type algorithm, size_t no_nodes, double prev_ns_per_event,
+    uint64_t *unit_ns, double *ns_per_event)
+{
+	struct qnetd_algo_harness harness;
+	const struct qnetd_algo_harness_stats *stats;
+	uint64_t start, setup_ns, events_start;
+	size_t zi;
+
+	start = algo_bench_now_ns();
+
+	if (qnetd_algo_harness_init(&harness, algorithm, NULL, no_nodes, settings->seed,
+	    settings->trace, settings->batch_evaluation, settings->vary_tie_breakers) != 0) {
+		errx(EXIT_FAILURE, "Can't initialize harness for %s with %zu nodes",
+		    qnetd_algo_harness_algorithm_to_str(algorithm), no_nodes);
+	}
+
+	setup_ns = algo_bench_now_ns() - start;
+	events_start = algo_bench_now_ns();
+
+	for (zi = 0; zi < settings->events; zi++) {
+		if (qnetd_algo_harness_run_event(&harness) != 0) {
+			errx(EXIT_FAILURE, "Event %zu failed for %s with %zu nodes", zi + 1,
+			    qnetd_algo_harness_algorithm_to_str(algorithm), no_nodes);
+		}
+
+		if (algo_bench_now_ns() - events_start > settings->budget_ns) {
+			break;
+		}
+	}
+
+	stats = &harness.stats;
+
+	/*
+	 * Time needed to set up cluster and run one event
+	 */
+	*unit_ns = setup_ns + (algo_bench_now_ns() - events_start) / stats->no_events;
+	*ns_per_event = (double)stats->decision_ns / stats->no_events;
+
+	printf("%s,%zu,%zu,%zu,%.0f,%"PRIu64",%.1f,%.0f,",
+	    qnetd_algo_harness_algorithm_to_str(algorithm), no_nodes, stats->no_events,
+	    stats->no_decisions, *ns_per_event, stats->max_event_decision_ns,
+	    (double)stats->no_allocs / stats->no_events,
+	    (double)stats->alloc_bytes / stats->no_events);
+
+	if (prev_ns_per_event > 0) {
+		printf("%.2f", *ns_per_event / prev_ns_per_event);
+	}
+
+	printf(",%.1f,%zu,%016"PRIx64",%.1f\n", setup_ns / 1000000.0,
+	    stats->no_split_brain_events, harness.digest,
+	    (double)stats->no_vote_infos / stats->no_events);
+	fflush(stdout);
+
+	qnetd_algo_harness_destroy(&harness);
+}
+
+int
+main(int argc, char * const argv[])
+{
+	struct algo_bench_settings settings;
+	enum tlv_decision_algorithm_type algorithm;
+	size_t za, zs;
+	uint64_t unit_ns, prev_unit_ns;
+	double ns_per_event, prev_ns_per_event;
+
+	cli_parse(argc, argv, &settings);
+
+	printf("algorithm,nodes,events,decisions,decision_ns_per_event,max_event_decision_ns,"
+	    "allocs_per_event,alloc_bytes_per_event,growth_vs_prev,setup_ms,split_brain_events,"
+	    "digest,vote_infos_per_event\n");
+
+	for (za = 0; za < settings.no_algorithms; za++) {
+		algorithm = settings.algorithms[za];
+		prev_unit_ns = 0;
+		prev_ns_per_event = 0;
+
+		for (zs = 0; zs < settings.no_sizes; zs++) {
+			if (algorithm == TLV_DECISION_ALGORITHM_TYPE_2NODELMS &&
+			    settings.sizes[zs] != 2) {
+				continue;
+			}
+
+			algo_bench_run(&settings, algorithm, settings.sizes[zs],
+			    prev_ns_per_event, &unit_ns, &ns_per_event);
+
+			/*
+			 * Stop growing cluster if setup and one event of next size would
+			 * exceed budget assuming same growth as between last two sizes
+			 */
+			if (unit_ns > settings.budget_ns ||
+			    (prev_unit_ns > 0 &&
+			    (double)unit_ns * unit_ns / prev_unit_ns > settings.budget_ns)) {
+				if (zs + 1 < settings.no_sizes) {
+					warnx("Skipping %s with more than %zu nodes because of time budget "
+					    "(see -b)", qnetd_algo_harness_algorithm_to_str(algorithm),
+					    settings.sizes[zs]);
+				}
+				break;
+			}
+
+			prev_unit_ns = unit_ns;
+			prev_ns_per_event = ns_per_event;
+		}
+	}
+
+	if (settings.trace != NULL) {
+		fclose(settings.trace);
+	}
+
+	return (EXIT_SUCCESS);
+}
@@ -35,6 +35,7 @@
 #include <sys/types.h>
 
 #include <assert.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "log.h"
@@ -52,9 +53,36 @@ enum qnetd_algo_ffsplit_cluster_state {
 	QNETD_ALGO_FFSPLIT_CLUSTER_STATE_SENDING_ACKS,
 };
 
+/*
+ * Clients of the cluster sorted by node id and position in the client list. Membership
+ * stability check and partition selection look up client by node id for every member
+ * of every membership list, so index is built once per evaluation. Lookup returns
+ * same client as qnetd_cluster_find_client_by_node_id.
+ */
+struct qnetd_algo_ffsplit_client_index_entry {
+	uint32_t node_id;
+	size_t position;
+	const struct qnetd_client *client;
+};
+
 struct qnetd_algo_ffsplit_cluster_data {
 	enum qnetd_algo_ffsplit_cluster_state cluster_state;
+	/*
+	 * Partition which got the vote. Used by keep active partition tie-breaker.
+	 */
 	struct node_list quorate_partition_node_list;
+	/*
+	 * Partition selected by last evaluation. It becomes quorate partition when
+	 * all NACK votes are sent, so evaluation done while votes of previous one
+	 * are still being sent doesn't change the active partition.
+	 */
+	struct node_list selected_partition_node_list;
+	struct qnetd_algo_ffsplit_client_index_entry *client_index;
+	size_t client_index_allocated;
+	/*
+	 * 0 if index is not built (outside of evaluation or allocation failed)
+	 */
+	size_t client_index_entries;
 };
 
 enum qnetd_algo_ffsplit_client_state {
@@ -66,6 +94,11 @@ enum qnetd_algo_ffsplit_client_state {
 struct qnetd_algo_ffsplit_client_data {
 	enum qnetd_algo_ffsplit_client_state client_state;
 	uint32_t vote_info_expected_seq_num;
+	/*
+	 * Client got ACK before qnetd restart (restored from state snapshot). Used by
+	 * keep active partition tie-breaker until first partition gets the vote.
+	 */
+	int restored_ack_vote;
 };
 
 enum tlv_reply_error_code
@@ -85,6 +118,7 @@ qnetd_algo_ffsplit_client_init(struct qnetd_client *client)
 		memset(cluster_data, 0, sizeof(*cluster_data));
 		cluster_data->cluster_state = QNETD_ALGO_FFSPLIT_CLUSTER_STATE_WAITING_FOR_CHANGE;
 		node_list_init(&cluster_data->quorate_partition_node_list);
+		node_list_init(&cluster_data->selected_partition_node_list);
 
 		client->cluster->algorithm_data = cluster_data;
 	}
@@ -98,11 +132,124 @@ qnetd_algo_ffsplit_client_init(struct qnetd_client *client)
 	}
 	memset(client_data, 0, sizeof(*client_data));
 	client_data->client_state = QNETD_ALGO_FFSPLIT_CLIENT_STATE_WAITING_FOR_CHANGE;
+	client_data->restored_ack_vote = (client->last_sent_ack_nack_vote == TLV_VOTE_ACK);
 	client->algorithm_data = client_data;
 
 	return (TLV_REPLY_ERROR_CODE_NO_ERROR);
 }
 
+static int
+qnetd_algo_ffsplit_client_index_entry_cmp(const void *a, const void *b)
+{
+	const struct qnetd_algo_ffsplit_client_index_entry *entry1, *entry2;
+
+	entry1 = (const struct qnetd_algo_ffsplit_client_index_entry *)a;
+	entry2 = (const struct qnetd_algo_ffsplit_client_index_entry *)b;
+
+	if (entry1->node_id != entry2->node_id) {
+		return (entry1->node_id < entry2->node_id ? -1 : 1);
+	}
+
+	if (entry1->position != entry2->position) {
+		return (entry1->position < entry2->position ? -1 : 1);
+	}
+
+	return (0);
+}
+
+/*
+ * Build client index. When memory can't be allocated, index is not used and
+ * lookup walks client list.
+ */
+static void
+qnetd_algo_ffsplit_client_index_build(struct qnetd_cluster *cluster)
+{
+	struct qnetd_algo_ffsplit_cluster_data *cluster_data;
+	struct qnetd_algo_ffsplit_client_index_entry *new_index;
+	const struct qnetd_client *iter_client;
+	size_t no_clients;
+	size_t zi;
+
+	cluster_data = (struct qnetd_algo_ffsplit_cluster_data *)cluster->algorithm_data;
+	cluster_data->client_index_entries = 0;
+
+	no_clients = qnetd_cluster_size(cluster);
+
+	if (no_clients > cluster_data->client_index_allocated) {
+		new_index = realloc(cluster_data->client_index, sizeof(*new_index) * no_clients);
+		if (new_index == NULL) {
+			return ;
+		}
+
+		cluster_data->client_index = new_index;
+		cluster_data->client_index_allocated = no_clients;
+	}
+
+	zi = 0;
+	TAILQ_FOREACH(iter_client, &cluster->client_list, cluster_entries) {
+		cluster_data->client_index[zi].node_id = iter_client->node_id;
+		cluster_data->client_index[zi].position = zi;
+		cluster_data->client_index[zi].client = iter_client;
+		zi++;
+	}
+
+	qsort(cluster_data->client_index, zi, sizeof(*cluster_data->client_index),
+	    qnetd_algo_ffsplit_client_index_entry_cmp);
+
+	cluster_data->client_index_entries = zi;
+}
+
+static const struct qnetd_client *
+qnetd_algo_ffsplit_find_client_by_node_id(const struct qnetd_cluster *cluster, uint32_t node_id)
+{
+	const struct qnetd_algo_ffsplit_cluster_data *cluster_data;
+	size_t lo, hi, mid;
+
+	cluster_data = (const struct qnetd_algo_ffsplit_cluster_data *)cluster->algorithm_data;
+
+	if (cluster_data->client_index_entries == 0) {
+		return (qnetd_cluster_find_client_by_node_id(cluster, node_id));
+	}
+
+	/*
+	 * Find first entry with given node id
+	 */
+	lo = 0;
+	hi = cluster_data->client_index_entries;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+
+		if (cluster_data->client_index[mid].node_id < node_id) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	if (lo < cluster_data->client_index_entries &&
+	    cluster_data->client_index[lo].node_id == node_id) {
+		return (cluster_data->client_index[lo].client);
+	}
+
+	return (NULL);
+}
+
+/*
+ * Client was member of the previous quorate partition
+ */
+static int
+qnetd_algo_ffsplit_was_in_quorate_partition(const struct qnetd_client *client,
+    const struct node_list *quorate_partition_node_list)
+{
+	const struct qnetd_algo_ffsplit_client_data *client_data;
+
+	client_data = (const struct qnetd_algo_ffsplit_client_data *)client->algorithm_data;
+
+	return (node_list_find_node_id(quorate_partition_node_list, client->node_id) != NULL ||
+	    client_data->restored_ack_vote);
+}
+
 static int
 qnetd_algo_ffsplit_is_preferred_partition(const struct qnetd_client *client,
     const struct node_list *config_node_list, const struct node_list *membership_node_list)
@@ -240,7 +387,7 @@ qnetd_algo_ffsplit_is_membership_stable(const struct qnetd_client *client, int c
 			/*
 			 * try to find client with given node id
 			 */
-			iter_client2 = qnetd_cluster_find_client_by_node_id(client->cluster,
+			iter_client2 = qnetd_algo_ffsplit_find_client_by_node_id(client->cluster,
 			    iter_node1->node_id);
 			if (iter_client2 == NULL) {
 				/*
@@ -294,7 +441,9 @@ qnetd_algo_ffsplit_is_membership_stable(const struct qnetd_client *client, int c
 
 static void
 qnetd_algo_ffsplit_get_active_clients_in_partition_stats(const struct qnetd_client *client,
-    const struct node_list *client_membership_node_list, enum tlv_heuristics client_heuristics,
+    const struct node_list *client_membership_node_list,
+    const struct qnetd_client *evaluating_client, int evaluating_client_leaving,
+    enum tlv_heuristics evaluating_client_heuristics,
     size_t *no_clients, size_t *no_heuristics_pass, size_t *no_heuristics_fail)
 {
 	const struct node_list_entry *iter_node;
@@ -310,13 +459,20 @@ qnetd_algo_ffsplit_get_active_clients_in_partition_stats(const struct qnetd_clie
 	}
 
 	TAILQ_FOREACH(iter_node, client_membership_node_list, entries) {
-		iter_client = qnetd_cluster_find_client_by_node_id(client->cluster,
+		iter_client = qnetd_algo_ffsplit_find_client_by_node_id(client->cluster,
 		    iter_node->node_id);
+		if (iter_client == evaluating_client && evaluating_client_leaving) {
+			/*
+			 * Leaving client is no longer active
+			 */
+			iter_client = NULL;
+		}
+
 		if (iter_client != NULL) {
 			(*no_clients)++;
 
-			if (iter_client == client) {
-				iter_heuristics = client_heuristics;
+			if (iter_client == evaluating_client) {
+				iter_heuristics = evaluating_client_heuristics;
 			} else {
 				iter_heuristics = iter_client->last_heuristics;
 			}
@@ -337,10 +493,10 @@ qnetd_algo_ffsplit_get_active_clients_in_partition_stats(const struct qnetd_clie
 static int
 qnetd_algo_ffsplit_partition_cmp(const struct qnetd_client *client1,
     const struct node_list *config_node_list1, const struct node_list *membership_node_list1,
-    enum tlv_heuristics heuristics_1,
     const struct qnetd_client *client2,
     const struct node_list *config_node_list2, const struct node_list *membership_node_list2,
-    enum tlv_heuristics heuristics_2,
+    const struct qnetd_client *evaluating_client, int evaluating_client_leaving,
+    enum tlv_heuristics evaluating_client_heuristics,
     const struct node_list *quorate_partition_node_list,
     int keep_active_partition_tie_breaker)
 {
@@ -348,10 +504,10 @@ qnetd_algo_ffsplit_partition_cmp(const struct qnetd_client *client1,
 	size_t part1_no_heuristics_pass, part2_no_heuristics_pass;
 	size_t part1_no_heuristics_fail, part2_no_heuristics_fail;
 	size_t part1_score, part2_score;
-	/* Result of node_list_find_node_id of client 1 node id in quorate_partition_node_list */
-	struct node_list_entry *qpnl_client1;
-	/* Result of node_list_find_node_id of client 2 node id in quorate_partition_node_list */
-	struct node_list_entry *qpnl_client2;
+	/* Client 1 was member of previous quorate partition */
+	int qpnl_client1;
+	/* Client 2 was member of previous quorate partition */
+	int qpnl_client2;
 
 	int res;
 
@@ -381,10 +537,12 @@ qnetd_algo_ffsplit_partition_cmp(const struct qnetd_client *client1,
 		 * Check how many active clients are in partitions and heuristics results
 		 */
 		qnetd_algo_ffsplit_get_active_clients_in_partition_stats(client1,
-		    membership_node_list1, heuristics_1, &part1_active_clients,
+		    membership_node_list1, evaluating_client, evaluating_client_leaving,
+		    evaluating_client_heuristics, &part1_active_clients,
 		    &part1_no_heuristics_pass, &part1_no_heuristics_fail);
 		qnetd_algo_ffsplit_get_active_clients_in_partition_stats(client2,
-		    membership_node_list2, heuristics_2, &part2_active_clients,
+		    membership_node_list2, evaluating_client, evaluating_client_leaving,
+		    evaluating_client_heuristics, &part2_active_clients,
 		    &part2_no_heuristics_pass, &part2_no_heuristics_fail);
 
 		/*
@@ -423,17 +581,19 @@ qnetd_algo_ffsplit_partition_cmp(const struct qnetd_client *client1,
 		 * Use keep active partition tie-breaker if enabled for both clients
 		 */
 		if (keep_active_partition_tie_breaker && client2 != NULL) {
-			qpnl_client1 = node_list_find_node_id(quorate_partition_node_list, client1->node_id);
-			qpnl_client2 = node_list_find_node_id(quorate_partition_node_list, client2->node_id);
+			qpnl_client1 = qnetd_algo_ffsplit_was_in_quorate_partition(client1,
+			    quorate_partition_node_list);
+			qpnl_client2 = qnetd_algo_ffsplit_was_in_quorate_partition(client2,
+			    quorate_partition_node_list);
 
 			/*
 			 * Client 1 in quorate partition, client 2 isn't and vice-versa.
 			 * If both either doesn't exist in quorate partion or both exists use
 			 * next tie-breaker
 			 */
-			if (qpnl_client1 != NULL && qpnl_client2 == NULL) {
+			if (qpnl_client1 && !qpnl_client2) {
 				res = 1; goto exit_res;
-			} else if (qpnl_client1 == NULL && qpnl_client2 != NULL) {
+			} else if (!qpnl_client1 && qpnl_client2) {
 				res = 0; goto exit_res;
 			}
 		}
@@ -478,12 +638,10 @@ qnetd_algo_ffsplit_select_partition(const struct qnetd_client *client, int clien
 	const struct qnetd_client *best_client;
 	const struct node_list *best_config_node_list, *best_membership_node_list;
 	const struct node_list *iter_config_node_list, *iter_membership_node_list;
-	enum tlv_heuristics iter_heuristics, best_heuristics;
 	int keep_active_partition_tie_breaker;
 
 	best_client = NULL;
 	best_config_node_list = best_membership_node_list = NULL;
-	best_heuristics = TLV_HEURISTICS_UNDEFINED;
 
 	keep_active_partition_tie_breaker = 1;
 
@@ -505,21 +663,18 @@ qnetd_algo_ffsplit_select_partition(const struct qnetd_client *client, int clien
 
 			iter_config_node_list = config_node_list;
 			iter_membership_node_list = membership_node_list;
-			iter_heuristics = client_heuristics;
 		} else {
 			iter_config_node_list = &iter_client->configuration_node_list;
 			iter_membership_node_list = &iter_client->last_membership_node_list;
-			iter_heuristics = iter_client->last_heuristics;
 		}
 
 		if (qnetd_algo_ffsplit_partition_cmp(iter_client, iter_config_node_list,
-		    iter_membership_node_list, iter_heuristics, best_client, best_config_node_list,
-		    best_membership_node_list, best_heuristics,
+		    iter_membership_node_list, best_client, best_config_node_list,
+		    best_membership_node_list, client, client_leaving, client_heuristics,
 		    quorate_partition_node_list, keep_active_partition_tie_breaker) > 0) {
 			best_client = iter_client;
 			best_config_node_list = iter_config_node_list;
 			best_membership_node_list = iter_membership_node_list;
-			best_heuristics = iter_heuristics;
 		}
 	}
 
@@ -539,6 +694,12 @@ qnetd_algo_ffsplit_update_nodes_state(struct qnetd_client *client, int client_le
 	TAILQ_FOREACH(iter_client, &client->cluster->client_list, cluster_entries) {
 		iter_client_data = (struct qnetd_algo_ffsplit_client_data *)iter_client->algorithm_data;
 
+		/*
+		 * Reply to vote info sent by previous evaluation must not change state
+		 * set by this one
+		 */
+		iter_client_data->vote_info_expected_seq_num++;
+
 		if (iter_client->node_id == client->node_id && client_leaving) {
 			iter_client_data->client_state = QNETD_ALGO_FFSPLIT_CLIENT_STATE_WAITING_FOR_CHANGE;
 
@@ -643,8 +804,42 @@ qnetd_algo_ffsplit_no_clients_in_sending_state(struct qnetd_client *client, int
 	return (no_clients);
 }
 
+/*
+ * All clients outside of selected partition got NACK, so selected partition becomes
+ * quorate partition. Returns 0 on success, -1 on failure.
+ */
+static int
+qnetd_algo_ffsplit_set_quorate_partition(struct qnetd_client *client)
+{
+	struct qnetd_algo_ffsplit_cluster_data *cluster_data;
+	struct qnetd_client *iter_client;
+	struct qnetd_algo_ffsplit_client_data *iter_client_data;
+
+	cluster_data = (struct qnetd_algo_ffsplit_cluster_data *)client->cluster->algorithm_data;
+
+	node_list_free(&cluster_data->quorate_partition_node_list);
+
+	if (node_list_clone(&cluster_data->quorate_partition_node_list,
+	    &cluster_data->selected_partition_node_list) != 0) {
+		log(LOG_ERR, "ffsplit: Can't clone quourate partition node list");
+
+		return (-1);
+	}
+
+	TAILQ_FOREACH(iter_client, &client->cluster->client_list, cluster_entries) {
+		iter_client_data = (struct qnetd_algo_ffsplit_client_data *)iter_client->algorithm_data;
+
+		/*
+		 * Previous quorate partition is now known
+		 */
+		iter_client_data->restored_ack_vote = 0;
+	}
+
+	return (0);
+}
+
 static enum tlv_reply_error_code
-qnetd_algo_ffsplit_do(struct qnetd_client *client, int client_leaving,
+qnetd_algo_ffsplit_evaluate(struct qnetd_client *client, int client_leaving,
     const struct tlv_ring_id *ring_id, const struct node_list *config_node_list,
     const struct node_list *membership_node_list, enum tlv_heuristics client_heuristics,
     enum tlv_vote *result_vote)
@@ -656,8 +851,12 @@ qnetd_algo_ffsplit_do(struct qnetd_client *client, int client_leaving,
 
 	cluster_data->cluster_state = QNETD_ALGO_FFSPLIT_CLUSTER_STATE_WAITING_FOR_STABLE_MEMBERSHIP;
 
+	qnetd_algo_ffsplit_client_index_build(client->cluster);
+
 	if (!qnetd_algo_ffsplit_is_membership_stable(client, client_leaving,
 	    ring_id, config_node_list, membership_node_list)) {
+		cluster_data->client_index_entries = 0;
+
 		/*
 		 * Wait until membership is stable
 		 */
@@ -673,7 +872,9 @@ qnetd_algo_ffsplit_do(struct qnetd_client *client, int client_leaving,
 	    config_node_list, membership_node_list, &cluster_data->quorate_partition_node_list,
 	    client_heuristics);
 
-	node_list_free(&cluster_data->quorate_partition_node_list);
+	cluster_data->client_index_entries = 0;
+
+	node_list_free(&cluster_data->selected_partition_node_list);
 
 	if (quorate_partition_node_list == NULL) {
 		log(LOG_DEBUG, "ffsplit: No quorate partition was selected");
@@ -681,7 +882,7 @@ qnetd_algo_ffsplit_do(struct qnetd_client *client, int client_leaving,
 		log(LOG_DEBUG, "ffsplit: Quorate partition selected");
 		log_common_debug_dump_node_list(quorate_partition_node_list);
 
-		if (node_list_clone(&cluster_data->quorate_partition_node_list,
+		if (node_list_clone(&cluster_data->selected_partition_node_list,
 		    quorate_partition_node_list) != 0) {
 			log(LOG_ERR, "ffsplit: Can't clone quourate partition node list");
 
@@ -698,6 +899,10 @@ qnetd_algo_ffsplit_do(struct qnetd_client *client, int client_leaving,
 		/*
 		 * No one gets nack -> send acks
 		 */
+		if (qnetd_algo_ffsplit_set_quorate_partition(client) != 0) {
+			return (TLV_REPLY_ERROR_CODE_INTERNAL_ERROR);
+		}
+
 		cluster_data->cluster_state = QNETD_ALGO_FFSPLIT_CLUSTER_STATE_SENDING_ACKS;
 
 		if (qnetd_algo_ffsplit_send_votes(client, client_leaving, ring_id, 1) == 0) {
@@ -714,6 +919,72 @@ qnetd_algo_ffsplit_do(struct qnetd_client *client, int client_leaving,
 	return (TLV_REPLY_ERROR_CODE_NO_ERROR);
 }
 
+static enum tlv_reply_error_code
+qnetd_algo_ffsplit_do(struct qnetd_client *client, int client_leaving,
+    const struct tlv_ring_id *ring_id, const struct node_list *config_node_list,
+    const struct node_list *membership_node_list, enum tlv_heuristics client_heuristics,
+    enum tlv_vote *result_vote)
+{
+	struct qnetd_algo_ffsplit_cluster_data *cluster_data;
+
+	cluster_data = (struct qnetd_algo_ffsplit_cluster_data *)client->cluster->algorithm_data;
+
+	if (client->batch_algorithm_evaluation) {
+		/*
+		 * Evaluate once at the end of main loop iteration. Vote is sent
+		 * in vote info message. Vote info replies received meanwhile
+		 * must not continue sending of votes.
+		 */
+		log(LOG_DEBUG, "ffsplit: Evaluation of cluster %s scheduled", client->cluster_name);
+		cluster_data->cluster_state =
+		    QNETD_ALGO_FFSPLIT_CLUSTER_STATE_WAITING_FOR_STABLE_MEMBERSHIP;
+		client->cluster->algorithm_evaluation_scheduled = 1;
+		*result_vote = TLV_VOTE_WAIT_FOR_REPLY;
+
+		return (TLV_REPLY_ERROR_CODE_NO_ERROR);
+	}
+
+	return (qnetd_algo_ffsplit_evaluate(client, client_leaving, ring_id, config_node_list,
+	    membership_node_list, client_heuristics, result_vote));
+}
+
+/*
+ * Deferred evaluation. All node lists are already stored in client structures,
+ * so result doesn't depend on which client evaluation is done for. Client with
+ * lowest node id which has both config and membership node list is used.
+ */
+static void
+qnetd_algo_ffsplit_cluster_evaluation(struct qnetd_client *client)
+{
+	struct qnetd_client *iter_client;
+	struct qnetd_client *eval_client;
+	enum tlv_vote result_vote;
+
+	eval_client = NULL;
+
+	TAILQ_FOREACH(iter_client, &client->cluster->client_list, cluster_entries) {
+		if (node_list_size(&iter_client->configuration_node_list) == 0 ||
+		    node_list_size(&iter_client->last_membership_node_list) == 0) {
+			continue;
+		}
+
+		if (eval_client == NULL || iter_client->node_id < eval_client->node_id) {
+			eval_client = iter_client;
+		}
+	}
+
+	if (eval_client == NULL) {
+		return ;
+	}
+
+	if (qnetd_algo_ffsplit_evaluate(eval_client, 0, &eval_client->last_ring_id,
+	    &eval_client->configuration_node_list, &eval_client->last_membership_node_list,
+	    eval_client->last_heuristics, &result_vote) != TLV_REPLY_ERROR_CODE_NO_ERROR) {
+		log(LOG_ERR, "ffsplit: Deferred evaluation of cluster %s failed",
+		    client->cluster_name);
+	}
+}
+
 enum tlv_reply_error_code
 qnetd_algo_ffsplit_config_node_list_received(struct qnetd_client *client,
     uint32_t msg_seq_num, int config_version_set, uint64_t config_version,
@@ -849,6 +1120,8 @@ qnetd_algo_ffsplit_client_disconnect(struct qnetd_client *client, int server_goi
 		 * Last client in the cluster
 		 */
 		node_list_free(&cluster_data->quorate_partition_node_list);
+		node_list_free(&cluster_data->selected_partition_node_list);
+		free(cluster_data->client_index);
 
 		free(client->cluster->algorithm_data);
 	}
@@ -893,6 +1166,10 @@ qnetd_algo_ffsplit_vote_info_reply_received(struct qnetd_client *client, uint32_
 			log(LOG_DEBUG, "ffsplit: All NACK votes sent for cluster %s",
 			     client->cluster_name);
 
+			if (qnetd_algo_ffsplit_set_quorate_partition(client) != 0) {
+				return (TLV_REPLY_ERROR_CODE_INTERNAL_ERROR);
+			}
+
 			cluster_data->cluster_state = QNETD_ALGO_FFSPLIT_CLUSTER_STATE_SENDING_ACKS;
 
 			if (qnetd_algo_ffsplit_send_votes(client, 0, &client->last_ring_id, 1) == 0) {
@@ -956,6 +1233,7 @@ static struct qnetd_algorithm qnetd_algo_ffsplit = {
 	.vote_info_reply_received	= qnetd_algo_ffsplit_vote_info_reply_received,
 	.heuristics_change_received	= qnetd_algo_ffsplit_heuristics_change_received,
 	.timer_callback			= qnetd_algo_ffsplit_timer_callback,
+	.cluster_evaluation		= qnetd_algo_ffsplit_cluster_evaluation,
 };
 
 enum tlv_reply_error_code qnetd_algo_ffsplit_register(void)
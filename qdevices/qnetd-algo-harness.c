@@ -0,0 +1,981 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sys/types.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "log.h"
+#include "msg.h"
+#include "qnet-config.h"
+#include "qnetd-algo-harness.h"
+#include "qnetd-algorithm.h"
+#include "qnetd-client-algo-timer.h"
+#include "qnetd-client-send.h"
+#include "utils.h"
+
+#define QNETD_ALGO_HARNESS_CLUSTER_NAME		"harness"
+#define QNETD_ALGO_HARNESS_MAX_PARTITIONS	4
+#define QNETD_ALGO_HARNESS_MAX_SETTLE_PASSES	16
+#define QNETD_ALGO_HARNESS_HEARTBEAT_INTERVAL	8000
+
+#define QNETD_ALGO_HARNESS_FNV_OFFSET_BASIS	14695981039346656037ULL
+#define QNETD_ALGO_HARNESS_FNV_PRIME		1099511628211ULL
+
+int qnetd_algo_harness_alloc_counting = 0;
+size_t qnetd_algo_harness_no_allocs = 0;
+size_t qnetd_algo_harness_alloc_bytes = 0;
+
+static int qnetd_algo_harness_algorithms_registered = 0;
+
+static void
+qnetd_algo_harness_registered_cluster_evaluation(struct qnetd_client *client)
+{
+
+	qnetd_algorithm_cluster_evaluation(client->cluster);
+}
+
+/*
+ * Callbacks dispatching to algorithm registered in qnetd
+ */
+static struct qnetd_algorithm qnetd_algo_harness_registered_algorithm = {
+	.init				= qnetd_algorithm_client_init,
+	.client_disconnect		= qnetd_algorithm_client_disconnect,
+	.membership_node_list_received	= qnetd_algorithm_membership_node_list_received,
+	.quorum_node_list_received	= qnetd_algorithm_quorum_node_list_received,
+	.config_node_list_received	= qnetd_algorithm_config_node_list_received,
+	.ask_for_vote_received		= qnetd_algorithm_ask_for_vote_received,
+	.vote_info_reply_received	= qnetd_algorithm_vote_info_reply_received,
+	.heuristics_change_received	= qnetd_algorithm_heuristics_change_received,
+	.timer_callback			= qnetd_algorithm_timer_callback,
+	.cluster_evaluation		= qnetd_algo_harness_registered_cluster_evaluation,
+};
+
+static uint64_t
+qnetd_algo_harness_now_ns(void)
+{
+	struct timespec ts;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+}
+
+/*
+ * xorshift32 so every run with same seed produces same sequence of events
+ */
+static uint32_t
+qnetd_algo_harness_rand(struct qnetd_algo_harness *harness)
+{
+
+	harness->rand_state ^= harness->rand_state << 13;
+	harness->rand_state ^= harness->rand_state >> 17;
+	harness->rand_state ^= harness->rand_state << 5;
+
+	return (harness->rand_state);
+}
+
+static void
+qnetd_algo_harness_digest_add(struct qnetd_algo_harness *harness, uint64_t value)
+{
+	size_t zi;
+
+	for (zi = 0; zi < sizeof(value); zi++) {
+		harness->digest ^= (value >> (zi * 8)) & 0xff;
+		harness->digest *= QNETD_ALGO_HARNESS_FNV_PRIME;
+	}
+}
+
+static uint64_t
+qnetd_algo_harness_decision_begin(struct qnetd_algo_harness *harness)
+{
+
+	if (!harness->measure) {
+		return (0);
+	}
+
+	qnetd_algo_harness_no_allocs = 0;
+	qnetd_algo_harness_alloc_bytes = 0;
+	qnetd_algo_harness_alloc_counting = 1;
+
+	return (qnetd_algo_harness_now_ns());
+}
+
+static void
+qnetd_algo_harness_decision_end(struct qnetd_algo_harness *harness, uint64_t start)
+{
+	uint64_t elapsed;
+
+	if (!harness->measure) {
+		return ;
+	}
+
+	elapsed = qnetd_algo_harness_now_ns() - start;
+	qnetd_algo_harness_alloc_counting = 0;
+
+	harness->stats.no_decisions++;
+	harness->stats.decision_ns += elapsed;
+	harness->stats.no_allocs += qnetd_algo_harness_no_allocs;
+	harness->stats.alloc_bytes += qnetd_algo_harness_alloc_bytes;
+	harness->event_decision_ns += elapsed;
+}
+
+/*
+ * Store vote as qdevice-net would. ACK/NACK replaces current vote, other
+ * results keep current vote.
+ */
+static void
+qnetd_algo_harness_vote_received(struct qnetd_algo_harness_node *node, enum tlv_vote vote)
+{
+
+	if (vote == TLV_VOTE_ACK || vote == TLV_VOTE_NACK) {
+		node->vote = vote;
+	}
+}
+
+static void
+qnetd_algo_harness_store_result_vote(struct qnetd_algo_harness_node *node,
+    enum tlv_vote result_vote)
+{
+
+	node->client->last_sent_vote = result_vote;
+	if (result_vote == TLV_VOTE_ACK || result_vote == TLV_VOTE_NACK) {
+		node->client->last_sent_ack_nack_vote = result_vote;
+	}
+
+	qnetd_algo_harness_vote_received(node, result_vote);
+}
+
+/*
+ * Process all messages queued by algorithms. Vote info is accepted only with
+ * current ring id (same as qdevice-net does) and it's always replied.
+ * Returns number of processed messages or -1 on error.
+ */
+static int
+qnetd_algo_harness_drain_node(struct qnetd_algo_harness *harness,
+    struct qnetd_algo_harness_node *node)
+{
+	struct send_buffer_list_entry *send_buffer;
+	struct msg_decoded msg;
+	enum tlv_reply_error_code reply_error_code;
+	uint64_t start;
+	int no_msgs;
+
+	if (node->client == NULL) {
+		return (0);
+	}
+
+	no_msgs = 0;
+	msg_decoded_init(&msg);
+
+	while ((send_buffer = send_buffer_list_get_active(&node->client->send_buffer_list)) != NULL) {
+		if (msg_decode(&send_buffer->buffer, &msg) != 0) {
+			log(LOG_ERR, "harness: Can't decode message sent to node "UTILS_PRI_NODE_ID,
+			    node->client->node_id);
+
+			msg_decoded_destroy(&msg);
+			return (-1);
+		}
+
+		send_buffer_list_delete(&node->client->send_buffer_list, send_buffer);
+		no_msgs++;
+		if (harness->measure) {
+			harness->stats.no_vote_infos++;
+		}
+
+		if (msg.type != MSG_TYPE_VOTE_INFO) {
+			log(LOG_ERR, "harness: Unexpected message %s sent to node "UTILS_PRI_NODE_ID,
+			    msg_type_to_str(msg.type), node->client->node_id);
+
+			msg_decoded_destroy(&msg);
+			return (-1);
+		}
+
+		if (tlv_ring_id_eq(&msg.ring_id, &node->ring_id)) {
+			qnetd_algo_harness_vote_received(node, msg.vote);
+		}
+
+		start = qnetd_algo_harness_decision_begin(harness);
+		reply_error_code = harness->callbacks->vote_info_reply_received(node->client,
+		    msg.seq_number);
+		qnetd_algo_harness_decision_end(harness, start);
+
+		if (reply_error_code != TLV_REPLY_ERROR_CODE_NO_ERROR) {
+			msg_decoded_destroy(&msg);
+			return (-1);
+		}
+	}
+
+	msg_decoded_destroy(&msg);
+
+	return (no_msgs);
+}
+
+/*
+ * Fire algorithm timer of given node. Mirrors qnetd_client_algo_timer_callback,
+ * but calls timer callback of harness algorithm instead of registered one.
+ */
+static int
+qnetd_algo_harness_fire_timer(struct qnetd_algo_harness *harness,
+    struct qnetd_algo_harness_node *node)
+{
+	struct qnetd_client *client;
+	enum tlv_vote result_vote;
+	enum tlv_reply_error_code reply_error_code;
+	int send_vote;
+	int reschedule_timer;
+	uint64_t start;
+	int res;
+
+	client = node->client;
+	result_vote = TLV_VOTE_WAIT_FOR_REPLY;
+	send_vote = 0;
+	reschedule_timer = 0;
+	res = 0;
+
+	start = qnetd_algo_harness_decision_begin(harness);
+	reply_error_code = harness->callbacks->timer_callback(client, &reschedule_timer,
+	    &send_vote, &result_vote);
+
+	if (reply_error_code == TLV_REPLY_ERROR_CODE_NO_ERROR && send_vote) {
+		client->algo_timer_vote_info_msq_seq_number++;
+
+		res = qnetd_client_send_vote_info(client,
+		    client->algo_timer_vote_info_msq_seq_number, &client->last_ring_id,
+		    result_vote);
+	}
+	qnetd_algo_harness_decision_end(harness, start);
+
+	if (reply_error_code != TLV_REPLY_ERROR_CODE_NO_ERROR || res != 0) {
+		log(LOG_ERR, "harness: Timer callback for node "UTILS_PRI_NODE_ID" failed",
+		    client->node_id);
+
+		return (-1);
+	}
+
+	if (!reschedule_timer) {
+		timer_list_entry_delete(&harness->timer_list, client->algo_timer);
+		client->algo_timer = NULL;
+	}
+
+	return (0);
+}
+
+/*
+ * Run evaluations scheduled in batch mode. Mirrors qnetd instance pre poll
+ * callback. Returns number of evaluated clusters.
+ */
+static int
+qnetd_algo_harness_run_scheduled_evaluations(struct qnetd_algo_harness *harness)
+{
+	struct qnetd_cluster *cluster;
+	uint64_t start;
+	int no_evaluated;
+
+	no_evaluated = 0;
+
+	TAILQ_FOREACH(cluster, &harness->clusters, entries) {
+		if (cluster->algorithm_evaluation_scheduled) {
+			cluster->algorithm_evaluation_scheduled = 0;
+
+			if (harness->callbacks->cluster_evaluation == NULL ||
+			    TAILQ_EMPTY(&cluster->client_list)) {
+				continue ;
+			}
+
+			start = qnetd_algo_harness_decision_begin(harness);
+			harness->callbacks->cluster_evaluation(TAILQ_FIRST(&cluster->client_list));
+			qnetd_algo_harness_decision_end(harness, start);
+
+			no_evaluated++;
+		}
+	}
+
+	return (no_evaluated);
+}
+
+static int
+qnetd_algo_harness_settle(struct qnetd_algo_harness *harness)
+{
+	struct qnetd_algo_harness_node *node;
+	size_t pass;
+	size_t zi;
+	int res;
+	int pending;
+
+	for (pass = 0; pass < QNETD_ALGO_HARNESS_MAX_SETTLE_PASSES; pass++) {
+		do {
+			pending = qnetd_algo_harness_run_scheduled_evaluations(harness);
+
+			for (zi = 0; zi < harness->no_nodes; zi++) {
+				if ((res = qnetd_algo_harness_drain_node(harness,
+				    &harness->nodes[zi])) == -1) {
+					return (-1);
+				}
+
+				pending += res;
+			}
+		} while (pending > 0);
+
+		pending = 0;
+		for (zi = 0; zi < harness->no_nodes; zi++) {
+			node = &harness->nodes[zi];
+
+			if (node->client != NULL &&
+			    qnetd_client_algo_timer_is_scheduled(node->client)) {
+				if (qnetd_algo_harness_fire_timer(harness, node) != 0) {
+					return (-1);
+				}
+
+				pending++;
+			}
+		}
+
+		if (pending == 0) {
+			break;
+		}
+	}
+
+	return (0);
+}
+
+static int
+qnetd_algo_harness_membership(struct qnetd_algo_harness *harness,
+    struct qnetd_algo_harness_node *node, const struct tlv_ring_id *ring_id,
+    const struct node_list *nodes, enum tlv_heuristics heuristics)
+{
+	struct qnetd_client *client;
+	enum tlv_vote result_vote;
+	enum tlv_reply_error_code reply_error_code;
+	uint64_t start;
+
+	client = node->client;
+	result_vote = TLV_VOTE_NO_CHANGE;
+	node->ring_id = *ring_id;
+
+	start = qnetd_algo_harness_decision_begin(harness);
+	reply_error_code = harness->callbacks->membership_node_list_received(client,
+	    ++node->msg_seq_num, ring_id, nodes, heuristics, &result_vote);
+	qnetd_algo_harness_decision_end(harness, start);
+
+	if (reply_error_code != TLV_REPLY_ERROR_CODE_NO_ERROR) {
+		log(LOG_ERR, "harness: Algorithm returned error %u for membership of node "UTILS_PRI_NODE_ID,
+		    reply_error_code, client->node_id);
+
+		return (-1);
+	}
+
+	node_list_free(&client->last_membership_node_list);
+	if (node_list_clone(&client->last_membership_node_list, nodes) != 0) {
+		return (-1);
+	}
+	client->last_ring_id = *ring_id;
+	client->last_membership_heuristics = heuristics;
+	client->last_heuristics = heuristics;
+	node->heuristics = heuristics;
+
+	qnetd_algo_harness_store_result_vote(node, result_vote);
+
+	return (0);
+}
+
+static int
+qnetd_algo_harness_quorum(struct qnetd_algo_harness *harness,
+    struct qnetd_algo_harness_node *node, const struct node_list *nodes)
+{
+	struct qnetd_client *client;
+	enum tlv_vote result_vote;
+	enum tlv_reply_error_code reply_error_code;
+	enum tlv_quorate quorate;
+	uint64_t start;
+
+	client = node->client;
+	result_vote = TLV_VOTE_NO_CHANGE;
+	quorate = (node->vote == TLV_VOTE_ACK ? TLV_QUORATE_QUORATE : TLV_QUORATE_INQUORATE);
+
+	start = qnetd_algo_harness_decision_begin(harness);
+	reply_error_code = harness->callbacks->quorum_node_list_received(client,
+	    ++node->msg_seq_num, quorate, nodes, &result_vote);
+	qnetd_algo_harness_decision_end(harness, start);
+
+	if (reply_error_code != TLV_REPLY_ERROR_CODE_NO_ERROR) {
+		log(LOG_ERR, "harness: Algorithm returned error %u for quorum of node "UTILS_PRI_NODE_ID,
+		    reply_error_code, client->node_id);
+
+		return (-1);
+	}
+
+	node_list_free(&client->last_quorum_node_list);
+	if (node_list_clone(&client->last_quorum_node_list, nodes) != 0) {
+		return (-1);
+	}
+
+	qnetd_algo_harness_store_result_vote(node, result_vote);
+
+	return (0);
+}
+
+static int
+qnetd_algo_harness_heuristics_change(struct qnetd_algo_harness *harness,
+    struct qnetd_algo_harness_node *node, enum tlv_heuristics heuristics)
+{
+	struct qnetd_client *client;
+	enum tlv_vote result_vote;
+	enum tlv_reply_error_code reply_error_code;
+	uint64_t start;
+
+	client = node->client;
+	result_vote = TLV_VOTE_NO_CHANGE;
+
+	start = qnetd_algo_harness_decision_begin(harness);
+	reply_error_code = harness->callbacks->heuristics_change_received(client,
+	    ++node->msg_seq_num, heuristics, &result_vote);
+	qnetd_algo_harness_decision_end(harness, start);
+
+	if (reply_error_code != TLV_REPLY_ERROR_CODE_NO_ERROR) {
+		log(LOG_ERR, "harness: Algorithm returned error %u for heuristics of node "UTILS_PRI_NODE_ID,
+		    reply_error_code, client->node_id);
+
+		return (-1);
+	}
+
+	client->last_regular_heuristics = heuristics;
+	client->last_heuristics = heuristics;
+	node->heuristics = heuristics;
+
+	qnetd_algo_harness_store_result_vote(node, result_vote);
+
+	return (0);
+}
+
+/*
+ * Connect client for node and send initial config node list
+ */
+static int
+qnetd_algo_harness_connect(struct qnetd_algo_harness *harness,
+    struct qnetd_algo_harness_node *node, uint32_t node_id)
+{
+	struct qnetd_client *client;
+	PRNetAddr addr;
+	char *addr_str;
+	enum tlv_vote result_vote;
+	enum tlv_reply_error_code reply_error_code;
+	uint64_t start;
+
+	memset(&addr, 0, sizeof(addr));
+
+	addr_str = strdup("harness");
+	if (addr_str == NULL) {
+		return (-1);
+	}
+
+	client = qnetd_client_list_add(&harness->clients, NULL, &addr, addr_str,
+	    QNETD_DEFAULT_MAX_CLIENT_RECEIVE_SIZE, QNETD_DEFAULT_MAX_CLIENT_SEND_BUFFERS,
+	    QNETD_DEFAULT_MAX_CLIENT_SEND_SIZE, &harness->timer_list);
+	if (client == NULL) {
+		free(addr_str);
+		return (-1);
+	}
+
+	node->client = client;
+	node->vote = TLV_VOTE_UNDEFINED;
+	node->heuristics = TLV_HEURISTICS_UNDEFINED;
+	memset(&node->ring_id, 0, sizeof(node->ring_id));
+
+	client->cluster_name = strdup(QNETD_ALGO_HARNESS_CLUSTER_NAME);
+	if (client->cluster_name == NULL) {
+		return (-1);
+	}
+	client->cluster_name_len = strlen(client->cluster_name);
+	client->node_id = node_id;
+	client->decision_algorithm = harness->algorithm;
+	client->heartbeat_interval = QNETD_ALGO_HARNESS_HEARTBEAT_INTERVAL;
+	if (harness->vary_tie_breakers) {
+		/*
+		 * Every client gets random tie-breaker, keep active partition
+		 * tie-breaker is enabled for all of them
+		 */
+		switch (qnetd_algo_harness_rand(harness) % 3) {
+		case 0:
+			client->tie_breaker.mode = TLV_TIE_BREAKER_MODE_LOWEST;
+			break;
+		case 1:
+			client->tie_breaker.mode = TLV_TIE_BREAKER_MODE_HIGHEST;
+			break;
+		default:
+			client->tie_breaker.mode = TLV_TIE_BREAKER_MODE_NODE_ID;
+			client->tie_breaker.node_id = 1 +
+			    qnetd_algo_harness_rand(harness) % harness->no_nodes;
+			break;
+		}
+		client->keep_active_partition_tie_breaker =
+		    TLV_KEEP_ACTIVE_PARTITION_TIE_BREAKER_ENABLED;
+	} else {
+		client->tie_breaker.mode = TLV_TIE_BREAKER_MODE_LOWEST;
+		client->keep_active_partition_tie_breaker =
+		    TLV_KEEP_ACTIVE_PARTITION_TIE_BREAKER_DISABLED;
+	}
+	client->batch_algorithm_evaluation = harness->batch_evaluation;
+
+	client->cluster = qnetd_cluster_list_add_client(&harness->clusters, client);
+	if (client->cluster == NULL) {
+		return (-1);
+	}
+	client->cluster_list = &harness->clusters;
+
+	start = qnetd_algo_harness_decision_begin(harness);
+	reply_error_code = harness->callbacks->init(client);
+	qnetd_algo_harness_decision_end(harness, start);
+
+	if (reply_error_code != TLV_REPLY_ERROR_CODE_NO_ERROR) {
+		return (-1);
+	}
+
+	client->init_received = 1;
+
+	result_vote = TLV_VOTE_NO_CHANGE;
+
+	start = qnetd_algo_harness_decision_begin(harness);
+	reply_error_code = harness->callbacks->config_node_list_received(client,
+	    ++node->msg_seq_num,
+	    0, 0, &harness->config_node_list, 1, &result_vote);
+	qnetd_algo_harness_decision_end(harness, start);
+
+	if (reply_error_code != TLV_REPLY_ERROR_CODE_NO_ERROR) {
+		log(LOG_ERR, "harness: Algorithm returned error %u for config of node "UTILS_PRI_NODE_ID,
+		    reply_error_code, node_id);
+
+		return (-1);
+	}
+
+	if (node_list_clone(&client->configuration_node_list, &harness->config_node_list) != 0) {
+		return (-1);
+	}
+
+	qnetd_algo_harness_store_result_vote(node, result_vote);
+
+	return (0);
+}
+
+static void
+qnetd_algo_harness_disconnect(struct qnetd_algo_harness *harness,
+    struct qnetd_algo_harness_node *node, int server_going_down)
+{
+	struct qnetd_client *client;
+	uint64_t start;
+
+	client = node->client;
+	if (client == NULL) {
+		return ;
+	}
+
+	if (client->init_received) {
+		start = qnetd_algo_harness_decision_begin(harness);
+		harness->callbacks->client_disconnect(client, server_going_down);
+		qnetd_algo_harness_decision_end(harness, start);
+	}
+
+	qnetd_client_algo_timer_abort(client);
+
+	if (client->cluster != NULL) {
+		qnetd_cluster_list_del_client(&harness->clusters, client->cluster, client);
+	}
+	qnetd_client_list_del(&harness->clients, client);
+
+	node->client = NULL;
+	node->vote = TLV_VOTE_UNDEFINED;
+}
+
+/*
+ * Deliver membership (and quorum) node lists matching current node partitions.
+ * If single_node is NULL, every partition gets new ring id and all nodes receive
+ * lists in random order. Otherwise only single_node receives lists with ring id
+ * already used by its partition.
+ */
+static int
+qnetd_algo_harness_deliver_partitions(struct qnetd_algo_harness *harness,
+    struct qnetd_algo_harness_node *single_node)
+{
+	struct node_list partition_nodes[QNETD_ALGO_HARNESS_MAX_PARTITIONS];
+	struct tlv_ring_id partition_ring_ids[QNETD_ALGO_HARNESS_MAX_PARTITIONS];
+	size_t *order;
+	size_t zi, zj, tmp;
+	size_t part;
+	size_t no_receivers;
+	int res;
+
+	order = malloc(sizeof(*order) * harness->no_nodes);
+	if (order == NULL) {
+		return (-1);
+	}
+
+	for (zi = 0; zi < QNETD_ALGO_HARNESS_MAX_PARTITIONS; zi++) {
+		node_list_init(&partition_nodes[zi]);
+		memset(&partition_ring_ids[zi], 0, sizeof(partition_ring_ids[zi]));
+	}
+
+	res = -1;
+
+	/*
+	 * Ring id of partition is formed from lowest node id in the partition
+	 */
+	for (zi = 0; zi < harness->no_nodes; zi++) {
+		part = harness->nodes[zi].partition;
+
+		if (node_list_add(&partition_nodes[part], zi + 1, 0, TLV_NODE_STATE_MEMBER) == NULL) {
+			goto exit_res;
+		}
+
+		if (partition_ring_ids[part].node_id == 0) {
+			if (single_node == NULL) {
+				partition_ring_ids[part].node_id = zi + 1;
+				partition_ring_ids[part].seq = ++harness->ring_seq;
+			} else if (&harness->nodes[zi] != single_node) {
+				partition_ring_ids[part] = harness->nodes[zi].ring_id;
+			}
+		}
+
+		order[zi] = zi;
+	}
+
+	if (single_node != NULL) {
+		part = single_node->partition;
+
+		if (partition_ring_ids[part].node_id == 0) {
+			partition_ring_ids[part].node_id = (single_node - harness->nodes) + 1;
+			partition_ring_ids[part].seq = ++harness->ring_seq;
+		}
+
+		no_receivers = 1;
+		order[0] = single_node - harness->nodes;
+	} else {
+		no_receivers = harness->no_nodes;
+
+		for (zi = harness->no_nodes - 1; zi > 0; zi--) {
+			zj = qnetd_algo_harness_rand(harness) % (zi + 1);
+			tmp = order[zi];
+			order[zi] = order[zj];
+			order[zj] = tmp;
+		}
+	}
+
+	for (zi = 0; zi < no_receivers; zi++) {
+		part = harness->nodes[order[zi]].partition;
+
+		if (qnetd_algo_harness_membership(harness, &harness->nodes[order[zi]],
+		    &partition_ring_ids[part], &partition_nodes[part],
+		    harness->nodes[order[zi]].heuristics) != 0) {
+			goto exit_res;
+		}
+	}
+
+	for (zi = 0; zi < no_receivers; zi++) {
+		part = harness->nodes[order[zi]].partition;
+
+		if (qnetd_algo_harness_quorum(harness, &harness->nodes[order[zi]],
+		    &partition_nodes[part]) != 0) {
+			goto exit_res;
+		}
+	}
+
+	res = 0;
+
+exit_res:
+	for (zi = 0; zi < QNETD_ALGO_HARNESS_MAX_PARTITIONS; zi++) {
+		node_list_free(&partition_nodes[zi]);
+	}
+	free(order);
+
+	return (res);
+}
+
+/*
+ * Check that at most one partition holds ACK votes (split brain events are
+ * counted), update digest and write trace.
+ */
+static void
+qnetd_algo_harness_check_result(struct qnetd_algo_harness *harness)
+{
+	const struct qnetd_algo_harness_node *node;
+	const struct tlv_ring_id *ack_ring_id;
+	size_t zi;
+	int split_brain;
+
+	ack_ring_id = NULL;
+	split_brain = 0;
+
+	for (zi = 0; zi < harness->no_nodes; zi++) {
+		node = &harness->nodes[zi];
+
+		qnetd_algo_harness_digest_add(harness, zi + 1);
+		qnetd_algo_harness_digest_add(harness, node->vote);
+		qnetd_algo_harness_digest_add(harness, node->ring_id.node_id);
+		qnetd_algo_harness_digest_add(harness, node->ring_id.seq);
+
+		if (harness->trace != NULL) {
+			fprintf(harness->trace, "%s %zu %zu %zu "UTILS_PRI_NODE_ID" %s "
+			    UTILS_PRI_RING_ID" %s\n",
+			    qnetd_algo_harness_algorithm_to_str(harness->algorithm),
+			    harness->no_nodes, harness->event_no, node->partition, (uint32_t)(zi + 1),
+			    tlv_heuristics_to_str(node->heuristics),
+			    node->ring_id.node_id, node->ring_id.seq, tlv_vote_to_str(node->vote));
+		}
+
+		if (node->vote != TLV_VOTE_ACK) {
+			continue;
+		}
+
+		if (ack_ring_id == NULL) {
+			ack_ring_id = &node->ring_id;
+		} else if (!tlv_ring_id_eq(ack_ring_id, &node->ring_id)) {
+			split_brain = 1;
+		}
+	}
+
+	if (split_brain) {
+		harness->stats.no_split_brain_events++;
+	}
+}
+
+const char *
+qnetd_algo_harness_algorithm_to_str(enum tlv_decision_algorithm_type algorithm)
+{
+
+	switch (algorithm) {
+	case TLV_DECISION_ALGORITHM_TYPE_TEST: return ("test"); break;
+	case TLV_DECISION_ALGORITHM_TYPE_FFSPLIT: return ("ffsplit"); break;
+	case TLV_DECISION_ALGORITHM_TYPE_2NODELMS: return ("2nodelms"); break;
+	case TLV_DECISION_ALGORITHM_TYPE_LMS: return ("lms"); break;
+	/*
+	 * Default is not defined intentionally. Compiler shows warning when new
+	 * algorithm is added
+	 */
+	}
+
+	return ("unknown");
+}
+
+int
+qnetd_algo_harness_init(struct qnetd_algo_harness *harness,
+    enum tlv_decision_algorithm_type algorithm, struct qnetd_algorithm *callbacks,
+    size_t no_nodes, uint32_t seed, FILE *trace, int batch_evaluation, int vary_tie_breakers)
+{
+	size_t zi;
+
+	memset(harness, 0, sizeof(*harness));
+
+	if (no_nodes == 0 || seed == 0) {
+		return (-1);
+	}
+
+	if (!qnetd_algo_harness_algorithms_registered) {
+		if (qnetd_algorithm_register_all() != 0) {
+			return (-1);
+		}
+
+		qnetd_algo_harness_algorithms_registered = 1;
+	}
+
+	harness->algorithm = algorithm;
+	if (callbacks != NULL) {
+		harness->callbacks = callbacks;
+	} else {
+		harness->callbacks = &qnetd_algo_harness_registered_algorithm;
+	}
+	harness->no_nodes = no_nodes;
+	harness->rand_state = seed;
+	harness->digest = QNETD_ALGO_HARNESS_FNV_OFFSET_BASIS;
+	harness->trace = trace;
+	harness->batch_evaluation = batch_evaluation;
+	harness->vary_tie_breakers = vary_tie_breakers;
+
+	qnetd_client_list_init(&harness->clients);
+	qnetd_cluster_list_init(&harness->clusters);
+	timer_list_init(&harness->timer_list);
+	node_list_init(&harness->config_node_list);
+
+	harness->nodes = calloc(no_nodes, sizeof(*harness->nodes));
+	if (harness->nodes == NULL) {
+		return (-1);
+	}
+
+	for (zi = 0; zi < no_nodes; zi++) {
+		if (node_list_add(&harness->config_node_list, zi + 1, 0,
+		    TLV_NODE_STATE_NOT_SET) == NULL) {
+			return (-1);
+		}
+	}
+
+	/*
+	 * All nodes connect and form one partition
+	 */
+	for (zi = 0; zi < no_nodes; zi++) {
+		if (qnetd_algo_harness_connect(harness, &harness->nodes[zi], zi + 1) != 0) {
+			return (-1);
+		}
+	}
+
+	if (qnetd_algo_harness_deliver_partitions(harness, NULL) != 0 ||
+	    qnetd_algo_harness_settle(harness) != 0) {
+		return (-1);
+	}
+
+	qnetd_algo_harness_check_result(harness);
+
+	harness->measure = 1;
+
+	return (0);
+}
+
+/*
+ * Generate and process one random event. Event is one of:
+ * - new partitioning of nodes (1 partition means heal) with new heuristics results
+ * - heuristics change of random subset of nodes
+ * - disconnect and reconnect of random node
+ *
+ * Returns 0 on success, -1 on error.
+ */
+int
+qnetd_algo_harness_run_event(struct qnetd_algo_harness *harness)
+{
+	struct qnetd_algo_harness_node *node;
+	enum tlv_heuristics heuristics;
+	size_t max_partitions;
+	size_t no_partitions;
+	size_t event_type;
+	size_t zi;
+	uint64_t event_start_ns;
+
+	harness->event_no++;
+	harness->event_decision_ns = 0;
+	event_start_ns = harness->stats.decision_ns;
+
+	event_type = qnetd_algo_harness_rand(harness) % 8;
+
+	if (event_type == 0) {
+		node = &harness->nodes[qnetd_algo_harness_rand(harness) % harness->no_nodes];
+
+		qnetd_algo_harness_disconnect(harness, node, 0);
+		if (qnetd_algo_harness_settle(harness) != 0) {
+			return (-1);
+		}
+
+		if (qnetd_algo_harness_connect(harness, node, (node - harness->nodes) + 1) != 0 ||
+		    qnetd_algo_harness_deliver_partitions(harness, node) != 0) {
+			return (-1);
+		}
+	} else if (event_type <= 2 && harness->algorithm != TLV_DECISION_ALGORITHM_TYPE_LMS) {
+		for (zi = 0; zi < harness->no_nodes; zi++) {
+			if (qnetd_algo_harness_rand(harness) % 2 != 0) {
+				continue;
+			}
+
+			heuristics = (qnetd_algo_harness_rand(harness) % 2 == 0 ?
+			    TLV_HEURISTICS_PASS : TLV_HEURISTICS_FAIL);
+
+			if (qnetd_algo_harness_heuristics_change(harness, &harness->nodes[zi],
+			    heuristics) != 0) {
+				return (-1);
+			}
+		}
+	} else {
+		max_partitions = (harness->no_nodes < QNETD_ALGO_HARNESS_MAX_PARTITIONS ?
+		    harness->no_nodes : QNETD_ALGO_HARNESS_MAX_PARTITIONS);
+		no_partitions = 1 + qnetd_algo_harness_rand(harness) % max_partitions;
+
+		for (zi = 0; zi < harness->no_nodes; zi++) {
+			node = &harness->nodes[zi];
+
+			node->partition = qnetd_algo_harness_rand(harness) % no_partitions;
+
+			switch (qnetd_algo_harness_rand(harness) % 4) {
+			case 0:
+				node->heuristics = TLV_HEURISTICS_PASS;
+				break;
+			case 1:
+				node->heuristics = TLV_HEURISTICS_FAIL;
+				break;
+			case 2:
+				node->heuristics = TLV_HEURISTICS_UNDEFINED;
+				break;
+			default:
+				/*
+				 * Keep previous heuristics result
+				 */
+				break;
+			}
+		}
+
+		if (qnetd_algo_harness_deliver_partitions(harness, NULL) != 0) {
+			return (-1);
+		}
+	}
+
+	if (qnetd_algo_harness_settle(harness) != 0) {
+		return (-1);
+	}
+
+	harness->stats.no_events++;
+	if (harness->stats.decision_ns - event_start_ns > harness->stats.max_event_decision_ns) {
+		harness->stats.max_event_decision_ns = harness->stats.decision_ns - event_start_ns;
+	}
+
+	qnetd_algo_harness_check_result(harness);
+
+	return (0);
+}
+
+void
+qnetd_algo_harness_destroy(struct qnetd_algo_harness *harness)
+{
+	size_t zi;
+
+	harness->measure = 0;
+
+	if (harness->nodes != NULL) {
+		for (zi = 0; zi < harness->no_nodes; zi++) {
+			qnetd_algo_harness_disconnect(harness, &harness->nodes[zi], 1);
+		}
+	}
+
+	free(harness->nodes);
+	harness->nodes = NULL;
+
+	node_list_free(&harness->config_node_list);
+	qnetd_cluster_list_free(&harness->clusters);
+	qnetd_client_list_free(&harness->clients);
+	timer_list_free(&harness->timer_list);
+}
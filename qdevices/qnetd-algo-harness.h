@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _QNETD_ALGO_HARNESS_H_
+#define _QNETD_ALGO_HARNESS_H_
+
+#include <sys/types.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "qnetd-algorithm.h"
+#include "qnetd-client-list.h"
+#include "qnetd-cluster-list.h"
+#include "timer-list.h"
+#include "tlv.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * In-memory driver for qnetd decision algorithms. Simulates one cluster with
+ * no_nodes clients and feeds algorithm callbacks directly (without sockets
+ * or message encoding). Vote info messages queued by algorithms are decoded
+ * and replied to immediately, algorithm timers are fired on demand.
+ *
+ * Algorithm callbacks are taken from callbacks passed to qnetd_algo_harness_init
+ * (used by tests to run reference implementation of algorithm). When NULL is
+ * passed, algorithm registered in qnetd is used.
+ */
+struct qnetd_algo_harness_stats {
+	size_t no_events;
+	size_t no_decisions;
+	uint64_t decision_ns;
+	uint64_t max_event_decision_ns;
+	size_t no_allocs;
+	size_t alloc_bytes;
+	size_t no_split_brain_events;
+	size_t no_vote_infos;
+};
+
+struct qnetd_algo_harness_node {
+	struct qnetd_client *client;
+	enum tlv_vote vote;
+	struct tlv_ring_id ring_id;
+	enum tlv_heuristics heuristics;
+	size_t partition;
+	uint32_t msg_seq_num;
+};
+
+struct qnetd_algo_harness {
+	enum tlv_decision_algorithm_type algorithm;
+	struct qnetd_algorithm *callbacks;
+	size_t no_nodes;
+	struct qnetd_algo_harness_node *nodes;
+	struct node_list config_node_list;
+	struct qnetd_client_list clients;
+	struct qnetd_cluster_list clusters;
+	struct timer_list timer_list;
+	uint32_t rand_state;
+	uint64_t ring_seq;
+	uint64_t digest;
+	size_t event_no;
+	FILE *trace;
+	int batch_evaluation;
+	int vary_tie_breakers;
+	int measure;
+	uint64_t event_decision_ns;
+	struct qnetd_algo_harness_stats stats;
+};
+
+/*
+ * Allocation counters. They are updated only by binaries which wrap malloc
+ * family of functions (see qnetd-algo-bench) and only while algorithm
+ * callback is running.
+ */
+extern int				qnetd_algo_harness_alloc_counting;
+extern size_t				qnetd_algo_harness_no_allocs;
+extern size_t				qnetd_algo_harness_alloc_bytes;
+
+extern int				qnetd_algo_harness_init(struct qnetd_algo_harness *harness,
+    enum tlv_decision_algorithm_type algorithm, struct qnetd_algorithm *callbacks,
+    size_t no_nodes, uint32_t seed, FILE *trace, int batch_evaluation, int vary_tie_breakers);
+
+extern int				qnetd_algo_harness_run_event(
+    struct qnetd_algo_harness *harness);
+
+extern void				qnetd_algo_harness_destroy(
+    struct qnetd_algo_harness *harness);
+
+extern const char			*qnetd_algo_harness_algorithm_to_str(
+    enum tlv_decision_algorithm_type algorithm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _QNETD_ALGO_HARNESS_H_ */
@@ -59,17 +59,26 @@
 #include "qnetd-client-algo-timer.h"
 #include "utils.h"
 
+/*
+ * Partitions of the whole cluster. Updated when client ring id or heuristics changes
+ */
+struct qnetd_algo_lms_cluster_data {
+	partitions_list_t partition_list;
+};
+
 struct qnetd_algo_lms_info {
 	int num_config_nodes;
 	enum tlv_vote last_result;
-	partitions_list_t partition_list;
+	struct qnetd_algo_partition_member partition_member;
 };
 
 static enum tlv_reply_error_code do_lms_algorithm(struct qnetd_client *client, const struct tlv_ring_id *cur_ring_id, enum tlv_vote *result_vote)
 {
  	struct qnetd_client *other_client;
 	struct qnetd_algo_lms_info *info = client->algorithm_data;
+	struct qnetd_algo_lms_cluster_data *cluster_data = client->cluster->algorithm_data;
 	struct qnetd_algo_partition *cur_partition;
+	struct qnetd_algo_partition_member *other_member;
 	struct qnetd_algo_partition *largest_partition;
 	struct qnetd_algo_partition *best_score_partition;
 	const struct tlv_ring_id *ring_id = cur_ring_id;
@@ -79,7 +88,7 @@ static enum tlv_reply_error_code do_lms_algorithm(struct qnetd_client *client, c
 	/* We are running the algorithm, don't do it again unless we say so */
 	qnetd_client_algo_timer_abort(client);
 
-	if (qnetd_algo_all_ring_ids_match(client, ring_id) == -1) {
+	if (qnetd_algo_all_ring_ids_match(client, &cluster_data->partition_list, ring_id) == -1) {
 		log(LOG_DEBUG, "algo-lms: nodeid %d: ring ID (" UTILS_PRI_RING_ID ") not unique in this membership, waiting",
 			  client->node_id, ring_id->node_id, ring_id->seq);
 
@@ -88,11 +97,8 @@ static enum tlv_reply_error_code do_lms_algorithm(struct qnetd_client *client, c
 		return (TLV_REPLY_ERROR_CODE_NO_ERROR);
 	}
 
-	/* Create and count the number of separate partitions */
-	if ( (num_partitions = qnetd_algo_create_partitions(client, &info->partition_list, ring_id)) == -1) {
-		log(LOG_DEBUG, "algo-lms: Error creating partition list");
-		return (TLV_REPLY_ERROR_CODE_INTERNAL_ERROR);
-	}
+	/* Count the number of separate partitions */
+	num_partitions = qnetd_algo_count_partitions(&cluster_data->partition_list);
 
 	/* This can happen if we are first on the block */
 	if (num_partitions == 0) {
@@ -103,12 +109,11 @@ static enum tlv_reply_error_code do_lms_algorithm(struct qnetd_client *client, c
 		return (TLV_REPLY_ERROR_CODE_NO_ERROR);
 	}
 
-	qnetd_algo_dump_partitions(&info->partition_list);
+	qnetd_algo_dump_partitions(&cluster_data->partition_list);
 
 	/* Only 1 partition - let votequorum sort it out */
 	if (num_partitions == 1) {
 		log(LOG_DEBUG, "algo-lms: Only 1 partition. This is votequorum's problem, not ours");
-		qnetd_algo_free_partitions(&info->partition_list);
 		*result_vote = info->last_result = TLV_VOTE_ACK;
 		return (TLV_REPLY_ERROR_CODE_NO_ERROR);
 	}
@@ -118,16 +123,19 @@ static enum tlv_reply_error_code do_lms_algorithm(struct qnetd_client *client, c
 	 * to avoid quorum moving to us from already active nodes.
 	 */
 	if (info->last_result == 0) {
-		TAILQ_FOREACH(other_client, &client->cluster->client_list, cluster_entries) {
-			struct qnetd_algo_lms_info *other_info = other_client->algorithm_data;
-			if (!tlv_ring_id_eq(ring_id, &other_client->last_ring_id) &&
-			    other_info->last_result == TLV_VOTE_ACK) {
-				qnetd_algo_free_partitions(&info->partition_list);
-
-				/* Don't save NACK, we need to know subsequently if we haven't been voting */
-				*result_vote = TLV_VOTE_NACK;
-				log(LOG_DEBUG, "algo-lms: we are a new partition and another active partition exists. NACK");
-				return (TLV_REPLY_ERROR_CODE_NO_ERROR);
+		TAILQ_FOREACH(cur_partition, &cluster_data->partition_list, entries) {
+			if (tlv_ring_id_eq(ring_id, &cur_partition->ring_id)) {
+				continue;
+			}
+
+			TAILQ_FOREACH(other_member, &cur_partition->members, entries) {
+				struct qnetd_algo_lms_info *other_info = other_member->client->algorithm_data;
+				if (other_info->last_result == TLV_VOTE_ACK) {
+					/* Don't save NACK, we need to know subsequently if we haven't been voting */
+					*result_vote = TLV_VOTE_NACK;
+					log(LOG_DEBUG, "algo-lms: we are a new partition and another active partition exists. NACK");
+					return (TLV_REPLY_ERROR_CODE_NO_ERROR);
+				}
 			}
 		}
 	}
@@ -136,7 +144,10 @@ static enum tlv_reply_error_code do_lms_algorithm(struct qnetd_client *client, c
 	 * Find the partition with highest score
 	 */
 	best_score_partition = NULL;
-	TAILQ_FOREACH(cur_partition, &info->partition_list, entries) {
+	TAILQ_FOREACH(cur_partition, &cluster_data->partition_list, entries) {
+		if (cur_partition->ring_id.seq == 0) {
+			continue; /* not initialised yet */
+		}
 		if (!best_score_partition ||
 		    best_score_partition->score < cur_partition->score) {
 			best_score_partition = cur_partition;
@@ -147,7 +158,10 @@ static enum tlv_reply_error_code do_lms_algorithm(struct qnetd_client *client, c
 
 	/* Now check if it's really the highest score, and not just the joint-highest */
 	joint_leader = 0;
-	TAILQ_FOREACH(cur_partition, &info->partition_list, entries) {
+	TAILQ_FOREACH(cur_partition, &cluster_data->partition_list, entries) {
+		if (cur_partition->ring_id.seq == 0) {
+			continue;
+		}
 		if (best_score_partition != cur_partition &&
 		    best_score_partition->score == cur_partition->score) {
 			joint_leader = 1;
@@ -165,8 +179,6 @@ static enum tlv_reply_error_code do_lms_algorithm(struct qnetd_client *client, c
 			*result_vote = info->last_result = TLV_VOTE_NACK;
 		}
 
-		qnetd_algo_free_partitions(&info->partition_list);
-
 		return (TLV_REPLY_ERROR_CODE_NO_ERROR);
 	}
 
@@ -174,7 +186,10 @@ static enum tlv_reply_error_code do_lms_algorithm(struct qnetd_client *client, c
 	 * There are multiple partitions with same score. Find the largest partition
 	 */
 	largest_partition = NULL;
-	TAILQ_FOREACH(cur_partition, &info->partition_list, entries) {
+	TAILQ_FOREACH(cur_partition, &cluster_data->partition_list, entries) {
+		if (cur_partition->ring_id.seq == 0) {
+			continue;
+		}
 		if (!largest_partition ||
 		    largest_partition->num_nodes < cur_partition->num_nodes) {
 			largest_partition = cur_partition;
@@ -186,7 +201,10 @@ static enum tlv_reply_error_code do_lms_algorithm(struct qnetd_client *client, c
 
 	/* Now check if it's really the largest, and not just the joint-largest */
 	joint_leader = 0;
-	TAILQ_FOREACH(cur_partition, &info->partition_list, entries) {
+	TAILQ_FOREACH(cur_partition, &cluster_data->partition_list, entries) {
+		if (cur_partition->ring_id.seq == 0) {
+			continue;
+		}
 		if (largest_partition != cur_partition &&
 		    largest_partition->num_nodes == cur_partition->num_nodes) {
 			joint_leader = 1;
@@ -272,7 +290,6 @@ static enum tlv_reply_error_code do_lms_algorithm(struct qnetd_client *client, c
 		}
 	}
 
-	qnetd_algo_free_partitions(&info->partition_list);
 	return (TLV_REPLY_ERROR_CODE_NO_ERROR);
 }
 
@@ -280,6 +297,19 @@ enum tlv_reply_error_code
 qnetd_algo_lms_client_init(struct qnetd_client *client)
 {
 	struct qnetd_algo_lms_info *info;
+	struct qnetd_algo_lms_cluster_data *cluster_data;
+
+	if (qnetd_cluster_size(client->cluster) == 1) {
+		cluster_data = malloc(sizeof(struct qnetd_algo_lms_cluster_data));
+		if (!cluster_data) {
+			return (TLV_REPLY_ERROR_CODE_INTERNAL_ERROR);
+		}
+
+		TAILQ_INIT(&cluster_data->partition_list);
+		client->cluster->algorithm_data = cluster_data;
+	}
+
+	cluster_data = client->cluster->algorithm_data;
 
 	info = malloc(sizeof(struct qnetd_algo_lms_info));
 	if (!info) {
@@ -288,8 +318,16 @@ qnetd_algo_lms_client_init(struct qnetd_client *client)
 
 	memset(info, 0, sizeof(*info));
 	client->algorithm_data = info;
-	info->last_result = 0; /* status unknown, or NEW */
-	TAILQ_INIT(&info->partition_list);
+	/* status unknown, or NEW, or restored from state snapshot */
+	info->last_result = client->last_sent_ack_nack_vote;
+	qnetd_algo_partition_member_init(&info->partition_member, client);
+
+	if (qnetd_algo_partition_member_update(&cluster_data->partition_list, &info->partition_member,
+	    &client->last_ring_id, client->last_heuristics) == -1) {
+		log(LOG_ERR, "algo-lms: Can't add client to partition list");
+		return (TLV_REPLY_ERROR_CODE_INTERNAL_ERROR);
+	}
+
 	return (TLV_REPLY_ERROR_CODE_NO_ERROR);
 }
 
@@ -326,10 +364,31 @@ qnetd_algo_lms_membership_node_list_received(struct qnetd_client *client,
     uint32_t msg_seq_num, const struct tlv_ring_id *ring_id,
     const struct node_list *nodes, enum tlv_heuristics heuristics, enum tlv_vote *result_vote)
 {
+	struct qnetd_algo_lms_info *info = client->algorithm_data;
+	struct qnetd_algo_lms_cluster_data *cluster_data = client->cluster->algorithm_data;
+	enum tlv_reply_error_code ret;
+
 	log(LOG_DEBUG, " ");
 	log(LOG_DEBUG, "algo-lms: membership list from node %d partition (" UTILS_PRI_RING_ID ")", client->node_id, ring_id->node_id, ring_id->seq);
 
-	return do_lms_algorithm(client, ring_id, result_vote);
+	/*
+	 * Client is still accounted with its previous ring id and heuristics while
+	 * voting, same as client->last_ring_id and client->last_heuristics are
+	 * updated only after the algorithm returns
+	 */
+	ret = do_lms_algorithm(client, ring_id, result_vote);
+	if (ret != TLV_REPLY_ERROR_CODE_NO_ERROR) {
+		return (ret);
+	}
+
+	if (qnetd_algo_partition_member_update(&cluster_data->partition_list, &info->partition_member,
+	    ring_id, heuristics) == -1) {
+		log(LOG_ERR, "algo-lms: Can't move client to partition (" UTILS_PRI_RING_ID ")",
+		    ring_id->node_id, ring_id->seq);
+		return (TLV_REPLY_ERROR_CODE_INTERNAL_ERROR);
+	}
+
+	return (TLV_REPLY_ERROR_CODE_NO_ERROR);
 }
 
 /*
@@ -355,12 +414,26 @@ qnetd_algo_lms_quorum_node_list_received(struct qnetd_client *client,
 void
 qnetd_algo_lms_client_disconnect(struct qnetd_client *client, int server_going_down)
 {
+	struct qnetd_algo_lms_info *info = client->algorithm_data;
+	struct qnetd_algo_lms_cluster_data *cluster_data = client->cluster->algorithm_data;
+
 	log(LOG_DEBUG, "algo-lms: Client %p (cluster %s, node_id "UTILS_PRI_NODE_ID") "
 	    "disconnect", client, client->cluster_name, client->node_id);
 
 	log(LOG_INFO, "algo-lms:   server going down %u", server_going_down);
 
+	qnetd_algo_partition_member_del(&cluster_data->partition_list, &info->partition_member);
+
 	free(client->algorithm_data);
+
+	if (qnetd_cluster_size(client->cluster) == 1) {
+		/*
+		 * Last client in the cluster
+		 */
+		qnetd_algo_free_partitions(&cluster_data->partition_list);
+
+		free(client->cluster->algorithm_data);
+	}
 }
 
 /*
@@ -391,6 +464,17 @@ enum tlv_reply_error_code
 qnetd_algo_lms_heuristics_change_received(struct qnetd_client *client, uint32_t msg_seq_num,
     enum tlv_heuristics heuristics, enum tlv_vote *result_vote)
 {
+	struct qnetd_algo_lms_info *info = client->algorithm_data;
+	struct qnetd_algo_lms_cluster_data *cluster_data = client->cluster->algorithm_data;
+
+	/*
+	 * Vote is not changed but heuristics is part of the partition score
+	 */
+	if (qnetd_algo_partition_member_update(&cluster_data->partition_list, &info->partition_member,
+	    &client->last_ring_id, heuristics) == -1) {
+		log(LOG_ERR, "algo-lms: Can't update client heuristics in partition list");
+		return (TLV_REPLY_ERROR_CODE_INTERNAL_ERROR);
+	}
 
 	log(LOG_INFO, "algo-lms: heuristics change is not supported.");
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2017 Red Hat, Inc.
+ * Copyright (c) 2026 Red Hat, Inc.
  *
  * All rights reserved.
  *
@@ -32,25 +32,26 @@
  * THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#ifndef _QDEVICE_HEURISTICS_CMD_STR_H_
-#define _QDEVICE_HEURISTICS_CMD_STR_H_
+
+#ifndef _QNETD_ALGO_REF_H_
+#define _QNETD_ALGO_REF_H_
+
+#include "qnetd-algorithm.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-#define QDEVICE_HEURISTICS_CMD_STR_EXEC_LIST_CLEAR		"exec-list-clear"
-#define QDEVICE_HEURISTICS_CMD_STR_EXEC_LIST_ADD		"exec-list-add"
-#define QDEVICE_HEURISTICS_CMD_STR_EXEC_LIST_ADD_SPACE		\
-    QDEVICE_HEURISTICS_CMD_STR_EXEC_LIST_ADD " "
-#define QDEVICE_HEURISTICS_CMD_STR_EXEC				"exec"
-#define QDEVICE_HEURISTICS_CMD_STR_EXEC_ADD_SPACE		QDEVICE_HEURISTICS_CMD_STR_EXEC " "
-#define QDEVICE_HEURISTICS_CMD_STR_EXEC_RESULT			"exec-result"
-#define QDEVICE_HEURISTICS_CMD_STR_EXEC_RESULT_ADD_SPACE	\
-    QDEVICE_HEURISTICS_CMD_STR_EXEC_RESULT " "
+/*
+ * Reference implementations of decision algorithms used by test-qnetd-algo
+ * to check decisions of optimized algorithms. They are not registered in qnetd.
+ */
+extern struct qnetd_algorithm		qnetd_algo_ref_ffsplit;
+
+extern struct qnetd_algorithm		qnetd_algo_ref_lms;
 
 #ifdef __cplusplus
 }
 #endif
 
-#endif /* _QDEVICE_HEURISTICS_CMD_STR_H_ */
+#endif /* _QNETD_ALGO_REF_H_ */
@@ -46,47 +46,47 @@
  * of the cluster and should wait until all of the ring_ids in this membership list match up
  */
 int
-qnetd_algo_all_ring_ids_match(struct qnetd_client *client, const struct tlv_ring_id *ring_id)
+qnetd_algo_all_ring_ids_match(struct qnetd_client *client, partitions_list_t *partitions,
+    const struct tlv_ring_id *ring_id)
 {
-	struct node_list_entry *node_info;
+	struct qnetd_algo_partition *partition;
+	struct qnetd_algo_partition_member *member;
  	struct qnetd_client *other_client;
 
-	TAILQ_FOREACH(other_client, &client->cluster->client_list, cluster_entries) {
-		int in_our_partition = 0;
-
-		if (other_client == client) {
-			continue; /* We've seen our membership list */
+	/*
+	 * Clients sharing our ring id are fine, so only clients from other partitions
+	 * have to be checked
+	 */
+	TAILQ_FOREACH(partition, partitions, entries) {
+		if (tlv_ring_id_eq(&partition->ring_id, ring_id)) {
+			continue;
 		}
-		log(LOG_DEBUG, "algo-util: all_ring_ids_match: seen nodeid %d (client %p) ring_id (" UTILS_PRI_RING_ID ")", other_client->node_id, other_client, other_client->last_ring_id.node_id, other_client->last_ring_id.seq);
 
-		/* Look down our node list and see if this client is known to us */
-		TAILQ_FOREACH(node_info, &client->last_membership_node_list, entries) {
-			if (node_info->node_id == other_client->node_id) {
-				in_our_partition = 1;
+		TAILQ_FOREACH(member, &partition->members, entries) {
+			other_client = member->client;
+
+			if (other_client == client) {
+				continue; /* We've seen our membership list */
 			}
-		}
 
-		if (in_our_partition == 0) {
 			/*
+			 * Look down our node list and see if this client is known to us.
 			 * Also try to look from the other side to see if we are
 			 * not in the other node's membership list.
 			 * Because if so it may mean the membership lists are not equal
 			 */
-			TAILQ_FOREACH(node_info, &other_client->last_membership_node_list, entries) {
-				if (node_info->node_id == client->node_id) {
-					in_our_partition = 1;
-				}
+			if (node_list_find_node_id(&client->last_membership_node_list,
+			    other_client->node_id) != NULL ||
+			    node_list_find_node_id(&other_client->last_membership_node_list,
+			    client->node_id) != NULL) {
+				/*
+				 * If the other nodes on our side of a partition have a different ring ID then
+				 * we need to wait until they have all caught up before making a decision
+				 */
+				log(LOG_DEBUG, "algo-util: nodeid %d in our partition has different ring_id (" UTILS_PRI_RING_ID ") to us (" UTILS_PRI_RING_ID ")", other_client->node_id, other_client->last_ring_id.node_id, other_client->last_ring_id.seq, ring_id->node_id, ring_id->seq);
+				return (-1); /* ring IDs don't match */
 			}
 		}
-
-		/*
-		 * If the other nodes on our side of a partition have a different ring ID then
-		 * we need to wait until they have all caught up before making a decision
-		 */
-		if (in_our_partition && !tlv_ring_id_eq(ring_id, &other_client->last_ring_id)) {
-			log(LOG_DEBUG, "algo-util: nodeid %d in our partition has different ring_id (" UTILS_PRI_RING_ID ") to us (" UTILS_PRI_RING_ID ")", other_client->node_id, other_client->last_ring_id.node_id, other_client->last_ring_id.seq, ring_id->node_id, ring_id->seq);
-			return (-1); /* ring IDs don't match */
-		}
 	}
 
 	return (0);
@@ -106,47 +106,117 @@ qnetd_algo_find_partition(partitions_list_t *partitions_list, const struct tlv_r
 	return (NULL);
 }
 
+/*
+ * Score is computed similar way as in the ffsplit algorithm
+ */
+static int
+qnetd_algo_partition_member_score(enum tlv_heuristics heuristics)
+{
+
+	if (heuristics == TLV_HEURISTICS_PASS) {
+		return (2);
+	} else if (heuristics == TLV_HEURISTICS_FAIL) {
+		return (0);
+	}
+
+	return (1);
+}
+
+void
+qnetd_algo_partition_member_init(struct qnetd_algo_partition_member *member,
+    struct qnetd_client *client)
+{
+
+	memset(member, 0, sizeof(*member));
+	member->client = client;
+}
+
+/*
+ * Move member to the partition with given ring id and account its heuristics.
+ * Partition is created when it doesn't exist yet.
+ */
 int
-qnetd_algo_create_partitions(struct qnetd_client *client, partitions_list_t *partitions_list, const struct tlv_ring_id *ring_id)
+qnetd_algo_partition_member_update(partitions_list_t *partitions_list,
+    struct qnetd_algo_partition_member *member, const struct tlv_ring_id *ring_id,
+    enum tlv_heuristics heuristics)
 {
- 	struct qnetd_client *other_client;
-	int num_partitions = 0;
+	struct qnetd_algo_partition *partition;
+
+	if (member->partition != NULL && tlv_ring_id_eq(&member->partition->ring_id, ring_id) &&
+	    member->heuristics == heuristics) {
+		return (0);
+	}
 
-	TAILQ_FOREACH(other_client, &client->cluster->client_list, cluster_entries) {
-		struct qnetd_algo_partition *partition;
+	qnetd_algo_partition_member_del(partitions_list, member);
 
-		if (other_client->last_ring_id.seq == 0){
-			continue; /* not initialised yet */
-		}
-		partition = qnetd_algo_find_partition(partitions_list, &other_client->last_ring_id);
+	partition = qnetd_algo_find_partition(partitions_list, ring_id);
+	if (!partition) {
+		partition = malloc(sizeof(struct qnetd_algo_partition));
 		if (!partition) {
-			partition = malloc(sizeof(struct qnetd_algo_partition));
-			if (!partition) {
-				return (-1);
-			}
-			partition->num_nodes = 0;
-			partition->score = 0;
-			memcpy(&partition->ring_id, &other_client->last_ring_id, sizeof(*ring_id));
-			num_partitions++;
-			TAILQ_INSERT_TAIL(partitions_list, partition, entries);
-		}
-		partition->num_nodes++;
-
-		/*
-		 * Score is computer similar way as in the ffsplit algorithm
-		 */
-		partition->score++;
-		if (other_client->last_heuristics == TLV_HEURISTICS_PASS) {
-			partition->score++;
-		} else if (other_client->last_heuristics == TLV_HEURISTICS_FAIL) {
-			partition->score--;
+			return (-1);
 		}
+		partition->num_nodes = 0;
+		partition->score = 0;
+		memcpy(&partition->ring_id, ring_id, sizeof(*ring_id));
+		TAILQ_INIT(&partition->members);
+		TAILQ_INSERT_TAIL(partitions_list, partition, entries);
+	}
+
+	TAILQ_INSERT_TAIL(&partition->members, member, entries);
+	partition->num_nodes++;
+	partition->score += qnetd_algo_partition_member_score(heuristics);
+
+	member->partition = partition;
+	member->heuristics = heuristics;
+
+	return (0);
+}
 
+/*
+ * Remove member from its partition. Empty partition is freed.
+ */
+void
+qnetd_algo_partition_member_del(partitions_list_t *partitions_list,
+    struct qnetd_algo_partition_member *member)
+{
+	struct qnetd_algo_partition *partition;
+
+	partition = member->partition;
+	if (partition == NULL) {
+		return ;
 	}
 
-	return (num_partitions);
+	TAILQ_REMOVE(&partition->members, member, entries);
+	partition->num_nodes--;
+	partition->score -= qnetd_algo_partition_member_score(member->heuristics);
+
+	if (partition->num_nodes == 0) {
+		TAILQ_REMOVE(partitions_list, partition, entries);
+		free(partition);
+	}
+
+	member->partition = NULL;
 }
 
+/*
+ * Return number of partitions. Partition of clients without ring id is not counted
+ */
+int
+qnetd_algo_count_partitions(const partitions_list_t *partitions_list)
+{
+	const struct qnetd_algo_partition *partition;
+	int num_partitions;
+
+	num_partitions = 0;
+
+	TAILQ_FOREACH(partition, partitions_list, entries) {
+		if (partition->ring_id.seq != 0) {
+			num_partitions++;
+		}
+	}
+
+	return (num_partitions);
+}
 
 void
 qnetd_algo_free_partitions(partitions_list_t *partitions_list)
@@ -44,23 +44,48 @@
 extern "C" {
 #endif
 
+struct qnetd_algo_partition;
+
+/*
+ * Client accounted in the partition list. Embedded in client algorithm data.
+ */
+struct qnetd_algo_partition_member {
+	struct qnetd_client *client;
+	struct qnetd_algo_partition *partition;
+	enum tlv_heuristics heuristics;
+	TAILQ_ENTRY(qnetd_algo_partition_member) entries;
+};
+
+TAILQ_HEAD(qnetd_algo_partition_member_list, qnetd_algo_partition_member);
+
 struct qnetd_algo_partition {
 	struct tlv_ring_id ring_id;
 	int num_nodes;
 	int score;
+	struct qnetd_algo_partition_member_list members;
 	TAILQ_ENTRY(qnetd_algo_partition) entries;
 };
 
 typedef TAILQ_HEAD(, qnetd_algo_partition) partitions_list_t;
 
 extern int				 qnetd_algo_all_ring_ids_match(struct qnetd_client *client,
-    const struct tlv_ring_id *ring_id);
+    partitions_list_t *partitions, const struct tlv_ring_id *ring_id);
 
 extern struct qnetd_algo_partition	*qnetd_algo_find_partition(partitions_list_t *partitions,
     const struct tlv_ring_id *ring_id);
 
-extern int				 qnetd_algo_create_partitions(struct qnetd_client *client,
-    partitions_list_t *partitions, const struct tlv_ring_id *ring_id);
+extern void				 qnetd_algo_partition_member_init(
+    struct qnetd_algo_partition_member *member, struct qnetd_client *client);
+
+extern int				 qnetd_algo_partition_member_update(
+    partitions_list_t *partitions, struct qnetd_algo_partition_member *member,
+    const struct tlv_ring_id *ring_id, enum tlv_heuristics heuristics);
+
+extern void				 qnetd_algo_partition_member_del(
+    partitions_list_t *partitions, struct qnetd_algo_partition_member *member);
+
+extern int				 qnetd_algo_count_partitions(
+    const partitions_list_t *partitions);
 
 extern void				 qnetd_algo_free_partitions(partitions_list_t *partitions);
 
@@ -37,6 +37,7 @@
 #include "log.h"
 #include "qnet-config.h"
 #include "qnetd-algorithm.h"
+#include "qnetd-cluster.h"
 #include "qnetd-algo-test.h"
 #include "qnetd-algo-ffsplit.h"
 #include "qnetd-algo-2nodelms.h"
@@ -185,6 +186,27 @@ qnetd_algorithm_timer_callback(struct qnetd_client *client, int *reschedule_time
 		client, reschedule_timer, send_vote, result_vote));
 }
 
+void
+qnetd_algorithm_cluster_evaluation(struct qnetd_cluster *cluster)
+{
+	struct qnetd_client *client;
+
+	client = TAILQ_FIRST(&cluster->client_list);
+	if (client == NULL) {
+		return ;
+	}
+
+	if (client->decision_algorithm >= QNETD_STATIC_SUPPORTED_DECISION_ALGORITHMS_SIZE ||
+	    qnetd_algorithm_array[client->decision_algorithm] == NULL) {
+		log(LOG_CRIT, "qnetd_algorithm_cluster_evaluation unhandled decision algorithm");
+		return ;
+	}
+
+	if (qnetd_algorithm_array[client->decision_algorithm]->cluster_evaluation != NULL) {
+		qnetd_algorithm_array[client->decision_algorithm]->cluster_evaluation(client);
+	}
+}
+
 int
 qnetd_algorithm_register(enum tlv_decision_algorithm_type algorithm_number,
     struct qnetd_algorithm *algorithm)
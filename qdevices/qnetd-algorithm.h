@@ -76,6 +76,9 @@ extern enum tlv_reply_error_code	qnetd_algorithm_heuristics_change_received(
 extern enum tlv_reply_error_code	qnetd_algorithm_timer_callback(
     struct qnetd_client *client, int *reschedule_timer, int *send_vote, enum tlv_vote *result_vote);
 
+extern void				qnetd_algorithm_cluster_evaluation(
+    struct qnetd_cluster *cluster);
+
 struct qnetd_algorithm {
 	enum tlv_reply_error_code (*init)(struct qnetd_client *client);
 
@@ -107,6 +110,12 @@ struct qnetd_algorithm {
 
 	 enum tlv_reply_error_code (*timer_callback)(struct qnetd_client *client,
 	    int *reschedule_timer, int *send_vote, enum tlv_vote *result_vote);
+
+	/*
+	 * Optional. Called at the end of main loop iteration for cluster with
+	 * algorithm_evaluation_scheduled set. Client is any client of the cluster.
+	 */
+	void (*cluster_evaluation)(struct qnetd_client *client);
 };
 
 extern int				qnetd_algorithm_register(
@@ -34,10 +34,12 @@
 
 #include <sys/types.h>
 
+#include "flight-recorder.h"
 #include "log.h"
 #include "log-common.h"
 #include "qnetd-algorithm.h"
 #include "qnetd-instance.h"
+#include "qnetd-ipc.h"
 #include "qnetd-log-debug.h"
 #include "qnetd-client-send.h"
 #include "qnetd-client-dpd-timer.h"
@@ -100,7 +102,8 @@ qnetd_client_msg_received_check_tls(struct qnetd_instance *instance, struct qnet
 	}
 
 	if (tls_required && !client->tls_started) {
-		log(LOG_ERR, "TLS is required but doesn't started yet. "
+		qnetd_client_log_ratelimit(client, LOG_ERR,
+		    "TLS is required but doesn't started yet. "
 		    "Sending back error message");
 
 		if (qnetd_client_send_err(client, msg->seq_number_set, msg->seq_number,
@@ -115,14 +118,16 @@ qnetd_client_msg_received_check_tls(struct qnetd_instance *instance, struct qnet
 		peer_cert = SSL_PeerCertificate(client->socket);
 
 		if (peer_cert == NULL) {
-			log(LOG_ERR, "Client doesn't sent valid certificate. "
+			qnetd_client_log_ratelimit(client, LOG_ERR,
+			    "Client doesn't sent valid certificate. "
 			    "Disconnecting client");
 
 			return (-1);
 		}
 
 		if (CERT_VerifyCertName(peer_cert, client->cluster_name) != SECSuccess) {
-			log(LOG_ERR, "Client doesn't sent certificate with valid CN. "
+			qnetd_client_log_ratelimit(client, LOG_ERR,
+			    "Client doesn't sent certificate with valid CN. "
 			    "Disconnecting client");
 
 			CERT_DestroyCertificate(peer_cert);
@@ -145,7 +150,8 @@ qnetd_client_msg_received_preinit(struct qnetd_instance *instance, struct qnetd_
 	struct send_buffer_list_entry *send_buffer;
 
 	if (msg->cluster_name == NULL) {
-		log(LOG_ERR, "Received preinit message without cluster name. "
+		qnetd_client_log_ratelimit(client, LOG_ERR,
+		    "Received preinit message without cluster name. "
 		    "Sending error reply.");
 
 		if (qnetd_client_send_err(client, msg->seq_number_set, msg->seq_number,
@@ -201,7 +207,8 @@ qnetd_client_msg_received_unexpected_msg(struct qnetd_client *client,
     const struct msg_decoded *msg, const char *msg_str)
 {
 
-	log(LOG_ERR, "Received %s message. Sending back error message", msg_str);
+	qnetd_client_log_ratelimit(client, LOG_ERR,
+	    "Received %s message. Sending back error message", msg_str);
 
 	if (qnetd_client_send_err(client, msg->seq_number_set, msg->seq_number,
 	    TLV_REPLY_ERROR_CODE_UNEXPECTED_MESSAGE) != 0) {
@@ -226,7 +233,8 @@ qnetd_client_msg_received_starttls(struct qnetd_instance *instance, struct qnetd
 	PRFileDesc *new_pr_fd;
 
 	if (!client->preinit_received) {
-		log(LOG_ERR, "Received starttls before preinit message. "
+		qnetd_client_log_ratelimit(client, LOG_ERR,
+		    "Received starttls before preinit message. "
 		    "Sending error reply.");
 
 		if (qnetd_client_send_err(client, msg->seq_number_set, msg->seq_number,
@@ -239,7 +247,8 @@ qnetd_client_msg_received_starttls(struct qnetd_instance *instance, struct qnetd
 
 	if ((new_pr_fd = nss_sock_start_ssl_as_server(client->socket, instance->server.cert,
 	    instance->server.private_key, instance->tls_client_cert_required, 0, NULL)) == NULL) {
-		log_nss(LOG_ERR, "Can't start TLS. Disconnecting client.");
+		qnetd_client_log_ratelimit_nss(client, LOG_ERR,
+		    "Can't start TLS. Disconnecting client.");
 
 		return (-1);
 	}
@@ -455,6 +464,9 @@ qnetd_client_msg_received_init(struct qnetd_instance *instance, struct qnetd_cli
 		 */
 		client->keep_active_partition_tie_breaker =
 		    instance->advanced_settings->keep_active_partition_tie_breaker;
+
+		client->batch_algorithm_evaluation =
+		    instance->advanced_settings->batch_algorithm_evaluation;
 	}
 
 	if (reply_error_code == TLV_REPLY_ERROR_CODE_NO_ERROR) {
@@ -478,6 +490,11 @@ qnetd_client_msg_received_init(struct qnetd_instance *instance, struct qnetd_cli
 	if (reply_error_code == TLV_REPLY_ERROR_CODE_NO_ERROR) {
 		qnetd_log_debug_new_client_connected(client);
 
+		if (qnetd_state_snapshot_restore_client(&instance->state_snapshot, client)) {
+			log(LOG_DEBUG, "Restored last sent vote %s of client %s from state snapshot",
+			    tlv_vote_to_str(client->last_sent_ack_nack_vote), client->addr_str);
+		}
+
 		reply_error_code = qnetd_algorithm_client_init(client);
 	}
 
@@ -486,6 +503,11 @@ qnetd_client_msg_received_init(struct qnetd_instance *instance, struct qnetd_cli
 		 * Correct init received
 		 */
 		client->init_received = 1;
+
+		flight_recorder_record_event(FLIGHT_RECORDER_EVENT_TYPE_CONNECTED,
+		    client->cluster_name, client->node_id);
+
+		qnetd_ipc_send_client_event(instance, client, "client_connected", NULL);
 	} else {
 		log(LOG_ERR, "Algorithm returned error code. Sending error reply.");
 	}
@@ -666,58 +688,131 @@ qnetd_client_msg_received_echo_request(struct qnetd_instance *instance, struct q
 	return (0);
 }
 
-static int
-qnetd_client_msg_received_node_list(struct qnetd_instance *instance, struct qnetd_client *client,
-    const struct msg_decoded *msg)
+/*
+ * Return stored node list and its version for given node list type
+ */
+static void
+qnetd_client_msg_received_node_list_get_stored(struct qnetd_client *client,
+    enum tlv_node_list_type node_list_type, struct node_list **nlist, uint32_t **version)
 {
-	int res;
-	struct send_buffer_list_entry *send_buffer;
-	enum tlv_reply_error_code reply_error_code;
-	enum tlv_vote result_vote;
 	int case_processed;
 
-	reply_error_code = TLV_REPLY_ERROR_CODE_NO_ERROR;
+	case_processed = 0;
+	switch (node_list_type) {
+	case TLV_NODE_LIST_TYPE_INITIAL_CONFIG:
+	case TLV_NODE_LIST_TYPE_CHANGED_CONFIG:
+		case_processed = 1;
+		*nlist = &client->configuration_node_list;
+		*version = &client->configuration_node_list_version;
+		break;
+	case TLV_NODE_LIST_TYPE_MEMBERSHIP:
+		case_processed = 1;
+		*nlist = &client->last_membership_node_list;
+		*version = &client->last_membership_node_list_version;
+		break;
+	case TLV_NODE_LIST_TYPE_QUORUM:
+		case_processed = 1;
+		*nlist = &client->last_quorum_node_list;
+		*version = &client->last_quorum_node_list_version;
+		break;
+	/*
+	 * Default is not defined intentionally. Compiler shows warning when new
+	 * node list type is added
+	 */
+	}
 
-	if ((res = qnetd_client_msg_received_check_tls(instance, client, msg)) != 0) {
-		return (res == -1 ? -1 : 0);
+	if (!case_processed) {
+		log(LOG_ERR, "qnetd_client_msg_received_node_list_get_stored fatal error. "
+		    "Unhandled node_list_type");
+		exit(EXIT_FAILURE);
 	}
+}
 
-	if (!client->init_received) {
-		log(LOG_ERR, "Received node list message before init message. "
-		    "Sending error reply.");
+/*
+ * Reconstruct full node list from stored list and delta sent by client.
+ * Returns 0 on success, 1 if stored list version doesn't match delta base version
+ * and -1 on allocation failure.
+ */
+static int
+qnetd_client_msg_received_node_list_apply_delta(struct qnetd_client *client,
+    const struct msg_decoded *msg, struct node_list *nodes)
+{
+	struct node_list *stored_list;
+	uint32_t *stored_version;
 
-		if (qnetd_client_send_err(client, msg->seq_number_set, msg->seq_number,
-		    TLV_REPLY_ERROR_CODE_INIT_REQUIRED) != 0) {
-			return (-1);
-		}
+	qnetd_client_msg_received_node_list_get_stored(client, msg->node_list_type,
+	    &stored_list, &stored_version);
 
-		return (0);
+	if (*stored_version == 0 || *stored_version != msg->node_list_base_version) {
+		log(LOG_WARNING, "Client %s sent delta node list against version %"PRIu32
+		    " but stored version is %"PRIu32". Requesting full node list.",
+		    client->addr_str, msg->node_list_base_version, *stored_version);
+
+		return (1);
 	}
 
-	if (!msg->node_list_type_set) {
-		log(LOG_ERR, "Received node list message without node list type set. "
-		    "Sending error reply.");
+	if (node_list_clone(nodes, stored_list) != 0) {
+		return (-1);
+	}
 
-		if (qnetd_client_send_err(client, msg->seq_number_set, msg->seq_number,
-		    TLV_REPLY_ERROR_CODE_DOESNT_CONTAIN_REQUIRED_OPTION) != 0) {
-			return (-1);
-		}
+	if (node_list_apply_delta(nodes, &msg->nodes, &msg->removed_nodes) != 0) {
+		node_list_free(nodes);
 
-		return (0);
+		return (-1);
 	}
 
-	if (!msg->seq_number_set) {
-		log(LOG_ERR, "Received node list message without seq number set. "
-		    "Sending error reply.");
+	return (0);
+}
 
-		if (qnetd_client_send_err(client, msg->seq_number_set, msg->seq_number,
-		    TLV_REPLY_ERROR_CODE_DOESNT_CONTAIN_REQUIRED_OPTION) != 0) {
-			return (-1);
-		}
+/*
+ * Reply to delta node list which can't be applied. Algorithm is not called, vote doesn't
+ * change and reply contains version of stored list so client sends full node list.
+ */
+static int
+qnetd_client_msg_received_node_list_send_version_mismatch(struct qnetd_client *client,
+    const struct msg_decoded *msg)
+{
+	struct send_buffer_list_entry *send_buffer;
+	struct node_list *stored_list;
+	uint32_t *stored_version;
 
-		return (0);
+	qnetd_client_msg_received_node_list_get_stored(client, msg->node_list_type,
+	    &stored_list, &stored_version);
+
+	send_buffer = send_buffer_list_get_new(&client->send_buffer_list);
+	if (send_buffer == NULL) {
+		log(LOG_ERR, "Can't alloc node list reply msg from list. "
+		    "Disconnecting client connection.");
+
+		return (-1);
+	}
+
+	if (msg_create_node_list_reply(&send_buffer->buffer, msg->seq_number, msg->node_list_type,
+	    &client->last_ring_id, TLV_VOTE_NO_CHANGE, 1, *stored_version) == 0) {
+		log(LOG_ERR, "Can't alloc node list reply msg. "
+		    "Disconnecting client connection.");
+
+		send_buffer_list_discard_new(&client->send_buffer_list, send_buffer);
+
+		return (-1);
 	}
 
+	send_buffer_list_put(&client->send_buffer_list, send_buffer);
+
+	return (0);
+}
+
+static int
+qnetd_client_msg_received_node_list_process(struct qnetd_instance *instance,
+    struct qnetd_client *client, const struct msg_decoded *msg, const struct node_list *nodes)
+{
+	struct send_buffer_list_entry *send_buffer;
+	enum tlv_reply_error_code reply_error_code;
+	enum tlv_vote result_vote;
+	int case_processed;
+
+	reply_error_code = TLV_REPLY_ERROR_CODE_NO_ERROR;
+
 	result_vote = TLV_VOTE_NO_CHANGE;
 
 	case_processed = 0;
@@ -726,12 +821,12 @@ qnetd_client_msg_received_node_list(struct qnetd_instance *instance, struct qnet
 	case TLV_NODE_LIST_TYPE_CHANGED_CONFIG:
 		case_processed = 1;
 		qnetd_log_debug_config_node_list_received(client, msg->seq_number,
-		    msg->config_version_set, msg->config_version, &msg->nodes,
+		    msg->config_version_set, msg->config_version, nodes,
 		    (msg->node_list_type == TLV_NODE_LIST_TYPE_INITIAL_CONFIG));
 
 		reply_error_code = qnetd_algorithm_config_node_list_received(client,
 		    msg->seq_number, msg->config_version_set, msg->config_version,
-		    &msg->nodes,
+		    nodes,
 		    (msg->node_list_type == TLV_NODE_LIST_TYPE_INITIAL_CONFIG),
 		    &result_vote);
 		break;
@@ -750,10 +845,10 @@ qnetd_client_msg_received_node_list(struct qnetd_instance *instance, struct qnet
 		}
 
 		qnetd_log_debug_membership_node_list_received(client, msg->seq_number, &msg->ring_id,
-		    msg->heuristics, &msg->nodes);
+		    msg->heuristics, nodes);
 
 		reply_error_code = qnetd_algorithm_membership_node_list_received(client,
-		    msg->seq_number, &msg->ring_id, &msg->nodes, msg->heuristics, &result_vote);
+		    msg->seq_number, &msg->ring_id, nodes, msg->heuristics, &result_vote);
 		break;
 	case TLV_NODE_LIST_TYPE_QUORUM:
 		case_processed = 1;
@@ -770,10 +865,10 @@ qnetd_client_msg_received_node_list(struct qnetd_instance *instance, struct qnet
 		}
 
 		qnetd_log_debug_quorum_node_list_received(client, msg->seq_number,msg->quorate,
-		    &msg->nodes);
+		    nodes);
 
 		reply_error_code = qnetd_algorithm_quorum_node_list_received(client,
-		    msg->seq_number,msg->quorate, &msg->nodes, &result_vote);
+		    msg->seq_number,msg->quorate, nodes, &result_vote);
 		break;
 	/*
 	 * Default is not defined intentionally. Compiler shows warning when new
@@ -810,7 +905,7 @@ qnetd_client_msg_received_node_list(struct qnetd_instance *instance, struct qnet
 	case TLV_NODE_LIST_TYPE_CHANGED_CONFIG:
 		case_processed = 1;
 		node_list_free(&client->configuration_node_list);
-		if (node_list_clone(&client->configuration_node_list, &msg->nodes) == -1) {
+		if (node_list_clone(&client->configuration_node_list, nodes) == -1) {
 			log(LOG_ERR, "Can't alloc config node list clone. "
 			    "Disconnecting client connection.");
 
@@ -818,30 +913,43 @@ qnetd_client_msg_received_node_list(struct qnetd_instance *instance, struct qnet
 		}
 		client->config_version_set = msg->config_version_set;
 		client->config_version = msg->config_version;
+		client->configuration_node_list_version = msg->node_list_version;
 
 		break;
 	case TLV_NODE_LIST_TYPE_MEMBERSHIP:
 		case_processed = 1;
 		node_list_free(&client->last_membership_node_list);
-		if (node_list_clone(&client->last_membership_node_list, &msg->nodes) == -1) {
+		if (node_list_clone(&client->last_membership_node_list, nodes) == -1) {
 			log(LOG_ERR, "Can't alloc membership node list clone. "
 			    "Disconnecting client connection.");
 
 			return (-1);
 		}
+		if (client->last_ring_id.node_id != msg->ring_id.node_id ||
+		    client->last_ring_id.seq != msg->ring_id.seq) {
+			qnetd_ipc_send_client_event(instance, client, "ring_id_changed",
+			    ",\"ring_id\":{\"node_id\":%"PRIu32",\"seq\":%"PRIu64"}",
+			    msg->ring_id.node_id, msg->ring_id.seq);
+		}
 		memcpy(&client->last_ring_id, &msg->ring_id, sizeof(struct tlv_ring_id));
+		client->last_membership_node_list_version = msg->node_list_version;
 		client->last_membership_heuristics = msg->heuristics;
+		if (client->last_heuristics != msg->heuristics) {
+			qnetd_ipc_send_client_event(instance, client, "heuristics_changed",
+			    ",\"heuristics\":\"%s\"", tlv_heuristics_to_str(msg->heuristics));
+		}
 		client->last_heuristics = msg->heuristics;
 		break;
 	case TLV_NODE_LIST_TYPE_QUORUM:
 		case_processed = 1;
 		node_list_free(&client->last_quorum_node_list);
-		if (node_list_clone(&client->last_quorum_node_list, &msg->nodes) == -1) {
+		if (node_list_clone(&client->last_quorum_node_list, nodes) == -1) {
 			log(LOG_ERR, "Can't alloc quorum node list clone. "
 			    "Disconnecting client connection.");
 
 			return (-1);
 		}
+		client->last_quorum_node_list_version = msg->node_list_version;
 		break;
 	/*
 	 * Default is not defined intentionally. Compiler shows warning when new
@@ -872,7 +980,8 @@ qnetd_client_msg_received_node_list(struct qnetd_instance *instance, struct qnet
 	}
 
 	if (msg_create_node_list_reply(&send_buffer->buffer, msg->seq_number, msg->node_list_type,
-	    &client->last_ring_id, result_vote) == 0) {
+	    &client->last_ring_id, result_vote,
+	    msg->node_list_version_set, msg->node_list_version) == 0) {
 		log(LOG_ERR, "Can't alloc node list reply msg. "
 		    "Disconnecting client connection.");
 
@@ -883,9 +992,93 @@ qnetd_client_msg_received_node_list(struct qnetd_instance *instance, struct qnet
 
 	send_buffer_list_put(&client->send_buffer_list, send_buffer);
 
+	flight_recorder_record_msg_info(FLIGHT_RECORDER_EVENT_TYPE_MSG_SENT, client->cluster_name,
+	    client->node_id, MSG_TYPE_NODE_LIST_REPLY, 1, msg->seq_number, 1, result_vote);
+
 	return (0);
 }
 
+static int
+qnetd_client_msg_received_node_list(struct qnetd_instance *instance, struct qnetd_client *client,
+    const struct msg_decoded *msg)
+{
+	int res;
+	struct node_list delta_nodes;
+
+	if ((res = qnetd_client_msg_received_check_tls(instance, client, msg)) != 0) {
+		return (res == -1 ? -1 : 0);
+	}
+
+	if (!client->init_received) {
+		log(LOG_ERR, "Received node list message before init message. "
+		    "Sending error reply.");
+
+		if (qnetd_client_send_err(client, msg->seq_number_set, msg->seq_number,
+		    TLV_REPLY_ERROR_CODE_INIT_REQUIRED) != 0) {
+			return (-1);
+		}
+
+		return (0);
+	}
+
+	if (!msg->node_list_type_set) {
+		log(LOG_ERR, "Received node list message without node list type set. "
+		    "Sending error reply.");
+
+		if (qnetd_client_send_err(client, msg->seq_number_set, msg->seq_number,
+		    TLV_REPLY_ERROR_CODE_DOESNT_CONTAIN_REQUIRED_OPTION) != 0) {
+			return (-1);
+		}
+
+		return (0);
+	}
+
+	if (!msg->seq_number_set) {
+		log(LOG_ERR, "Received node list message without seq number set. "
+		    "Sending error reply.");
+
+		if (qnetd_client_send_err(client, msg->seq_number_set, msg->seq_number,
+		    TLV_REPLY_ERROR_CODE_DOESNT_CONTAIN_REQUIRED_OPTION) != 0) {
+			return (-1);
+		}
+
+		return (0);
+	}
+
+	if (!msg->node_list_base_version_set) {
+		return (qnetd_client_msg_received_node_list_process(instance, client, msg,
+		    &msg->nodes));
+	}
+
+	if (!msg->node_list_version_set) {
+		log(LOG_ERR, "Received delta node list message without node list version set. "
+		    "Sending error reply.");
+
+		if (qnetd_client_send_err(client, msg->seq_number_set, msg->seq_number,
+		    TLV_REPLY_ERROR_CODE_DOESNT_CONTAIN_REQUIRED_OPTION) != 0) {
+			return (-1);
+		}
+
+		return (0);
+	}
+
+	res = qnetd_client_msg_received_node_list_apply_delta(client, msg, &delta_nodes);
+	if (res == -1) {
+		log(LOG_ERR, "Can't alloc node list for applying delta. "
+		    "Disconnecting client connection.");
+
+		return (-1);
+	} else if (res == 1) {
+		return (qnetd_client_msg_received_node_list_send_version_mismatch(client, msg));
+	}
+
+	res = qnetd_client_msg_received_node_list_process(instance, client, msg, &delta_nodes);
+
+	node_list_free(&delta_nodes);
+
+	return (res);
+}
+
 static int
 qnetd_client_msg_received_node_list_reply(struct qnetd_instance *instance,
     struct qnetd_client *client, const struct msg_decoded *msg)
@@ -980,6 +1173,9 @@ qnetd_client_msg_received_ask_for_vote(struct qnetd_instance *instance, struct q
 
 	send_buffer_list_put(&client->send_buffer_list, send_buffer);
 
+	flight_recorder_record_msg_info(FLIGHT_RECORDER_EVENT_TYPE_MSG_SENT, client->cluster_name,
+	    client->node_id, MSG_TYPE_ASK_FOR_VOTE_REPLY, 1, msg->seq_number, 1, result_vote);
+
 	return (0);
 }
 
@@ -1121,6 +1317,10 @@ qnetd_client_msg_received_heuristics_change(struct qnetd_instance *instance, str
 		client->last_sent_ack_nack_vote = result_vote;
 	}
 	client->last_regular_heuristics = msg->heuristics;
+	if (client->last_heuristics != msg->heuristics) {
+		qnetd_ipc_send_client_event(instance, client, "heuristics_changed",
+		    ",\"heuristics\":\"%s\"", tlv_heuristics_to_str(msg->heuristics));
+	}
 	client->last_heuristics = msg->heuristics;
 
 	send_buffer = send_buffer_list_get_new(&client->send_buffer_list);
@@ -1143,6 +1343,9 @@ qnetd_client_msg_received_heuristics_change(struct qnetd_instance *instance, str
 
 	send_buffer_list_put(&client->send_buffer_list, send_buffer);
 
+	flight_recorder_record_msg_info(FLIGHT_RECORDER_EVENT_TYPE_MSG_SENT, client->cluster_name,
+	    client->node_id, MSG_TYPE_HEURISTICS_CHANGE_REPLY, 1, msg->seq_number, 1, result_vote);
+
 	return (0);
 }
 
@@ -1182,6 +1385,9 @@ qnetd_client_msg_received(struct qnetd_instance *instance, struct qnetd_client *
 		return (0);
 	}
 
+	flight_recorder_record_msg(FLIGHT_RECORDER_EVENT_TYPE_MSG_RECEIVED, client->cluster_name,
+	    client->node_id, &msg);
+
 	ret_val = 0;
 
 	msg_processed = 0;
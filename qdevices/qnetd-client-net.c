@@ -42,6 +42,7 @@
 #include "qnetd-client-net.h"
 #include "qnetd-client-send.h"
 #include "qnetd-client-msg-received.h"
+#include "qnetd-ipc.h"
 
 #define CLIENT_ADDR_STR_LEN_COLON_PORT	(1 + 5 + 1)
 #define CLIENT_ADDR_STR_LEN		(INET6_ADDRSTRLEN + CLIENT_ADDR_STR_LEN_COLON_PORT)
@@ -132,6 +133,39 @@ qnetd_client_net_socket_poll_loop_err_cb(PRFileDesc *prfd, short revents,
 	return (0);
 }
 
+/*
+ * Send vote_sent IPC event if message written to the client carries ACK or NACK vote.
+ * Message is decoded only when there is an event subscriber.
+ */
+static void
+qnetd_client_net_send_vote_event(struct qnetd_instance *instance,
+    const struct qnetd_client *client, const struct dynar *msg_buffer)
+{
+	struct msg_decoded msg;
+	enum msg_type msg_type;
+
+	if (!unix_socket_ipc_has_subscribers(&instance->local_ipc)) {
+		return ;
+	}
+
+	msg_type = msg_get_type(msg_buffer);
+	if (msg_type != MSG_TYPE_NODE_LIST_REPLY && msg_type != MSG_TYPE_ASK_FOR_VOTE_REPLY &&
+	    msg_type != MSG_TYPE_VOTE_INFO && msg_type != MSG_TYPE_HEURISTICS_CHANGE_REPLY) {
+		return ;
+	}
+
+	msg_decoded_init(&msg);
+
+	if (msg_decode(msg_buffer, &msg) != 0) {
+		log(LOG_ERR, "Can't decode sent message for IPC event");
+	} else if (msg.vote_set && (msg.vote == TLV_VOTE_ACK || msg.vote == TLV_VOTE_NACK)) {
+		qnetd_ipc_send_client_event(instance, client, "vote_sent",
+		    ",\"vote\":\"%s\"", tlv_vote_to_str(msg.vote));
+	}
+
+	msg_decoded_destroy(&msg);
+}
+
 int
 qnetd_client_net_write(struct qnetd_instance *instance, struct qnetd_client *client)
 {
@@ -149,6 +183,8 @@ qnetd_client_net_write(struct qnetd_instance *instance, struct qnetd_client *cli
 	    &send_buffer->msg_already_sent_bytes);
 
 	if (res == 1) {
+		qnetd_client_net_send_vote_event(instance, client, &send_buffer->buffer);
+
 		send_buffer_list_delete(&client->send_buffer_list, send_buffer);
 
 		if (qnetd_client_net_write_finished(instance, client) == -1) {
@@ -204,25 +240,28 @@ qnetd_client_net_read(struct qnetd_instance *instance, struct qnetd_client *clie
 		ret_val = -1;
 		break;
 	case -2:
-		log_nss(LOG_ERR, "Unhandled error when reading from client. "
-		    "Disconnecting client");
+		qnetd_client_log_ratelimit_nss(client, LOG_ERR,
+		    "Unhandled error when reading from client. Disconnecting client");
 		ret_val = -1;
 		break;
 	case -3:
-		log(LOG_ERR, "Can't store message header from client. Disconnecting client");
+		qnetd_client_log_ratelimit(client, LOG_ERR,
+		    "Can't store message header from client. Disconnecting client");
 		ret_val = -1;
 		break;
 	case -4:
-		log(LOG_ERR, "Can't store message from client. Skipping message");
+		qnetd_client_log_ratelimit(client, LOG_ERR,
+		    "Can't store message from client. Skipping message");
 		client->skipping_msg_reason = TLV_REPLY_ERROR_CODE_ERROR_DECODING_MSG;
 		break;
 	case -5:
-		log(LOG_WARNING, "Client sent unsupported msg type %u. Skipping message",
-			    msg_get_type(&client->receive_buffer));
+		qnetd_client_log_ratelimit(client, LOG_WARNING,
+		    "Client sent unsupported msg type %u. Skipping message",
+		    msg_get_type(&client->receive_buffer));
 		client->skipping_msg_reason = TLV_REPLY_ERROR_CODE_UNSUPPORTED_MESSAGE;
 		break;
 	case -6:
-		log(LOG_WARNING,
+		qnetd_client_log_ratelimit(client, LOG_WARNING,
 		    "Client wants to send too long message %u bytes. Skipping message",
 		    msg_get_len(&client->receive_buffer));
 		client->skipping_msg_reason = TLV_REPLY_ERROR_CODE_MESSAGE_TOO_LONG;
@@ -279,9 +318,13 @@ qnetd_client_net_accept(struct qnetd_instance *instance)
 		goto exit_close;
 	}
 
+	/*
+	 * Checked before client address is formatted so rejecting is cheap. Log is limited
+	 * only by call site because peer address is not known yet.
+	 */
 	if (instance->max_clients != 0 &&
 	    qnetd_client_list_no_clients(&instance->clients) >= instance->max_clients) {
-		log(LOG_ERR, "Maximum clients reached. Not accepting connection");
+		log_ratelimit(NULL, 0, LOG_ERR, "Maximum clients reached. Not accepting connection");
 		goto exit_close;
 	}
 
@@ -36,6 +36,7 @@
 
 #include <string.h>
 
+#include "flight-recorder.h"
 #include "log.h"
 #include "qnetd-client-send.h"
 #include "qnetd-log-debug.h"
@@ -103,5 +104,8 @@ qnetd_client_send_vote_info(struct qnetd_client *client, uint32_t msg_seq_number
 
 	send_buffer_list_put(&client->send_buffer_list, send_buffer);
 
+	flight_recorder_record_msg_info(FLIGHT_RECORDER_EVENT_TYPE_MSG_SENT, client->cluster_name,
+	    client->node_id, MSG_TYPE_VOTE_INFO, 1, msg_seq_number, 1, vote);
+
 	return (0);
 }
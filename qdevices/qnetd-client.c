@@ -74,3 +74,38 @@ qnetd_client_destroy(struct qnetd_client *client)
 	send_buffer_list_free(&client->send_buffer_list);
 	dynar_destroy(&client->receive_buffer);
 }
+
+const char *
+qnetd_client_log_key(const struct qnetd_client *client)
+{
+
+	if (client->cluster_name != NULL) {
+		return (client->cluster_name);
+	}
+
+	return (client->addr_str);
+}
+
+/*
+ * Port is not part of the key, so every new connection from same host shares limit
+ */
+size_t
+qnetd_client_log_key_len(const struct qnetd_client *client)
+{
+	const char *port_sep;
+
+	if (client->cluster_name != NULL) {
+		return (client->cluster_name_len);
+	}
+
+	if (client->addr_str == NULL) {
+		return (0);
+	}
+
+	port_sep = strrchr(client->addr_str, ':');
+	if (port_sep == NULL) {
+		return (strlen(client->addr_str));
+	}
+
+	return (port_sep - client->addr_str);
+}
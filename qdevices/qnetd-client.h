@@ -42,6 +42,7 @@
 
 #include <nspr.h>
 #include "dynar.h"
+#include "log-ratelimit.h"
 #include "tlv.h"
 #include "send-buffer-list.h"
 #include "node-list.h"
@@ -76,6 +77,10 @@ struct qnetd_client {
 	uint64_t config_version;
 	struct node_list last_membership_node_list;
 	struct node_list last_quorum_node_list;
+	/* Versions of node lists sent by client supporting delta node lists, 0 - unknown */
+	uint32_t configuration_node_list_version;
+	uint32_t last_membership_node_list_version;
+	uint32_t last_quorum_node_list_version;
 	struct tlv_ring_id last_ring_id;
 	struct qnetd_cluster *cluster;
 	struct qnetd_cluster_list *cluster_list;
@@ -90,6 +95,7 @@ struct qnetd_client {
 	enum tlv_heuristics last_regular_heuristics; /* Passed in heuristics change callback */
 	enum tlv_heuristics last_heuristics; /* Latest heuristics both membership and regular */
 	enum tlv_keep_active_partition_tie_breaker keep_active_partition_tie_breaker;
+	uint8_t batch_algorithm_evaluation;
 	TAILQ_ENTRY(qnetd_client) entries;
 	TAILQ_ENTRY(qnetd_client) cluster_entries;
 };
@@ -100,6 +106,21 @@ extern void		qnetd_client_init(struct qnetd_client *client, PRFileDesc *sock,
 
 extern void		qnetd_client_destroy(struct qnetd_client *client);
 
+extern const char	*qnetd_client_log_key(const struct qnetd_client *client);
+
+extern size_t		qnetd_client_log_key_len(const struct qnetd_client *client);
+
+/*
+ * Rate limited log keyed by cluster name (or client address when cluster is not yet known)
+ */
+#define qnetd_client_log_ratelimit(client, priority, ...) \
+    log_ratelimit(qnetd_client_log_key(client), qnetd_client_log_key_len(client), \
+    priority, __VA_ARGS__)
+
+#define qnetd_client_log_ratelimit_nss(client, priority, str) \
+    log_ratelimit_nss(qnetd_client_log_key(client), qnetd_client_log_key_len(client), \
+    priority, str)
+
 #ifdef __cplusplus
 }
 #endif
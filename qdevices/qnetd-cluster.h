@@ -51,6 +51,7 @@ struct qnetd_cluster {
 	char *cluster_name;
 	size_t cluster_name_len;
 	void *algorithm_data;
+	int algorithm_evaluation_scheduled;
 	struct qnetd_client_list client_list;
 	TAILQ_ENTRY(qnetd_cluster) entries;
 };
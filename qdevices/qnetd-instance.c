@@ -35,9 +35,12 @@
 #include <sys/types.h>
 
 #include <pk11func.h>
+#include "flight-recorder.h"
 #include "log.h"
+#include "log-ratelimit.h"
 #include "qnetd-instance.h"
 #include "qnetd-client.h"
+#include "qnetd-ipc.h"
 #include "qnetd-client-dpd-timer.h"
 #include "qnetd-algorithm.h"
 #include "qnetd-log-debug.h"
@@ -49,6 +52,12 @@ qnetd_instance_poll_loop_pre_poll_cb(void *user_data1, void *user_data2)
 	struct qnetd_instance *instance = (struct qnetd_instance *)user_data1;
 	struct qnetd_client *client;
 	struct qnetd_client *client_next;
+	struct qnetd_cluster *cluster;
+
+	/*
+	 * Report messages suppressed by rate limiting
+	 */
+	log_ratelimit_flush(0);
 
 	/*
 	 * This functionality used to be per client fd in
@@ -79,6 +88,20 @@ qnetd_instance_poll_loop_pre_poll_cb(void *user_data1, void *user_data2)
 		client = client_next;
 	}
 
+	/*
+	 * Run algorithm evaluation deferred during previous iteration
+	 * (batch_algorithm_evaluation advanced setting). All node lists received in
+	 * the iteration are coalesced into one evaluation. Clients which failed to
+	 * receive vote are disconnected in the next iteration.
+	 */
+	TAILQ_FOREACH(cluster, &instance->clusters, entries) {
+		if (cluster->algorithm_evaluation_scheduled) {
+			cluster->algorithm_evaluation_scheduled = 0;
+
+			qnetd_algorithm_cluster_evaluation(cluster);
+		}
+	}
+
 	return (0);
 }
 
@@ -102,6 +125,9 @@ qnetd_instance_init(struct qnetd_instance *instance,
 
 	pr_poll_loop_init(&instance->main_poll_loop);
 
+	qnetd_state_snapshot_init(&instance->state_snapshot);
+	qnetd_state_snapshot_save_cache_init(&instance->state_snapshot_save_cache);
+
 	if (pr_poll_loop_add_pre_poll_cb(&instance->main_poll_loop,
 	    qnetd_instance_poll_loop_pre_poll_cb,
 	    instance, NULL) == -1) {
@@ -131,6 +157,9 @@ qnetd_instance_destroy(struct qnetd_instance *instance)
 	qnetd_cluster_list_free(&instance->clusters);
 	qnetd_client_list_free(&instance->clients);
 
+	qnetd_state_snapshot_destroy(&instance->state_snapshot);
+	qnetd_state_snapshot_save_cache_destroy(&instance->state_snapshot_save_cache);
+
 	if (pr_poll_loop_del_pre_poll_cb(&instance->main_poll_loop,
 	    qnetd_instance_poll_loop_pre_poll_cb) == -1) {
 		log(LOG_WARNING, "Can't delete instance pre poll loop cb");
@@ -148,20 +177,107 @@ qnetd_instance_client_disconnect(struct qnetd_instance *instance, struct qnetd_c
 
 	qnetd_log_debug_client_disconnect(client, server_going_down);
 
+	flight_recorder_record_event(FLIGHT_RECORDER_EVENT_TYPE_DISCONNECTED,
+	    client->cluster_name, client->node_id);
+
 	if (client->init_received) {
 		qnetd_algorithm_client_disconnect(client, server_going_down);
+
+		qnetd_ipc_send_client_event(instance, client, "client_disconnected",
+		    ",\"server_going_down\":%s", (server_going_down ? "true" : "false"));
 	}
 
 	qnetd_client_dpd_timer_destroy(instance, client);
 
 	PR_Close(client->socket);
 	if (client->cluster != NULL) {
+		qnetd_ipc_client_removed(instance, client);
 		qnetd_cluster_list_del_client(&instance->clusters, client->cluster, client);
 	}
 	qnetd_client_algo_timer_abort(client);
 	qnetd_client_list_del(&instance->clients, client);
 }
 
+static int
+qnetd_instance_state_snapshot_timer_cb(void *data1, void *data2)
+{
+	struct qnetd_instance *instance = (struct qnetd_instance *)data1;
+
+	(void)qnetd_state_snapshot_expire(&instance->state_snapshot, time(NULL));
+
+	/*
+	 * Write (and fsync) only changed state. Unchanged one is refreshed often enough
+	 * to stay within max age of reader.
+	 */
+	if (qnetd_state_snapshot_save_if_changed(&instance->clients,
+	    instance->advanced_settings->state_file, &instance->state_snapshot_save_cache,
+	    instance->advanced_settings->state_file_max_age / 2) == -1) {
+		log_err(LOG_WARNING, "Can't save state snapshot");
+	}
+
+	/*
+	 * Schedule this function again
+	 */
+	return (-1);
+}
+
+/*
+ * Load state snapshot (if state_file is set) and schedule its periodic save.
+ * Failure to load snapshot is not fatal, qnetd just starts without history.
+ */
+int
+qnetd_instance_state_snapshot_init(struct qnetd_instance *instance)
+{
+	const struct qnetd_advanced_settings *settings;
+
+	settings = instance->advanced_settings;
+
+	if (settings->state_file[0] == '\0') {
+		return (0);
+	}
+
+	if (qnetd_state_snapshot_load(&instance->state_snapshot, settings->state_file,
+	    settings->state_file_max_age, settings->state_file_restore_grace) != 0) {
+		log(LOG_WARNING, "Can't load state snapshot %s. Starting without it",
+		    settings->state_file);
+	} else if (instance->state_snapshot.no_entries > 0) {
+		log(LOG_INFO, "Loaded state of %zu clients from state snapshot",
+		    instance->state_snapshot.no_entries);
+	}
+
+	if (settings->state_file_save_interval > 0) {
+		instance->state_snapshot_timer = timer_list_add(
+		    pr_poll_loop_get_timer_list(&instance->main_poll_loop),
+		    settings->state_file_save_interval,
+		    qnetd_instance_state_snapshot_timer_cb, (void *)instance, NULL);
+		if (instance->state_snapshot_timer == NULL) {
+			log(LOG_ERR, "Can't initialize state snapshot timer");
+
+			return (-1);
+		}
+	}
+
+	return (0);
+}
+
+int
+qnetd_instance_state_snapshot_save(struct qnetd_instance *instance)
+{
+
+	if (instance->advanced_settings->state_file[0] == '\0') {
+		return (0);
+	}
+
+	if (qnetd_state_snapshot_save(&instance->clients,
+	    instance->advanced_settings->state_file) != 0) {
+		log_err(LOG_WARNING, "Can't save state snapshot");
+
+		return (-1);
+	}
+
+	return (0);
+}
+
 int
 qnetd_instance_init_certs(struct qnetd_instance *instance)
 {
@@ -48,6 +48,7 @@
 #include "unix-socket-ipc.h"
 #include "qnetd-advanced-settings.h"
 #include "pr-poll-loop.h"
+#include "qnetd-state-snapshot.h"
 #include "timer-list.h"
 
 #ifdef __cplusplus
@@ -70,6 +71,9 @@ struct qnetd_instance {
 	struct unix_socket_ipc local_ipc;
 	const struct qnetd_advanced_settings *advanced_settings;
 	struct pr_poll_loop main_poll_loop;
+	struct qnetd_state_snapshot state_snapshot;
+	struct qnetd_state_snapshot_save_cache state_snapshot_save_cache;
+	struct timer_list_entry *state_snapshot_timer;
 };
 
 extern int		qnetd_instance_init(struct qnetd_instance *instance,
@@ -78,6 +82,10 @@ extern int		qnetd_instance_init(struct qnetd_instance *instance,
 
 extern int		qnetd_instance_destroy(struct qnetd_instance *instance);
 
+extern int		qnetd_instance_state_snapshot_init(struct qnetd_instance *instance);
+
+extern int		qnetd_instance_state_snapshot_save(struct qnetd_instance *instance);
+
 extern void		qnetd_instance_client_disconnect(struct qnetd_instance *instance,
     struct qnetd_client *client, int server_going_down);
 
@@ -37,10 +37,64 @@
 #include "qnetd-ipc-cmd.h"
 #include "utils.h"
 
+static int
+qnetd_ipc_cmd_status_json(struct qnetd_instance *instance, struct dynar *outbuf, int verbose)
+{
+
+	if (dynar_str_cat(outbuf, "{\"qnetd_address\":") != 0 ||
+	    dynar_str_json_quote_cat(outbuf,
+	    (instance->host_addr != NULL ? instance->host_addr : "*")) != 0) {
+		return (-1);
+	}
+
+	if (dynar_str_catf(outbuf, ",\"qnetd_port\":%"PRIu16, instance->host_port) == -1) {
+		return (-1);
+	}
+
+	if (dynar_str_catf(outbuf, ",\"tls\":\"%s\",\"tls_client_certificate_required\":%s",
+	    tlv_tls_supported_to_str(instance->tls_supported),
+	    ((instance->tls_supported != TLV_TLS_UNSUPPORTED && instance->tls_client_cert_required) ?
+	    "true" : "false")) == -1) {
+		return (-1);
+	}
+
+	if (dynar_str_catf(outbuf, ",\"connected_clients\":%zu,\"connected_clusters\":%zu",
+	    qnetd_client_list_no_clients(&instance->clients),
+	    qnetd_cluster_list_size(&instance->clusters)) == -1) {
+		return (-1);
+	}
+
+	if (verbose) {
+		if (instance->max_clients != 0) {
+			if (dynar_str_catf(outbuf, ",\"max_clients\":%zu",
+			    instance->max_clients) == -1) {
+				return (-1);
+			}
+		}
+
+		if (dynar_str_catf(outbuf, ",\"max_send_size\":%zu,\"max_receive_size\":%zu",
+		    instance->advanced_settings->max_client_send_size,
+		    instance->advanced_settings->max_client_receive_size) == -1) {
+			return (-1);
+		}
+	}
+
+	if (dynar_str_cat(outbuf, "}\n") != 0) {
+		return (-1);
+	}
+
+	return (0);
+}
+
 int
-qnetd_ipc_cmd_status(struct qnetd_instance *instance, struct dynar *outbuf, int verbose)
+qnetd_ipc_cmd_status(struct qnetd_instance *instance, struct dynar *outbuf, int verbose,
+    int json)
 {
 
+	if (json) {
+		return (qnetd_ipc_cmd_status_json(instance, outbuf, verbose));
+	}
+
 	if (dynar_str_catf(outbuf, "QNetd address:\t\t\t%s:%"PRIu16"\n",
 	    (instance->host_addr != NULL ? instance->host_addr : "*"), instance->host_port) == -1) {
 		return (-1);
@@ -258,6 +312,153 @@ qnetd_ipc_cmd_list_add_client_info(const struct qnetd_client *client, struct dyn
 	return (0);
 }
 
+static int
+qnetd_ipc_cmd_add_tie_breaker_json(const struct qnetd_client *client, struct dynar *outbuf)
+{
+	int res;
+
+	res = 0;
+
+	switch (client->tie_breaker.mode) {
+	case TLV_TIE_BREAKER_MODE_LOWEST:
+		res = dynar_str_catf(outbuf, ",\"tie_breaker\":{\"mode\":\"lowest\"}");
+		break;
+	case TLV_TIE_BREAKER_MODE_HIGHEST:
+		res = dynar_str_catf(outbuf, ",\"tie_breaker\":{\"mode\":\"highest\"}");
+		break;
+	case TLV_TIE_BREAKER_MODE_NODE_ID:
+		res = dynar_str_catf(outbuf, ",\"tie_breaker\":{\"mode\":\"node_id\","
+		    "\"node_id\":%"PRIu32"}", client->tie_breaker.node_id);
+		break;
+	}
+
+	return (res == -1 ? -1 : 0);
+}
+
+static int
+qnetd_ipc_cmd_list_add_node_list_json(struct dynar *outbuf, const char *key,
+    const struct node_list *nlist)
+{
+	struct node_list_entry *node_info;
+	int i;
+
+	if (dynar_str_catf(outbuf, ",\"%s\":[", key) == -1) {
+		return (-1);
+	}
+
+	i = 0;
+
+	TAILQ_FOREACH(node_info, nlist, entries) {
+		if (dynar_str_catf(outbuf, "%s{\"node_id\":%"PRIu32, (i != 0 ? "," : ""),
+		    node_info->node_id) == -1) {
+			return (-1);
+		}
+
+		if (node_info->data_center_id != 0) {
+			if (dynar_str_catf(outbuf, ",\"data_center_id\":%"PRIu32,
+			    node_info->data_center_id) == -1) {
+				return (-1);
+			}
+		}
+
+		if (dynar_str_cat(outbuf, "}") != 0) {
+			return (-1);
+		}
+
+		i++;
+	}
+
+	return (dynar_str_cat(outbuf, "]"));
+}
+
+static int
+qnetd_ipc_cmd_list_add_client_info_json(const struct qnetd_client *client, struct dynar *outbuf,
+    int verbose)
+{
+
+	if (dynar_str_catf(outbuf, "{\"node_id\":%"PRIu32",\"address\":", client->node_id) == -1 ||
+	    dynar_str_json_quote_cat(outbuf, client->addr_str) != 0) {
+		return (-1);
+	}
+
+	if (verbose) {
+		if (dynar_str_catf(outbuf, ",\"hb_interval\":%"PRIu32,
+		    client->heartbeat_interval) == -1) {
+			return (-1);
+		}
+	}
+
+	if (client->config_version_set) {
+		if (dynar_str_catf(outbuf, ",\"config_version\":%"PRIu64,
+		    client->config_version) == -1) {
+			return (-1);
+		}
+	}
+
+	if (!node_list_is_empty(&client->configuration_node_list)) {
+		if (qnetd_ipc_cmd_list_add_node_list_json(outbuf, "configured_node_list",
+		    &client->configuration_node_list) != 0) {
+			return (-1);
+		}
+	}
+
+	if (verbose) {
+		if (dynar_str_catf(outbuf, ",\"ring_id\":{\"node_id\":%"PRIu32",\"seq\":%"PRIu64"}",
+		    client->last_ring_id.node_id, client->last_ring_id.seq) == -1) {
+			return (-1);
+		}
+	}
+
+	if (!node_list_is_empty(&client->last_membership_node_list)) {
+		if (qnetd_ipc_cmd_list_add_node_list_json(outbuf, "membership_node_list",
+		    &client->last_membership_node_list) != 0) {
+			return (-1);
+		}
+	}
+
+	if (client->last_heuristics != TLV_HEURISTICS_UNDEFINED || verbose) {
+		if (dynar_str_catf(outbuf, ",\"heuristics\":\"%s\"",
+		    tlv_heuristics_to_str(client->last_heuristics)) == -1) {
+			return (-1);
+		}
+
+		if (verbose) {
+			if (dynar_str_catf(outbuf, ",\"membership_heuristics\":\"%s\","
+			    "\"regular_heuristics\":\"%s\"",
+			    tlv_heuristics_to_str(client->last_membership_heuristics),
+			    tlv_heuristics_to_str(client->last_regular_heuristics)) == -1) {
+				return (-1);
+			}
+		}
+	}
+
+	if (verbose) {
+		if (dynar_str_catf(outbuf, ",\"tls_active\":%s,"
+		    "\"client_certificate_verified\":%s",
+		    (client->tls_started ? "true" : "false"),
+		    (client->tls_started && client->tls_peer_certificate_verified ?
+		    "true" : "false")) == -1) {
+			return (-1);
+		}
+	}
+
+	if (client->last_sent_vote != TLV_VOTE_UNDEFINED) {
+		if (dynar_str_catf(outbuf, ",\"vote\":\"%s\"",
+		    tlv_vote_to_str(client->last_sent_vote)) == -1) {
+			return (-1);
+		}
+
+		if (client->last_sent_ack_nack_vote != TLV_VOTE_UNDEFINED) {
+			if (dynar_str_catf(outbuf, ",\"last_ack_nack_vote\":\"%s\"",
+			    tlv_vote_to_str(client->last_sent_ack_nack_vote)) == -1) {
+				return (-1);
+			}
+		}
+	}
+
+	return (dynar_str_cat(outbuf, "}"));
+}
+
 static
 int qnetd_ipc_cmd_keep_active_partition_tie_breaker_active(const struct qnetd_cluster *cluster)
 {
@@ -279,52 +480,284 @@ int qnetd_ipc_cmd_keep_active_partition_tie_breaker_active(const struct qnetd_cl
 }
 
 int
-qnetd_ipc_cmd_list(struct qnetd_instance *instance, struct dynar *outbuf, int verbose,
-    const char *cluster_name)
+qnetd_ipc_cmd_list_cursor_init(struct qnetd_ipc_cmd_list_cursor *cursor,
+    struct qnetd_instance *instance, int verbose, int json, const char *cluster_name,
+    int node_id_set, uint32_t node_id)
+{
+
+	memset(cursor, 0, sizeof(*cursor));
+
+	if (cluster_name != NULL && strcmp(cluster_name, "") != 0) {
+		if ((cursor->cluster_name = strdup(cluster_name)) == NULL) {
+			return (-1);
+		}
+
+		cursor->cluster = qnetd_cluster_list_find_by_name(&instance->clusters,
+		    cluster_name, strlen(cluster_name));
+	} else {
+		cursor->cluster = TAILQ_FIRST(&instance->clusters);
+	}
+
+	cursor->verbose = verbose;
+	cursor->json = json;
+	cursor->node_id_set = node_id_set;
+	cursor->node_id = node_id;
+	cursor->client = NULL;
+	cursor->cluster_header_sent = 0;
+	cursor->in_progress = 1;
+
+	return (0);
+}
+
+void
+qnetd_ipc_cmd_list_cursor_destroy(struct qnetd_ipc_cmd_list_cursor *cursor)
+{
+
+	free(cursor->cluster_name);
+	memset(cursor, 0, sizeof(*cursor));
+}
+
+int
+qnetd_ipc_cmd_list_cursor_is_finished(const struct qnetd_ipc_cmd_list_cursor *cursor)
+{
+
+	return (cursor->cluster == NULL && (!cursor->json || cursor->json_footer_sent));
+}
+
+static void
+qnetd_ipc_cmd_list_cursor_next_cluster(struct qnetd_ipc_cmd_list_cursor *cursor)
+{
+
+	if (cursor->cluster_name != NULL) {
+		/*
+		 * Only one cluster can match
+		 */
+		cursor->cluster = NULL;
+	} else {
+		cursor->cluster = TAILQ_NEXT(cursor->cluster, entries);
+	}
+
+	cursor->client = NULL;
+	cursor->cluster_header_sent = 0;
+}
+
+/*
+ * Must be called before client is removed from the cluster client list so cursor never
+ * points to freed client or cluster
+ */
+void
+qnetd_ipc_cmd_list_cursor_client_removed(struct qnetd_ipc_cmd_list_cursor *cursor,
+    const struct qnetd_client *client)
+{
+	struct qnetd_client *client_next;
+
+	if (!cursor->in_progress || cursor->cluster == NULL ||
+	    cursor->cluster != client->cluster) {
+		return ;
+	}
+
+	client_next = TAILQ_NEXT(client, cluster_entries);
+
+	if (cursor->client == client) {
+		cursor->client = client_next;
+
+		if (client_next == NULL) {
+			qnetd_ipc_cmd_list_cursor_next_cluster(cursor);
+		}
+	} else if (cursor->client == NULL &&
+	    TAILQ_FIRST(&cursor->cluster->client_list) == client && client_next == NULL) {
+		/*
+		 * Last client of not yet listed cluster -> cluster is going to be freed
+		 */
+		qnetd_ipc_cmd_list_cursor_next_cluster(cursor);
+	}
+}
+
+static int
+qnetd_ipc_cmd_list_add_cluster_header_json(const struct qnetd_cluster *cluster,
+    struct dynar *outbuf)
+{
+	const struct qnetd_client *client;
+
+	client = TAILQ_FIRST(&cluster->client_list);
+
+	if (dynar_str_cat(outbuf, "{\"name\":") != 0 ||
+	    dynar_str_json_quote_cat(outbuf, cluster->cluster_name) != 0) {
+		return (-1);
+	}
+
+	if (dynar_str_catf(outbuf, ",\"algorithm\":\"%s\",\"kap_tie_breaker\":%s",
+	    tlv_decision_algorithm_type_to_str(client->decision_algorithm),
+	    (qnetd_ipc_cmd_keep_active_partition_tie_breaker_active(cluster) ?
+	    "true" : "false")) == -1) {
+		return (-1);
+	}
+
+	if (qnetd_ipc_cmd_add_tie_breaker_json(client, outbuf) != 0) {
+		return (-1);
+	}
+
+	return (dynar_str_cat(outbuf, ",\"clients\":["));
+}
+
+static int
+qnetd_ipc_cmd_list_add_cluster_header(const struct qnetd_cluster *cluster,
+    struct dynar *outbuf)
+{
+	const struct qnetd_client *client;
+	const char *kap_tb_str;		/* Keep active partition tie breaker string */
+
+	if (dynar_str_catf(outbuf, "Cluster \"%s\":\n", cluster->cluster_name) == -1) {
+		return (-1);
+	}
+
+	client = TAILQ_FIRST(&cluster->client_list);
+
+	kap_tb_str = "";
+	if (qnetd_ipc_cmd_keep_active_partition_tie_breaker_active(cluster)) {
+		kap_tb_str = " (KAP Tie-breaker)";
+	}
+
+	if (dynar_str_catf(outbuf, "    Algorithm:\t\t%s%s\n",
+	    tlv_decision_algorithm_type_to_str(client->decision_algorithm),
+	    kap_tb_str) == -1) {
+		return (-1);
+	}
+
+	if (!qnetd_ipc_cmd_add_tie_breaker(client, outbuf)) {
+		return (-1);
+	}
+
+	return (0);
+}
+
+/*
+ * Add client to the list including cluster header when needed
+ */
+static int
+qnetd_ipc_cmd_list_add_client(struct qnetd_ipc_cmd_list_cursor *cursor,
+    const struct qnetd_cluster *cluster, const struct qnetd_client *client,
+    struct dynar *outbuf, size_t client_no)
+{
+
+	if (!cursor->json) {
+		if (!cursor->cluster_header_sent &&
+		    qnetd_ipc_cmd_list_add_cluster_header(cluster, outbuf) != 0) {
+			return (-1);
+		}
+
+		return (qnetd_ipc_cmd_list_add_client_info(client, outbuf, cursor->verbose,
+		    client_no));
+	}
+
+	if (cursor->cluster_header_sent) {
+		if (dynar_str_cat(outbuf, ",") != 0) {
+			return (-1);
+		}
+	} else {
+		if (cursor->json_cluster_open && dynar_str_cat(outbuf, "]}") != 0) {
+			return (-1);
+		}
+
+		if (cursor->no_clusters_listed > 0 && dynar_str_cat(outbuf, ",") != 0) {
+			return (-1);
+		}
+
+		if (qnetd_ipc_cmd_list_add_cluster_header_json(cluster, outbuf) != 0) {
+			return (-1);
+		}
+	}
+
+	return (qnetd_ipc_cmd_list_add_client_info_json(client, outbuf, cursor->verbose));
+}
+
+/*
+ * Add next part of the client list described by cursor to outbuf. Whole clients are added
+ * until outbuf reaches ipc_list_chunk_size or cursor is finished. Clients which doesn't fit
+ * into outbuf (maximum size reached) are left for the next call.
+ *
+ * Returns 0 on success and -1 if not even one client fits into outbuf.
+ */
+int
+qnetd_ipc_cmd_list(struct qnetd_instance *instance, struct dynar *outbuf,
+    struct qnetd_ipc_cmd_list_cursor *cursor)
 {
 	struct qnetd_cluster *cluster;
 	struct qnetd_client *client;
+	size_t chunk_size;
+	size_t saved_size;
 	size_t client_no;
-	const char *kap_tb_str;		/* Keep active partition tie breaker string */
 
-	TAILQ_FOREACH(cluster, &instance->clusters, entries) {
-		if (cluster_name != NULL && strcmp(cluster_name, "") != 0 &&
-		    strcmp(cluster_name, cluster->cluster_name) != 0) {
+	chunk_size = instance->advanced_settings->ipc_list_chunk_size;
+	client_no = 0;
+
+	if (cursor->json && !cursor->json_header_sent) {
+		if (dynar_str_cat(outbuf, "{\"clusters\":[") != 0) {
+			return (-1);
+		}
+
+		cursor->json_header_sent = 1;
+	}
+
+	while (cursor->cluster != NULL) {
+		cluster = cursor->cluster;
+
+		if (cursor->cluster_name != NULL &&
+		    strcmp(cursor->cluster_name, cluster->cluster_name) != 0) {
+			qnetd_ipc_cmd_list_cursor_next_cluster(cursor);
 			continue;
 		}
 
-		if (dynar_str_catf(outbuf, "Cluster \"%s\":\n", cluster->cluster_name) == -1) {
-			return (-1);
+		if (cursor->client == NULL) {
+			cursor->client = TAILQ_FIRST(&cluster->client_list);
 		}
 
-		client_no = 0;
+		while ((client = cursor->client) != NULL) {
+			if (dynar_size(outbuf) >= chunk_size) {
+				return (0);
+			}
+
+			if (cursor->node_id_set && client->node_id != cursor->node_id) {
+				cursor->client = TAILQ_NEXT(client, cluster_entries);
+				continue;
+			}
 
-		TAILQ_FOREACH(client, &cluster->client_list, cluster_entries) {
-			if (client_no == 0) {
-				kap_tb_str = "";
-				if (qnetd_ipc_cmd_keep_active_partition_tie_breaker_active(cluster)) {
-					kap_tb_str = " (KAP Tie-breaker)";
-				}
+			saved_size = dynar_size(outbuf);
 
-				if (dynar_str_catf(outbuf, "    Algorithm:\t\t%s%s\n",
-				    tlv_decision_algorithm_type_to_str(
-				    client->decision_algorithm),
-				    kap_tb_str) == -1) {
-					return (-1);
-				}
+			if (qnetd_ipc_cmd_list_add_client(cursor, cluster, client, outbuf,
+			    client_no) != 0) {
+				/*
+				 * Client doesn't fit -> remove partial output and try next time
+				 */
+				(void)dynar_set_size(outbuf, saved_size);
 
-				if (!qnetd_ipc_cmd_add_tie_breaker(client, outbuf)) {
-					return (-1);
-				}
+				return (client_no == 0 ? -1 : 0);
 			}
 
-			if (qnetd_ipc_cmd_list_add_client_info(client, outbuf, verbose,
-			    client_no) == -1) {
-				return (-1);
+			if (!cursor->cluster_header_sent) {
+				cursor->cluster_header_sent = 1;
+				cursor->json_cluster_open = 1;
+				cursor->no_clusters_listed++;
 			}
 
+			cursor->client = TAILQ_NEXT(client, cluster_entries);
 			client_no++;
-                }
+		}
+
+		qnetd_ipc_cmd_list_cursor_next_cluster(cursor);
+	}
+
+	if (cursor->json && !cursor->json_footer_sent) {
+		saved_size = dynar_size(outbuf);
+
+		if ((cursor->json_cluster_open && dynar_str_cat(outbuf, "]}") != 0) ||
+		    dynar_str_cat(outbuf, "]}\n") != 0) {
+			(void)dynar_set_size(outbuf, saved_size);
+
+			return (client_no == 0 ? -1 : 0);
+		}
+
+		cursor->json_footer_sent = 1;
 	}
 
 	return (0);
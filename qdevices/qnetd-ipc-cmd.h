@@ -43,10 +43,38 @@ extern "C" {
 #endif
 
 extern int	qnetd_ipc_cmd_status(struct qnetd_instance *instance,
-    struct dynar *outbuf, int verbose);
+    struct dynar *outbuf, int verbose, int json);
+
+struct qnetd_ipc_cmd_list_cursor {
+	int in_progress;
+	int verbose;
+	int json;
+	char *cluster_name;
+	int node_id_set;
+	uint32_t node_id;
+	struct qnetd_cluster *cluster;
+	struct qnetd_client *client;
+	int cluster_header_sent;
+	int json_header_sent;
+	int json_footer_sent;
+	int json_cluster_open;
+	size_t no_clusters_listed;
+};
+
+extern int	qnetd_ipc_cmd_list_cursor_init(struct qnetd_ipc_cmd_list_cursor *cursor,
+    struct qnetd_instance *instance, int verbose, int json, const char *cluster_name,
+    int node_id_set, uint32_t node_id);
+
+extern void	qnetd_ipc_cmd_list_cursor_destroy(struct qnetd_ipc_cmd_list_cursor *cursor);
+
+extern int	qnetd_ipc_cmd_list_cursor_is_finished(
+    const struct qnetd_ipc_cmd_list_cursor *cursor);
+
+extern void	qnetd_ipc_cmd_list_cursor_client_removed(
+    struct qnetd_ipc_cmd_list_cursor *cursor, const struct qnetd_client *client);
 
 extern int	qnetd_ipc_cmd_list(struct qnetd_instance *instance,
-    struct dynar *outbuf, int verbose, const char *cluster_name);
+    struct dynar *outbuf, struct qnetd_ipc_cmd_list_cursor *cursor);
 
 #ifdef __cplusplus
 }
@@ -32,6 +32,9 @@
  * THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <time.h>
+
+#include "flight-recorder.h"
 #include "log.h"
 #include "qnet-config.h"
 #include "qnetd-ipc.h"
@@ -39,6 +42,7 @@
 #include "unix-socket-ipc.h"
 #include "dynar-simple-lex.h"
 #include "dynar-str.h"
+#include "utils.h"
 
 /*
  * Callbacks
@@ -166,9 +170,36 @@ ipc_client_socket_poll_loop_err_cb(int fd, short revents, void *user_data1, void
 	return (0);
 }
 
+static void
+qnetd_ipc_user_data_free(struct qnetd_ipc_user_data *ipc_user_data)
+{
+
+	if (ipc_user_data != NULL) {
+		qnetd_ipc_cmd_list_cursor_destroy(&ipc_user_data->list_cursor);
+	}
+
+	free(ipc_user_data);
+}
+
 /*
  * Exported functions
  */
+void
+qnetd_ipc_client_removed(struct qnetd_instance *instance, const struct qnetd_client *client)
+{
+	struct unix_socket_client *ipc_client;
+	struct qnetd_ipc_user_data *ipc_user_data;
+
+	TAILQ_FOREACH(ipc_client, &instance->local_ipc.clients, entries) {
+		ipc_user_data = (struct qnetd_ipc_user_data *)ipc_client->user_data;
+
+		if (ipc_user_data != NULL) {
+			qnetd_ipc_cmd_list_cursor_client_removed(&ipc_user_data->list_cursor,
+			    client);
+		}
+	}
+}
+
 int
 qnetd_ipc_init(struct qnetd_instance *instance)
 {
@@ -230,7 +261,8 @@ qnetd_ipc_destroy(struct qnetd_instance *instance)
 	ipc_client_list = &instance->local_ipc.clients;
 
 	TAILQ_FOREACH(client, ipc_client_list, entries) {
-		free(client->user_data);
+		qnetd_ipc_user_data_free(client->user_data);
+		client->user_data = NULL;
 	}
 
 	res = unix_socket_ipc_destroy(&instance->local_ipc);
@@ -302,7 +334,7 @@ void
 qnetd_ipc_client_disconnect(struct qnetd_instance *instance, struct unix_socket_client *client)
 {
 
-	free(client->user_data);
+	qnetd_ipc_user_data_free(client->user_data);
 	unix_socket_ipc_client_disconnect(&instance->local_ipc, client);
 }
 
@@ -348,6 +380,40 @@ qnetd_ipc_send_buffer(struct qnetd_instance *instance, struct unix_socket_client
 	return (0);
 }
 
+/*
+ * Add next chunk of the client list to the send buffer and start sending it. Cursor is
+ * destroyed when whole list was added.
+ *
+ *  0 - Chunk added
+ *  1 - Nothing more to send
+ * -1 - Error
+ */
+static int
+qnetd_ipc_send_list_chunk(struct qnetd_instance *instance, struct unix_socket_client *client)
+{
+	struct qnetd_ipc_user_data *ipc_user_data;
+	struct qnetd_ipc_cmd_list_cursor *cursor;
+
+	ipc_user_data = (struct qnetd_ipc_user_data *)client->user_data;
+	cursor = &ipc_user_data->list_cursor;
+
+	if (qnetd_ipc_cmd_list(instance, &client->send_buffer, cursor) != 0) {
+		return (-1);
+	}
+
+	if (qnetd_ipc_cmd_list_cursor_is_finished(cursor)) {
+		qnetd_ipc_cmd_list_cursor_destroy(cursor);
+	}
+
+	if (dynar_size(&client->send_buffer) == 0) {
+		return (1);
+	}
+
+	unix_socket_client_write_buffer(client, 1);
+
+	return (0);
+}
+
 static void
 qnetd_ipc_parse_line(struct qnetd_instance *instance, struct unix_socket_client *client)
 {
@@ -356,7 +422,11 @@ qnetd_ipc_parse_line(struct qnetd_instance *instance, struct unix_socket_client
 	char *str;
 	struct qnetd_ipc_user_data *ipc_user_data;
 	int verbose;
+	int json;
 	char *cluster_name;
+	int node_id_set;
+	uint32_t node_id;
+	long long int tmpll;
 
 	ipc_user_data = (struct qnetd_ipc_user_data *)client->user_data;
 
@@ -364,7 +434,10 @@ qnetd_ipc_parse_line(struct qnetd_instance *instance, struct unix_socket_client
 	token = dynar_simple_lex_token_next(&lex);
 
 	verbose = 0;
+	json = 0;
 	cluster_name = NULL;
+	node_id_set = 0;
+	node_id = 0;
 
 	if (token == NULL) {
 		goto exit_err_low_mem;
@@ -385,20 +458,22 @@ qnetd_ipc_parse_line(struct qnetd_instance *instance, struct unix_socket_client
 			client->schedule_disconnect = 1;
 		}
 	} else if (strcasecmp(str, "status") == 0) {
-		token = dynar_simple_lex_token_next(&lex);
-		if (token == NULL) {
-			goto exit_err_low_mem;
-		}
-
-		str = dynar_data(token);
-
-		if (token != NULL && strcmp(str, "") != 0) {
+		while (((token = dynar_simple_lex_token_next(&lex)) != NULL) &&
+		    (str = dynar_data(token), strcmp(str, "") != 0)) {
 			if (strcasecmp(str, "verbose") == 0) {
 				verbose = 1;
+			} else if (strcasecmp(str, "json") == 0) {
+				json = 1;
+			} else {
+				break;
 			}
 		}
 
-		if (qnetd_ipc_cmd_status(instance, &client->send_buffer, verbose) != 0) {
+		if (token == NULL) {
+			goto exit_err_low_mem;
+		}
+
+		if (qnetd_ipc_cmd_status(instance, &client->send_buffer, verbose, json) != 0) {
 			if (qnetd_ipc_send_error(instance, client, "Can't get QNetd status") != 0) {
 				client->schedule_disconnect = 1;
 			}
@@ -412,6 +487,8 @@ qnetd_ipc_parse_line(struct qnetd_instance *instance, struct unix_socket_client
 		    (str = dynar_data(token), strcmp(str, "") != 0)) {
 			if (strcasecmp(str, "verbose") == 0) {
 				verbose = 1;
+			} else if (strcasecmp(str, "json") == 0) {
+				json = 1;
 			} else if (strcasecmp(str, "cluster") == 0) {
 				token = dynar_simple_lex_token_next(&lex);
 				if (token == NULL) {
@@ -422,22 +499,73 @@ qnetd_ipc_parse_line(struct qnetd_instance *instance, struct unix_socket_client
 				if ((cluster_name = strdup(dynar_data(token))) == NULL) {
 					goto exit_err_low_mem;
 				}
+			} else if (strcasecmp(str, "node") == 0) {
+				token = dynar_simple_lex_token_next(&lex);
+				if (token == NULL) {
+					goto exit_err_low_mem;
+				}
+
+				if (utils_strtonum(dynar_data(token), 0, UINT32_MAX, &tmpll) == -1) {
+					free(cluster_name); cluster_name = NULL;
+
+					if (qnetd_ipc_send_error(instance, client,
+					    "Invalid node ID '%s'", dynar_data(token)) != 0) {
+						client->schedule_disconnect = 1;
+					}
+
+					dynar_simple_lex_destroy(&lex);
+
+					return ;
+				}
+
+				node_id_set = 1;
+				node_id = (uint32_t)tmpll;
 			} else {
 				break;
 			}
 		}
 
-		if (qnetd_ipc_cmd_list(instance, &client->send_buffer, verbose, cluster_name) != 0) {
+		if (qnetd_ipc_cmd_list_cursor_init(&ipc_user_data->list_cursor, instance, verbose,
+		    json, cluster_name, node_id_set, node_id) != 0) {
+			goto exit_err_low_mem;
+		}
+
+		free(cluster_name); cluster_name = NULL;
+
+		if (dynar_str_cpy(&client->send_buffer, "OK\n") != 0 ||
+		    qnetd_ipc_send_list_chunk(instance, client) == -1) {
+			qnetd_ipc_cmd_list_cursor_destroy(&ipc_user_data->list_cursor);
+
 			if (qnetd_ipc_send_error(instance, client, "Can't get QNetd cluster list") != 0) {
 				client->schedule_disconnect = 1;
 			}
+		}
+	} else if (strcasecmp(str, "subscribe") == 0) {
+		log(LOG_DEBUG, "IPC client subscribed for events");
+
+		dynar_clean(&client->send_buffer);
+		if (qnetd_ipc_send_buffer(instance, client) != 0) {
+			client->schedule_disconnect = 1;
+		} else {
+			/*
+			 * Keep connection open. Reading is enabled only to detect closed connection.
+			 */
+			client->subscribed = 1;
+			dynar_set_max_size(&client->send_buffer,
+			    instance->advanced_settings->ipc_subscriber_buffer_size);
+			unix_socket_client_read_line(client, 1);
+		}
+	} else if (strcasecmp(str, "flight-recorder") == 0) {
+		if (flight_recorder_dump(&client->send_buffer) != 0) {
+			if (qnetd_ipc_send_error(instance, client,
+			    "Can't get QNetd flight recorder events") != 0) {
+				client->schedule_disconnect = 1;
+			}
 		} else {
 			if (qnetd_ipc_send_buffer(instance, client) != 0) {
 				client->schedule_disconnect = 1;
 			}
 		}
-
-		free(cluster_name); cluster_name = NULL;
 	} else {
 		log(LOG_DEBUG, "IPC client sent unknown command");
 		if (qnetd_ipc_send_error(instance, client, "Unknown command '%s'", str) != 0) {
@@ -488,6 +616,14 @@ qnetd_ipc_io_read(struct qnetd_instance *instance, struct unix_socket_client *cl
 		/*
 		 * Full message received
 		 */
+		if (client->subscribed) {
+			/*
+			 * Subscriber is not expected to send anything else
+			 */
+			dynar_clean(&client->receive_buffer);
+			break;
+		}
+
 		unix_socket_client_read_line(client, 0);
 
 		qnetd_ipc_parse_line(instance, client);
@@ -524,6 +660,24 @@ qnetd_ipc_io_write(struct qnetd_instance *instance, struct unix_socket_client *c
 		 * Full message sent
 		 */
 		unix_socket_client_write_buffer(client, 0);
+
+		if (client->subscribed) {
+			dynar_clean(&client->send_buffer);
+			break;
+		}
+
+		if (ipc_user_data->list_cursor.in_progress) {
+			dynar_clean(&client->send_buffer);
+
+			res = qnetd_ipc_send_list_chunk(instance, client);
+			if (res == 0) {
+				break;
+			} else if (res == -1) {
+				log(LOG_ERR, "Can't get next part of QNetd cluster list. "
+				    "Disconnecting IPC client");
+			}
+		}
+
 		client->schedule_disconnect = 1;
 
 		if (ipc_user_data->shutdown_requested) {
@@ -533,3 +687,83 @@ qnetd_ipc_io_write(struct qnetd_instance *instance, struct unix_socket_client *c
 		break;
 	}
 }
+
+static int
+qnetd_ipc_event_header(struct dynar *line, const char *event)
+{
+	struct timespec ts;
+	struct tm tm_res;
+	char time_str[32];
+
+	(void)clock_gettime(CLOCK_REALTIME, &ts);
+	localtime_r(&ts.tv_sec, &tm_res);
+
+	if (strftime(time_str, sizeof(time_str), "%Y-%m-%dT%H:%M:%S", &tm_res) == 0) {
+		return (-1);
+	}
+
+	return ((dynar_str_catf(line, "{\"time\":\"%s.%03ld\",\"event\":\"%s\"",
+	    time_str, (long)(ts.tv_nsec / 1000000), event) > 0) ? 0 : -1);
+}
+
+/*
+ * Send event about client to all IPC subscribers. fields_fmt (if not NULL) is appended
+ * to the JSON object and must start with comma.
+ */
+void
+qnetd_ipc_send_client_event(struct qnetd_instance *instance, const struct qnetd_client *client,
+    const char *event, const char *fields_fmt, ...)
+{
+	struct dynar line;
+	va_list ap;
+	size_t dropped;
+	int res;
+
+	if (!unix_socket_ipc_has_subscribers(&instance->local_ipc)) {
+		return ;
+	}
+
+	dynar_init(&line, instance->local_ipc.max_send_size);
+
+	res = (qnetd_ipc_event_header(&line, event) == 0 &&
+	    dynar_str_cat(&line, ",\"cluster\":") == 0);
+
+	if (res) {
+		if (client->cluster_name != NULL) {
+			res = (dynar_str_json_quote_cat(&line, client->cluster_name) == 0);
+		} else {
+			res = (dynar_str_cat(&line, "null") == 0);
+		}
+	}
+
+	if (res) {
+		res = (dynar_str_catf(&line, ",\"node_id\":%"PRIu32",\"address\":",
+		    client->node_id) > 0 &&
+		    dynar_str_json_quote_cat(&line, client->addr_str) == 0);
+	}
+
+	if (res && fields_fmt != NULL) {
+		va_start(ap, fields_fmt);
+		res = (dynar_str_vcatf(&line, fields_fmt, ap) > 0);
+		va_end(ap);
+	}
+
+	if (res) {
+		res = (dynar_str_cat(&line, "}\n") == 0);
+	}
+
+	if (!res) {
+		log(LOG_ERR, "Can't create IPC event %s", event);
+		dynar_destroy(&line);
+
+		return ;
+	}
+
+	dropped = unix_socket_ipc_send_event(&instance->local_ipc, dynar_data(&line),
+	    dynar_size(&line));
+	if (dropped > 0) {
+		log(LOG_WARNING, "%zu IPC event subscriber(s) too slow. Disconnecting", dropped);
+	}
+
+	dynar_destroy(&line);
+}
@@ -36,6 +36,7 @@
 #define _QNETD_IPC_H_
 
 #include "qnetd-instance.h"
+#include "qnetd-ipc-cmd.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -43,6 +44,7 @@ extern "C" {
 
 struct qnetd_ipc_user_data {
 	int shutdown_requested;
+	struct qnetd_ipc_cmd_list_cursor list_cursor;
 };
 
 extern int		qnetd_ipc_init(struct qnetd_instance *instance);
@@ -53,6 +55,10 @@ extern int		qnetd_ipc_is_closed(struct qnetd_instance *instance);
 
 extern int		qnetd_ipc_destroy(struct qnetd_instance *instance);
 
+extern void		qnetd_ipc_send_client_event(struct qnetd_instance *instance,
+    const struct qnetd_client *client, const char *event, const char *fields_fmt, ...)
+    __attribute__((__format__(__printf__, 4, 5)));
+
 extern int		qnetd_ipc_accept(struct qnetd_instance *instance,
     struct unix_socket_client **res_client);
 
@@ -72,6 +78,9 @@ extern int		qnetd_ipc_send_error(struct qnetd_instance *instance,
 extern int		qnetd_ipc_send_buffer(struct qnetd_instance *instance,
     struct unix_socket_client *client);
 
+extern void		qnetd_ipc_client_removed(struct qnetd_instance *instance,
+    const struct qnetd_client *client);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,1446 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Synthetic load generator for qnetd. Simulates many qdevice clients (grouped into
+ * clusters) in one process and reports throughput, vote latency and missed heartbeats.
+ */
+
+#include <sys/types.h>
+
+#include <err.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <nss.h>
+#include <ssl.h>
+#include <secerr.h>
+#include <sslerr.h>
+
+#include "qnet-config.h"
+
+#include "msg.h"
+#include "msgio.h"
+#include "node-list.h"
+#include "nss-sock.h"
+#include "pr-poll-loop.h"
+#include "send-buffer-list.h"
+#include "tlv.h"
+#include "utils.h"
+
+#define LOADGEN_PROGRAM_NAME			"qnetd-loadgen"
+
+#define LOADGEN_DEFAULT_CLUSTERS		1
+#define LOADGEN_DEFAULT_NODES			2
+#define LOADGEN_DEFAULT_HEARTBEAT_INTERVAL	(8*1000)
+#define LOADGEN_DEFAULT_CONNECT_RATE		1000
+#define LOADGEN_DEFAULT_DURATION		60
+#define LOADGEN_DEFAULT_REPORT_INTERVAL		5
+#define LOADGEN_MAX_EVENTS			64
+
+/*
+ * Connect ramp and exit checks are done with this period (ms)
+ */
+#define LOADGEN_TICK_INTERVAL			100
+#define LOADGEN_CONNECT_TIMEOUT			5000
+
+enum loadgen_exit_code {
+	LOADGEN_EXIT_CODE_NO_ERROR = EXIT_SUCCESS,
+	LOADGEN_EXIT_CODE_USAGE = 1,
+	LOADGEN_EXIT_CODE_INTERNAL_ERROR = 2,
+};
+
+enum loadgen_event_type {
+	LOADGEN_EVENT_TYPE_PARTITION,
+	LOADGEN_EVENT_TYPE_HEAL,
+};
+
+enum loadgen_client_state {
+	LOADGEN_CLIENT_STATE_NOT_CONNECTED,
+	LOADGEN_CLIENT_STATE_WAITING_PREINIT_REPLY,
+	LOADGEN_CLIENT_STATE_WAITING_STARTTLS_BEING_SENT,
+	LOADGEN_CLIENT_STATE_WAITING_INIT_REPLY,
+	LOADGEN_CLIENT_STATE_CONNECTED,
+	LOADGEN_CLIENT_STATE_DISCONNECTED,
+};
+
+struct loadgen_event {
+	enum loadgen_event_type type;
+	uint32_t time;		/* Seconds since start */
+	uint32_t partitions;
+};
+
+struct loadgen_settings {
+	char *host;
+	uint16_t port;
+	uint32_t clusters;
+	uint32_t nodes;
+	uint32_t heartbeat_interval;
+	enum tlv_decision_algorithm_type algorithm;
+	int tls;
+	char *nss_db_dir;
+	uint32_t connect_rate;
+	uint32_t duration;
+	uint32_t report_interval;
+	struct loadgen_event events[LOADGEN_MAX_EVENTS];
+	size_t no_events;
+};
+
+struct loadgen_cluster;
+
+struct loadgen_client {
+	struct loadgen_cluster *cluster;
+	uint32_t node_id;
+	enum loadgen_client_state state;
+	PRFileDesc *socket;
+	struct dynar receive_buffer;
+	size_t msg_already_received_bytes;
+	int skipping_msg;
+	struct send_buffer_list send_buffer_list;
+	uint32_t last_msg_seq_num;
+	uint32_t echo_request_expected_msg_seq_num;
+	uint32_t echo_reply_received_msg_seq_num;
+	struct timer_list_entry *heartbeat_timer;
+	struct tlv_ring_id ring_id;
+	int vote_pending;
+	uint64_t vote_pending_since;
+	int schedule_disconnect;
+};
+
+struct loadgen_cluster {
+	char *name;
+	struct loadgen_client *clients;
+	uint64_t ring_seq;
+	uint32_t partitions;
+};
+
+struct loadgen_stats {
+	uint64_t msgs_sent;
+	uint64_t msgs_received;
+	uint64_t connect_failures;
+	uint64_t disconnects;
+	uint64_t server_errors;
+	uint64_t missed_heartbeats;
+	uint64_t votes_ack;
+	uint64_t votes_nack;
+	uint32_t *vote_latencies;	/* In microseconds */
+	size_t no_vote_latencies;
+	size_t vote_latencies_size;
+};
+
+struct loadgen_instance {
+	const struct loadgen_settings *settings;
+	struct pr_poll_loop main_poll_loop;
+	struct loadgen_cluster *clusters;
+	size_t no_clients;
+	size_t next_client_to_connect;
+	size_t connected_clients;
+	struct loadgen_stats stats;
+	struct loadgen_stats last_report_stats;
+	uint64_t start_time;
+	uint64_t last_report_time;
+	size_t next_event;
+	int exit_requested;
+};
+
+static volatile sig_atomic_t loadgen_signal_received = 0;
+
+static void	loadgen_client_disconnect_error(struct loadgen_client *client,
+    const char *format, ...) __attribute__((__format__(__printf__, 2, 3)));
+
+static uint64_t
+loadgen_time_us(void)
+{
+	struct timespec ts;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+}
+
+static void
+loadgen_signal_handler(int sig)
+{
+
+	loadgen_signal_received = 1;
+}
+
+static void
+usage(void)
+{
+
+	printf("usage: %s [-h] [-a algorithm] [-c clusters] [-d nss_db_dir] [-e time:event]\n",
+	    LOADGEN_PROGRAM_NAME);
+	printf("       [-H host] [-i heartbeat_interval] [-n nodes] [-p port] [-r connect_rate]\n");
+	printf("       [-R report_interval] [-s tls] [-t duration]\n");
+}
+
+static int
+parse_algorithm(const char *str, enum tlv_decision_algorithm_type *algorithm)
+{
+
+	if (strcasecmp(str, "test") == 0) {
+		*algorithm = TLV_DECISION_ALGORITHM_TYPE_TEST;
+	} else if (strcasecmp(str, "ffsplit") == 0) {
+		*algorithm = TLV_DECISION_ALGORITHM_TYPE_FFSPLIT;
+	} else if (strcasecmp(str, "2nodelms") == 0) {
+		*algorithm = TLV_DECISION_ALGORITHM_TYPE_2NODELMS;
+	} else if (strcasecmp(str, "lms") == 0) {
+		*algorithm = TLV_DECISION_ALGORITHM_TYPE_LMS;
+	} else {
+		return (-1);
+	}
+
+	return (0);
+}
+
+/*
+ * Parse event in format time:partition[=N] or time:heal
+ */
+static int
+parse_event(char *str, struct loadgen_event *event)
+{
+	char *sep;
+	char *parts;
+	long long int tmpll;
+
+	sep = strchr(str, ':');
+	if (sep == NULL) {
+		return (-1);
+	}
+	*sep = '\0';
+	sep++;
+
+	if (utils_strtonum(str, 0, UINT32_MAX, &tmpll) == -1) {
+		return (-1);
+	}
+	event->time = (uint32_t)tmpll;
+
+	parts = strchr(sep, '=');
+	if (parts != NULL) {
+		*parts = '\0';
+		parts++;
+	}
+
+	if (strcasecmp(sep, "partition") == 0) {
+		event->type = LOADGEN_EVENT_TYPE_PARTITION;
+		event->partitions = 2;
+
+		if (parts != NULL) {
+			if (utils_strtonum(parts, 2, UINT32_MAX, &tmpll) == -1) {
+				return (-1);
+			}
+			event->partitions = (uint32_t)tmpll;
+		}
+	} else if (strcasecmp(sep, "heal") == 0 && parts == NULL) {
+		event->type = LOADGEN_EVENT_TYPE_HEAL;
+		event->partitions = 1;
+	} else {
+		return (-1);
+	}
+
+	return (0);
+}
+
+static int
+event_cmp(const void *a, const void *b)
+{
+	const struct loadgen_event *e1 = a;
+	const struct loadgen_event *e2 = b;
+
+	if (e1->time < e2->time) {
+		return (-1);
+	} else if (e1->time > e2->time) {
+		return (1);
+	}
+
+	return (0);
+}
+
+static void
+cli_parse(int argc, char * const argv[], struct loadgen_settings *settings)
+{
+	int ch;
+	long long int tmpll;
+	int tmpi;
+
+	memset(settings, 0, sizeof(*settings));
+
+	settings->port = QNETD_DEFAULT_HOST_PORT;
+	settings->clusters = LOADGEN_DEFAULT_CLUSTERS;
+	settings->nodes = LOADGEN_DEFAULT_NODES;
+	settings->heartbeat_interval = LOADGEN_DEFAULT_HEARTBEAT_INTERVAL;
+	settings->algorithm = QDEVICE_NET_DEFAULT_ALGORITHM;
+	settings->connect_rate = LOADGEN_DEFAULT_CONNECT_RATE;
+	settings->duration = LOADGEN_DEFAULT_DURATION;
+	settings->report_interval = LOADGEN_DEFAULT_REPORT_INTERVAL;
+
+	settings->host = strdup("localhost");
+	settings->nss_db_dir = strdup(QDEVICE_NET_DEFAULT_NSS_DB_DIR);
+	if (settings->host == NULL || settings->nss_db_dir == NULL) {
+		errx(LOADGEN_EXIT_CODE_INTERNAL_ERROR, "Can't alloc memory for default settings");
+	}
+
+	while ((ch = getopt(argc, argv, "ha:c:d:e:H:i:n:p:r:R:s:t:")) != -1) {
+		switch (ch) {
+		case 'a':
+			if (parse_algorithm(optarg, &settings->algorithm) != 0) {
+				errx(LOADGEN_EXIT_CODE_USAGE, "Unknown algorithm %s", optarg);
+			}
+			break;
+		case 'c':
+			if (utils_strtonum(optarg, 1, UINT32_MAX, &tmpll) == -1) {
+				errx(LOADGEN_EXIT_CODE_USAGE, "Number of clusters must be a positive number");
+			}
+			settings->clusters = (uint32_t)tmpll;
+			break;
+		case 'd':
+			free(settings->nss_db_dir);
+			settings->nss_db_dir = strdup(optarg);
+			if (settings->nss_db_dir == NULL) {
+				errx(LOADGEN_EXIT_CODE_INTERNAL_ERROR,
+				    "Can't alloc memory for nss db dir string");
+			}
+			break;
+		case 'e':
+			if (settings->no_events >= LOADGEN_MAX_EVENTS) {
+				errx(LOADGEN_EXIT_CODE_USAGE, "Too many events (maximum is %u)",
+				    LOADGEN_MAX_EVENTS);
+			}
+
+			if (parse_event(optarg, &settings->events[settings->no_events]) != 0) {
+				errx(LOADGEN_EXIT_CODE_USAGE, "Event must be in format "
+				    "time:partition[=N] or time:heal");
+			}
+			settings->no_events++;
+			break;
+		case 'H':
+			free(settings->host);
+			settings->host = strdup(optarg);
+			if (settings->host == NULL) {
+				errx(LOADGEN_EXIT_CODE_INTERNAL_ERROR,
+				    "Can't alloc memory for host string");
+			}
+			break;
+		case 'i':
+			if (utils_strtonum(optarg, QNETD_MIN_HEARTBEAT_INTERVAL,
+			    TIMER_LIST_MAX_INTERVAL, &tmpll) == -1) {
+				errx(LOADGEN_EXIT_CODE_USAGE, "Heartbeat interval must be a number "
+				    "in range %u - %u", QNETD_MIN_HEARTBEAT_INTERVAL,
+				    TIMER_LIST_MAX_INTERVAL);
+			}
+			settings->heartbeat_interval = (uint32_t)tmpll;
+			break;
+		case 'n':
+			if (utils_strtonum(optarg, 1, UINT32_MAX - 1, &tmpll) == -1) {
+				errx(LOADGEN_EXIT_CODE_USAGE, "Number of nodes must be a positive number");
+			}
+			settings->nodes = (uint32_t)tmpll;
+			break;
+		case 'p':
+			if (utils_strtonum(optarg, 1, UINT16_MAX, &tmpll) == -1) {
+				errx(LOADGEN_EXIT_CODE_USAGE, "Port must be a number in range 1 - %u",
+				    UINT16_MAX);
+			}
+			settings->port = (uint16_t)tmpll;
+			break;
+		case 'r':
+			if (utils_strtonum(optarg, 1, UINT32_MAX, &tmpll) == -1) {
+				errx(LOADGEN_EXIT_CODE_USAGE, "Connect rate must be a positive number");
+			}
+			settings->connect_rate = (uint32_t)tmpll;
+			break;
+		case 'R':
+			if (utils_strtonum(optarg, 0, UINT32_MAX, &tmpll) == -1) {
+				errx(LOADGEN_EXIT_CODE_USAGE, "Report interval must be a number");
+			}
+			settings->report_interval = (uint32_t)tmpll;
+			break;
+		case 's':
+			if ((tmpi = utils_parse_bool_str(optarg)) == -1) {
+				errx(LOADGEN_EXIT_CODE_USAGE, "TLS must be on or off");
+			}
+			settings->tls = tmpi;
+			break;
+		case 't':
+			if (utils_strtonum(optarg, 1, UINT32_MAX, &tmpll) == -1) {
+				errx(LOADGEN_EXIT_CODE_USAGE, "Duration must be a positive number");
+			}
+			settings->duration = (uint32_t)tmpll;
+			break;
+		case 'h':
+		case '?':
+			usage();
+			exit(LOADGEN_EXIT_CODE_USAGE);
+			break;
+		}
+	}
+
+	if (settings->algorithm == TLV_DECISION_ALGORITHM_TYPE_2NODELMS && settings->nodes != 2) {
+		errx(LOADGEN_EXIT_CODE_USAGE, "2nodelms algorithm requires exactly 2 nodes");
+	}
+
+	qsort(settings->events, settings->no_events, sizeof(settings->events[0]), event_cmp);
+}
+
+/*
+ * Statistics
+ */
+static void
+loadgen_stats_add_vote_latency(struct loadgen_stats *stats, uint64_t latency)
+{
+	uint32_t *new_latencies;
+	size_t new_size;
+
+	if (stats->no_vote_latencies >= stats->vote_latencies_size) {
+		new_size = (stats->vote_latencies_size == 0 ? 1024 : stats->vote_latencies_size * 2);
+
+		new_latencies = realloc(stats->vote_latencies, new_size * sizeof(*new_latencies));
+		if (new_latencies == NULL) {
+			errx(LOADGEN_EXIT_CODE_INTERNAL_ERROR, "Can't alloc memory for vote latencies");
+		}
+
+		stats->vote_latencies = new_latencies;
+		stats->vote_latencies_size = new_size;
+	}
+
+	if (latency > UINT32_MAX) {
+		latency = UINT32_MAX;
+	}
+
+	stats->vote_latencies[stats->no_vote_latencies++] = (uint32_t)latency;
+}
+
+static int
+u32_cmp(const void *a, const void *b)
+{
+	uint32_t u1 = *(const uint32_t *)a;
+	uint32_t u2 = *(const uint32_t *)b;
+
+	return ((u1 > u2) - (u1 < u2));
+}
+
+/*
+ * Return latency percentile (in ms) of sorted latencies array
+ */
+static double
+loadgen_percentile(const uint32_t *latencies, size_t no_latencies, unsigned int percentile)
+{
+	size_t index;
+
+	if (no_latencies == 0) {
+		return (0);
+	}
+
+	index = (no_latencies * percentile + 99) / 100;
+	if (index > 0) {
+		index--;
+	}
+
+	return (latencies[index] / 1000.0);
+}
+
+static void
+loadgen_report_interval(struct loadgen_instance *instance)
+{
+	uint64_t now;
+	double elapsed;
+	uint64_t msgs;
+
+	now = loadgen_time_us();
+	elapsed = (now - instance->last_report_time) / 1000000.0;
+	if (elapsed <= 0) {
+		return ;
+	}
+
+	msgs = (instance->stats.msgs_sent + instance->stats.msgs_received) -
+	    (instance->last_report_stats.msgs_sent + instance->last_report_stats.msgs_received);
+
+	printf("[%6.1fs] connected %zu/%zu, %.0f msgs/s, votes %"PRIu64
+	    ", missed heartbeats %"PRIu64", disconnects %"PRIu64"\n",
+	    (now - instance->start_time) / 1000000.0,
+	    instance->connected_clients, instance->no_clients, msgs / elapsed,
+	    (instance->stats.votes_ack + instance->stats.votes_nack) -
+	    (instance->last_report_stats.votes_ack + instance->last_report_stats.votes_nack),
+	    instance->stats.missed_heartbeats - instance->last_report_stats.missed_heartbeats,
+	    instance->stats.disconnects - instance->last_report_stats.disconnects);
+	fflush(stdout);
+
+	memcpy(&instance->last_report_stats, &instance->stats, sizeof(instance->stats));
+	instance->last_report_time = now;
+}
+
+static void
+loadgen_report_final(struct loadgen_instance *instance)
+{
+	struct loadgen_stats *stats;
+	double elapsed;
+
+	stats = &instance->stats;
+	elapsed = (loadgen_time_us() - instance->start_time) / 1000000.0;
+
+	qsort(stats->vote_latencies, stats->no_vote_latencies, sizeof(*stats->vote_latencies),
+	    u32_cmp);
+
+	printf("\n");
+	printf("Duration:\t\t%.1f s\n", elapsed);
+	printf("Clients:\t\t%zu (%"PRIu32" clusters, %"PRIu32" nodes each)\n",
+	    instance->no_clients, instance->settings->clusters, instance->settings->nodes);
+	printf("Connected at end:\t%zu\n", instance->connected_clients);
+	printf("Connect failures:\t%"PRIu64"\n", stats->connect_failures);
+	printf("Disconnects:\t\t%"PRIu64"\n", stats->disconnects);
+	printf("Server errors:\t\t%"PRIu64"\n", stats->server_errors);
+	printf("Messages sent:\t\t%"PRIu64"\n", stats->msgs_sent);
+	printf("Messages received:\t%"PRIu64"\n", stats->msgs_received);
+	printf("Throughput:\t\t%.0f msgs/s\n",
+	    (elapsed > 0 ? (stats->msgs_sent + stats->msgs_received) / elapsed : 0));
+	printf("Votes:\t\t\t%"PRIu64" (ACK %"PRIu64", NACK %"PRIu64")\n",
+	    stats->votes_ack + stats->votes_nack, stats->votes_ack, stats->votes_nack);
+	printf("Vote latency samples:\t%zu\n", stats->no_vote_latencies);
+	printf("Vote latency (ms):\tp50 %.3f, p90 %.3f, p99 %.3f, max %.3f\n",
+	    loadgen_percentile(stats->vote_latencies, stats->no_vote_latencies, 50),
+	    loadgen_percentile(stats->vote_latencies, stats->no_vote_latencies, 90),
+	    loadgen_percentile(stats->vote_latencies, stats->no_vote_latencies, 99),
+	    loadgen_percentile(stats->vote_latencies, stats->no_vote_latencies, 100));
+	printf("Missed heartbeats:\t%"PRIu64"\n", stats->missed_heartbeats);
+}
+
+/*
+ * Client membership
+ */
+static uint32_t
+loadgen_client_partition(const struct loadgen_client *client, uint32_t nodes)
+{
+
+	return ((uint32_t)(((uint64_t)(client->node_id - 1) * client->cluster->partitions) / nodes));
+}
+
+/*
+ * Fill membership node list of partition client belongs to and return ring id of
+ * the partition (node id of the first node in the partition)
+ */
+static int
+loadgen_client_membership(const struct loadgen_client *client, uint32_t nodes,
+    struct node_list *nlist, struct tlv_ring_id *ring_id)
+{
+	uint32_t partition;
+	uint32_t u32;
+	const struct loadgen_client *peer;
+
+	partition = loadgen_client_partition(client, nodes);
+
+	node_list_init(nlist);
+	ring_id->node_id = 0;
+	ring_id->seq = client->cluster->ring_seq;
+
+	for (u32 = 0; u32 < nodes; u32++) {
+		peer = &client->cluster->clients[u32];
+
+		if (loadgen_client_partition(peer, nodes) != partition) {
+			continue;
+		}
+
+		if (ring_id->node_id == 0) {
+			ring_id->node_id = peer->node_id;
+		}
+
+		if (node_list_add(nlist, peer->node_id, 0, TLV_NODE_STATE_MEMBER) == NULL) {
+			node_list_free(nlist);
+
+			return (-1);
+		}
+	}
+
+	return (0);
+}
+
+/*
+ * Sending
+ */
+static struct send_buffer_list_entry *
+loadgen_client_get_send_buffer(struct loadgen_client *client)
+{
+	struct send_buffer_list_entry *send_buffer;
+
+	send_buffer = send_buffer_list_get_new(&client->send_buffer_list);
+	if (send_buffer == NULL) {
+		loadgen_client_disconnect_error(client, "Can't allocate send list buffer");
+	}
+
+	client->last_msg_seq_num++;
+
+	return (send_buffer);
+}
+
+static int
+loadgen_client_put_send_buffer(struct loadgen_client *client,
+    struct send_buffer_list_entry *send_buffer, size_t msg_len)
+{
+
+	if (msg_len == 0) {
+		send_buffer_list_discard_new(&client->send_buffer_list, send_buffer);
+		loadgen_client_disconnect_error(client, "Can't create message");
+
+		return (-1);
+	}
+
+	send_buffer_list_put(&client->send_buffer_list, send_buffer);
+
+	return (0);
+}
+
+static int
+loadgen_client_send_preinit(struct loadgen_client *client)
+{
+	struct send_buffer_list_entry *send_buffer;
+
+	if ((send_buffer = loadgen_client_get_send_buffer(client)) == NULL) {
+		return (-1);
+	}
+
+	return (loadgen_client_put_send_buffer(client, send_buffer,
+	    msg_create_preinit(&send_buffer->buffer, client->cluster->name, 1,
+	    client->last_msg_seq_num)));
+}
+
+static int
+loadgen_client_send_starttls(struct loadgen_client *client)
+{
+	struct send_buffer_list_entry *send_buffer;
+
+	if ((send_buffer = loadgen_client_get_send_buffer(client)) == NULL) {
+		return (-1);
+	}
+
+	return (loadgen_client_put_send_buffer(client, send_buffer,
+	    msg_create_starttls(&send_buffer->buffer, 1, client->last_msg_seq_num)));
+}
+
+static int
+loadgen_client_send_init(struct loadgen_instance *instance, struct loadgen_client *client)
+{
+	struct send_buffer_list_entry *send_buffer;
+	enum msg_type *supported_msgs;
+	size_t no_supported_msgs;
+	enum tlv_opt_type *supported_opts;
+	size_t no_supported_opts;
+	struct tlv_tie_breaker tie_breaker;
+	struct tlv_ring_id ring_id;
+	struct node_list nlist;
+
+	tlv_get_supported_options(&supported_opts, &no_supported_opts);
+	msg_get_supported_messages(&supported_msgs, &no_supported_msgs);
+
+	tie_breaker.mode = TLV_TIE_BREAKER_MODE_LOWEST;
+	tie_breaker.node_id = 0;
+
+	if (loadgen_client_membership(client, instance->settings->nodes, &nlist, &ring_id) != 0) {
+		loadgen_client_disconnect_error(client, "Can't alloc membership node list");
+
+		return (-1);
+	}
+	node_list_free(&nlist);
+
+	if ((send_buffer = loadgen_client_get_send_buffer(client)) == NULL) {
+		return (-1);
+	}
+
+	client->state = LOADGEN_CLIENT_STATE_WAITING_INIT_REPLY;
+
+	return (loadgen_client_put_send_buffer(client, send_buffer,
+	    msg_create_init(&send_buffer->buffer, 1, client->last_msg_seq_num,
+	    instance->settings->algorithm, supported_msgs, no_supported_msgs,
+	    supported_opts, no_supported_opts, client->node_id,
+	    instance->settings->heartbeat_interval, &tie_breaker, &ring_id)));
+}
+
+static int
+loadgen_client_send_echo_request(struct loadgen_client *client)
+{
+	struct send_buffer_list_entry *send_buffer;
+
+	if ((send_buffer = loadgen_client_get_send_buffer(client)) == NULL) {
+		return (-1);
+	}
+
+	client->echo_request_expected_msg_seq_num = client->last_msg_seq_num;
+
+	return (loadgen_client_put_send_buffer(client, send_buffer,
+	    msg_create_echo_request(&send_buffer->buffer, 1, client->last_msg_seq_num)));
+}
+
+static int
+loadgen_client_send_config_node_list(struct loadgen_instance *instance,
+    struct loadgen_client *client)
+{
+	struct send_buffer_list_entry *send_buffer;
+	struct node_list nlist;
+	uint32_t u32;
+	size_t msg_len;
+
+	node_list_init(&nlist);
+
+	for (u32 = 0; u32 < instance->settings->nodes; u32++) {
+		if (node_list_add(&nlist, client->cluster->clients[u32].node_id, 0,
+		    TLV_NODE_STATE_NOT_SET) == NULL) {
+			node_list_free(&nlist);
+			loadgen_client_disconnect_error(client, "Can't alloc config node list");
+
+			return (-1);
+		}
+	}
+
+	if ((send_buffer = loadgen_client_get_send_buffer(client)) == NULL) {
+		node_list_free(&nlist);
+
+		return (-1);
+	}
+
+	msg_len = msg_create_node_list(&send_buffer->buffer, client->last_msg_seq_num,
+	    TLV_NODE_LIST_TYPE_INITIAL_CONFIG, 0, NULL, 1, 1, 0, TLV_QUORATE_INQUORATE,
+	    0, TLV_HEURISTICS_UNDEFINED, &nlist);
+	node_list_free(&nlist);
+
+	return (loadgen_client_put_send_buffer(client, send_buffer, msg_len));
+}
+
+/*
+ * Send membership and quorum node list of the partition client belongs to. Vote
+ * latency is measured from this moment till ACK/NACK vote is received.
+ */
+static int
+loadgen_client_send_membership(struct loadgen_instance *instance, struct loadgen_client *client)
+{
+	struct send_buffer_list_entry *send_buffer;
+	struct node_list nlist;
+	struct tlv_ring_id ring_id;
+	enum tlv_quorate quorate;
+	size_t msg_len;
+
+	if (loadgen_client_membership(client, instance->settings->nodes, &nlist, &ring_id) != 0) {
+		loadgen_client_disconnect_error(client, "Can't alloc membership node list");
+
+		return (-1);
+	}
+
+	quorate = (node_list_size(&nlist) * 2 > instance->settings->nodes ?
+	    TLV_QUORATE_QUORATE : TLV_QUORATE_INQUORATE);
+
+	if ((send_buffer = loadgen_client_get_send_buffer(client)) == NULL) {
+		node_list_free(&nlist);
+
+		return (-1);
+	}
+
+	msg_len = msg_create_node_list(&send_buffer->buffer, client->last_msg_seq_num,
+	    TLV_NODE_LIST_TYPE_MEMBERSHIP, 1, &ring_id, 0, 0, 0, TLV_QUORATE_INQUORATE,
+	    0, TLV_HEURISTICS_UNDEFINED, &nlist);
+	if (loadgen_client_put_send_buffer(client, send_buffer, msg_len) != 0) {
+		node_list_free(&nlist);
+
+		return (-1);
+	}
+
+	memcpy(&client->ring_id, &ring_id, sizeof(ring_id));
+	client->vote_pending = 1;
+	client->vote_pending_since = loadgen_time_us();
+
+	if ((send_buffer = loadgen_client_get_send_buffer(client)) == NULL) {
+		node_list_free(&nlist);
+
+		return (-1);
+	}
+
+	msg_len = msg_create_node_list(&send_buffer->buffer, client->last_msg_seq_num,
+	    TLV_NODE_LIST_TYPE_QUORUM, 0, NULL, 0, 0, 1, quorate,
+	    0, TLV_HEURISTICS_UNDEFINED, &nlist);
+	node_list_free(&nlist);
+
+	return (loadgen_client_put_send_buffer(client, send_buffer, msg_len));
+}
+
+static int
+loadgen_client_send_vote_info_reply(struct loadgen_client *client, uint32_t msg_seq_number)
+{
+	struct send_buffer_list_entry *send_buffer;
+
+	if ((send_buffer = loadgen_client_get_send_buffer(client)) == NULL) {
+		return (-1);
+	}
+
+	return (loadgen_client_put_send_buffer(client, send_buffer,
+	    msg_create_vote_info_reply(&send_buffer->buffer, msg_seq_number)));
+}
+
+/*
+ * Timers
+ */
+static int
+loadgen_client_heartbeat_timer_callback(void *data1, void *data2)
+{
+	struct loadgen_instance *instance = (struct loadgen_instance *)data1;
+	struct loadgen_client *client = (struct loadgen_client *)data2;
+
+	if (client->echo_reply_received_msg_seq_num !=
+	    client->echo_request_expected_msg_seq_num) {
+		instance->stats.missed_heartbeats++;
+	}
+
+	if (loadgen_client_send_echo_request(client) != 0) {
+		client->heartbeat_timer = NULL;
+
+		return (0);
+	}
+
+	return (-1);
+}
+
+/*
+ * Connection handling
+ */
+static void
+loadgen_client_disconnect_error(struct loadgen_client *client, const char *format, ...)
+{
+	va_list ap;
+
+	if (client->schedule_disconnect) {
+		return ;
+	}
+
+	fprintf(stderr, "%s: cluster %s node %"PRIu32": ", LOADGEN_PROGRAM_NAME,
+	    client->cluster->name, client->node_id);
+
+	va_start(ap, format);
+	vfprintf(stderr, format, ap);
+	va_end(ap);
+
+	fprintf(stderr, "\n");
+
+	client->schedule_disconnect = 1;
+}
+
+static void
+loadgen_client_close(struct loadgen_instance *instance, struct loadgen_client *client)
+{
+
+	if (client->socket == NULL) {
+		return ;
+	}
+
+	if (client->heartbeat_timer != NULL) {
+		timer_list_entry_delete(pr_poll_loop_get_timer_list(&instance->main_poll_loop),
+		    client->heartbeat_timer);
+		client->heartbeat_timer = NULL;
+	}
+
+	if (pr_poll_loop_del_prfd(&instance->main_poll_loop, client->socket) != 0) {
+		errx(LOADGEN_EXIT_CODE_INTERNAL_ERROR, "Can't delete client socket from poll loop");
+	}
+
+	PR_Close(client->socket);
+	client->socket = NULL;
+
+	if (client->state == LOADGEN_CLIENT_STATE_CONNECTED) {
+		instance->connected_clients--;
+	}
+
+	client->state = LOADGEN_CLIENT_STATE_DISCONNECTED;
+	client->vote_pending = 0;
+
+	send_buffer_list_free(&client->send_buffer_list);
+	dynar_destroy(&client->receive_buffer);
+}
+
+static SECStatus
+loadgen_nss_bad_cert_hook(void *arg, PRFileDesc *fd)
+{
+
+	if (PR_GetError() == SEC_ERROR_EXPIRED_CERTIFICATE ||
+	    PR_GetError() == SEC_ERROR_EXPIRED_ISSUER_CERTIFICATE ||
+	    PR_GetError() == SEC_ERROR_CRL_EXPIRED ||
+	    PR_GetError() == SEC_ERROR_KRL_EXPIRED ||
+	    PR_GetError() == SSL_ERROR_EXPIRED_CERT_ALERT) {
+		return (SECSuccess);
+	}
+
+	return (SECFailure);
+}
+
+static SECStatus
+loadgen_nss_get_client_auth_data(void *arg, PRFileDesc *sock, struct CERTDistNamesStr *caNames,
+    struct CERTCertificateStr **pRetCert, struct SECKEYPrivateKeyStr **pRetKey)
+{
+
+	return (NSS_GetClientAuthData((void *)QDEVICE_NET_DEFAULT_NSS_CLIENT_CERT_NICKNAME,
+	    sock, caNames, pRetCert, pRetKey));
+}
+
+/*
+ * Received messages
+ */
+static void
+loadgen_client_vote_received(struct loadgen_instance *instance, struct loadgen_client *client,
+    const struct msg_decoded *msg)
+{
+
+	if (!msg->vote_set || (msg->vote != TLV_VOTE_ACK && msg->vote != TLV_VOTE_NACK)) {
+		return ;
+	}
+
+	if (msg->vote == TLV_VOTE_ACK) {
+		instance->stats.votes_ack++;
+	} else {
+		instance->stats.votes_nack++;
+	}
+
+	if (client->vote_pending && (!msg->ring_id_set ||
+	    (msg->ring_id.node_id == client->ring_id.node_id &&
+	    msg->ring_id.seq == client->ring_id.seq))) {
+		loadgen_stats_add_vote_latency(&instance->stats,
+		    loadgen_time_us() - client->vote_pending_since);
+		client->vote_pending = 0;
+	}
+}
+
+static int
+loadgen_client_msg_received(struct loadgen_instance *instance, struct loadgen_client *client)
+{
+	struct msg_decoded msg;
+	int res;
+
+	msg_decoded_init(&msg);
+
+	if (msg_decode(&client->receive_buffer, &msg) != 0) {
+		loadgen_client_disconnect_error(client, "Can't decode message");
+		res = -1;
+		goto exit_destroy;
+	}
+
+	instance->stats.msgs_received++;
+	res = 0;
+
+	switch (msg.type) {
+	case MSG_TYPE_PREINIT_REPLY:
+		if (client->state != LOADGEN_CLIENT_STATE_WAITING_PREINIT_REPLY ||
+		    !msg.tls_supported_set) {
+			loadgen_client_disconnect_error(client, "Unexpected preinit reply");
+			res = -1;
+		} else if (instance->settings->tls && msg.tls_supported != TLV_TLS_UNSUPPORTED) {
+			client->state = LOADGEN_CLIENT_STATE_WAITING_STARTTLS_BEING_SENT;
+			res = loadgen_client_send_starttls(client);
+		} else if (!instance->settings->tls && msg.tls_supported == TLV_TLS_REQUIRED) {
+			loadgen_client_disconnect_error(client, "Server requires TLS");
+			res = -1;
+		} else if (instance->settings->tls) {
+			loadgen_client_disconnect_error(client, "Server doesn't support TLS");
+			res = -1;
+		} else {
+			res = loadgen_client_send_init(instance, client);
+		}
+		break;
+	case MSG_TYPE_INIT_REPLY:
+		if (client->state != LOADGEN_CLIENT_STATE_WAITING_INIT_REPLY) {
+			loadgen_client_disconnect_error(client, "Unexpected init reply");
+			res = -1;
+			break;
+		}
+
+		if (msg.reply_error_code_set &&
+		    msg.reply_error_code != TLV_REPLY_ERROR_CODE_NO_ERROR) {
+			instance->stats.server_errors++;
+			loadgen_client_disconnect_error(client, "Init reply error %u",
+			    (unsigned int)msg.reply_error_code);
+			res = -1;
+			break;
+		}
+
+		client->state = LOADGEN_CLIENT_STATE_CONNECTED;
+		instance->connected_clients++;
+
+		client->heartbeat_timer = timer_list_add(
+		    pr_poll_loop_get_timer_list(&instance->main_poll_loop),
+		    instance->settings->heartbeat_interval,
+		    loadgen_client_heartbeat_timer_callback, instance, client);
+		if (client->heartbeat_timer == NULL) {
+			loadgen_client_disconnect_error(client, "Can't add heartbeat timer");
+			res = -1;
+			break;
+		}
+
+		if (loadgen_client_send_config_node_list(instance, client) != 0 ||
+		    loadgen_client_send_membership(instance, client) != 0) {
+			res = -1;
+		}
+		break;
+	case MSG_TYPE_SERVER_ERROR:
+		instance->stats.server_errors++;
+		loadgen_client_disconnect_error(client, "Server sent error %u",
+		    (unsigned int)msg.reply_error_code);
+		res = -1;
+		break;
+	case MSG_TYPE_ECHO_REPLY:
+		if (msg.seq_number_set) {
+			client->echo_reply_received_msg_seq_num = msg.seq_number;
+		}
+		break;
+	case MSG_TYPE_NODE_LIST_REPLY:
+	case MSG_TYPE_ASK_FOR_VOTE_REPLY:
+		loadgen_client_vote_received(instance, client, &msg);
+		break;
+	case MSG_TYPE_VOTE_INFO:
+		loadgen_client_vote_received(instance, client, &msg);
+		res = loadgen_client_send_vote_info_reply(client, msg.seq_number);
+		break;
+	case MSG_TYPE_SET_OPTION_REPLY:
+	case MSG_TYPE_HEURISTICS_CHANGE_REPLY:
+		break;
+	default:
+		loadgen_client_disconnect_error(client, "Unexpected message %s",
+		    msg_type_to_str(msg.type));
+		res = -1;
+		break;
+	}
+
+exit_destroy:
+	msg_decoded_destroy(&msg);
+
+	return (res);
+}
+
+static int
+loadgen_client_read(struct loadgen_instance *instance, struct loadgen_client *client)
+{
+	int res;
+
+	res = msgio_read(client->socket, &client->receive_buffer,
+	    &client->msg_already_received_bytes, &client->skipping_msg);
+
+	switch (res) {
+	case 0:
+		/*
+		 * Partial read
+		 */
+		break;
+	case 1:
+		if (client->skipping_msg) {
+			loadgen_client_disconnect_error(client, "Message too long");
+
+			return (-1);
+		}
+
+		res = loadgen_client_msg_received(instance, client);
+
+		client->msg_already_received_bytes = 0;
+		dynar_clean(&client->receive_buffer);
+
+		return (res);
+	case -1:
+		loadgen_client_disconnect_error(client, "Server closed connection");
+
+		return (-1);
+	default:
+		loadgen_client_disconnect_error(client, "Can't read message (%d)", res);
+
+		return (-1);
+	}
+
+	return (0);
+}
+
+static int
+loadgen_client_write(struct loadgen_instance *instance, struct loadgen_client *client)
+{
+	struct send_buffer_list_entry *send_buffer;
+	PRFileDesc *new_pr_fd;
+	int res;
+
+	send_buffer = send_buffer_list_get_active(&client->send_buffer_list);
+	if (send_buffer == NULL) {
+		return (0);
+	}
+
+	res = msgio_write(client->socket, &send_buffer->buffer,
+	    &send_buffer->msg_already_sent_bytes);
+	if (res == 1) {
+		instance->stats.msgs_sent++;
+		send_buffer_list_delete(&client->send_buffer_list, send_buffer);
+
+		if (client->state == LOADGEN_CLIENT_STATE_WAITING_STARTTLS_BEING_SENT) {
+			if ((new_pr_fd = nss_sock_start_ssl_as_client(client->socket,
+			    QDEVICE_NET_DEFAULT_NSS_QNETD_CN, loadgen_nss_bad_cert_hook,
+			    loadgen_nss_get_client_auth_data, NULL, 0, NULL)) == NULL) {
+				loadgen_client_disconnect_error(client, "Can't start TLS");
+
+				return (-1);
+			}
+
+			client->socket = new_pr_fd;
+
+			return (loadgen_client_send_init(instance, client));
+		}
+	} else if (res < 0) {
+		loadgen_client_disconnect_error(client, "Can't send message");
+
+		return (-1);
+	}
+
+	return (0);
+}
+
+/*
+ * Poll loop callbacks
+ */
+static int
+client_socket_set_events_cb(PRFileDesc *prfd, short *events, void *user_data1, void *user_data2)
+{
+	struct loadgen_client *client = (struct loadgen_client *)user_data2;
+
+	if (!send_buffer_list_empty(&client->send_buffer_list)) {
+		*events |= POLLOUT;
+	}
+
+	return (0);
+}
+
+static int
+client_socket_read_cb(PRFileDesc *prfd, const PRPollDesc *pd, void *user_data1, void *user_data2)
+{
+	struct loadgen_instance *instance = (struct loadgen_instance *)user_data1;
+	struct loadgen_client *client = (struct loadgen_client *)user_data2;
+
+	if (!client->schedule_disconnect) {
+		(void)loadgen_client_read(instance, client);
+	}
+
+	return (0);
+}
+
+static int
+client_socket_write_cb(PRFileDesc *prfd, const PRPollDesc *pd, void *user_data1, void *user_data2)
+{
+	struct loadgen_instance *instance = (struct loadgen_instance *)user_data1;
+	struct loadgen_client *client = (struct loadgen_client *)user_data2;
+
+	if (!client->schedule_disconnect) {
+		(void)loadgen_client_write(instance, client);
+	}
+
+	return (0);
+}
+
+static int
+client_socket_err_cb(PRFileDesc *prfd, short revents, const PRPollDesc *pd, void *user_data1,
+    void *user_data2)
+{
+	struct loadgen_client *client = (struct loadgen_client *)user_data2;
+
+	loadgen_client_disconnect_error(client, "POLL_ERR (%u) on client socket", revents);
+
+	return (0);
+}
+
+static int
+loadgen_pre_poll_cb(void *user_data1, void *user_data2)
+{
+	struct loadgen_instance *instance = (struct loadgen_instance *)user_data1;
+	struct loadgen_client *client;
+	uint32_t cl, u32;
+
+	for (cl = 0; cl < instance->settings->clusters; cl++) {
+		for (u32 = 0; u32 < instance->settings->nodes; u32++) {
+			client = &instance->clusters[cl].clients[u32];
+
+			if (client->schedule_disconnect && client->socket != NULL) {
+				instance->stats.disconnects++;
+				loadgen_client_close(instance, client);
+			}
+		}
+	}
+
+	return (0);
+}
+
+static void
+loadgen_client_connect(struct loadgen_instance *instance, struct loadgen_client *client)
+{
+
+	client->socket = nss_sock_create_client_socket(instance->settings->host,
+	    instance->settings->port, PR_AF_UNSPEC,
+	    PR_MillisecondsToInterval(LOADGEN_CONNECT_TIMEOUT));
+	if (client->socket == NULL) {
+		instance->stats.connect_failures++;
+		client->state = LOADGEN_CLIENT_STATE_DISCONNECTED;
+
+		return ;
+	}
+
+	if (nss_sock_set_non_blocking(client->socket) != 0) {
+		errx(LOADGEN_EXIT_CODE_INTERNAL_ERROR, "Can't set client socket non blocking");
+	}
+
+	dynar_init(&client->receive_buffer, QDEVICE_NET_DEFAULT_INITIAL_MSG_RECEIVE_SIZE);
+	send_buffer_list_init(&client->send_buffer_list, QDEVICE_NET_DEFAULT_MAX_SEND_BUFFERS,
+	    QDEVICE_NET_DEFAULT_INITIAL_MSG_SEND_SIZE);
+
+	if (pr_poll_loop_add_prfd(&instance->main_poll_loop, client->socket, POLLIN,
+	    client_socket_set_events_cb, client_socket_read_cb, client_socket_write_cb,
+	    client_socket_err_cb, instance, client) != 0) {
+		errx(LOADGEN_EXIT_CODE_INTERNAL_ERROR, "Can't add client socket to poll loop");
+	}
+
+	client->state = LOADGEN_CLIENT_STATE_WAITING_PREINIT_REPLY;
+	(void)loadgen_client_send_preinit(client);
+}
+
+/*
+ * Apply scripted event to all clusters. New ring id is generated for every
+ * partition and all connected clients send new membership.
+ */
+static void
+loadgen_event_apply(struct loadgen_instance *instance, const struct loadgen_event *event)
+{
+	struct loadgen_cluster *cluster;
+	struct loadgen_client *client;
+	uint32_t cl, u32;
+
+	printf("Applying event %s",
+	    (event->type == LOADGEN_EVENT_TYPE_PARTITION ? "partition" : "heal"));
+	if (event->type == LOADGEN_EVENT_TYPE_PARTITION) {
+		printf(" (%"PRIu32" partitions)", event->partitions);
+	}
+	printf("\n");
+
+	for (cl = 0; cl < instance->settings->clusters; cl++) {
+		cluster = &instance->clusters[cl];
+		cluster->ring_seq++;
+		cluster->partitions = (event->partitions > instance->settings->nodes ?
+		    instance->settings->nodes : event->partitions);
+
+		for (u32 = 0; u32 < instance->settings->nodes; u32++) {
+			client = &cluster->clients[u32];
+
+			if (client->state == LOADGEN_CLIENT_STATE_CONNECTED &&
+			    !client->schedule_disconnect) {
+				(void)loadgen_client_send_membership(instance, client);
+			}
+		}
+	}
+}
+
+static int
+loadgen_tick_timer_callback(void *data1, void *data2)
+{
+	struct loadgen_instance *instance = (struct loadgen_instance *)data1;
+	const struct loadgen_settings *settings;
+	uint64_t now;
+	uint64_t elapsed;
+	size_t should_be_connected;
+	size_t cluster_index, node_index;
+
+	settings = instance->settings;
+	now = loadgen_time_us();
+	elapsed = now - instance->start_time;
+
+	/*
+	 * Ramp up connections
+	 */
+	should_be_connected = (size_t)((elapsed * settings->connect_rate) / 1000000) + 1;
+	while (instance->next_client_to_connect < instance->no_clients &&
+	    instance->next_client_to_connect < should_be_connected) {
+		cluster_index = instance->next_client_to_connect / settings->nodes;
+		node_index = instance->next_client_to_connect % settings->nodes;
+
+		loadgen_client_connect(instance,
+		    &instance->clusters[cluster_index].clients[node_index]);
+
+		instance->next_client_to_connect++;
+	}
+
+	while (instance->next_event < settings->no_events &&
+	    elapsed >= (uint64_t)settings->events[instance->next_event].time * 1000000) {
+		loadgen_event_apply(instance, &settings->events[instance->next_event]);
+		instance->next_event++;
+	}
+
+	if (settings->report_interval > 0 &&
+	    now - instance->last_report_time >= (uint64_t)settings->report_interval * 1000000) {
+		loadgen_report_interval(instance);
+	}
+
+	if (elapsed >= (uint64_t)settings->duration * 1000000 || loadgen_signal_received) {
+		instance->exit_requested = 1;
+	}
+
+	return (-1);
+}
+
+static void
+loadgen_instance_init(struct loadgen_instance *instance, const struct loadgen_settings *settings)
+{
+	struct loadgen_cluster *cluster;
+	uint32_t cl, u32;
+	char name[64];
+
+	memset(instance, 0, sizeof(*instance));
+	instance->settings = settings;
+	instance->no_clients = (size_t)settings->clusters * settings->nodes;
+
+	instance->clusters = calloc(settings->clusters, sizeof(*instance->clusters));
+	if (instance->clusters == NULL) {
+		errx(LOADGEN_EXIT_CODE_INTERNAL_ERROR, "Can't alloc memory for clusters");
+	}
+
+	for (cl = 0; cl < settings->clusters; cl++) {
+		cluster = &instance->clusters[cl];
+
+		snprintf(name, sizeof(name), "loadgen%"PRIu32, cl);
+		cluster->name = strdup(name);
+		cluster->clients = calloc(settings->nodes, sizeof(*cluster->clients));
+		if (cluster->name == NULL || cluster->clients == NULL) {
+			errx(LOADGEN_EXIT_CODE_INTERNAL_ERROR, "Can't alloc memory for cluster");
+		}
+
+		cluster->ring_seq = 1;
+		cluster->partitions = 1;
+
+		for (u32 = 0; u32 < settings->nodes; u32++) {
+			cluster->clients[u32].cluster = cluster;
+			cluster->clients[u32].node_id = u32 + 1;
+			cluster->clients[u32].state = LOADGEN_CLIENT_STATE_NOT_CONNECTED;
+		}
+	}
+
+	pr_poll_loop_init(&instance->main_poll_loop);
+
+	if (pr_poll_loop_add_pre_poll_cb(&instance->main_poll_loop, loadgen_pre_poll_cb,
+	    instance, NULL) != 0) {
+		errx(LOADGEN_EXIT_CODE_INTERNAL_ERROR, "Can't add pre poll callback");
+	}
+}
+
+static void
+loadgen_instance_destroy(struct loadgen_instance *instance)
+{
+	struct loadgen_cluster *cluster;
+	uint32_t cl, u32;
+
+	for (cl = 0; cl < instance->settings->clusters; cl++) {
+		cluster = &instance->clusters[cl];
+
+		for (u32 = 0; u32 < instance->settings->nodes; u32++) {
+			loadgen_client_close(instance, &cluster->clients[u32]);
+		}
+
+		free(cluster->clients);
+		free(cluster->name);
+	}
+
+	free(instance->clusters);
+	free(instance->stats.vote_latencies);
+
+	pr_poll_loop_destroy(&instance->main_poll_loop);
+}
+
+int
+main(int argc, char * const argv[])
+{
+	struct loadgen_settings settings;
+	struct loadgen_instance instance;
+	struct sigaction act;
+
+	cli_parse(argc, argv, &settings);
+
+	if (nss_sock_init_nss((settings.tls ? settings.nss_db_dir : NULL)) != 0) {
+		errx(LOADGEN_EXIT_CODE_INTERNAL_ERROR, "Can't init nss (%d)", PR_GetError());
+	}
+
+	memset(&act, 0, sizeof(act));
+	act.sa_handler = loadgen_signal_handler;
+	sigaction(SIGINT, &act, NULL);
+	sigaction(SIGTERM, &act, NULL);
+
+	act.sa_handler = SIG_IGN;
+	sigaction(SIGPIPE, &act, NULL);
+
+	loadgen_instance_init(&instance, &settings);
+
+	printf("Simulating %zu clients (%"PRIu32" clusters, %"PRIu32" nodes each) "
+	    "against %s:%"PRIu16" using %s algorithm, TLS %s\n",
+	    instance.no_clients, settings.clusters, settings.nodes, settings.host, settings.port,
+	    tlv_decision_algorithm_type_to_str(settings.algorithm), (settings.tls ? "on" : "off"));
+
+	instance.start_time = loadgen_time_us();
+	instance.last_report_time = instance.start_time;
+
+	if (timer_list_add(pr_poll_loop_get_timer_list(&instance.main_poll_loop),
+	    LOADGEN_TICK_INTERVAL, loadgen_tick_timer_callback, &instance, NULL) == NULL) {
+		errx(LOADGEN_EXIT_CODE_INTERNAL_ERROR, "Can't add tick timer");
+	}
+
+	/*
+	 * Connect first clients right away
+	 */
+	(void)loadgen_tick_timer_callback(&instance, NULL);
+
+	while (!instance.exit_requested) {
+		if (pr_poll_loop_exec(&instance.main_poll_loop) != 0 &&
+		    !loadgen_signal_received) {
+			errx(LOADGEN_EXIT_CODE_INTERNAL_ERROR, "Main poll loop failed");
+		}
+	}
+
+	loadgen_report_final(&instance);
+
+	loadgen_instance_destroy(&instance);
+
+	if (settings.tls) {
+		SSL_ClearSessionCache();
+	}
+
+	if (NSS_Shutdown() != SECSuccess) {
+		warnx("Can't shutdown NSS");
+	}
+
+	PR_Cleanup();
+
+	free(settings.host);
+	free(settings.nss_db_dir);
+
+	return (LOADGEN_EXIT_CODE_NO_ERROR);
+}
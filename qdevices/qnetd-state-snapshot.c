@@ -0,0 +1,596 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "log.h"
+#include "qnetd-state-snapshot.h"
+
+/*
+ * Header:
+ *  0 magic, 4 version, 8 header size, 12 record size, 16 number of records,
+ *  20 reserved, 24 save time (seconds since epoch, high and low 32 bits)
+ * Record:
+ *  0 node id, 4 decision algorithm, 5 last sent ACK/NACK vote, 6 cluster name length,
+ *  8 cluster name (not null terminated)
+ */
+
+static void
+qnetd_state_snapshot_put_u32(unsigned char *buf, uint32_t value)
+{
+	uint32_t nvalue;
+
+	nvalue = htonl(value);
+	memcpy(buf, &nvalue, sizeof(nvalue));
+}
+
+static uint32_t
+qnetd_state_snapshot_get_u32(const unsigned char *buf)
+{
+	uint32_t nvalue;
+
+	memcpy(&nvalue, buf, sizeof(nvalue));
+
+	return (ntohl(nvalue));
+}
+
+static void
+qnetd_state_snapshot_put_u16(unsigned char *buf, uint16_t value)
+{
+	uint16_t nvalue;
+
+	nvalue = htons(value);
+	memcpy(buf, &nvalue, sizeof(nvalue));
+}
+
+static uint16_t
+qnetd_state_snapshot_get_u16(const unsigned char *buf)
+{
+	uint16_t nvalue;
+
+	memcpy(&nvalue, buf, sizeof(nvalue));
+
+	return (ntohs(nvalue));
+}
+
+static int
+qnetd_state_snapshot_client_is_stored(const struct qnetd_client *client)
+{
+
+	return (client->init_received &&
+	    client->cluster_name_len > 0 &&
+	    client->cluster_name_len <= QNETD_STATE_SNAPSHOT_CLUSTER_NAME_LEN &&
+	    (client->last_sent_ack_nack_vote == TLV_VOTE_ACK ||
+	    client->last_sent_ack_nack_vote == TLV_VOTE_NACK));
+}
+
+void
+qnetd_state_snapshot_init(struct qnetd_state_snapshot *snapshot)
+{
+
+	memset(snapshot, 0, sizeof(*snapshot));
+
+	TAILQ_INIT(&snapshot->entries);
+}
+
+void
+qnetd_state_snapshot_destroy(struct qnetd_state_snapshot *snapshot)
+{
+	struct qnetd_state_snapshot_entry *entry;
+	struct qnetd_state_snapshot_entry *entry_next;
+
+	entry = TAILQ_FIRST(&snapshot->entries);
+
+	while (entry != NULL) {
+		entry_next = TAILQ_NEXT(entry, entries);
+
+		free(entry);
+
+		entry = entry_next;
+	}
+
+	TAILQ_INIT(&snapshot->entries);
+	snapshot->no_entries = 0;
+}
+
+/*
+ * Build snapshot of all clients in memory.
+ * Returns 0 on success, otherwise -1.
+ */
+static int
+qnetd_state_snapshot_build(const struct qnetd_client_list *clients, time_t save_time,
+    unsigned char **res_buf, size_t *res_buf_size)
+{
+	const struct qnetd_client *client;
+	unsigned char *buf;
+	unsigned char *rec;
+	size_t no_records;
+	size_t buf_size;
+
+	no_records = 0;
+	TAILQ_FOREACH(client, clients, entries) {
+		if (qnetd_state_snapshot_client_is_stored(client)) {
+			no_records++;
+		}
+	}
+
+	buf_size = QNETD_STATE_SNAPSHOT_HEADER_SIZE + no_records * QNETD_STATE_SNAPSHOT_RECORD_SIZE;
+	buf = calloc(1, buf_size);
+	if (buf == NULL) {
+		return (-1);
+	}
+
+	qnetd_state_snapshot_put_u32(buf, QNETD_STATE_SNAPSHOT_MAGIC);
+	qnetd_state_snapshot_put_u32(buf + 4, QNETD_STATE_SNAPSHOT_VERSION);
+	qnetd_state_snapshot_put_u32(buf + 8, QNETD_STATE_SNAPSHOT_HEADER_SIZE);
+	qnetd_state_snapshot_put_u32(buf + 12, QNETD_STATE_SNAPSHOT_RECORD_SIZE);
+	qnetd_state_snapshot_put_u32(buf + 16, no_records);
+	qnetd_state_snapshot_put_u32(buf + 24, (uint32_t)((uint64_t)save_time >> 32));
+	qnetd_state_snapshot_put_u32(buf + 28, (uint32_t)save_time);
+
+	rec = buf + QNETD_STATE_SNAPSHOT_HEADER_SIZE;
+	TAILQ_FOREACH(client, clients, entries) {
+		if (!qnetd_state_snapshot_client_is_stored(client)) {
+			continue;
+		}
+
+		qnetd_state_snapshot_put_u32(rec, client->node_id);
+		rec[4] = (unsigned char)client->decision_algorithm;
+		rec[5] = (unsigned char)client->last_sent_ack_nack_vote;
+		qnetd_state_snapshot_put_u16(rec + 6, (uint16_t)client->cluster_name_len);
+		memcpy(rec + 8, client->cluster_name, client->cluster_name_len);
+
+		rec += QNETD_STATE_SNAPSHOT_RECORD_SIZE;
+	}
+
+	*res_buf = buf;
+	*res_buf_size = buf_size;
+
+	return (0);
+}
+
+/*
+ * Make rename of file_name durable
+ */
+static int
+qnetd_state_snapshot_fsync_dir(const char *file_name)
+{
+	char *file_name_copy;
+	int fd;
+	int res;
+	int saved_errno;
+
+	file_name_copy = strdup(file_name);
+	if (file_name_copy == NULL) {
+		return (-1);
+	}
+
+	fd = open(dirname(file_name_copy), O_RDONLY | O_DIRECTORY);
+	free(file_name_copy);
+	if (fd == -1) {
+		return (-1);
+	}
+
+	res = fsync(fd);
+	saved_errno = errno;
+	close(fd);
+	errno = saved_errno;
+
+	return (res);
+}
+
+/*
+ * Write buf into file_name. Data are first written and synced into temporary
+ * file which is then renamed, so reader never sees partially written snapshot
+ * and crash never leaves empty one.
+ * Returns 0 on success, otherwise -1 (errno is set).
+ */
+static int
+qnetd_state_snapshot_write(const char *file_name, const unsigned char *buf, size_t buf_size)
+{
+	char *tmp_file_name;
+	size_t written;
+	ssize_t res;
+	int fd;
+	int saved_errno;
+
+	tmp_file_name = malloc(strlen(file_name) + strlen(".tmp") + 1);
+	if (tmp_file_name == NULL) {
+		return (-1);
+	}
+	sprintf(tmp_file_name, "%s.tmp", file_name);
+
+	fd = open(tmp_file_name, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	if (fd == -1) {
+		goto err_free;
+	}
+
+	written = 0;
+	while (written < buf_size) {
+		res = write(fd, buf + written, buf_size - written);
+		if (res == -1) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			goto err_close;
+		}
+
+		written += res;
+	}
+
+	if (fsync(fd) != 0) {
+		goto err_close;
+	}
+
+	if (close(fd) != 0) {
+		goto err_unlink;
+	}
+
+	if (rename(tmp_file_name, file_name) != 0) {
+		goto err_unlink;
+	}
+
+	free(tmp_file_name);
+
+	return (qnetd_state_snapshot_fsync_dir(file_name));
+
+err_close:
+	saved_errno = errno;
+	close(fd);
+	errno = saved_errno;
+err_unlink:
+	saved_errno = errno;
+	unlink(tmp_file_name);
+	errno = saved_errno;
+err_free:
+	saved_errno = errno;
+	free(tmp_file_name);
+	errno = saved_errno;
+
+	return (-1);
+}
+
+/*
+ * Write state of all clients into file_name.
+ * Returns 0 on success, otherwise -1 (errno is set).
+ */
+int
+qnetd_state_snapshot_save(const struct qnetd_client_list *clients, const char *file_name)
+{
+	unsigned char *buf;
+	size_t buf_size;
+	int res;
+	int saved_errno;
+
+	if (qnetd_state_snapshot_build(clients, time(NULL), &buf, &buf_size) != 0) {
+		return (-1);
+	}
+
+	res = qnetd_state_snapshot_write(file_name, buf, buf_size);
+	saved_errno = errno;
+	free(buf);
+	errno = saved_errno;
+
+	return (res);
+}
+
+void
+qnetd_state_snapshot_save_cache_init(struct qnetd_state_snapshot_save_cache *cache)
+{
+
+	memset(cache, 0, sizeof(*cache));
+}
+
+void
+qnetd_state_snapshot_save_cache_destroy(struct qnetd_state_snapshot_save_cache *cache)
+{
+
+	free(cache->data);
+	qnetd_state_snapshot_save_cache_init(cache);
+}
+
+/*
+ * Compare snapshots ignoring save time
+ */
+static int
+qnetd_state_snapshot_buf_equal(const unsigned char *buf1, size_t buf1_size,
+    const unsigned char *buf2, size_t buf2_size)
+{
+
+	return (buf1_size == buf2_size &&
+	    memcmp(buf1, buf2, 24) == 0 &&
+	    memcmp(buf1 + QNETD_STATE_SNAPSHOT_HEADER_SIZE, buf2 + QNETD_STATE_SNAPSHOT_HEADER_SIZE,
+	    buf1_size - QNETD_STATE_SNAPSHOT_HEADER_SIZE) == 0);
+}
+
+/*
+ * Periodic save. Snapshot is written only when state of clients changed since last
+ * write or when last write is older than refresh_interval seconds (so save time
+ * stays within max age of the reader). 0 refresh_interval means unchanged state is
+ * never rewritten.
+ * Returns 1 if snapshot was written, 0 if write was skipped, -1 on error (errno is set).
+ */
+int
+qnetd_state_snapshot_save_if_changed(const struct qnetd_client_list *clients,
+    const char *file_name, struct qnetd_state_snapshot_save_cache *cache,
+    uint32_t refresh_interval)
+{
+	unsigned char *buf;
+	size_t buf_size;
+	time_t now;
+	int saved_errno;
+
+	now = time(NULL);
+
+	if (qnetd_state_snapshot_build(clients, now, &buf, &buf_size) != 0) {
+		return (-1);
+	}
+
+	if (cache->data != NULL &&
+	    qnetd_state_snapshot_buf_equal(buf, buf_size, cache->data, cache->size) &&
+	    (refresh_interval == 0 ||
+	    (now >= cache->save_time && now - cache->save_time < refresh_interval))) {
+		free(buf);
+
+		return (0);
+	}
+
+	if (qnetd_state_snapshot_write(file_name, buf, buf_size) != 0) {
+		saved_errno = errno;
+		free(buf);
+		errno = saved_errno;
+
+		return (-1);
+	}
+
+	free(cache->data);
+	cache->data = buf;
+	cache->size = buf_size;
+	cache->save_time = now;
+
+	return (1);
+}
+
+static int
+qnetd_state_snapshot_parse(struct qnetd_state_snapshot *snapshot, const unsigned char *buf,
+    size_t buf_size, uint32_t max_age)
+{
+	struct qnetd_state_snapshot_entry *entry;
+	const unsigned char *rec;
+	uint32_t no_records;
+	uint32_t zi;
+	size_t cluster_name_len;
+	uint64_t save_time;
+	time_t now;
+
+	if (buf_size < QNETD_STATE_SNAPSHOT_HEADER_SIZE ||
+	    qnetd_state_snapshot_get_u32(buf) != QNETD_STATE_SNAPSHOT_MAGIC) {
+		log(LOG_WARNING, "State snapshot has invalid header");
+
+		return (-1);
+	}
+
+	if (qnetd_state_snapshot_get_u32(buf + 4) != QNETD_STATE_SNAPSHOT_VERSION ||
+	    qnetd_state_snapshot_get_u32(buf + 8) != QNETD_STATE_SNAPSHOT_HEADER_SIZE ||
+	    qnetd_state_snapshot_get_u32(buf + 12) != QNETD_STATE_SNAPSHOT_RECORD_SIZE) {
+		log(LOG_WARNING, "State snapshot has unsupported version %u",
+		    qnetd_state_snapshot_get_u32(buf + 4));
+
+		return (-1);
+	}
+
+	no_records = qnetd_state_snapshot_get_u32(buf + 16);
+	if ((buf_size - QNETD_STATE_SNAPSHOT_HEADER_SIZE) / QNETD_STATE_SNAPSHOT_RECORD_SIZE !=
+	    no_records ||
+	    (buf_size - QNETD_STATE_SNAPSHOT_HEADER_SIZE) % QNETD_STATE_SNAPSHOT_RECORD_SIZE != 0) {
+		log(LOG_WARNING, "State snapshot is truncated");
+
+		return (-1);
+	}
+
+	save_time = ((uint64_t)qnetd_state_snapshot_get_u32(buf + 24) << 32) |
+	    qnetd_state_snapshot_get_u32(buf + 28);
+	snapshot->save_time = (time_t)save_time;
+
+	now = time(NULL);
+	if (max_age != 0 && (now < snapshot->save_time || now - snapshot->save_time > max_age)) {
+		log(LOG_INFO, "State snapshot is too old (saved %lld s ago), ignoring it",
+		    (long long int)(now - snapshot->save_time));
+
+		return (0);
+	}
+
+	rec = buf + QNETD_STATE_SNAPSHOT_HEADER_SIZE;
+	for (zi = 0; zi < no_records; zi++, rec += QNETD_STATE_SNAPSHOT_RECORD_SIZE) {
+		cluster_name_len = qnetd_state_snapshot_get_u16(rec + 6);
+
+		if (cluster_name_len == 0 ||
+		    cluster_name_len > QNETD_STATE_SNAPSHOT_CLUSTER_NAME_LEN ||
+		    (rec[5] != TLV_VOTE_ACK && rec[5] != TLV_VOTE_NACK)) {
+			log(LOG_DEBUG, "Skipping invalid state snapshot record %"PRIu32, zi);
+
+			continue;
+		}
+
+		entry = malloc(sizeof(*entry));
+		if (entry == NULL) {
+			return (-1);
+		}
+
+		memset(entry, 0, sizeof(*entry));
+		entry->node_id = qnetd_state_snapshot_get_u32(rec);
+		entry->decision_algorithm = (enum tlv_decision_algorithm_type)rec[4];
+		entry->last_sent_ack_nack_vote = (enum tlv_vote)rec[5];
+		memcpy(entry->cluster_name, rec + 8, cluster_name_len);
+
+		TAILQ_INSERT_TAIL(&snapshot->entries, entry, entries);
+		snapshot->no_entries++;
+	}
+
+	return (0);
+}
+
+/*
+ * Load snapshot from file_name. Missing file is not an error (nothing is loaded).
+ * Snapshot older than max_age seconds is ignored (0 means no limit). Loaded entries
+ * are restored only during restore_grace seconds after load and only while snapshot
+ * is not older than max_age (see qnetd_state_snapshot_expire).
+ * Returns 0 on success, otherwise -1.
+ */
+int
+qnetd_state_snapshot_load(struct qnetd_state_snapshot *snapshot, const char *file_name,
+    uint32_t max_age, uint32_t restore_grace)
+{
+	struct stat st;
+	void *buf;
+	int fd;
+	int res;
+
+	fd = open(file_name, O_RDONLY);
+	if (fd == -1) {
+		if (errno == ENOENT) {
+			return (0);
+		}
+
+		log_err(LOG_WARNING, "Can't open state snapshot");
+		return (-1);
+	}
+
+	if (fstat(fd, &st) != 0) {
+		log_err(LOG_WARNING, "Can't stat state snapshot");
+		close(fd);
+		return (-1);
+	}
+
+	if (st.st_size < QNETD_STATE_SNAPSHOT_HEADER_SIZE) {
+		log(LOG_WARNING, "State snapshot is too short");
+		close(fd);
+		return (-1);
+	}
+
+	buf = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (buf == MAP_FAILED) {
+		log_err(LOG_WARNING, "Can't map state snapshot");
+		return (-1);
+	}
+
+	res = qnetd_state_snapshot_parse(snapshot, buf, st.st_size, max_age);
+
+	munmap(buf, st.st_size);
+
+	if (res != 0) {
+		qnetd_state_snapshot_destroy(snapshot);
+	}
+
+	snapshot->load_time = time(NULL);
+	snapshot->max_age = max_age;
+	snapshot->restore_grace = restore_grace;
+
+	return (res);
+}
+
+/*
+ * Drop all entries of snapshot when restore grace period passed or snapshot became
+ * older than max age, so client reconnecting long after restart doesn't get stale vote.
+ * Returns 1 if entries were dropped, otherwise 0.
+ */
+int
+qnetd_state_snapshot_expire(struct qnetd_state_snapshot *snapshot, time_t now)
+{
+
+	if (snapshot->no_entries == 0) {
+		return (0);
+	}
+
+	if (now >= snapshot->load_time && now - snapshot->load_time <= snapshot->restore_grace &&
+	    (snapshot->max_age == 0 ||
+	    (now >= snapshot->save_time && now - snapshot->save_time <= snapshot->max_age))) {
+		return (0);
+	}
+
+	log(LOG_INFO, "State snapshot expired. Dropping state of %zu not reconnected clients",
+	    snapshot->no_entries);
+
+	qnetd_state_snapshot_destroy(snapshot);
+
+	return (1);
+}
+
+/*
+ * Restore state of client from snapshot. Matching entry is removed so state is
+ * restored only for the first connection after restart.
+ * Returns 1 if state was restored, otherwise 0.
+ */
+int
+qnetd_state_snapshot_restore_client(struct qnetd_state_snapshot *snapshot,
+    struct qnetd_client *client)
+{
+	struct qnetd_state_snapshot_entry *entry;
+
+	(void)qnetd_state_snapshot_expire(snapshot, time(NULL));
+
+	TAILQ_FOREACH(entry, &snapshot->entries, entries) {
+		if (entry->node_id == client->node_id &&
+		    entry->decision_algorithm == client->decision_algorithm &&
+		    strcmp(entry->cluster_name, client->cluster_name) == 0) {
+			break;
+		}
+	}
+
+	if (entry == NULL) {
+		return (0);
+	}
+
+	client->last_sent_ack_nack_vote = entry->last_sent_ack_nack_vote;
+
+	TAILQ_REMOVE(&snapshot->entries, entry, entries);
+	snapshot->no_entries--;
+	free(entry);
+
+	return (1);
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _QNETD_STATE_SNAPSHOT_H_
+#define _QNETD_STATE_SNAPSHOT_H_
+
+#include <sys/types.h>
+#include <sys/queue.h>
+
+#include <inttypes.h>
+#include <time.h>
+
+#include "qnetd-client.h"
+#include "qnetd-client-list.h"
+#include "tlv.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Snapshot file consists of fixed size header followed by fixed size records, so it
+ * can be mapped into memory and accessed directly. All numbers are stored in network
+ * byte order.
+ */
+#define QNETD_STATE_SNAPSHOT_MAGIC		0x514e5353	/* "QNSS" */
+#define QNETD_STATE_SNAPSHOT_VERSION		1
+#define QNETD_STATE_SNAPSHOT_HEADER_SIZE	32
+#define QNETD_STATE_SNAPSHOT_RECORD_SIZE	72
+#define QNETD_STATE_SNAPSHOT_CLUSTER_NAME_LEN	64
+
+struct qnetd_state_snapshot_entry {
+	char cluster_name[QNETD_STATE_SNAPSHOT_CLUSTER_NAME_LEN + 1];
+	uint32_t node_id;
+	enum tlv_decision_algorithm_type decision_algorithm;
+	enum tlv_vote last_sent_ack_nack_vote;
+	TAILQ_ENTRY(qnetd_state_snapshot_entry) entries;
+};
+
+TAILQ_HEAD(qnetd_state_snapshot_entry_list, qnetd_state_snapshot_entry);
+
+struct qnetd_state_snapshot {
+	struct qnetd_state_snapshot_entry_list entries;
+	size_t no_entries;
+	time_t save_time;
+	time_t load_time;
+	uint32_t max_age;
+	uint32_t restore_grace;
+};
+
+/*
+ * Content of last written snapshot, used to skip periodic writes of unchanged state
+ */
+struct qnetd_state_snapshot_save_cache {
+	unsigned char *data;
+	size_t size;
+	time_t save_time;
+};
+
+extern void		qnetd_state_snapshot_init(struct qnetd_state_snapshot *snapshot);
+
+extern void		qnetd_state_snapshot_destroy(struct qnetd_state_snapshot *snapshot);
+
+extern int		qnetd_state_snapshot_save(const struct qnetd_client_list *clients,
+    const char *file_name);
+
+extern void		qnetd_state_snapshot_save_cache_init(
+    struct qnetd_state_snapshot_save_cache *cache);
+
+extern void		qnetd_state_snapshot_save_cache_destroy(
+    struct qnetd_state_snapshot_save_cache *cache);
+
+extern int		qnetd_state_snapshot_save_if_changed(
+    const struct qnetd_client_list *clients, const char *file_name,
+    struct qnetd_state_snapshot_save_cache *cache, uint32_t refresh_interval);
+
+extern int		qnetd_state_snapshot_load(struct qnetd_state_snapshot *snapshot,
+    const char *file_name, uint32_t max_age, uint32_t restore_grace);
+
+extern int		qnetd_state_snapshot_expire(struct qnetd_state_snapshot *snapshot,
+    time_t now);
+
+extern int		qnetd_state_snapshot_restore_client(
+    struct qnetd_state_snapshot *snapshot, struct qnetd_client *client);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _QNETD_STATE_SNAPSHOT_H_ */
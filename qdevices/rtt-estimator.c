@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+
+#include "rtt-estimator.h"
+
+void
+rtt_estimator_init(struct rtt_estimator *est)
+{
+
+	memset(est, 0, sizeof(*est));
+}
+
+void
+rtt_estimator_add_sample(struct rtt_estimator *est, uint64_t rtt)
+{
+	uint64_t delta;
+
+	if (est->no_samples == 0) {
+		est->srtt = rtt;
+		est->rttvar = rtt / 2;
+		est->min_rtt = rtt;
+		est->max_rtt = rtt;
+	} else {
+		delta = (est->srtt > rtt ? est->srtt - rtt : rtt - est->srtt);
+
+		/*
+		 * rttvar = 3/4 * rttvar + 1/4 * |srtt - rtt|, srtt = 7/8 * srtt + 1/8 * rtt
+		 */
+		est->rttvar = (3 * est->rttvar + delta) / 4;
+		est->srtt = (7 * est->srtt + rtt) / 8;
+
+		if (rtt < est->min_rtt) {
+			est->min_rtt = rtt;
+		}
+
+		if (rtt > est->max_rtt) {
+			est->max_rtt = rtt;
+		}
+	}
+
+	est->last_rtt = rtt;
+
+	if (est->no_samples < UINT32_MAX) {
+		est->no_samples++;
+	}
+}
+
+/*
+ * Returns retransmission timeout (srtt + 4 * rttvar) or 0 if there is no sample yet
+ */
+uint64_t
+rtt_estimator_get_rto(const struct rtt_estimator *est)
+{
+
+	if (est->no_samples == 0) {
+		return (0);
+	}
+
+	return (est->srtt + 4 * est->rttvar);
+}
+
+/*
+ * Returns rto_multiplier * RTO rounded up to ms and bounded by <min_timeout, max_timeout>.
+ * When min_timeout is bigger than max_timeout, max_timeout wins.
+ */
+uint32_t
+rtt_estimator_get_timeout_ms(const struct rtt_estimator *est, uint32_t rto_multiplier,
+    uint32_t min_timeout, uint32_t max_timeout)
+{
+	uint64_t timeout;
+
+	timeout = (rtt_estimator_get_rto(est) * rto_multiplier + 999) / 1000;
+
+	if (timeout < min_timeout) {
+		timeout = min_timeout;
+	}
+
+	if (timeout > max_timeout) {
+		timeout = max_timeout;
+	}
+
+	return ((uint32_t)timeout);
+}
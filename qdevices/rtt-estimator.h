@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTT_ESTIMATOR_H_
+#define _RTT_ESTIMATOR_H_
+
+#include <inttypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Round trip time estimator using smoothed RTT and RTT variance (same as TCP,
+ * RFC 6298). All values are in microseconds.
+ */
+struct rtt_estimator {
+	uint64_t srtt;
+	uint64_t rttvar;
+	uint64_t last_rtt;
+	uint64_t min_rtt;
+	uint64_t max_rtt;
+	uint32_t no_samples;
+};
+
+extern void		rtt_estimator_init(struct rtt_estimator *est);
+
+extern void		rtt_estimator_add_sample(struct rtt_estimator *est, uint64_t rtt);
+
+extern uint64_t		rtt_estimator_get_rto(const struct rtt_estimator *est);
+
+extern uint32_t		rtt_estimator_get_timeout_ms(const struct rtt_estimator *est,
+    uint32_t rto_multiplier, uint32_t min_timeout, uint32_t max_timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTT_ESTIMATOR_H_ */
@@ -47,6 +47,7 @@ main(void)
 	struct dynar_simple_lex lex;
 	struct dynar *output_str_ptr;
 	struct dynar output_str;
+	struct dynar output_str2;
 	const char *cstr;
 
 	dynar_init(&input_str, 128);
@@ -284,6 +285,22 @@ main(void)
 	assert(strcmp(dynar_data(output_str_ptr), "") == 0);
 	dynar_simple_lex_destroy(&lex);
 
+	dynar_clean(&output_str);
+	assert(dynar_str_json_quote_cat(&output_str, "abcd") == 0);
+	assert(dynar_size(&output_str) == 6);
+	assert(memcmp(dynar_data(&output_str), "\"abcd\"", dynar_size(&output_str)) == 0);
+
+	dynar_clean(&output_str);
+	assert(dynar_str_json_quote_cat(&output_str, "a\"b\\c\nd\te\x01") == 0);
+	assert(dynar_size(&output_str) == 21);
+	assert(memcmp(dynar_data(&output_str), "\"a\\\"b\\\\c\\nd\\te\\u0001\"",
+	    dynar_size(&output_str)) == 0);
+
+	dynar_init(&output_str2, 5);
+	assert(dynar_str_json_quote_cat(&output_str2, "abc") == 0);
+	assert(dynar_str_json_quote_cat(&output_str2, "") != 0);
+	dynar_destroy(&output_str2);
+
 	dynar_destroy(&input_str);
 	dynar_destroy(&output_str);
 
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <string.h>
+
+#include "dynar.h"
+#include "flight-recorder.h"
+
+#define TEST_FLIGHT_RECORDER_SIZE	4
+
+static size_t
+count_lines(const struct dynar *str)
+{
+	size_t zi;
+	size_t lines;
+
+	lines = 0;
+	for (zi = 0; zi < dynar_size(str); zi++) {
+		if (dynar_data(str)[zi] == '\n') {
+			lines++;
+		}
+	}
+
+	return (lines);
+}
+
+int
+main(void)
+{
+	struct dynar str;
+	struct msg_decoded msg;
+	char node_str[32];
+	size_t full_dump_size;
+	uint32_t i;
+
+	dynar_init(&str, 65536);
+
+	/*
+	 * Disabled flight recorder
+	 */
+	assert(flight_recorder_init(0) == 0);
+	assert(flight_recorder_get_size() == 0);
+	flight_recorder_record_event(FLIGHT_RECORDER_EVENT_TYPE_CONNECTED, "cluster", 1);
+	assert(flight_recorder_get_no_events() == 0);
+	assert(flight_recorder_dump(&str) == 0);
+	assert(count_lines(&str) == 3);
+	dynar_clean(&str);
+
+	/*
+	 * Not yet wrapped ring
+	 */
+	assert(flight_recorder_init(TEST_FLIGHT_RECORDER_SIZE) == 0);
+	assert(flight_recorder_get_size() == TEST_FLIGHT_RECORDER_SIZE);
+
+	flight_recorder_record_event(FLIGHT_RECORDER_EVENT_TYPE_CONNECTED, "cluster", 1);
+
+	memset(&msg, 0, sizeof(msg));
+	msg.type = MSG_TYPE_ASK_FOR_VOTE;
+	msg.seq_number_set = 1;
+	msg.seq_number = 5;
+	flight_recorder_record_msg(FLIGHT_RECORDER_EVENT_TYPE_MSG_RECEIVED, "cluster", 1, &msg);
+
+	assert(flight_recorder_get_no_events() == 2);
+	assert(flight_recorder_dump(&str) == 0);
+	assert(count_lines(&str) == 3 + 2);
+	assert(strstr(dynar_data(&str), "connect") != NULL);
+	assert(strstr(dynar_data(&str), "seq=5") != NULL);
+	assert(strstr(dynar_data(&str), "vote=") == NULL);
+	dynar_clean(&str);
+
+	/*
+	 * Wrapped ring keeps only newest events in chronological order
+	 */
+	for (i = 0; i < 10; i++) {
+		flight_recorder_record_msg_info(FLIGHT_RECORDER_EVENT_TYPE_MSG_SENT,
+		    "cluster-with-very-long-name-which-doesnt-fit-into-event", 100 + i,
+		    MSG_TYPE_VOTE_INFO, 1, i, 1, TLV_VOTE_ACK);
+	}
+
+	assert(flight_recorder_get_no_events() == 12);
+	assert(flight_recorder_dump(&str) == 0);
+	assert(count_lines(&str) == 3 + TEST_FLIGHT_RECORDER_SIZE);
+	assert(strstr(dynar_data(&str), "node_id=105") == NULL);
+	for (i = 6; i < 10; i++) {
+		snprintf(node_str, sizeof(node_str), "node_id=%u", 100 + i);
+		assert(strstr(dynar_data(&str), node_str) != NULL);
+	}
+	assert(strstr(dynar_data(&str), "node_id=106") < strstr(dynar_data(&str), "node_id=109"));
+	assert(strstr(dynar_data(&str), "vote=ACK") != NULL);
+	full_dump_size = dynar_size(&str);
+	dynar_clean(&str);
+
+	/*
+	 * Smaller output buffer gets only newest events
+	 */
+	dynar_set_max_size(&str, full_dump_size - 1);
+	assert(flight_recorder_dump(&str) == 0);
+	assert(count_lines(&str) > 3 && count_lines(&str) < 3 + TEST_FLIGHT_RECORDER_SIZE);
+	snprintf(node_str, sizeof(node_str), "Shown events:\t%zu\n", count_lines(&str) - 3);
+	assert(strstr(dynar_data(&str), node_str) != NULL);
+	assert(strstr(dynar_data(&str), "node_id=106") == NULL);
+	assert(strstr(dynar_data(&str), "node_id=109") != NULL);
+	dynar_clean(&str);
+
+	dynar_set_max_size(&str, 128);
+	assert(flight_recorder_dump(&str) == 0);
+	assert(count_lines(&str) == 3);
+	assert(strstr(dynar_data(&str), "Shown events:\t0\n") != NULL);
+	dynar_clean(&str);
+
+	/*
+	 * Too small output buffer
+	 */
+	dynar_set_max_size(&str, 16);
+	assert(flight_recorder_dump(&str) == -1);
+
+	flight_recorder_destroy();
+	assert(flight_recorder_get_size() == 0);
+
+	dynar_destroy(&str);
+
+	return (0);
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "qdevice-heuristics-exec-list.h"
+#include "qdevice-heuristics-history.h"
+
+static void
+add_sample(struct qdevice_heuristics_history *history, const char *name, const char *command,
+    enum qdevice_heuristics_exec_entry_result result, uint32_t duration)
+{
+	struct qdevice_heuristics_history_sample sample;
+
+	memset(&sample, 0, sizeof(sample));
+	sample.time = 1;
+	sample.result = result;
+	sample.exit_status = (result == QDEVICE_HEURISTICS_EXEC_ENTRY_RESULT_PASS ? 0 : 1);
+	sample.duration = duration;
+
+	assert(qdevice_heuristics_history_add(history, name, command, &sample) == 0);
+}
+
+int
+main(void)
+{
+	struct qdevice_heuristics_history history;
+	struct qdevice_heuristics_history_entry *entry;
+	struct qdevice_heuristics_history_stats stats;
+	struct qdevice_heuristics_exec_list exec_list;
+	const struct qdevice_heuristics_history_sample *sample;
+	char name[16];
+	char command[16];
+	uint32_t zi;
+
+	qdevice_heuristics_history_init(&history, 100);
+
+	/*
+	 * Not full ring
+	 */
+	add_sample(&history, "a", "cmd_a", QDEVICE_HEURISTICS_EXEC_ENTRY_RESULT_PASS, 10);
+	add_sample(&history, "a", "cmd_a", QDEVICE_HEURISTICS_EXEC_ENTRY_RESULT_FAIL, 30);
+	add_sample(&history, "a", "cmd_a", QDEVICE_HEURISTICS_EXEC_ENTRY_RESULT_NOT_FINISHED, 2000);
+
+	entry = TAILQ_FIRST(&history.entries);
+	assert(entry != NULL && strcmp(entry->name, "a") == 0);
+	assert(entry->no_samples == 3 && entry->total_execs == 3);
+
+	assert(qdevice_heuristics_history_entry_get_sample(entry, 0)->duration == 2000);
+	assert(qdevice_heuristics_history_entry_get_sample(entry, 1)->duration == 30);
+	assert(qdevice_heuristics_history_entry_get_sample(entry, 2)->duration == 10);
+	assert(qdevice_heuristics_history_entry_get_sample(entry, 3) == NULL);
+
+	assert(qdevice_heuristics_history_entry_get_stats(entry, &stats) == 0);
+	assert(stats.no_samples == 3);
+	assert(stats.no_pass == 1 && stats.no_fail == 1 && stats.no_not_finished == 1);
+	assert(stats.min_duration == 10 && stats.max_duration == 30);
+	assert(stats.avg_duration == 20 && stats.p99_duration == 30);
+
+	/*
+	 * Full ring keeps only newest samples. Durations 1..250 -> ring holds 151..250
+	 */
+	for (zi = 1; zi <= 250; zi++) {
+		add_sample(&history, "b", "cmd_b", QDEVICE_HEURISTICS_EXEC_ENTRY_RESULT_PASS, zi);
+	}
+
+	entry = TAILQ_NEXT(TAILQ_FIRST(&history.entries), entries);
+	assert(entry != NULL && strcmp(entry->name, "b") == 0);
+	assert(entry->no_samples == 100 && entry->total_execs == 250);
+
+	for (zi = 0; zi < 100; zi++) {
+		sample = qdevice_heuristics_history_entry_get_sample(entry, zi);
+		assert(sample != NULL && sample->duration == 250 - zi);
+	}
+	assert(qdevice_heuristics_history_entry_get_sample(entry, 100) == NULL);
+
+	assert(qdevice_heuristics_history_entry_get_stats(entry, &stats) == 0);
+	assert(stats.no_samples == 100 && stats.no_pass == 100);
+	assert(stats.min_duration == 151 && stats.max_duration == 250);
+	assert(stats.avg_duration == 200);
+	assert(stats.p99_duration == 249);
+
+	/*
+	 * Only not finished samples -> no duration statistics
+	 */
+	add_sample(&history, "c", "cmd_c", QDEVICE_HEURISTICS_EXEC_ENTRY_RESULT_NOT_FINISHED, 5000);
+	entry = TAILQ_LAST(&history.entries, qdevice_heuristics_history_entry_head);
+	assert(strcmp(entry->name, "c") == 0);
+	assert(qdevice_heuristics_history_entry_get_stats(entry, &stats) == 0);
+	assert(stats.no_samples == 1 && stats.no_not_finished == 1);
+	assert(stats.min_duration == 0 && stats.max_duration == 0);
+	assert(stats.avg_duration == 0 && stats.p99_duration == 0);
+
+	/*
+	 * Changed command resets history
+	 */
+	add_sample(&history, "a", "cmd_a2", QDEVICE_HEURISTICS_EXEC_ENTRY_RESULT_PASS, 5);
+	entry = TAILQ_LAST(&history.entries, qdevice_heuristics_history_entry_head);
+	assert(strcmp(entry->name, "a") == 0 && entry->no_samples == 1);
+	assert(strcmp(TAILQ_FIRST(&history.entries)->name, "b") == 0);
+
+	/*
+	 * Prune removes heuristics not in exec list
+	 */
+	qdevice_heuristics_exec_list_init(&exec_list);
+	strcpy(name, "b");
+	strcpy(command, "cmd_b");
+	assert(qdevice_heuristics_exec_list_add(&exec_list, name, command) != NULL);
+
+	qdevice_heuristics_history_prune(&history, &exec_list);
+	entry = TAILQ_FIRST(&history.entries);
+	assert(entry != NULL && strcmp(entry->name, "b") == 0);
+	assert(TAILQ_NEXT(entry, entries) == NULL);
+
+	qdevice_heuristics_history_prune(&history, NULL);
+	assert(TAILQ_EMPTY(&history.entries));
+
+	qdevice_heuristics_exec_list_free(&exec_list);
+	qdevice_heuristics_history_destroy(&history);
+
+	/*
+	 * Disabled history
+	 */
+	qdevice_heuristics_history_init(&history, 0);
+	add_sample(&history, "a", "cmd_a", QDEVICE_HEURISTICS_EXEC_ENTRY_RESULT_PASS, 10);
+	assert(TAILQ_EMPTY(&history.entries));
+	qdevice_heuristics_history_destroy(&history);
+
+	return (0);
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "dynar.h"
+#include "qdevice-heuristics-exec-list.h"
+#include "qdevice-heuristics-msg.h"
+
+#define MAX_MSG_SIZE	(1 << 16)
+
+static void
+decode_first(struct dynar *buf, struct qdevice_heuristics_msg_decoded *decoded_msg)
+{
+	size_t msg_len;
+
+	msg_len = qdevice_heuristics_msg_get_complete_len(buf);
+	assert(msg_len > 0);
+
+	qdevice_heuristics_msg_decoded_init(decoded_msg);
+	assert(qdevice_heuristics_msg_decode(dynar_data(buf), msg_len, decoded_msg) == 0);
+
+	qdevice_heuristics_msg_remove_from_buffer(buf, msg_len);
+}
+
+int
+main(void)
+{
+	struct dynar msg;
+	struct dynar buf;
+	struct qdevice_heuristics_msg_decoded decoded_msg;
+	struct qdevice_heuristics_exec_list exec_list;
+	struct qdevice_heuristics_exec_list_entry *entry;
+	char name[16];
+	char command[32];
+	size_t zi;
+
+	dynar_init(&msg, MAX_MSG_SIZE);
+	dynar_init(&buf, MAX_MSG_SIZE * 4);
+	qdevice_heuristics_exec_list_init(&exec_list);
+
+	/*
+	 * Queue few messages into one buffer
+	 */
+	assert(qdevice_heuristics_msg_create_exec_list_clear(&msg) > 0);
+	assert(dynar_cat(&buf, dynar_data(&msg), dynar_size(&msg)) == 0);
+
+	assert(qdevice_heuristics_msg_create_exec_list_add(&msg, "check1",
+	    "/bin/true \"with space\"", QDEVICE_HEURISTICS_EXEC_TYPE_PERSISTENT) > 0);
+	assert(dynar_cat(&buf, dynar_data(&msg), dynar_size(&msg)) == 0);
+
+	assert(qdevice_heuristics_msg_create_exec(&msg, 5000, 42) > 0);
+	assert(dynar_cat(&buf, dynar_data(&msg), dynar_size(&msg)) == 0);
+
+	assert(qdevice_heuristics_msg_create_log(&msg, 7, "line1\nline2") > 0);
+	assert(dynar_cat(&buf, dynar_data(&msg), dynar_size(&msg)) == 0);
+
+	/*
+	 * Incomplete message is not returned
+	 */
+	assert(qdevice_heuristics_msg_create_exec(&msg, 1, 2) > 0);
+	assert(dynar_cat(&buf, dynar_data(&msg), dynar_size(&msg) - 1) == 0);
+
+	decode_first(&buf, &decoded_msg);
+	assert(decoded_msg.type == QDEVICE_HEURISTICS_MSG_TYPE_EXEC_LIST_CLEAR);
+	qdevice_heuristics_msg_decoded_destroy(&decoded_msg);
+
+	decode_first(&buf, &decoded_msg);
+	assert(decoded_msg.type == QDEVICE_HEURISTICS_MSG_TYPE_EXEC_LIST_ADD);
+	assert(strcmp(decoded_msg.exec_name, "check1") == 0);
+	assert(strcmp(decoded_msg.exec_command, "/bin/true \"with space\"") == 0);
+	assert(decoded_msg.exec_type_set);
+	assert(decoded_msg.exec_type == QDEVICE_HEURISTICS_EXEC_TYPE_PERSISTENT);
+	qdevice_heuristics_msg_decoded_destroy(&decoded_msg);
+
+	decode_first(&buf, &decoded_msg);
+	assert(decoded_msg.type == QDEVICE_HEURISTICS_MSG_TYPE_EXEC);
+	assert(decoded_msg.timeout_set && decoded_msg.timeout == 5000);
+	assert(decoded_msg.seq_number_set && decoded_msg.seq_number == 42);
+	qdevice_heuristics_msg_decoded_destroy(&decoded_msg);
+
+	decode_first(&buf, &decoded_msg);
+	assert(decoded_msg.type == QDEVICE_HEURISTICS_MSG_TYPE_LOG);
+	assert(decoded_msg.log_priority_set && decoded_msg.log_priority == 7);
+	assert(strcmp(decoded_msg.log_message, "line1\nline2") == 0);
+	qdevice_heuristics_msg_decoded_destroy(&decoded_msg);
+
+	assert(qdevice_heuristics_msg_get_complete_len(&buf) == 0);
+	dynar_clean(&buf);
+
+	/*
+	 * Exec result with per entry info
+	 */
+	strcpy(name, "a");
+	strcpy(command, "/bin/true");
+	entry = qdevice_heuristics_exec_list_add(&exec_list, name, command);
+	assert(entry != NULL);
+	entry->last_result = QDEVICE_HEURISTICS_EXEC_ENTRY_RESULT_PASS;
+	entry->last_exit_status = 0;
+	entry->last_duration = 12;
+
+	strcpy(name, "b");
+	strcpy(command, "/bin/false");
+	entry = qdevice_heuristics_exec_list_add(&exec_list, name, command);
+	assert(entry != NULL);
+	entry->last_result = QDEVICE_HEURISTICS_EXEC_ENTRY_RESULT_FAIL;
+	entry->last_term_signal = 9;
+	entry->last_duration = 3456;
+
+	strcpy(name, "c");
+	strcpy(command, "/bin/sleep 10");
+	entry = qdevice_heuristics_exec_list_add(&exec_list, name, command);
+	assert(entry != NULL);
+
+	assert(qdevice_heuristics_msg_create_exec_result(&msg, 43,
+	    QDEVICE_HEURISTICS_EXEC_RESULT_FAIL, &exec_list) > 0);
+	assert(dynar_cat(&buf, dynar_data(&msg), dynar_size(&msg)) == 0);
+
+	decode_first(&buf, &decoded_msg);
+	assert(decoded_msg.type == QDEVICE_HEURISTICS_MSG_TYPE_EXEC_RESULT);
+	assert(decoded_msg.seq_number_set && decoded_msg.seq_number == 43);
+	assert(decoded_msg.exec_result_set &&
+	    decoded_msg.exec_result == QDEVICE_HEURISTICS_EXEC_RESULT_FAIL);
+	assert(decoded_msg.no_entry_infos == 3);
+
+	zi = 0;
+	TAILQ_FOREACH(entry, &exec_list, entries) {
+		assert(strcmp(decoded_msg.entry_infos[zi].name, entry->name) == 0);
+		assert(decoded_msg.entry_infos[zi].result == entry->last_result);
+		assert(decoded_msg.entry_infos[zi].exit_status == entry->last_exit_status);
+		assert(decoded_msg.entry_infos[zi].term_signal == entry->last_term_signal);
+		assert(decoded_msg.entry_infos[zi].duration == entry->last_duration);
+		zi++;
+	}
+	assert(decoded_msg.entry_infos[2].result == QDEVICE_HEURISTICS_EXEC_ENTRY_RESULT_NOT_FINISHED);
+	assert(decoded_msg.entry_infos[2].exit_status == -1);
+	qdevice_heuristics_msg_decoded_destroy(&decoded_msg);
+
+	/*
+	 * Invalid message is refused
+	 */
+	assert(qdevice_heuristics_msg_create_exec(&msg, 5000, 42) > 0);
+	qdevice_heuristics_msg_decoded_init(&decoded_msg);
+	assert(qdevice_heuristics_msg_decode(dynar_data(&msg), dynar_size(&msg) - 1,
+	    &decoded_msg) != 0);
+	qdevice_heuristics_msg_decoded_destroy(&decoded_msg);
+
+	qdevice_heuristics_exec_list_free(&exec_list);
+	dynar_destroy(&buf);
+	dynar_destroy(&msg);
+
+	return (0);
+}
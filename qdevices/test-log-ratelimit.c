@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <string.h>
+
+#include "log.h"
+#include "log-ratelimit.h"
+
+#define MAX_LINE_LEN		512
+
+static char vsyslog_buf[MAX_LINE_LEN];
+static int vsyslog_called;
+
+extern void __vsyslog_chk(int priority, int flag, const char *format, va_list ap)
+    __attribute__((__format__(__printf__, 3, 0)));
+
+void
+openlog(const char *ident, int option, int facility)
+{
+
+}
+
+void
+vsyslog(int priority, const char *format, va_list ap)
+{
+	va_list ap_copy;
+	int res;
+
+	vsyslog_called++;
+
+	va_copy(ap_copy, ap);
+	res = vsnprintf(vsyslog_buf, MAX_LINE_LEN, format, ap_copy);
+	assert(res < MAX_LINE_LEN && res != -1);
+	va_end(ap_copy);
+}
+
+void
+__vsyslog_chk(int priority, int flag, const char *format, va_list ap)
+{
+
+	vsyslog(priority, format, ap);
+}
+
+void
+closelog(void)
+{
+
+}
+
+static void
+log_same_site(const char *key, size_t key_len, int no_messages)
+{
+	int i;
+
+	for (i = 0; i < no_messages; i++) {
+		log_ratelimit(key, key_len, LOG_ERR, "test message %d", i);
+	}
+}
+
+int
+main(void)
+{
+
+	assert(log_init("test", LOG_TARGET_SYSLOG, LOG_DAEMON) == 0);
+
+	/*
+	 * Long interval so bucket is not refilled during test
+	 */
+	log_ratelimit_init(3, 1000000);
+
+	vsyslog_called = 0;
+	log_same_site("a", 1, 10);
+	assert(vsyslog_called == 3);
+
+	/*
+	 * Different key has its own bucket
+	 */
+	vsyslog_called = 0;
+	log_same_site("b", 1, 1);
+	assert(vsyslog_called == 1);
+
+	/*
+	 * Port (or anything after key_len) is not part of the key
+	 */
+	vsyslog_called = 0;
+	log_same_site("a:1234", 1, 1);
+	assert(vsyslog_called == 0);
+
+	vsyslog_called = 0;
+	log_ratelimit_flush(1);
+	assert(vsyslog_called == 1);
+	assert(strstr(vsyslog_buf, "8 similar messages suppressed for a") != NULL);
+
+	/*
+	 * Nothing more to report
+	 */
+	vsyslog_called = 0;
+	log_ratelimit_flush(1);
+	assert(vsyslog_called == 0);
+
+	/*
+	 * Disabled rate limiting
+	 */
+	log_ratelimit_init(0, 1000);
+	vsyslog_called = 0;
+	log_same_site("a", 1, 10);
+	assert(vsyslog_called == 10);
+
+	log_ratelimit_destroy();
+	log_close();
+
+	return (0);
+}
@@ -36,11 +36,15 @@
 #include <assert.h>
 #include <string.h>
 #include <errno.h>
+#include <pthread.h>
 
 #include "log.h"
 
 #define MAX_LINE_LEN		512
 
+#define TEST_ASYNC_QUEUE_SIZE	16
+#define TEST_ASYNC_FLOOD_MSGS	1000
+
 static int openlog_called;
 static int openlog_facility;
 static char vsyslog_buf[MAX_LINE_LEN];
@@ -48,6 +52,17 @@ static int vsyslog_priority;
 static int vsyslog_called;
 static int closelog_called;
 
+/*
+ * Used to block async writer thread inside of vsyslog
+ */
+static pthread_mutex_t vsyslog_block_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t vsyslog_block_cond = PTHREAD_COND_INITIALIZER;
+static int vsyslog_block;
+static int vsyslog_blocked;
+static int vsyslog_flood_msgs;
+static int vsyslog_overflow_priority;
+static char vsyslog_overflow_buf[MAX_LINE_LEN];
+
 extern void __vsyslog_chk(int priority, int flag, const char *format, va_list ap)
     __attribute__((__format__(__printf__, 3, 0)));
 
@@ -72,6 +87,26 @@ vsyslog(int priority, const char *format, va_list ap)
 	res = vsnprintf(vsyslog_buf, MAX_LINE_LEN, format, ap_copy);
 	assert(res < MAX_LINE_LEN && res != -1);
 	va_end(ap_copy);
+
+	pthread_mutex_lock(&vsyslog_block_mutex);
+	if (strncmp(vsyslog_buf, "test async log flood", strlen("test async log flood")) == 0) {
+		vsyslog_flood_msgs++;
+	}
+
+	if (strncmp(vsyslog_buf, "Log queue overflow", strlen("Log queue overflow")) == 0) {
+		strcpy(vsyslog_overflow_buf, vsyslog_buf);
+		vsyslog_overflow_priority = priority;
+	}
+
+	if (vsyslog_block) {
+		vsyslog_blocked = 1;
+		pthread_cond_broadcast(&vsyslog_block_cond);
+
+		while (vsyslog_block) {
+			pthread_cond_wait(&vsyslog_block_cond, &vsyslog_block_mutex);
+		}
+	}
+	pthread_mutex_unlock(&vsyslog_block_mutex);
 }
 
 void
@@ -110,6 +145,7 @@ log_check(int priority, const char *msg, int should_be_called, int expected_prio
 int
 main(void)
 {
+	int i;
 
 	openlog_called = 0;
 	assert(log_init("test", LOG_TARGET_SYSLOG, LOG_DAEMON) == 0);
@@ -142,6 +178,54 @@ main(void)
 	assert(closelog_called);
 	assert(openlog_facility == LOG_USER);
 
+	/*
+	 * Async logging - messages are written by writer thread so check after stop
+	 */
+	assert(log_async_start(16) == 0);
+	assert(log_async_start(16) == -1);
+	vsyslog_called = 0;
+	vsyslog_buf[0] = '\0';
+	log(LOG_ERR, "%s", "test async log err");
+	log_async_stop();
+	assert(vsyslog_called);
+	assert(vsyslog_priority == LOG_ERR);
+	assert(strcmp(vsyslog_buf, "test async log err") == 0);
+
+	/*
+	 * Overflow of the queue is reported once writer catches up. Writer is blocked
+	 * in vsyslog, so exactly queue size messages are queued and the rest is dropped.
+	 */
+	assert(log_async_start(TEST_ASYNC_QUEUE_SIZE) == 0);
+
+	vsyslog_block = 1;
+	vsyslog_blocked = 0;
+	vsyslog_flood_msgs = 0;
+	vsyslog_overflow_buf[0] = '\0';
+	log(LOG_ERR, "%s", "test async log blocker");
+
+	pthread_mutex_lock(&vsyslog_block_mutex);
+	while (!vsyslog_blocked) {
+		pthread_cond_wait(&vsyslog_block_cond, &vsyslog_block_mutex);
+	}
+	pthread_mutex_unlock(&vsyslog_block_mutex);
+
+	for (i = 0; i < TEST_ASYNC_FLOOD_MSGS; i++) {
+		log(LOG_INFO, "test async log flood %d", i);
+	}
+
+	pthread_mutex_lock(&vsyslog_block_mutex);
+	vsyslog_block = 0;
+	pthread_cond_broadcast(&vsyslog_block_cond);
+	pthread_mutex_unlock(&vsyslog_block_mutex);
+
+	log_async_stop();
+
+	snprintf(vsyslog_buf, MAX_LINE_LEN, "Log queue overflow - %d messages dropped",
+	    TEST_ASYNC_FLOOD_MSGS - TEST_ASYNC_QUEUE_SIZE);
+	assert(strcmp(vsyslog_overflow_buf, vsyslog_buf) == 0);
+	assert(vsyslog_overflow_priority == LOG_WARNING);
+	assert(vsyslog_flood_msgs == TEST_ASYNC_QUEUE_SIZE);
+
 	closelog_called = 0;
 	log_close();
 	assert(closelog_called);
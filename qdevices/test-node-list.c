@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "dynar.h"
+#include "msg.h"
+#include "node-list.h"
+
+#define MAX_MSG_SIZE	(1 << 16)
+
+static void
+test_diff_apply(void)
+{
+	struct node_list old_list, new_list, changed, removed, applied;
+	struct node_list_entry *node;
+
+	node_list_init(&old_list);
+	node_list_init(&new_list);
+
+	assert(node_list_add(&old_list, 1, 0, TLV_NODE_STATE_MEMBER) != NULL);
+	assert(node_list_add(&old_list, 2, 0, TLV_NODE_STATE_MEMBER) != NULL);
+	assert(node_list_add(&old_list, 3, 0, TLV_NODE_STATE_MEMBER) != NULL);
+
+	/*
+	 * Same lists -> empty delta
+	 */
+	assert(node_list_diff(&old_list, &old_list, &changed, &removed) == 0);
+	assert(node_list_is_empty(&changed));
+	assert(node_list_is_empty(&removed));
+
+	/*
+	 * Node 2 removed, node 3 changed state, node 4 added, node 1 unchanged
+	 */
+	assert(node_list_add(&new_list, 1, 0, TLV_NODE_STATE_MEMBER) != NULL);
+	assert(node_list_add(&new_list, 3, 0, TLV_NODE_STATE_DEAD) != NULL);
+	assert(node_list_add(&new_list, 4, 0, TLV_NODE_STATE_MEMBER) != NULL);
+
+	assert(node_list_diff(&old_list, &new_list, &changed, &removed) == 0);
+	assert(node_list_size(&changed) == 2);
+	node = node_list_find_node_id(&changed, 3);
+	assert(node != NULL && node->node_state == TLV_NODE_STATE_DEAD);
+	assert(node_list_find_node_id(&changed, 4) != NULL);
+	assert(node_list_size(&removed) == 1);
+	assert(node_list_find_node_id(&removed, 2) != NULL);
+
+	assert(node_list_clone(&applied, &old_list) == 0);
+	assert(node_list_apply_delta(&applied, &changed, &removed) == 0);
+	assert(node_list_eq(&applied, &new_list) == 1);
+
+	/*
+	 * Removing node which doesn't exist is ignored
+	 */
+	assert(node_list_apply_delta(&applied, &changed, &removed) == 0);
+	assert(node_list_eq(&applied, &new_list) == 1);
+
+	node_list_free(&applied);
+	node_list_free(&changed);
+	node_list_free(&removed);
+
+	/*
+	 * Delta from empty list is full list
+	 */
+	node_list_init(&applied);
+	assert(node_list_diff(&applied, &new_list, &changed, &removed) == 0);
+	assert(node_list_eq(&changed, &new_list) == 1);
+	assert(node_list_is_empty(&removed));
+
+	node_list_free(&changed);
+	node_list_free(&removed);
+	node_list_free(&old_list);
+	node_list_free(&new_list);
+}
+
+static void
+test_msg(void)
+{
+	struct dynar msg;
+	struct msg_decoded decoded_msg;
+	struct node_list changed, removed;
+	struct tlv_ring_id ring_id;
+
+	dynar_init(&msg, MAX_MSG_SIZE);
+	node_list_init(&changed);
+	node_list_init(&removed);
+
+	ring_id.node_id = 1;
+	ring_id.seq = 8;
+
+	assert(node_list_add(&changed, 4, 0, TLV_NODE_STATE_MEMBER) != NULL);
+	assert(node_list_add(&removed, 2, 0, TLV_NODE_STATE_NOT_SET) != NULL);
+	assert(node_list_add(&removed, 5, 0, TLV_NODE_STATE_NOT_SET) != NULL);
+
+	/*
+	 * Delta message
+	 */
+	assert(msg_create_node_list_versioned(&msg, 10, TLV_NODE_LIST_TYPE_MEMBERSHIP,
+	    1, &ring_id, 0, 0, 0, TLV_QUORATE_INQUORATE, 1, TLV_HEURISTICS_PASS,
+	    7, 1, 6, &changed, &removed) > 0);
+
+	msg_decoded_init(&decoded_msg);
+	assert(msg_decode(&msg, &decoded_msg) == 0);
+	assert(decoded_msg.type == MSG_TYPE_NODE_LIST);
+	assert(decoded_msg.node_list_version_set && decoded_msg.node_list_version == 7);
+	assert(decoded_msg.node_list_base_version_set && decoded_msg.node_list_base_version == 6);
+	assert(node_list_eq(&decoded_msg.nodes, &changed) == 1);
+	assert(node_list_size(&decoded_msg.removed_nodes) == 2);
+	assert(node_list_find_node_id(&decoded_msg.removed_nodes, 2) != NULL);
+	assert(node_list_find_node_id(&decoded_msg.removed_nodes, 5) != NULL);
+	assert(decoded_msg.heuristics == TLV_HEURISTICS_PASS);
+	msg_decoded_destroy(&decoded_msg);
+
+	/*
+	 * Full versioned message
+	 */
+	assert(msg_create_node_list_versioned(&msg, 11, TLV_NODE_LIST_TYPE_QUORUM,
+	    0, NULL, 0, 0, 1, TLV_QUORATE_QUORATE, 0, TLV_HEURISTICS_UNDEFINED,
+	    8, 0, 0, &changed, NULL) > 0);
+
+	assert(msg_decode(&msg, &decoded_msg) == 0);
+	assert(decoded_msg.node_list_version_set && decoded_msg.node_list_version == 8);
+	assert(!decoded_msg.node_list_base_version_set);
+	assert(node_list_is_empty(&decoded_msg.removed_nodes));
+	msg_decoded_destroy(&decoded_msg);
+
+	/*
+	 * Unversioned message (old protocol)
+	 */
+	assert(msg_create_node_list(&msg, 12, TLV_NODE_LIST_TYPE_QUORUM,
+	    0, NULL, 0, 0, 1, TLV_QUORATE_QUORATE, 0, TLV_HEURISTICS_UNDEFINED, &changed) > 0);
+
+	assert(msg_decode(&msg, &decoded_msg) == 0);
+	assert(!decoded_msg.node_list_version_set);
+	assert(!decoded_msg.node_list_base_version_set);
+	msg_decoded_destroy(&decoded_msg);
+
+	/*
+	 * Reply
+	 */
+	assert(msg_create_node_list_reply(&msg, 10, TLV_NODE_LIST_TYPE_MEMBERSHIP, &ring_id,
+	    TLV_VOTE_NO_CHANGE, 1, 5) > 0);
+
+	assert(msg_decode(&msg, &decoded_msg) == 0);
+	assert(decoded_msg.type == MSG_TYPE_NODE_LIST_REPLY);
+	assert(decoded_msg.node_list_version_set && decoded_msg.node_list_version == 5);
+	assert(decoded_msg.vote_set && decoded_msg.vote == TLV_VOTE_NO_CHANGE);
+	msg_decoded_destroy(&decoded_msg);
+
+	node_list_free(&changed);
+	node_list_free(&removed);
+	dynar_destroy(&msg);
+}
+
+int
+main(void)
+{
+
+	test_diff_apply();
+	test_msg();
+
+	return (0);
+}
@@ -204,6 +204,10 @@ main(void)
 	struct process_list plist;
 	struct process_list_entry *plist_entry;
 	char *true_path, *false_path;
+	char **parsed_argv;
+	size_t parsed_argc;
+	char pipe_buf[16];
+	struct pollfd pfd;
 	char ignore_sigint_cmd[PATH_MAX];
 	char ignore_sigintterm_cmd[PATH_MAX];
 
@@ -287,7 +291,45 @@ main(void)
 	assert(process_list_get_summary_result(&plist) == 1);
 	assert(process_list_get_summary_result_short(&plist) == 1);
 
+	/*
+	 * Exit code, signal and duration are recorded for finished processes
+	 */
+	TAILQ_FOREACH(plist_entry, &plist.active_list, entries) {
+		assert(process_list_entry_get_exit_code(plist_entry) ==
+		    (strcmp(plist_entry->name, "true") == 0 ? 0 : 1));
+		assert(process_list_entry_get_term_signal(plist_entry) == 0);
+		assert(process_list_entry_get_duration(plist_entry) < WAIT_FOR_NO_RUNNING_TIMEOUT);
+	}
+
+	process_list_free(&plist);
+
+	/*
+	 * Test pre-parsed argv. Process list doesn't take ownership and doesn't keep
+	 * argv after exec
+	 */
+	parsed_argv = process_list_parse_command(false_path, &parsed_argc);
+	assert(parsed_argv != NULL);
+	assert(parsed_argc == 1);
+
+	assert(process_list_add_argv(&plist, "empty", 0, NULL) == NULL);
+
+	plist_entry = process_list_add_argv(&plist, "false", parsed_argc, parsed_argv);
+	assert(plist_entry != NULL);
+	assert(plist_entry->exec_argv == parsed_argv);
+
+	no_executed = 0;
+	no_finished = 0;
+	assert(process_list_exec_initialized(&plist) == 0);
+	assert(no_executed == 1);
+	assert(plist_entry->exec_argv == NULL);
+
+	assert(wait_for_no_running(&plist, 0, 0) == 0);
+
+	assert(no_finished == 1);
+	assert(process_list_get_summary_result(&plist) == 1);
+
 	process_list_free(&plist);
+	process_list_free_argv(parsed_argc, parsed_argv);
 
 	/*
 	 * Test two processes. /bin/true and one non-existing. Accumulated result should be fail
@@ -378,6 +420,29 @@ main(void)
 
 	process_list_free(&plist);
 
+	/*
+	 * Test that process_list_terminate_kill_list sends SIGTERM to not yet signaled
+	 * processes in kill list
+	 */
+	plist_entry = process_list_add(&plist, "cat", "/bin/cat /dev/zero");
+	assert(plist_entry != NULL);
+
+	assert(process_list_exec_initialized(&plist) == 0);
+	assert(process_list_get_no_running(&plist) == 1);
+
+	process_list_move_active_entries_to_kill_list(&plist);
+	assert(process_list_get_kill_list_items(&plist) == 1);
+	assert(process_list_terminate_kill_list(&plist) == 0);
+	assert(TAILQ_FIRST(&plist.to_kill_list)->state == PROCESS_LIST_ENTRY_STATE_SIGTERM_SENT);
+
+	/*
+	 * Already signaled process is not signaled again
+	 */
+	assert(process_list_terminate_kill_list(&plist) == 0);
+	assert(wait_for_no_running(&plist, 0, 0) == 0);
+
+	process_list_free(&plist);
+
 	/*
 	 * Test two bash proceses. One ignores INT and second ignores INT and TERM.
 	 */
@@ -595,5 +660,38 @@ main(void)
 
 	process_list_free(&plist);
 
+	/*
+	 * Test stdio pipes. Process is kept running and it's stdin/stdout is used
+	 */
+	process_list_set_use_stdio_pipes(&plist, 1);
+
+	plist_entry = process_list_add(&plist, "cat", "cat");
+	assert(plist_entry != NULL);
+	assert(plist_entry->stdin_fd == -1 && plist_entry->stdout_fd == -1);
+
+	no_executed = 0;
+	assert(process_list_exec_initialized(&plist) == 0);
+	assert(no_executed == 1);
+	assert(plist_entry->stdin_fd != -1 && plist_entry->stdout_fd != -1);
+
+	assert(write(plist_entry->stdin_fd, "check 1\n", 8) == 8);
+	memset(pipe_buf, 0, sizeof(pipe_buf));
+	pfd.fd = plist_entry->stdout_fd;
+	pfd.events = POLLIN;
+	assert(poll(&pfd, 1, WAIT_FOR_NO_RUNNING_TIMEOUT) == 1);
+	assert(read(plist_entry->stdout_fd, pipe_buf, sizeof(pipe_buf) - 1) == 8);
+	assert(strcmp(pipe_buf, "check 1\n") == 0);
+	assert(process_list_get_no_running(&plist) == 1);
+
+	/*
+	 * Deleting running entry closes pipes (cat exits) and moves it to kill list
+	 */
+	process_list_del(&plist, plist_entry);
+	assert(process_list_get_no_running(&plist) == 0);
+	assert(process_list_get_kill_list_items(&plist) == 1);
+	assert(wait_for_no_running(&plist, 0, 0) == 0);
+
+	process_list_free(&plist);
+
 	return (0);
 }
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sys/types.h>
+
+#include <assert.h>
+#include <stdio.h>
+
+#include "qnetd-algo-harness.h"
+#include "qnetd-algo-ref.h"
+
+#define TEST_EVENTS		200
+#define TEST_SEED		42
+#define TEST_MAX_NODES		9
+#define TEST_BATCH_MAX_NODES	16
+
+static uint64_t
+run_harness(enum tlv_decision_algorithm_type algorithm, struct qnetd_algorithm *callbacks,
+    size_t no_nodes, uint32_t seed, int batch_evaluation, int vary_tie_breakers)
+{
+	struct qnetd_algo_harness harness;
+	uint64_t digest;
+	size_t zi;
+
+	assert(qnetd_algo_harness_init(&harness, algorithm, callbacks, no_nodes, seed, NULL,
+	    batch_evaluation, vary_tie_breakers) == 0);
+
+	for (zi = 0; zi < TEST_EVENTS; zi++) {
+		assert(qnetd_algo_harness_run_event(&harness) == 0);
+	}
+
+	assert(harness.stats.no_events == TEST_EVENTS);
+	assert(harness.stats.no_decisions > 0);
+
+	/*
+	 * Ffsplit sends NACKs before ACKs so it must never leave more partitions
+	 * with ACK vote. Lms and 2nodelms evaluate each client separately and
+	 * can temporarily give ACK to more partitions when membership and
+	 * heuristics change at the same time.
+	 */
+	if (algorithm == TLV_DECISION_ALGORITHM_TYPE_FFSPLIT) {
+		assert(harness.stats.no_split_brain_events == 0);
+	}
+
+	digest = harness.digest;
+
+	qnetd_algo_harness_destroy(&harness);
+
+	return (digest);
+}
+
+static void
+test_algorithm(enum tlv_decision_algorithm_type algorithm, size_t min_nodes, size_t max_nodes,
+    int batch_evaluation, int vary_tie_breakers)
+{
+	size_t no_nodes;
+	uint64_t digest;
+
+	for (no_nodes = min_nodes; no_nodes <= max_nodes; no_nodes++) {
+		digest = run_harness(algorithm, NULL, no_nodes, TEST_SEED, batch_evaluation,
+		    vary_tie_breakers);
+
+		/*
+		 * Same seed must produce same decisions
+		 */
+		assert(run_harness(algorithm, NULL, no_nodes, TEST_SEED, batch_evaluation,
+		    vary_tie_breakers) == digest);
+	}
+}
+
+/*
+ * Batched evaluation must end with same votes as evaluation of every message.
+ * Digest is computed from votes after all messages of event are processed.
+ */
+static void
+test_ffsplit_batch_evaluation(void)
+{
+	size_t no_nodes;
+	int vary_tie_breakers;
+
+	for (vary_tie_breakers = 0; vary_tie_breakers <= 1; vary_tie_breakers++) {
+		for (no_nodes = 1; no_nodes <= TEST_MAX_NODES; no_nodes++) {
+			assert(run_harness(TLV_DECISION_ALGORITHM_TYPE_FFSPLIT, NULL, no_nodes,
+			    TEST_SEED, 1, vary_tie_breakers) ==
+			    run_harness(TLV_DECISION_ALGORITHM_TYPE_FFSPLIT, NULL, no_nodes,
+			    TEST_SEED, 0, vary_tie_breakers));
+		}
+
+		assert(run_harness(TLV_DECISION_ALGORITHM_TYPE_FFSPLIT, NULL,
+		    TEST_BATCH_MAX_NODES, TEST_SEED, 1, vary_tie_breakers) ==
+		    run_harness(TLV_DECISION_ALGORITHM_TYPE_FFSPLIT, NULL,
+		    TEST_BATCH_MAX_NODES, TEST_SEED, 0, vary_tie_breakers));
+	}
+}
+
+/*
+ * Algorithm registered in qnetd must produce same decisions as its reference
+ * implementation (see qnetd-algo-ref.h)
+ */
+static void
+test_reference(enum tlv_decision_algorithm_type algorithm, struct qnetd_algorithm *reference,
+    int batch_evaluation, int vary_tie_breakers)
+{
+	size_t no_nodes;
+
+	for (no_nodes = 1; no_nodes <= TEST_MAX_NODES; no_nodes++) {
+		assert(run_harness(algorithm, NULL, no_nodes, TEST_SEED, batch_evaluation,
+		    vary_tie_breakers) ==
+		    run_harness(algorithm, reference, no_nodes, TEST_SEED, 0, vary_tie_breakers));
+	}
+}
+
+int
+main(void)
+{
+
+	test_algorithm(TLV_DECISION_ALGORITHM_TYPE_FFSPLIT, 1, TEST_MAX_NODES, 0, 0);
+	test_algorithm(TLV_DECISION_ALGORITHM_TYPE_FFSPLIT, 1, TEST_MAX_NODES, 1, 0);
+	test_algorithm(TLV_DECISION_ALGORITHM_TYPE_FFSPLIT, 1, TEST_MAX_NODES, 1, 1);
+	test_reference(TLV_DECISION_ALGORITHM_TYPE_FFSPLIT, &qnetd_algo_ref_ffsplit, 0, 0);
+	test_reference(TLV_DECISION_ALGORITHM_TYPE_FFSPLIT, &qnetd_algo_ref_ffsplit, 0, 1);
+	test_reference(TLV_DECISION_ALGORITHM_TYPE_FFSPLIT, &qnetd_algo_ref_ffsplit, 1, 0);
+	test_reference(TLV_DECISION_ALGORITHM_TYPE_FFSPLIT, &qnetd_algo_ref_ffsplit, 1, 1);
+	test_ffsplit_batch_evaluation();
+	test_algorithm(TLV_DECISION_ALGORITHM_TYPE_LMS, 1, TEST_MAX_NODES, 0, 0);
+	test_reference(TLV_DECISION_ALGORITHM_TYPE_LMS, &qnetd_algo_ref_lms, 0, 0);
+	test_reference(TLV_DECISION_ALGORITHM_TYPE_LMS, &qnetd_algo_ref_lms, 0, 1);
+	test_algorithm(TLV_DECISION_ALGORITHM_TYPE_2NODELMS, 2, 2, 0, 0);
+
+	return (0);
+}
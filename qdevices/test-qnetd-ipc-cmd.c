@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <string.h>
+
+#include "dynar.h"
+#include "qnetd-cluster-list.h"
+#include "qnetd-client.h"
+#include "qnetd-client-list.h"
+#include "qnetd-instance.h"
+#include "qnetd-ipc-cmd.h"
+
+static struct qnetd_instance instance;
+static struct qnetd_advanced_settings advanced_settings;
+
+static struct qnetd_client *
+add_client(const char *cluster_name, uint32_t node_id)
+{
+	PRNetAddr addr;
+	struct qnetd_client *client;
+	char *client_addr_str;
+
+	memset(&addr, 0, sizeof(addr));
+
+	client_addr_str = strdup("addrstr");
+	assert(client_addr_str != NULL);
+
+	client = qnetd_client_list_add(&instance.clients, NULL, &addr, client_addr_str, 1000, 2,
+	    1000, NULL);
+	assert(client != NULL);
+	client->cluster_name = strdup(cluster_name);
+	assert(client->cluster_name != NULL);
+	client->cluster_name_len = strlen(cluster_name);
+	client->node_id = node_id;
+	client->init_received = 1;
+
+	client->cluster = qnetd_cluster_list_add_client(&instance.clusters, client);
+	assert(client->cluster != NULL);
+
+	return (client);
+}
+
+static void
+del_client(struct qnetd_ipc_cmd_list_cursor *cursor, struct qnetd_client *client)
+{
+
+	qnetd_ipc_cmd_list_cursor_client_removed(cursor, client);
+	qnetd_cluster_list_del_client(&instance.clusters, client->cluster, client);
+	qnetd_client_list_del(&instance.clients, client);
+}
+
+static int
+str_count(const char *str, const char *needle)
+{
+	int res;
+
+	res = 0;
+
+	while ((str = strstr(str, needle)) != NULL) {
+		res++;
+		str++;
+	}
+
+	return (res);
+}
+
+/*
+ * Return number of chunks needed to list all clients. Output is concatenated to res_buf.
+ */
+static int
+list_all(struct qnetd_ipc_cmd_list_cursor *cursor, struct dynar *res_buf)
+{
+	struct dynar chunk;
+	int no_chunks;
+	char zero;
+
+	dynar_init(&chunk, 1024);
+	dynar_clean(res_buf);
+	no_chunks = 0;
+
+	while (!qnetd_ipc_cmd_list_cursor_is_finished(cursor)) {
+		dynar_clean(&chunk);
+		assert(qnetd_ipc_cmd_list(&instance, &chunk, cursor) == 0);
+		assert(dynar_cat(res_buf, dynar_data(&chunk), dynar_size(&chunk)) == 0);
+		no_chunks++;
+	}
+
+	zero = '\0';
+	assert(dynar_cat(res_buf, &zero, sizeof(zero)) == 0);
+
+	dynar_destroy(&chunk);
+
+	return (no_chunks);
+}
+
+int
+main(void)
+{
+	struct qnetd_ipc_cmd_list_cursor cursor;
+	struct qnetd_client *client[5];
+	struct dynar res_buf;
+	struct dynar small_buf;
+
+	memset(&instance, 0, sizeof(instance));
+	memset(&advanced_settings, 0, sizeof(advanced_settings));
+	instance.advanced_settings = &advanced_settings;
+
+	qnetd_client_list_init(&instance.clients);
+	qnetd_cluster_list_init(&instance.clusters);
+
+	dynar_init(&res_buf, 65536);
+
+	client[0] = add_client("c1", 3);
+	client[1] = add_client("c1", 1);
+	client[2] = add_client("c1", 2);
+	client[3] = add_client("c2", 2);
+	client[4] = add_client("c2", 1);
+
+	/*
+	 * Whole list in one chunk
+	 */
+	advanced_settings.ipc_list_chunk_size = 65536;
+	assert(qnetd_ipc_cmd_list_cursor_init(&cursor, &instance, 0, 0, NULL, 0, 0) == 0);
+	assert(list_all(&cursor, &res_buf) == 1);
+	assert(str_count(dynar_data(&res_buf), "Cluster \"c1\"") == 1);
+	assert(str_count(dynar_data(&res_buf), "Cluster \"c2\"") == 1);
+	assert(str_count(dynar_data(&res_buf), "Node ID") == 5);
+	qnetd_ipc_cmd_list_cursor_destroy(&cursor);
+
+	/*
+	 * One client per chunk
+	 */
+	advanced_settings.ipc_list_chunk_size = 1;
+	assert(qnetd_ipc_cmd_list_cursor_init(&cursor, &instance, 1, 0, "", 0, 0) == 0);
+	assert(list_all(&cursor, &res_buf) == 5);
+	assert(str_count(dynar_data(&res_buf), "Cluster \"c1\"") == 1);
+	assert(str_count(dynar_data(&res_buf), "Cluster \"c2\"") == 1);
+	assert(str_count(dynar_data(&res_buf), "Algorithm") == 2);
+	assert(str_count(dynar_data(&res_buf), "Node ID") == 5);
+	qnetd_ipc_cmd_list_cursor_destroy(&cursor);
+
+	/*
+	 * Cluster and node filters
+	 */
+	assert(qnetd_ipc_cmd_list_cursor_init(&cursor, &instance, 0, 0, "c2", 0, 0) == 0);
+	assert(list_all(&cursor, &res_buf) == 2);
+	assert(str_count(dynar_data(&res_buf), "Cluster \"c1\"") == 0);
+	assert(str_count(dynar_data(&res_buf), "Cluster \"c2\"") == 1);
+	assert(str_count(dynar_data(&res_buf), "Node ID") == 2);
+	qnetd_ipc_cmd_list_cursor_destroy(&cursor);
+
+	assert(qnetd_ipc_cmd_list_cursor_init(&cursor, &instance, 0, 0, "nonexisting", 0, 0) == 0);
+	assert(qnetd_ipc_cmd_list_cursor_is_finished(&cursor));
+	qnetd_ipc_cmd_list_cursor_destroy(&cursor);
+
+	assert(qnetd_ipc_cmd_list_cursor_init(&cursor, &instance, 0, 0, NULL, 1, 2) == 0);
+	list_all(&cursor, &res_buf);
+	assert(str_count(dynar_data(&res_buf), "Cluster \"c1\"") == 1);
+	assert(str_count(dynar_data(&res_buf), "Cluster \"c2\"") == 1);
+	assert(str_count(dynar_data(&res_buf), "Node ID 2:") == 2);
+	assert(str_count(dynar_data(&res_buf), "Node ID") == 2);
+	qnetd_ipc_cmd_list_cursor_destroy(&cursor);
+
+	assert(qnetd_ipc_cmd_list_cursor_init(&cursor, &instance, 0, 0, "c1", 1, 4) == 0);
+	list_all(&cursor, &res_buf);
+	assert(strcmp(dynar_data(&res_buf), "") == 0);
+	qnetd_ipc_cmd_list_cursor_destroy(&cursor);
+
+	/*
+	 * Client doesn't fit into buffer
+	 */
+	dynar_init(&small_buf, 16);
+	assert(qnetd_ipc_cmd_list_cursor_init(&cursor, &instance, 0, 0, NULL, 0, 0) == 0);
+	assert(qnetd_ipc_cmd_list(&instance, &small_buf, &cursor) == -1);
+	assert(dynar_size(&small_buf) == 0);
+	qnetd_ipc_cmd_list_cursor_destroy(&cursor);
+	dynar_destroy(&small_buf);
+
+	/*
+	 * Clients removed during listing
+	 */
+	assert(qnetd_ipc_cmd_list_cursor_init(&cursor, &instance, 0, 0, NULL, 0, 0) == 0);
+	dynar_clean(&res_buf);
+	assert(qnetd_ipc_cmd_list(&instance, &res_buf, &cursor) == 0);
+	assert(str_count(dynar_data(&res_buf), "Node ID 1:") == 1);
+	assert(cursor.client == client[2]);
+
+	/*
+	 * Remove next client to list
+	 */
+	del_client(&cursor, client[2]);
+	assert(cursor.client == client[0]);
+	dynar_clean(&res_buf);
+	assert(qnetd_ipc_cmd_list(&instance, &res_buf, &cursor) == 0);
+	assert(str_count(dynar_data(&res_buf), "Node ID 3:") == 1);
+	assert(cursor.client == client[4]);
+
+	/*
+	 * Remove whole cluster which is going to be listed
+	 */
+	del_client(&cursor, client[4]);
+	assert(cursor.client == client[3]);
+	del_client(&cursor, client[3]);
+	assert(qnetd_ipc_cmd_list_cursor_is_finished(&cursor));
+	qnetd_ipc_cmd_list_cursor_destroy(&cursor);
+
+	/*
+	 * Removed clients of unrelated cluster doesn't change cursor
+	 */
+	client[3] = add_client("c2", 1);
+	assert(qnetd_ipc_cmd_list_cursor_init(&cursor, &instance, 0, 0, NULL, 0, 0) == 0);
+	del_client(&cursor, client[3]);
+	assert(cursor.cluster == client[0]->cluster);
+	assert(cursor.client == NULL);
+	assert(list_all(&cursor, &res_buf) == 2);
+	assert(str_count(dynar_data(&res_buf), "Node ID") == 2);
+	qnetd_ipc_cmd_list_cursor_destroy(&cursor);
+
+	/*
+	 * JSON output
+	 */
+	client[2] = add_client("c1", 2);
+	client[3] = add_client("c2", 2);
+	client[4] = add_client("c2", 1);
+
+	assert(qnetd_ipc_cmd_list_cursor_init(&cursor, &instance, 0, 1, "c3", 0, 0) == 0);
+	assert(list_all(&cursor, &res_buf) == 1);
+	assert(strcmp(dynar_data(&res_buf), "{\"clusters\":[]}\n") == 0);
+	qnetd_ipc_cmd_list_cursor_destroy(&cursor);
+
+	assert(qnetd_ipc_cmd_list_cursor_init(&cursor, &instance, 0, 1, "c2", 1, 1) == 0);
+	assert(list_all(&cursor, &res_buf) == 3);
+	assert(strcmp(dynar_data(&res_buf), "{\"clusters\":[{\"name\":\"c2\",\"algorithm\":\"Test\","
+	    "\"kap_tie_breaker\":false,\"clients\":[{\"node_id\":1,\"address\":\"addrstr\"}]}]}\n") == 0);
+	qnetd_ipc_cmd_list_cursor_destroy(&cursor);
+
+	assert(qnetd_ipc_cmd_list_cursor_init(&cursor, &instance, 1, 1, NULL, 0, 0) == 0);
+	assert(list_all(&cursor, &res_buf) == 6);
+	assert(str_count(dynar_data(&res_buf), "{\"name\":\"c1\"") == 1);
+	assert(str_count(dynar_data(&res_buf), "{\"name\":\"c2\"") == 1);
+	assert(str_count(dynar_data(&res_buf), "\"address\":") == 5);
+	assert(str_count(dynar_data(&res_buf), "\"tls_active\":false") == 5);
+	assert(str_count(dynar_data(&res_buf), "}]},{\"name\":\"c2\"") == 1);
+	assert(str_count(dynar_data(&res_buf), "{") == str_count(dynar_data(&res_buf), "}"));
+	assert(str_count(dynar_data(&res_buf), "[") == str_count(dynar_data(&res_buf), "]"));
+	qnetd_ipc_cmd_list_cursor_destroy(&cursor);
+
+	dynar_destroy(&res_buf);
+	qnetd_cluster_list_free(&instance.clusters);
+	qnetd_client_list_free(&instance.clients);
+
+	return (0);
+}
@@ -0,0 +1,356 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sys/types.h>
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "qnetd-client-list.h"
+#include "qnetd-state-snapshot.h"
+
+static struct qnetd_client *
+add_client(struct qnetd_client_list *clients, const char *cluster_name, uint32_t node_id,
+    enum tlv_vote last_sent_ack_nack_vote)
+{
+	PRNetAddr addr;
+	struct qnetd_client *client;
+	char *client_addr_str;
+
+	memset(&addr, 0, sizeof(addr));
+
+	client_addr_str = strdup("addrstr");
+	assert(client_addr_str != NULL);
+
+	client = qnetd_client_list_add(clients, NULL, &addr, client_addr_str, 1000, 2, 1000, NULL);
+	assert(client != NULL);
+
+	client->cluster_name = strdup(cluster_name);
+	assert(client->cluster_name != NULL);
+	client->cluster_name_len = strlen(cluster_name);
+	client->node_id = node_id;
+	client->decision_algorithm = TLV_DECISION_ALGORITHM_TYPE_FFSPLIT;
+	client->last_sent_ack_nack_vote = last_sent_ack_nack_vote;
+	client->init_received = 1;
+
+	return (client);
+}
+
+static void
+write_file(const char *file_name, const char *data, size_t data_len)
+{
+	FILE *f;
+
+	f = fopen(file_name, "w");
+	assert(f != NULL);
+	assert(fwrite(data, 1, data_len, f) == data_len);
+	assert(fclose(f) == 0);
+}
+
+static void
+test_save_load(const char *file_name)
+{
+	struct qnetd_client_list clients;
+	struct qnetd_client_list new_clients;
+	struct qnetd_state_snapshot snapshot;
+	struct qnetd_client *client;
+	char long_name[QNETD_STATE_SNAPSHOT_CLUSTER_NAME_LEN + 2];
+
+	qnetd_client_list_init(&clients);
+	qnetd_client_list_init(&new_clients);
+
+	(void)add_client(&clients, "cluster1", 1, TLV_VOTE_ACK);
+	(void)add_client(&clients, "cluster1", 2, TLV_VOTE_NACK);
+	(void)add_client(&clients, "cluster2", 1, TLV_VOTE_NACK);
+	/*
+	 * Clients which never got ACK/NACK or have too long cluster name are not stored
+	 */
+	(void)add_client(&clients, "cluster2", 2, TLV_VOTE_UNDEFINED);
+	memset(long_name, 'a', sizeof(long_name) - 1);
+	long_name[sizeof(long_name) - 1] = '\0';
+	(void)add_client(&clients, long_name, 1, TLV_VOTE_ACK);
+
+	assert(qnetd_state_snapshot_save(&clients, file_name) == 0);
+	qnetd_client_list_free(&clients);
+
+	qnetd_state_snapshot_init(&snapshot);
+	assert(qnetd_state_snapshot_load(&snapshot, file_name, 0, 60) == 0);
+	assert(snapshot.no_entries == 3);
+
+	client = add_client(&new_clients, "cluster1", 1, TLV_VOTE_UNDEFINED);
+	assert(qnetd_state_snapshot_restore_client(&snapshot, client) == 1);
+	assert(client->last_sent_ack_nack_vote == TLV_VOTE_ACK);
+	assert(snapshot.no_entries == 2);
+
+	/*
+	 * State is restored only once
+	 */
+	client = add_client(&new_clients, "cluster1", 1, TLV_VOTE_UNDEFINED);
+	assert(qnetd_state_snapshot_restore_client(&snapshot, client) == 0);
+	assert(client->last_sent_ack_nack_vote == TLV_VOTE_UNDEFINED);
+
+	/*
+	 * Different algorithm doesn't match
+	 */
+	client = add_client(&new_clients, "cluster2", 1, TLV_VOTE_UNDEFINED);
+	client->decision_algorithm = TLV_DECISION_ALGORITHM_TYPE_LMS;
+	assert(qnetd_state_snapshot_restore_client(&snapshot, client) == 0);
+
+	client = add_client(&new_clients, "cluster1", 2, TLV_VOTE_UNDEFINED);
+	assert(qnetd_state_snapshot_restore_client(&snapshot, client) == 1);
+	assert(client->last_sent_ack_nack_vote == TLV_VOTE_NACK);
+
+	client = add_client(&new_clients, "cluster2", 2, TLV_VOTE_UNDEFINED);
+	assert(qnetd_state_snapshot_restore_client(&snapshot, client) == 0);
+
+	assert(snapshot.no_entries == 1);
+
+	qnetd_state_snapshot_destroy(&snapshot);
+	assert(snapshot.no_entries == 0);
+
+	qnetd_client_list_free(&new_clients);
+}
+
+static void
+test_invalid(const char *file_name)
+{
+	struct qnetd_client_list clients;
+	struct qnetd_state_snapshot snapshot;
+	FILE *f;
+	long size;
+
+	qnetd_state_snapshot_init(&snapshot);
+
+	/*
+	 * Missing file is not an error
+	 */
+	(void)unlink(file_name);
+	assert(qnetd_state_snapshot_load(&snapshot, file_name, 0, 60) == 0);
+	assert(snapshot.no_entries == 0);
+
+	write_file(file_name, "short", 5);
+	assert(qnetd_state_snapshot_load(&snapshot, file_name, 0, 60) == -1);
+
+	write_file(file_name, "0123456789012345678901234567890123456789", 40);
+	assert(qnetd_state_snapshot_load(&snapshot, file_name, 0, 60) == -1);
+	assert(snapshot.no_entries == 0);
+
+	/*
+	 * Truncated snapshot is rejected
+	 */
+	qnetd_client_list_init(&clients);
+	(void)add_client(&clients, "cluster1", 1, TLV_VOTE_ACK);
+	(void)add_client(&clients, "cluster1", 2, TLV_VOTE_ACK);
+	assert(qnetd_state_snapshot_save(&clients, file_name) == 0);
+	qnetd_client_list_free(&clients);
+
+	f = fopen(file_name, "r+");
+	assert(f != NULL);
+	assert(fseek(f, 0, SEEK_END) == 0);
+	size = ftell(f);
+	assert(fclose(f) == 0);
+	assert(size == QNETD_STATE_SNAPSHOT_HEADER_SIZE + 2 * QNETD_STATE_SNAPSHOT_RECORD_SIZE);
+	assert(truncate(file_name, size - 1) == 0);
+
+	assert(qnetd_state_snapshot_load(&snapshot, file_name, 0, 60) == -1);
+	assert(snapshot.no_entries == 0);
+
+	qnetd_state_snapshot_destroy(&snapshot);
+}
+
+static void
+test_max_age(const char *file_name)
+{
+	struct qnetd_client_list clients;
+	struct qnetd_state_snapshot snapshot;
+	unsigned char old_time[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+	FILE *f;
+
+	qnetd_client_list_init(&clients);
+	(void)add_client(&clients, "cluster1", 1, TLV_VOTE_ACK);
+	assert(qnetd_state_snapshot_save(&clients, file_name) == 0);
+	qnetd_client_list_free(&clients);
+
+	qnetd_state_snapshot_init(&snapshot);
+	assert(qnetd_state_snapshot_load(&snapshot, file_name, 60, 60) == 0);
+	assert(snapshot.no_entries == 1);
+	qnetd_state_snapshot_destroy(&snapshot);
+
+	/*
+	 * Rewrite save time to the beginning of epoch
+	 */
+	f = fopen(file_name, "r+");
+	assert(f != NULL);
+	assert(fseek(f, 24, SEEK_SET) == 0);
+	assert(fwrite(old_time, 1, sizeof(old_time), f) == sizeof(old_time));
+	assert(fclose(f) == 0);
+
+	assert(qnetd_state_snapshot_load(&snapshot, file_name, 60, 60) == 0);
+	assert(snapshot.no_entries == 0);
+
+	assert(qnetd_state_snapshot_load(&snapshot, file_name, 0, 60) == 0);
+	assert(snapshot.no_entries == 1);
+
+	qnetd_state_snapshot_destroy(&snapshot);
+}
+
+static void
+test_expire(const char *file_name)
+{
+	struct qnetd_client_list clients;
+	struct qnetd_client_list new_clients;
+	struct qnetd_state_snapshot snapshot;
+	struct qnetd_client *client;
+
+	qnetd_client_list_init(&clients);
+	qnetd_client_list_init(&new_clients);
+	(void)add_client(&clients, "cluster1", 1, TLV_VOTE_ACK);
+	(void)add_client(&clients, "cluster1", 2, TLV_VOTE_ACK);
+	assert(qnetd_state_snapshot_save(&clients, file_name) == 0);
+	qnetd_client_list_free(&clients);
+
+	qnetd_state_snapshot_init(&snapshot);
+
+	/*
+	 * Within grace period and max age
+	 */
+	assert(qnetd_state_snapshot_load(&snapshot, file_name, 600, 60) == 0);
+	assert(snapshot.no_entries == 2);
+	assert(qnetd_state_snapshot_expire(&snapshot, snapshot.load_time + 60) == 0);
+	assert(snapshot.no_entries == 2);
+
+	/*
+	 * Grace period passed
+	 */
+	assert(qnetd_state_snapshot_expire(&snapshot, snapshot.load_time + 61) == 1);
+	assert(snapshot.no_entries == 0);
+
+	/*
+	 * Snapshot became older than max age during grace period
+	 */
+	assert(qnetd_state_snapshot_load(&snapshot, file_name, 30, 60) == 0);
+	assert(snapshot.no_entries == 2);
+	assert(qnetd_state_snapshot_expire(&snapshot, snapshot.save_time + 30) == 0);
+	assert(qnetd_state_snapshot_expire(&snapshot, snapshot.save_time + 31) == 1);
+	assert(snapshot.no_entries == 0);
+
+	/*
+	 * Time going backward
+	 */
+	assert(qnetd_state_snapshot_load(&snapshot, file_name, 0, 60) == 0);
+	assert(qnetd_state_snapshot_expire(&snapshot, snapshot.load_time - 1) == 1);
+
+	/*
+	 * Expired snapshot doesn't restore client
+	 */
+	assert(qnetd_state_snapshot_load(&snapshot, file_name, 0, 60) == 0);
+	snapshot.load_time -= 61;
+	client = add_client(&new_clients, "cluster1", 1, TLV_VOTE_UNDEFINED);
+	assert(qnetd_state_snapshot_restore_client(&snapshot, client) == 0);
+	assert(client->last_sent_ack_nack_vote == TLV_VOTE_UNDEFINED);
+	assert(snapshot.no_entries == 0);
+
+	qnetd_state_snapshot_destroy(&snapshot);
+	qnetd_client_list_free(&new_clients);
+}
+
+static void
+test_save_if_changed(const char *file_name)
+{
+	struct qnetd_client_list clients;
+	struct qnetd_state_snapshot_save_cache cache;
+	struct qnetd_state_snapshot snapshot;
+	struct qnetd_client *client;
+
+	qnetd_client_list_init(&clients);
+	qnetd_state_snapshot_save_cache_init(&cache);
+	qnetd_state_snapshot_init(&snapshot);
+
+	client = add_client(&clients, "cluster1", 1, TLV_VOTE_ACK);
+
+	assert(qnetd_state_snapshot_save_if_changed(&clients, file_name, &cache, 0) == 1);
+	assert(qnetd_state_snapshot_save_if_changed(&clients, file_name, &cache, 0) == 0);
+	assert(qnetd_state_snapshot_save_if_changed(&clients, file_name, &cache, 300) == 0);
+
+	/*
+	 * Changed vote is written
+	 */
+	client->last_sent_ack_nack_vote = TLV_VOTE_NACK;
+	assert(qnetd_state_snapshot_save_if_changed(&clients, file_name, &cache, 0) == 1);
+	assert(qnetd_state_snapshot_load(&snapshot, file_name, 0, 60) == 0);
+	assert(snapshot.no_entries == 1);
+	assert(TAILQ_FIRST(&snapshot.entries)->last_sent_ack_nack_vote == TLV_VOTE_NACK);
+	qnetd_state_snapshot_destroy(&snapshot);
+
+	/*
+	 * New client is written
+	 */
+	(void)add_client(&clients, "cluster1", 2, TLV_VOTE_ACK);
+	assert(qnetd_state_snapshot_save_if_changed(&clients, file_name, &cache, 0) == 1);
+	assert(qnetd_state_snapshot_save_if_changed(&clients, file_name, &cache, 0) == 0);
+
+	/*
+	 * Unchanged state is refreshed after refresh interval
+	 */
+	cache.save_time -= 300;
+	assert(qnetd_state_snapshot_save_if_changed(&clients, file_name, &cache, 300) == 1);
+	assert(qnetd_state_snapshot_save_if_changed(&clients, file_name, &cache, 300) == 0);
+
+	qnetd_state_snapshot_save_cache_destroy(&cache);
+	qnetd_client_list_free(&clients);
+}
+
+int
+main(void)
+{
+	char file_name[] = "/tmp/qnetd-state-snapshot-test-XXXXXX";
+	int fd;
+
+	fd = mkstemp(file_name);
+	assert(fd != -1);
+	close(fd);
+
+	test_save_load(file_name);
+	test_invalid(file_name);
+	test_max_age(file_name);
+	test_expire(file_name);
+	test_save_if_changed(file_name);
+
+	unlink(file_name);
+
+	return (0);
+}
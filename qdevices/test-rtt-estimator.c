@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+
+#include "rtt-estimator.h"
+
+static void
+test_first_sample(void)
+{
+	struct rtt_estimator est;
+
+	rtt_estimator_init(&est);
+	assert(est.no_samples == 0);
+	assert(rtt_estimator_get_rto(&est) == 0);
+
+	rtt_estimator_add_sample(&est, 1000);
+	assert(est.no_samples == 1);
+	assert(est.srtt == 1000);
+	assert(est.rttvar == 500);
+	assert(est.last_rtt == 1000);
+	assert(est.min_rtt == 1000 && est.max_rtt == 1000);
+	assert(rtt_estimator_get_rto(&est) == 3000);
+}
+
+static void
+test_stable_rtt(void)
+{
+	struct rtt_estimator est;
+	int i;
+
+	rtt_estimator_init(&est);
+
+	for (i = 0; i < 100; i++) {
+		rtt_estimator_add_sample(&est, 1000);
+	}
+
+	assert(est.no_samples == 100);
+	assert(est.srtt == 1000);
+	assert(est.rttvar == 0);
+	assert(rtt_estimator_get_rto(&est) == 1000);
+}
+
+static void
+test_jitter(void)
+{
+	struct rtt_estimator stable, jittery;
+	int i;
+
+	rtt_estimator_init(&stable);
+	rtt_estimator_init(&jittery);
+
+	for (i = 0; i < 100; i++) {
+		rtt_estimator_add_sample(&stable, 50000);
+		rtt_estimator_add_sample(&jittery, (i % 2 == 0 ? 10000 : 90000));
+	}
+
+	assert(jittery.min_rtt == 10000 && jittery.max_rtt == 90000);
+	assert(jittery.srtt > 10000 && jittery.srtt < 90000);
+	assert(jittery.rttvar > 10000);
+
+	/*
+	 * Same mean but jittery link must get bigger timeout
+	 */
+	assert(rtt_estimator_get_rto(&jittery) > 2 * rtt_estimator_get_rto(&stable));
+}
+
+static void
+test_convergence(void)
+{
+	struct rtt_estimator est;
+	uint64_t prev_srtt;
+	int i;
+
+	rtt_estimator_init(&est);
+
+	rtt_estimator_add_sample(&est, 1000);
+	prev_srtt = est.srtt;
+
+	for (i = 0; i < 50; i++) {
+		rtt_estimator_add_sample(&est, 100000);
+		assert(est.srtt >= prev_srtt);
+		prev_srtt = est.srtt;
+	}
+
+	assert(est.srtt > 99000 && est.srtt <= 100000);
+	assert(est.min_rtt == 1000 && est.max_rtt == 100000);
+
+	for (i = 0; i < 50; i++) {
+		rtt_estimator_add_sample(&est, 1000);
+	}
+
+	assert(est.srtt < 2000);
+	assert(est.last_rtt == 1000);
+}
+
+static void
+test_timeout_ms(void)
+{
+	struct rtt_estimator est;
+	int i;
+
+	rtt_estimator_init(&est);
+
+	/*
+	 * No sample -> min timeout
+	 */
+	assert(rtt_estimator_get_timeout_ms(&est, 4, 1000, 8000) == 1000);
+
+	/*
+	 * Stable LAN RTT -> min timeout
+	 */
+	for (i = 0; i < 100; i++) {
+		rtt_estimator_add_sample(&est, 500);
+	}
+	assert(rtt_estimator_get_timeout_ms(&est, 4, 1000, 8000) == 1000);
+
+	/*
+	 * Stable WAN RTT 300ms -> 4 * 300ms
+	 */
+	rtt_estimator_init(&est);
+	for (i = 0; i < 100; i++) {
+		rtt_estimator_add_sample(&est, 300000);
+	}
+	assert(rtt_estimator_get_timeout_ms(&est, 4, 1000, 8000) == 1200);
+
+	/*
+	 * Jittery WAN RTT -> max timeout
+	 */
+	rtt_estimator_init(&est);
+	for (i = 0; i < 100; i++) {
+		rtt_estimator_add_sample(&est, (i % 2 == 0 ? 50000 : 900000));
+	}
+	assert(rtt_estimator_get_timeout_ms(&est, 4, 1000, 8000) == 8000);
+
+	/*
+	 * Rounding up and min bigger than max
+	 */
+	rtt_estimator_init(&est);
+	for (i = 0; i < 100; i++) {
+		rtt_estimator_add_sample(&est, 1001);
+	}
+	assert(rtt_estimator_get_timeout_ms(&est, 1, 1, 8000) == 2);
+	assert(rtt_estimator_get_timeout_ms(&est, 1, 9000, 8000) == 8000);
+}
+
+int
+main(void)
+{
+
+	test_first_sample();
+	test_stable_rtt();
+	test_jitter();
+	test_convergence();
+	test_timeout_ms();
+
+	return (0);
+}
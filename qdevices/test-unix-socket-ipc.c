@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2026 Red Hat, Inc.
+ *
+ * All rights reserved.
+ *
+ * Author: Jan Friesse (jfriesse@redhat.com)
+ *
+ * This software licensed under BSD license, the text of which follows:
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of the Red Hat, Inc. nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#include <assert.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "unix-socket-ipc.h"
+
+#define MAX_SEND_SIZE		16
+
+static void
+test_read_peer(int fd, const char *expected)
+{
+	char buf[MAX_SEND_SIZE * 2];
+	ssize_t readed;
+
+	readed = read(fd, buf, sizeof(buf));
+	assert(readed == (ssize_t)strlen(expected));
+	assert(memcmp(buf, expected, readed) == 0);
+}
+
+int
+main(void)
+{
+	struct unix_socket_ipc ipc;
+	struct unix_socket_client *subscriber;
+	struct unix_socket_client *client;
+	int sub_fds[2];
+	int client_fds[2];
+
+	memset(&ipc, 0, sizeof(ipc));
+	unix_socket_client_list_init(&ipc.clients);
+
+	assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sub_fds) == 0);
+	assert(socketpair(AF_UNIX, SOCK_STREAM, 0, client_fds) == 0);
+
+	subscriber = unix_socket_client_list_add(&ipc.clients, sub_fds[0], MAX_SEND_SIZE,
+	    MAX_SEND_SIZE, NULL);
+	assert(subscriber != NULL);
+	client = unix_socket_client_list_add(&ipc.clients, client_fds[0], MAX_SEND_SIZE,
+	    MAX_SEND_SIZE, NULL);
+	assert(client != NULL);
+
+	assert(!unix_socket_ipc_has_subscribers(&ipc));
+	assert(unix_socket_ipc_send_event(&ipc, "e0\n", 3) == 0);
+	assert(!client->writing_buffer);
+
+	subscriber->subscribed = 1;
+	assert(unix_socket_ipc_has_subscribers(&ipc));
+
+	/*
+	 * Only subscriber gets the event
+	 */
+	assert(unix_socket_ipc_send_event(&ipc, "e1\n", 3) == 0);
+	assert(subscriber->writing_buffer);
+	assert(!client->writing_buffer);
+	assert(dynar_size(&client->send_buffer) == 0);
+
+	/*
+	 * Events are queued while previous ones are not sent
+	 */
+	assert(unix_socket_ipc_send_event(&ipc, "e2\n", 3) == 0);
+	assert(dynar_size(&subscriber->send_buffer) == 6);
+
+	assert(unix_socket_client_io_write(subscriber) == 1);
+	test_read_peer(sub_fds[1], "e1\ne2\n");
+	unix_socket_client_write_buffer(subscriber, 0);
+
+	/*
+	 * Buffer is reused after everything was sent
+	 */
+	assert(unix_socket_ipc_send_event(&ipc, "0123456789\n", 11) == 0);
+	assert(dynar_size(&subscriber->send_buffer) == 11);
+
+	/*
+	 * Already sent data are discarded when buffer would overflow
+	 */
+	subscriber->msg_already_sent_bytes = 8;
+	assert(unix_socket_ipc_send_event(&ipc, "abcdefghi\n", 10) == 0);
+	assert(subscriber->msg_already_sent_bytes == 0);
+	assert(dynar_size(&subscriber->send_buffer) == 13);
+	assert(memcmp(dynar_data(&subscriber->send_buffer), "89\nabcdefghi\n", 13) == 0);
+
+	/*
+	 * Slow subscriber is dropped
+	 */
+	assert(unix_socket_ipc_send_event(&ipc, "e3e3\n", 5) == 1);
+	assert(subscriber->schedule_disconnect);
+	assert(!unix_socket_ipc_has_subscribers(&ipc));
+	assert(unix_socket_ipc_send_event(&ipc, "e4\n", 3) == 0);
+
+	unix_socket_client_list_free(&ipc.clients);
+
+	close(sub_fds[0]);
+	close(sub_fds[1]);
+	close(client_fds[0]);
+	close(client_fds[1]);
+
+	return (0);
+}
@@ -56,7 +56,7 @@
 #define TLV_TYPE_LENGTH		2
 #define TLV_LENGTH_LENGTH	2
 
-#define TLV_STATIC_SUPPORTED_OPTIONS_SIZE	24
+#define TLV_STATIC_SUPPORTED_OPTIONS_SIZE	27
 
 enum tlv_opt_type tlv_static_supported_options[TLV_STATIC_SUPPORTED_OPTIONS_SIZE] = {
     TLV_OPT_MSG_SEQ_NUMBER,
@@ -83,6 +83,9 @@ enum tlv_opt_type tlv_static_supported_options[TLV_STATIC_SUPPORTED_OPTIONS_SIZE
     TLV_OPT_TIE_BREAKER,
     TLV_OPT_HEURISTICS,
     TLV_OPT_KEEP_ACTIVE_PARTITION_TIE_BREAKER,
+    TLV_OPT_NODE_LIST_VERSION,
+    TLV_OPT_NODE_LIST_BASE_VERSION,
+    TLV_OPT_REMOVED_NODE_ID,
 };
 
 int
@@ -436,6 +439,27 @@ tlv_add_keep_active_partition_tie_breaker(struct dynar *msg,
 	return (tlv_add_u8(msg, TLV_OPT_KEEP_ACTIVE_PARTITION_TIE_BREAKER, enabled));
 }
 
+int
+tlv_add_node_list_version(struct dynar *msg, uint32_t node_list_version)
+{
+
+	return (tlv_add_u32(msg, TLV_OPT_NODE_LIST_VERSION, node_list_version));
+}
+
+int
+tlv_add_node_list_base_version(struct dynar *msg, uint32_t node_list_base_version)
+{
+
+	return (tlv_add_u32(msg, TLV_OPT_NODE_LIST_BASE_VERSION, node_list_base_version));
+}
+
+int
+tlv_add_removed_node_id(struct dynar *msg, uint32_t node_id)
+{
+
+	return (tlv_add_u32(msg, TLV_OPT_REMOVED_NODE_ID, node_id));
+}
+
 void
 tlv_iter_init_str(const char *msg, size_t msg_len, size_t msg_header_len,
     struct tlv_iterator *tlv_iter)
@@ -69,6 +69,9 @@ enum tlv_opt_type {
 	TLV_OPT_TIE_BREAKER = 21,
 	TLV_OPT_HEURISTICS = 22,
 	TLV_OPT_KEEP_ACTIVE_PARTITION_TIE_BREAKER = 23,
+	TLV_OPT_NODE_LIST_VERSION = 24,
+	TLV_OPT_NODE_LIST_BASE_VERSION = 25,
+	TLV_OPT_REMOVED_NODE_ID = 26,
 };
 
 enum tlv_tls_supported {
@@ -262,6 +265,14 @@ extern int			 tlv_add_heuristics(struct dynar *msg,
 extern int			 tlv_add_keep_active_partition_tie_breaker(struct dynar *msg,
     enum tlv_keep_active_partition_tie_breaker enabled);
 
+extern int			 tlv_add_node_list_version(struct dynar *msg,
+    uint32_t node_list_version);
+
+extern int			 tlv_add_node_list_base_version(struct dynar *msg,
+    uint32_t node_list_base_version);
+
+extern int			 tlv_add_removed_node_id(struct dynar *msg, uint32_t node_id);
+
 extern void			 tlv_iter_init_str(const char *msg, size_t msg_len,
     size_t msg_header_len, struct tlv_iterator *tlv_iter);
 
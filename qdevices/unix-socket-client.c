@@ -72,6 +72,46 @@ unix_socket_client_write_buffer(struct unix_socket_client *client, int enabled)
 {
 
 	client->writing_buffer = enabled;
+
+	if (enabled) {
+		client->msg_already_sent_bytes = 0;
+	}
+}
+
+/*
+ * Append data to send buffer of client which may be already sending. Data which
+ * were already sent are discarded when there is not enough space in the buffer.
+ *  0 Data appended and client is sending buffer
+ * -1 Data doesn't fit into send buffer
+ */
+int
+unix_socket_client_write_buffer_append(struct unix_socket_client *client, const void *data,
+    size_t size)
+{
+	size_t unsent;
+
+	if (!client->writing_buffer) {
+		dynar_clean(&client->send_buffer);
+		client->msg_already_sent_bytes = 0;
+	}
+
+	if (dynar_size(&client->send_buffer) + size > dynar_max_size(&client->send_buffer) &&
+	    client->msg_already_sent_bytes > 0) {
+		unsent = dynar_size(&client->send_buffer) - client->msg_already_sent_bytes;
+
+		memmove(dynar_data(&client->send_buffer),
+		    dynar_data(&client->send_buffer) + client->msg_already_sent_bytes, unsent);
+		(void)dynar_set_size(&client->send_buffer, unsent);
+		client->msg_already_sent_bytes = 0;
+	}
+
+	if (dynar_cat(&client->send_buffer, data, size) == -1) {
+		return (-1);
+	}
+
+	client->writing_buffer = 1;
+
+	return (0);
 }
 
 /*
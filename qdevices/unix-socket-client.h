@@ -55,6 +55,7 @@ struct unix_socket_client {
 	int reading_line;
 	int writing_buffer;
 	int schedule_disconnect;
+	int subscribed;
 	void *user_data;
 	TAILQ_ENTRY(unix_socket_client) entries;
 };
@@ -68,6 +69,9 @@ extern void		unix_socket_client_read_line(struct unix_socket_client *client, int
 
 extern void		unix_socket_client_write_buffer(struct unix_socket_client *client, int enabled);
 
+extern int		unix_socket_client_write_buffer_append(struct unix_socket_client *client,
+    const void *data, size_t size);
+
 extern int		unix_socket_client_io_read(struct unix_socket_client *client);
 
 extern int		unix_socket_client_io_write(struct unix_socket_client *client);
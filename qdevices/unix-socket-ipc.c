@@ -154,3 +154,44 @@ unix_socket_ipc_client_disconnect(struct unix_socket_ipc *ipc, struct unix_socke
 	unix_socket_close(client->socket);
 	unix_socket_client_list_del(&ipc->clients, client);
 }
+
+int
+unix_socket_ipc_has_subscribers(const struct unix_socket_ipc *ipc)
+{
+	const struct unix_socket_client *client;
+
+	TAILQ_FOREACH(client, &ipc->clients, entries) {
+		if (client->subscribed && !client->schedule_disconnect) {
+			return (1);
+		}
+	}
+
+	return (0);
+}
+
+/*
+ * Queue event for all subscribed clients. Client which is not able to keep up
+ * (send buffer is full) is scheduled for disconnect. Returns number of such
+ * dropped clients.
+ */
+size_t
+unix_socket_ipc_send_event(struct unix_socket_ipc *ipc, const char *event, size_t event_len)
+{
+	struct unix_socket_client *client;
+	size_t dropped;
+
+	dropped = 0;
+
+	TAILQ_FOREACH(client, &ipc->clients, entries) {
+		if (!client->subscribed || client->schedule_disconnect) {
+			continue;
+		}
+
+		if (unix_socket_client_write_buffer_append(client, event, event_len) != 0) {
+			client->schedule_disconnect = 1;
+			dropped++;
+		}
+	}
+
+	return (dropped);
+}
@@ -65,6 +65,11 @@ extern int		unix_socket_ipc_accept(struct unix_socket_ipc *ipc,
 void			unix_socket_ipc_client_disconnect(struct unix_socket_ipc *ipc,
     struct unix_socket_client *client);
 
+extern int		unix_socket_ipc_has_subscribers(const struct unix_socket_ipc *ipc);
+
+extern size_t		unix_socket_ipc_send_event(struct unix_socket_ipc *ipc,
+    const char *event, size_t event_len);
+
 extern int		unix_socket_ipc_close(struct unix_socket_ipc *ipc);
 
 extern int		unix_socket_ipc_is_closed(struct unix_socket_ipc *ipc);